@@ -169,6 +169,18 @@ CONF_String(doris_cgroups, "");
 CONF_Int32(num_threads_per_core, "3");
 // if true, compresses tuple data in Serialize
 CONF_Bool(compress_rowbatches, "true");
+// if true, the exchange sends the tuple data of row batches as brpc attachment instead of
+// a protobuf field, which saves copying it when the request is serialized and parsed.
+// Older backends ignore the attachment, only enable it once all backends are upgraded
+CONF_mBool(transfer_data_by_brpc_attachment, "false");
+// max number of transmit_data rpcs in flight per exchange channel, the receiver bounds the
+// bytes in flight further by the credit it grants with each response. Older backends drop
+// packets that arrive out of order, only raise it once all backends are upgraded
+CONF_mInt32(exchange_max_in_flight_rpcs, "1");
+// whether the exchange channels of a query to the same backend share their rpcs, each
+// rpc then carries the packets of several channels. Only enable it once all the backends
+// support transmit_data_batch
+CONF_mBool(enable_exchange_multiplexing, "false");
 // serialize and deserialize each returned row batch
 CONF_Bool(serialize_batch, "false");
 // interval between profile reports; in seconds
@@ -183,6 +195,11 @@ CONF_Int32(doris_scanner_thread_pool_queue_size, "102400");
 CONF_Int32(etl_thread_pool_size, "8");
 // number of etl thread pool size
 CONF_Int32(etl_thread_pool_queue_size, "256");
+// max number of scanner threads of one broker scan node
+CONF_mInt32(broker_scan_node_max_scanner_threads, "4");
+// plain text file ranges larger than this are split into ranges of this size on BE,
+// so that one large file can be scanned by multiple scanner threads. 0 means no split.
+CONF_mInt64(broker_scan_range_split_bytes, "134217728");
 // port on which to run Doris test backend
 CONF_Int32(port, "20001");
 // default thrift client connect timeout(in seconds)
@@ -202,8 +219,23 @@ CONF_mInt32(doris_max_scan_key_num, "1024");
 CONF_mInt32(max_pushdown_conditions_per_column, "1024");
 // return_row / total_row
 CONF_mInt32(doris_max_pushdown_conjuncts_return_rate, "90");
+// whether a TopN node publishes its heap boundary to the olap scan node below it,
+// so that scanners can skip pages by zone map and drop rows that cannot enter the TopN
+CONF_mBool(enable_topn_runtime_filter, "false");
 // (Advanced) Maximum size of per-query receive-side buffer
 CONF_mInt32(exchg_node_buffer_size_bytes, "10485760");
+// a merging exchange with more senders than this pre-merges groups of at most this many
+// senders on a shared thread pool, and merges the outputs of the groups. 0 disables it
+CONF_mInt32(exchange_merge_fan_in, "16");
+// the max number of threads pre-merging the groups of senders of all the merging
+// exchanges, 0 means the number of cores
+CONF_Int32(exchange_merge_thread_num, "0");
+// whether a DataStreamSender hands row batches to receivers on the same backend directly,
+// without serializing them and sending them through brpc
+CONF_mBool(enable_local_exchange, "false");
+// whether the instances of a broadcast hash join on a backend share one hash table, built
+// by one of them, instead of each building its own
+CONF_mBool(enable_shared_broadcast_hash_table, "false");
 // insert sort threshold for sorter
 // CONF_Int32(insertion_threshold, "16");
 // the block_size every block allocate for sorter
@@ -349,6 +381,8 @@ CONF_Int64(load_data_reserve_hours, "4");
 // log error log will be removed after this time
 CONF_mInt64(load_error_log_reserve_hours, "48");
 CONF_Int32(number_tablet_writer_threads, "16");
+// the count of threads to receive rowsets from master replicas in single replica load
+CONF_Int32(number_sync_rowset_threads, "8");
 
 // The maximum amount of data that can be processed by a stream load
 CONF_mInt64(streaming_load_max_mb, "10240");
@@ -370,11 +404,28 @@ CONF_Int32(tablet_writer_open_rpc_timeout_sec, "60");
 // CONF_Int32(tablet_writer_rpc_timeout_sec, "600");
 // OlapTableSink sender's send interval, should be less than the real response time of a tablet writer rpc.
 CONF_mInt32(olap_table_sink_send_interval_ms, "10");
+// In single replica load, the master replica sends the segment files of its rowset
+// to slave replicas in chunks of this size. Should be less than 'brpc_max_body_size'.
+CONF_mInt64(single_replica_load_sync_chunk_bytes, "67108864");
+// the timeout of a rpc to send one chunk of segment file to a slave replica
+CONF_mInt32(single_replica_load_sync_rpc_timeout_sec, "300");
+// the max number of tablets of a load channel whose rowsets are synced to slave replicas
+// in parallel, each of them has one chunk in flight at a time.
+CONF_mInt32(single_replica_load_sync_parallel_tablets, "8");
 
 // Fragment thread pool
 CONF_Int32(fragment_pool_thread_num_min, "64");
 CONF_Int32(fragment_pool_thread_num_max, "512");
 CONF_Int32(fragment_pool_queue_size, "2048");
+// Whether to run fragment instances with a sink as pipeline tasks once they are opened.
+// The tasks run on a fixed size executor pool and are parked, instead of a thread,
+// while they wait on exchanges, scanners or rpcs.
+CONF_Bool(enable_pipeline_execution, "false");
+// Number of pipeline executor threads, 0 means the number of cpu cores
+CONF_Int32(pipeline_executor_size, "0");
+// Max number of extra pipeline executor threads, started while executor threads are
+// blocked inside a step, 0 means as many as pipeline_executor_size
+CONF_Int32(pipeline_max_extra_workers, "0");
 
 //for cast
 // CONF_Bool(cast, "true");
@@ -517,6 +568,9 @@ CONF_Int32(routine_load_thread_pool_size, "10");
 // max external scan cache batch count, means cache max_memory_cache_batch_count * batch_size row
 // default is 20, batch_size's default value is 1024 means 20 * 1024 rows will be cached
 CONF_mInt32(max_memory_sink_batch_count, "20");
+// whether the olap scanners of an external scan convert the storage column blocks to arrow
+// directly, instead of materializing tuples which the memory scratch sink converts back
+CONF_mBool(enable_columnar_external_scan, "false");
 
 // This configuration is used for the context gc thread schedule period
 // note: unit is minute, default is 5min
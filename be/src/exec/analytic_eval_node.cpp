@@ -19,7 +19,9 @@
 
 #include "exprs/agg_fn_evaluator.h"
 #include "exprs/anyval_util.h"
+#include "exprs/expr_context.h"
 #include "runtime/descriptors.h"
+#include "runtime/raw_value.h"
 #include "runtime/row_batch.h"
 #include "runtime/runtime_state.h"
 #include "udf/udf_internal.h"
@@ -217,6 +219,20 @@ Status AnalyticEvalNode::open(RuntimeState* state) {
             VLOG_FILE << id() << " FIRST_VAL rewrite null offset: " << _first_val_null_offset;
             _has_first_val_null_offset = true;
         }
+
+        AggFnEvaluator::AggregationOp op = _evaluators[i]->agg_op();
+        if (_fn_scope == ROWS && _window.__isset.window_start &&
+            (op == AggFnEvaluator::MIN || op == AggFnEvaluator::MAX)) {
+            DCHECK_EQ(_evaluators[i]->input_expr_ctxs().size(), 1);
+            MinMaxWindow window;
+            window.evaluator_idx = i;
+            window.is_min = op == AggFnEvaluator::MIN;
+            window.input_expr_ctx = _evaluators[i]->input_expr_ctxs()[0];
+            window.value_buffer = _mem_pool->allocate(
+                    window.input_expr_ctx->root()->type().get_slot_size());
+            window.front_removed = false;
+            _min_max_windows.push_back(window);
+        }
     }
 
     if (_partition_by_eq_expr_ctx != NULL) {
@@ -375,11 +391,71 @@ std::string AnalyticEvalNode::debug_state_string(bool detailed) const {
     return ss.str();
 }
 
+void AnalyticEvalNode::add_min_max_window_tuple(int64_t stream_idx, Tuple* tuple) {
+    TupleRow* row = reinterpret_cast<TupleRow*>(&tuple);
+    for (int i = 0; i < _min_max_windows.size(); ++i) {
+        MinMaxWindow& window = _min_max_windows[i];
+        const void* result = window.input_expr_ctx->get_value(row);
+        if (result == NULL) {
+            // NULLs are ignored by MIN()/MAX()
+            continue;
+        }
+        // Copy the value, evaluating the argument on another row may overwrite it.
+        const TypeDescriptor& type = window.input_expr_ctx->root()->type();
+        RawValue::write(result, window.value_buffer, type, NULL);
+        // Tuples before the new one that are not better can never be the min (max) again.
+        while (!window.tuples.empty()) {
+            TupleRow* back = reinterpret_cast<TupleRow*>(&window.tuples.back().second);
+            int cmp = RawValue::compare(window.input_expr_ctx->get_value(back),
+                                       window.value_buffer, type);
+            if (window.is_min ? cmp < 0 : cmp > 0) {
+                break;
+            }
+            window.tuples.pop_back();
+        }
+        window.tuples.push_back(std::pair<int64_t, Tuple*>(stream_idx, tuple));
+    }
+}
+
+void AnalyticEvalNode::remove_min_max_window_tuple(int64_t stream_idx) {
+    for (int i = 0; i < _min_max_windows.size(); ++i) {
+        MinMaxWindow& window = _min_max_windows[i];
+        if (!window.tuples.empty() && window.tuples.front().first <= stream_idx) {
+            DCHECK_EQ(window.tuples.front().first, stream_idx);
+            window.tuples.pop_front();
+            window.front_removed = true;
+        }
+    }
+}
+
+void AnalyticEvalNode::update_min_max_values() {
+    for (int i = 0; i < _min_max_windows.size(); ++i) {
+        MinMaxWindow& window = _min_max_windows[i];
+        if (!window.front_removed) {
+            // the intermediate value is still the min (max) of the tuples added since the
+            // last rebuild, which includes the front
+            continue;
+        }
+        AggFnEvaluator* evaluator = _evaluators[window.evaluator_idx];
+        doris_udf::FunctionContext* ctx = _fn_ctxs[window.evaluator_idx];
+        // Release the resources of the old value, e.g. a copied string.
+        evaluator->finalize(ctx, _curr_tuple, _dummy_result_tuple);
+        evaluator->init(ctx, _curr_tuple);
+        if (!window.tuples.empty()) {
+            evaluator->add(ctx, reinterpret_cast<TupleRow*>(&window.tuples.front().second),
+                           _curr_tuple);
+        }
+        window.front_removed = false;
+    }
+}
+
 void AnalyticEvalNode::add_result_tuple(int64_t stream_idx) {
     VLOG_ROW << id() << " add_result_tuple idx=" << stream_idx;
     DCHECK(_curr_tuple != NULL);
     Tuple* result_tuple = Tuple::create(_result_tuple_desc->byte_size(), _curr_tuple_pool.get());
 
+    update_min_max_values();
+
     AggFnEvaluator::get_value(_evaluators, _fn_ctxs, _curr_tuple, result_tuple);
     DCHECK_GT(stream_idx, _last_result_idx);
     _result_tuples.push_back(std::pair<int64_t, Tuple*>(stream_idx, result_tuple));
@@ -439,6 +515,7 @@ inline void AnalyticEvalNode::try_remove_rows_before_window(int64_t stream_idx)
             << debug_state_string(true);
     TupleRow* remove_row = reinterpret_cast<TupleRow*>(&_window_tuples.front().second);
     AggFnEvaluator::remove(_evaluators, _fn_ctxs, remove_row, _curr_tuple);
+    remove_min_max_window_tuple(_window_tuples.front().first);
     _window_tuples.pop_front();
 }
 
@@ -485,6 +562,7 @@ inline void AnalyticEvalNode::try_add_remaining_results(int64_t partition_idx,
                      << " for result row at idx=" << next_result_idx;
             TupleRow* remove_row = reinterpret_cast<TupleRow*>(&_window_tuples.front().second);
             AggFnEvaluator::remove(_evaluators, _fn_ctxs, remove_row, _curr_tuple);
+            remove_min_max_window_tuple(_window_tuples.front().first);
             _window_tuples.pop_front();
         }
 
@@ -545,6 +623,10 @@ inline void AnalyticEvalNode::init_next_partition(int64_t stream_idx) {
     }
 
     _window_tuples.clear();
+    for (int i = 0; i < _min_max_windows.size(); ++i) {
+        _min_max_windows[i].tuples.clear();
+        _min_max_windows[i].front_removed = false;
+    }
 
     // Re-initialize _curr_tuple.
     VLOG_ROW << id() << " Reset curr_tuple";
@@ -669,6 +751,7 @@ Status AnalyticEvalNode::process_child_batch(RuntimeState* state) {
                 Tuple* tuple =
                         row->get_tuple(0)->deep_copy(*_child_tuple_desc, _curr_tuple_pool.get());
                 _window_tuples.push_back(std::pair<int64_t, Tuple*>(stream_idx, tuple));
+                add_min_max_window_tuple(stream_idx, tuple);
                 last_window_tuple_idx = stream_idx;
             }
         }
@@ -18,6 +18,8 @@
 #ifndef INF_DORIS_BE_SRC_EXEC_ANALYTIC_EVAL_NODE_H
 #define INF_DORIS_BE_SRC_EXEC_ANALYTIC_EVAL_NODE_H
 
+#include <deque>
+
 #include "exec/exec_node.h"
 #include "exprs/expr.h"
 //#include "exprs/expr_context.h"
@@ -113,6 +115,15 @@ private:
         ROWS
     };
 
+    // Maintain the monotonic deques of _min_max_windows when the tuple of the row at
+    // 'stream_idx' is added to or removed from _window_tuples.
+    void add_min_max_window_tuple(int64_t stream_idx, Tuple* tuple);
+    void remove_min_max_window_tuple(int64_t stream_idx);
+
+    // Rebuilds the intermediate values of the _min_max_windows whose front was removed
+    // from the current front. Called before the values are read from _curr_tuple.
+    void update_min_max_values();
+
     // Evaluates analytic functions over _curr_child_batch. Each input row is passed
     // to the evaluators and added to _input_stream where they are stored until a tuple
     // containing the results of the analytic functions for that row is ready to be
@@ -258,6 +269,25 @@ private:
     std::list<std::pair<int64_t, Tuple*>> _window_tuples;
     TupleDescriptor* _child_tuple_desc;
 
+    // MIN()/MAX() have no Remove() function, so over a ROWS window with an offset start
+    // bound their intermediate value can not be updated when a tuple leaves the window.
+    // Instead a monotonic deque of the window tuples that may still become the min (max)
+    // of the window is kept, in window order with the current min (max) at the front.
+    // Every tuple is pushed and popped at most once, and the intermediate value is only
+    // rebuilt from the new front when the front left the window.
+    struct MinMaxWindow {
+        int evaluator_idx;
+        bool is_min;
+        // the argument of the function, evaluated on the window tuples
+        ExprContext* input_expr_ctx;
+        // holds a copy of the argument value of the tuple being added
+        uint8_t* value_buffer;
+        // true once the front was removed since the intermediate value was last rebuilt
+        bool front_removed;
+        std::deque<std::pair<int64_t, Tuple*>> tuples;
+    };
+    std::vector<MinMaxWindow> _min_max_windows;
+
     // Pools used to allocate result tuples (added to _result_tuples and later returned)
     // and window tuples (added to _window_tuples to buffer the current window). Resources
     // are transferred from _curr_tuple_pool to _prev_tuple_pool once it is at least
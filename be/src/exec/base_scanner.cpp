@@ -22,6 +22,7 @@
 #include "runtime/mem_tracker.h"
 #include "runtime/raw_value.h"
 #include "runtime/runtime_state.h"
+#include "runtime/stream_load/stream_load_pipe.h"
 #include "runtime/tuple.h"
 
 namespace doris {
@@ -62,6 +63,19 @@ Status BaseScanner::open() {
     return Status::OK();
 }
 
+void BaseScanner::update_stream_load_pipe_counters(StreamLoadPipe* pipe) {
+    RuntimeProfile::Counter* read_wait_timer = ADD_TIMER(_profile, "PipeReadWaitTime");
+    RuntimeProfile::Counter* append_wait_timer = ADD_TIMER(_profile, "PipeAppendWaitTime");
+    RuntimeProfile::Counter* peak_buffered_counter =
+            ADD_COUNTER(_profile, "PipePeakBufferedBytes", TUnit::BYTES);
+    COUNTER_UPDATE(read_wait_timer, pipe->read_wait_nanos());
+    COUNTER_UPDATE(append_wait_timer, pipe->append_wait_nanos());
+    int64_t peak_buffered_bytes = pipe->peak_buffered_bytes();
+    if (peak_buffered_bytes > peak_buffered_counter->value()) {
+        COUNTER_SET(peak_buffered_counter, peak_buffered_bytes);
+    }
+}
+
 Status BaseScanner::init_expr_ctxes() {
     // Construct _src_slot_descs
     const TupleDescriptor* src_tuple_desc =
@@ -32,6 +32,7 @@ class RowDescriptor;
 class MemTracker;
 class RuntimeState;
 class ExprContext;
+class StreamLoadPipe;
 
 struct ScannerCounter {
     ScannerCounter() : num_rows_filtered(0), num_rows_unselected(0) {}
@@ -61,6 +62,9 @@ public:
                                          const std::vector<std::string>& columns_from_path);
 
 protected:
+    // Add the statistics of a stream load pipe to the profile, called before releasing the pipe.
+    void update_stream_load_pipe_counters(StreamLoadPipe* pipe);
+
     RuntimeState* _state;
     const TBrokerScanRangeParams& _params;
     // used for process stat
@@ -50,7 +50,7 @@ public:
     virtual Status read(uint8_t* buf, size_t* buf_len, bool* eof) override;
     virtual Status readat(int64_t position, int64_t nbytes, int64_t* bytes_read,
                           void* out) override;
-    virtual Status read_one_message(uint8_t** buf, size_t* length) override;
+    virtual Status read_one_message(ByteBufferPtr* buf) override;
     virtual int64_t size() override;
     virtual Status seek(int64_t position) override;
     virtual Status tell(int64_t* position) override;
@@ -17,9 +17,11 @@
 
 #include "exec/broker_scan_node.h"
 
+#include <algorithm>
 #include <chrono>
 #include <sstream>
 
+#include "common/config.h"
 #include "common/object_pool.h"
 #include "exec/broker_scanner.h"
 #include "exec/json_scanner.h"
@@ -39,6 +41,7 @@ BrokerScanNode::BrokerScanNode(ObjectPool* pool, const TPlanNode& tnode, const D
           _runtime_state(nullptr),
           _tuple_desc(nullptr),
           _num_running_scanners(0),
+          _next_scan_range_idx(0),
           _scan_finished(false),
           _max_buffered_batches(32),
           _wait_scanner_timer(nullptr) {}
@@ -125,11 +128,16 @@ Status BrokerScanNode::open(RuntimeState* state) {
 }
 
 Status BrokerScanNode::start_scanners() {
+    int num_scanners = std::min<int>(config::broker_scan_node_max_scanner_threads,
+                                     _scan_ranges.size());
+    num_scanners = std::max(1, num_scanners);
     {
         std::unique_lock<std::mutex> l(_batch_queue_lock);
-        _num_running_scanners = 1;
+        _num_running_scanners = num_scanners;
+    }
+    for (int i = 0; i < num_scanners; ++i) {
+        _scanner_threads.emplace_back(&BrokerScanNode::scanner_worker, this);
     }
-    _scanner_threads.emplace_back(&BrokerScanNode::scanner_worker, this, 0, _scan_ranges.size());
     return Status::OK();
 }
 
@@ -255,9 +263,71 @@ Status BrokerScanNode::set_scan_ranges(const std::vector<TScanRangeParams>& scan
         }
     }
 
+    split_scan_ranges();
     return Status::OK();
 }
 
+static bool is_range_splittable(const TBrokerRangeDesc& range, int64_t split_bytes) {
+    // Only plain text can be read from any offset, the first line of a range which
+    // does not start at 0 is skipped by BrokerScanner, and the line across the end
+    // of a range is read to the end by the range before it.
+    if (!range.splittable || range.format_type != TFileFormatType::FORMAT_CSV_PLAIN) {
+        return false;
+    }
+    if (range.file_type != TFileType::FILE_LOCAL && range.file_type != TFileType::FILE_BROKER) {
+        return false;
+    }
+    if (range.size < 0) {
+        return range.__isset.file_size && range.file_size - range.start_offset > split_bytes;
+    }
+    return range.size > split_bytes;
+}
+
+void BrokerScanNode::split_scan_ranges() {
+    int64_t split_bytes = config::broker_scan_range_split_bytes;
+    if (split_bytes <= 0) {
+        return;
+    }
+    std::vector<TScanRangeParams> split_ranges;
+    for (auto& scan_range_params : _scan_ranges) {
+        const auto& ranges = scan_range_params.scan_range.broker_scan_range.ranges;
+        bool need_split = false;
+        for (auto& range : ranges) {
+            need_split |= is_range_splittable(range, split_bytes);
+        }
+        if (!need_split) {
+            split_ranges.push_back(scan_range_params);
+            continue;
+        }
+
+        TScanRangeParams empty_range_params = scan_range_params;
+        empty_range_params.scan_range.broker_scan_range.ranges.clear();
+        // ranges which can not be split are still scanned by one scanner in order
+        TScanRangeParams unsplit_range_params = empty_range_params;
+        for (auto& range : ranges) {
+            if (!is_range_splittable(range, split_bytes)) {
+                unsplit_range_params.scan_range.broker_scan_range.ranges.push_back(range);
+                continue;
+            }
+            int64_t end_offset =
+                    range.size < 0 ? range.file_size : range.start_offset + range.size;
+            for (int64_t offset = range.start_offset; offset < end_offset; offset += split_bytes) {
+                TBrokerRangeDesc split_range = range;
+                split_range.start_offset = offset;
+                split_range.size = std::min(split_bytes, end_offset - offset);
+                split_ranges.push_back(empty_range_params);
+                split_ranges.back().scan_range.broker_scan_range.ranges.push_back(split_range);
+            }
+        }
+        if (!unsplit_range_params.scan_range.broker_scan_range.ranges.empty()) {
+            split_ranges.push_back(unsplit_range_params);
+        }
+    }
+    VLOG_QUERY << "BrokerScanNode split " << _scan_ranges.size() << " scan ranges into "
+               << split_ranges.size();
+    _scan_ranges.swap(split_ranges);
+}
+
 void BrokerScanNode::debug_string(int ident_level, std::stringstream* out) const {
     (*out) << "BrokerScanNode";
 }
@@ -380,7 +450,7 @@ Status BrokerScanNode::scanner_scan(const TBrokerScanRange& scan_range,
     return Status::OK();
 }
 
-void BrokerScanNode::scanner_worker(int start_idx, int length) {
+void BrokerScanNode::scanner_worker() {
     // Clone expr context
     std::vector<ExprContext*> scanner_expr_ctxs;
     auto status = Expr::clone_if_not_exists(_conjunct_ctxs, _runtime_state, &scanner_expr_ctxs);
@@ -397,12 +467,15 @@ void BrokerScanNode::scanner_worker(int start_idx, int length) {
         }
     }
     ScannerCounter counter;
-    for (int i = 0; i < length && status.ok(); ++i) {
-        const TBrokerScanRange& scan_range =
-                _scan_ranges[start_idx + i].scan_range.broker_scan_range;
+    while (status.ok() && !_scan_finished.load()) {
+        int idx = _next_scan_range_idx.fetch_add(1);
+        if (idx >= _scan_ranges.size()) {
+            break;
+        }
+        const TBrokerScanRange& scan_range = _scan_ranges[idx].scan_range.broker_scan_range;
         status = scanner_scan(scan_range, scanner_expr_ctxs, partition_expr_ctxs, &counter);
         if (!status.ok()) {
-            LOG(WARNING) << "Scanner[" << start_idx + i
+            LOG(WARNING) << "Scanner[" << idx
                          << "] process failed. status=" << status.get_error_msg();
         }
     }
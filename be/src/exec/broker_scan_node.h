@@ -84,8 +84,13 @@ private:
     // Create scanners to do scan job
     Status start_scanners();
 
-    // One scanner worker, This scanner will handle 'length' ranges start from start_idx
-    void scanner_worker(int start_idx, int length);
+    // Split large plain text ranges in _scan_ranges into ranges of
+    // config::broker_scan_range_split_bytes, each of which is scanned by its own scanner.
+    void split_scan_ranges();
+
+    // One scanner worker, This worker will fetch ranges from _scan_ranges until all
+    // of them are taken by workers.
+    void scanner_worker();
 
     // Scan one range
     Status scanner_scan(const TBrokerScanRange& scan_range,
@@ -112,6 +117,8 @@ private:
     std::deque<std::shared_ptr<RowBatch>> _batch_queue;
 
     int _num_running_scanners;
+    // index of the next range in _scan_ranges to be scanned by scanner workers
+    std::atomic<int> _next_scan_range_idx;
     // Indicate if all scanners have been finished scan worker
     bool _all_scanners_finished;
 
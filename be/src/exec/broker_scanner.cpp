@@ -34,6 +34,7 @@
 #include "runtime/stream_load/load_stream_mgr.h"
 #include "runtime/stream_load/stream_load_pipe.h"
 #include "runtime/tuple.h"
+#include "util/csv_tokenizer.h"
 #include "util/utf8_check.h"
 
 namespace doris {
@@ -47,7 +48,9 @@ BrokerScanner::BrokerScanner(RuntimeState* state, RuntimeProfile* profile,
           _ranges(ranges),
           _broker_addresses(broker_addresses),
           // _splittable(params.splittable),
-          _value_separator(static_cast<char>(params.column_separator)),
+          _value_separator(params.__isset.multi_column_separator
+                                   ? params.multi_column_separator
+                                   : std::string(1, static_cast<char>(params.column_separator))),
           _line_delimiter(static_cast<char>(params.line_delimiter)),
           _cur_file_reader(nullptr),
           _cur_line_reader(nullptr),
@@ -55,7 +58,9 @@ BrokerScanner::BrokerScanner(RuntimeState* state, RuntimeProfile* profile,
           _next_range(0),
           _cur_line_reader_eof(false),
           _scanner_eof(false),
-          _skip_next_line(false) {}
+          _skip_next_line(false) {
+    _tokenizer.reset(new CsvTokenizer(_value_separator));
+}
 
 BrokerScanner::~BrokerScanner() {
     close();
@@ -124,6 +129,7 @@ Status BrokerScanner::open_next_reader() {
 Status BrokerScanner::open_file_reader() {
     if (_cur_file_reader != nullptr) {
         if (_stream_load_pipe != nullptr) {
+            update_stream_load_pipe_counters(_stream_load_pipe.get());
             _stream_load_pipe.reset();
             _cur_file_reader = nullptr;
         } else {
@@ -273,6 +279,7 @@ void BrokerScanner::close() {
 
     if (_cur_file_reader != nullptr) {
         if (_stream_load_pipe != nullptr) {
+            update_stream_load_pipe_counters(_stream_load_pipe.get());
             _stream_load_pipe.reset();
             _cur_file_reader = nullptr;
         } else {
@@ -284,15 +291,7 @@ void BrokerScanner::close() {
 
 void BrokerScanner::split_line(const Slice& line, std::vector<Slice>* values) {
     // line-begin char and line-end char are considered to be 'delimiter'
-    const char* value = line.data;
-    const char* ptr = line.data;
-    for (size_t i = 0; i < line.size; ++i, ++ptr) {
-        if (*ptr == _value_separator) {
-            values->emplace_back(value, ptr - value);
-            value = ptr + 1;
-        }
-    }
-    values->emplace_back(value, ptr - value);
+    _tokenizer->split(line, values);
 }
 
 void BrokerScanner::fill_fix_length_string(const Slice& value, MemPool* pool, char** new_value_p,
@@ -394,7 +393,7 @@ bool BrokerScanner::line_to_src_tuple(const Slice& line) {
         return false;
     }
 
-    std::vector<Slice> values;
+    std::vector<Slice>& values = _split_values;
     { split_line(line, &values); }
 
     // range of current file
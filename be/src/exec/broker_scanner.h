@@ -36,6 +36,7 @@ namespace doris {
 class Tuple;
 class SlotDescriptor;
 class Slice;
+class CsvTokenizer;
 class TextConverter;
 class FileReader;
 class LineReader;
@@ -99,8 +100,11 @@ private:
 
     std::unique_ptr<TextConverter> _text_converter;
 
-    char _value_separator;
+    std::string _value_separator;
     char _line_delimiter;
+    std::unique_ptr<CsvTokenizer> _tokenizer;
+    // reused by every line to avoid allocation
+    std::vector<Slice> _split_values;
 
     // Reader
     FileReader* _cur_file_reader;
@@ -50,7 +50,7 @@ Status BufferedReader::open() {
 }
 
 //not support
-Status BufferedReader::read_one_message(uint8_t** buf, size_t* length) {
+Status BufferedReader::read_one_message(ByteBufferPtr* buf) {
     return Status::NotSupported("Not support");
 }
 
@@ -31,6 +31,7 @@
 #include "runtime/runtime_state.h"
 #include "runtime/string_value.h"
 #include "runtime/tuple_row.h"
+#include "util/csv_tokenizer.h"
 #include "util/debug_util.h"
 #include "util/file_utils.h"
 #include "util/hash_util.hpp"
@@ -38,52 +39,6 @@
 
 namespace doris {
 
-class StringRef {
-public:
-    StringRef(char const* const begin, int const size) : _begin(begin), _size(size) {}
-
-    ~StringRef() {
-        // No need to delete _begin, because it only record the index in a std::string.
-        // The c-string will be released along with the std::string object.
-    }
-
-    int size() const { return _size; }
-    int length() const { return _size; }
-
-    char const* c_str() const { return _begin; }
-    char const* begin() const { return _begin; }
-
-    char const* end() const { return _begin + _size; }
-
-private:
-    char const* _begin;
-    int _size;
-};
-
-void split_line(const std::string& str, char delimiter, std::vector<StringRef>& result) {
-    enum State { IN_DELIM = 1, IN_TOKEN = 0 };
-
-    // line-begin char and line-end char are considered to be 'delimeter'
-    State state = IN_DELIM;
-    char const* p_begin = str.c_str(); // Begin of either a token or a delimiter
-    for (string::const_iterator it = str.begin(); it != str.end(); ++it) {
-        State const new_state = (*it == delimiter ? IN_DELIM : IN_TOKEN);
-        if (new_state != state) {
-            if (new_state == IN_DELIM) {
-                result.push_back(StringRef(p_begin, &*it - p_begin));
-            }
-            p_begin = &*it;
-        } else if (new_state == IN_DELIM) {
-            result.push_back(StringRef(&*p_begin, 0));
-            p_begin = &*it;
-        }
-
-        state = new_state;
-    }
-
-    result.push_back(StringRef(p_begin, (&*str.end() - p_begin) - state));
-}
-
 CsvScanNode::CsvScanNode(ObjectPool* pool, const TPlanNode& tnode, const DescriptorTbl& descs)
         : ScanNode(pool, tnode, descs),
           _tuple_id(tnode.csv_scan_node.tuple_id),
@@ -127,6 +82,8 @@ Status CsvScanNode::prepare(RuntimeState* state) {
     // add timer
     _split_check_timer = ADD_TIMER(_runtime_profile, "split check timer");
     _split_line_timer = ADD_TIMER(_runtime_profile, "split line timer");
+    // only the first char of separator is used
+    _tokenizer.reset(new CsvTokenizer(std::string(1, _column_separator[0])));
 
     _tuple_desc = state->desc_tbl().get_tuple_descriptor(_tuple_id);
     if (nullptr == _tuple_desc) {
@@ -517,11 +474,10 @@ bool CsvScanNode::split_check_fill(const std::string& line, RuntimeState* state)
     SCOPED_TIMER(_split_check_timer);
 
     std::stringstream error_msg;
-    // std::vector<std::string> fields;
-    std::vector<StringRef> fields;
+    std::vector<Slice>& fields = _split_fields;
     {
         SCOPED_TIMER(_split_line_timer);
-        split_line(line, _column_separator[0], fields);
+        _tokenizer->split(Slice(line), &fields);
     }
 
     if (_hll_column_num == 0 && fields.size() < _columns.size()) {
@@ -555,8 +511,8 @@ bool CsvScanNode::split_check_fill(const std::string& line, RuntimeState* state)
         }
 
         const TColumnType& column_type = _column_type_vec[i];
-        bool flag = check_and_write_text_slot(column_name, column_type, fields[i].c_str(),
-                                              fields[i].length(), slot, state, &error_msg);
+        bool flag = check_and_write_text_slot(column_name, column_type, fields[i].data,
+                                              fields[i].size, slot, state, &error_msg);
 
         if (flag == false) {
             _runtime_state->append_error_msg_to_file(line, error_msg.str());
@@ -596,8 +552,8 @@ bool CsvScanNode::split_check_fill(const std::string& line, RuntimeState* state)
         const SlotDescriptor* slot = _column_slot_map[column_name];
         const TColumnType& column_type = _column_type_map[column_name];
         std::string column_string = "";
-        const char* src = fields[function.param_column_index].c_str();
-        int src_column_len = fields[function.param_column_index].length();
+        const char* src = fields[function.param_column_index].data;
+        int src_column_len = fields[function.param_column_index].size;
         hll_hash(src, src_column_len, &column_string);
         bool flag = check_and_write_text_slot(column_name, column_type, column_string.c_str(),
                                               column_string.length(), slot, state, &error_msg);
@@ -26,9 +26,11 @@
 #include "exec/csv_scanner.h"
 #include "exec/scan_node.h"
 #include "runtime/descriptors.h"
+#include "util/slice.h"
 
 namespace doris {
 
+class CsvTokenizer;
 class TextConverter;
 class Tuple;
 class TupleDescriptor;
@@ -85,6 +87,9 @@ private:
     std::vector<std::string> _file_paths;
 
     std::string _column_separator;
+    std::unique_ptr<CsvTokenizer> _tokenizer;
+    // reused by every line to avoid allocation
+    std::vector<Slice> _split_fields;
 
     std::map<std::string, TColumnType> _column_type_map;
     // mapping function
@@ -56,6 +56,10 @@ public:
     // Send a row batch into this sink.
     // eos should be true when the last batch is passed to send()
     virtual Status send(RuntimeState* state, RowBatch* batch) = 0;
+
+    // Returns false if send() would block, e.g. on the in-flight rpc of a channel.
+    // Used by the pipeline scheduler together with ExecNode::can_get_next().
+    virtual bool can_send() { return true; }
     // virtual Status send(RuntimeState* state, RowBatch* batch, bool eos) = 0;
 
     // Releases all resources that were allocated in prepare()/send().
@@ -38,52 +38,37 @@ Status ExceptNode::init(const TPlanNode& tnode, RuntimeState* state) {
     return Status::OK();
 }
 
+// 1 build a hash table from child(0), removing duplicated rows
+// 2 probe with child(1), and mark the rows it found as matched, they are not in the result
+// repeat [2] this for all the rest child on the same hash table, evaluating the rows of
+// each child with its own exprs. Stop once every row is matched, the result is empty
+// then and the rest of the children need not be read.
 Status ExceptNode::open(RuntimeState* state) {
     RETURN_IF_ERROR(SetOperationNode::open(state));
-    // if a table is empty, the result must be empty
-
-    if (_hash_tbl->size() == 0) {
-        _hash_tbl_iterator = _hash_tbl->begin();
-        return Status::OK();
-    }
-    bool eos = false;
+    // number of rows not matched yet
+    int64_t num_valid = _hash_tbl->size();
 
-    for (int i = 1; i < _children.size(); ++i) {
-        // rebuild hash table, for first time will rebuild with the no duplicated _hash_tbl,
-        if (i > 1) {
-            SCOPED_TIMER(_build_timer);
-            std::unique_ptr<HashTable> temp_tbl(
-                    new HashTable(_child_expr_lists[0], _child_expr_lists[i], _build_tuple_size,
-                                  true, _find_nulls, id(), mem_tracker(), 1024));
-            _hash_tbl_iterator = _hash_tbl->begin();
-            while (_hash_tbl_iterator.has_next()) {
-                if (!_hash_tbl_iterator.matched()) {
-                    VLOG_ROW << "rebuild row: "
-                             << get_row_output_string(_hash_tbl_iterator.get_row(),
-                                                      child(0)->row_desc());
-                    temp_tbl->insert(_hash_tbl_iterator.get_row());
-                }
-                _hash_tbl_iterator.next<false>();
-            }
-            _hash_tbl.swap(temp_tbl);
-            temp_tbl->close();
-        }
+    // if a table is empty, the result must be empty
+    for (int i = 1; i < _children.size() && num_valid > 0; ++i) {
         // probe
         _probe_batch.reset(
                 new RowBatch(child(i)->row_desc(), state->batch_size(), mem_tracker().get()));
         ScopedTimer<MonotonicStopWatch> probe_timer(_probe_timer);
         RETURN_IF_ERROR(child(i)->open(state));
-        eos = false;
-        while (!eos) {
+        bool eos = false;
+        while (!eos && num_valid > 0) {
             RETURN_IF_CANCELLED(state);
             RETURN_IF_ERROR(child(i)->get_next(state, _probe_batch.get(), &eos));
             RETURN_IF_LIMIT_EXCEEDED(state, " Except , while probing the hash table.");
             for (int j = 0; j < _probe_batch->num_rows(); ++j) {
                 VLOG_ROW << "probe row: "
                          << get_row_output_string(_probe_batch->get_row(j), child(i)->row_desc());
-                _hash_tbl_iterator = _hash_tbl->find(_probe_batch->get_row(j));
-                if (_hash_tbl_iterator != _hash_tbl->end()) {
+                // the rows of every child have their own layout
+                _hash_tbl_iterator =
+                        _hash_tbl->find(_probe_batch->get_row(j), _child_expr_lists[i]);
+                if (_hash_tbl_iterator != _hash_tbl->end() && !_hash_tbl_iterator.matched()) {
                     _hash_tbl_iterator.set_matched();
+                    --num_valid;
                     VLOG_ROW << "probe matched: "
                              << get_row_output_string(_hash_tbl_iterator.get_row(),
                                                       child(0)->row_desc());
@@ -91,10 +76,6 @@ Status ExceptNode::open(RuntimeState* state) {
             }
             _probe_batch->reset();
         }
-        // if a table is empty, the result must be empty
-        if (_hash_tbl->size() == 0) {
-            break;
-        }
     }
     _hash_tbl_iterator = _hash_tbl->begin();
     return Status::OK();
@@ -23,6 +23,7 @@
 #include "runtime/data_stream_mgr.h"
 #include "runtime/data_stream_recvr.h"
 #include "runtime/exec_env.h"
+#include "runtime/pipeline_scheduler.h"
 #include "runtime/row_batch.h"
 #include "runtime/runtime_state.h"
 #include "util/runtime_profile.h"
@@ -80,10 +81,10 @@ Status ExchangeNode::open(RuntimeState* state) {
     RETURN_IF_ERROR(ExecNode::open(state));
     if (_is_merging) {
         RETURN_IF_ERROR(_sort_exec_exprs.open(state));
-        TupleRowComparator less_than(_sort_exec_exprs, _is_asc_order, _nulls_first);
         // create_merger() will populate its merging heap with batches from the _stream_recvr,
         // so it is not necessary to call fill_input_row_batch().
-        RETURN_IF_ERROR(_stream_recvr->create_merger(less_than));
+        RETURN_IF_ERROR(_stream_recvr->create_merger(state, _sort_exec_exprs, _is_asc_order,
+                                                     _nulls_first));
     } else {
         RETURN_IF_ERROR(fill_input_row_batch(state));
     }
@@ -191,6 +192,15 @@ Status ExchangeNode::get_next(RuntimeState* state, RowBatch* output_batch, bool*
             _input_batch->transfer_resource_ownership(output_batch);
         }
 
+        // on the pipeline scheduler, return the rows we have rather than wait for the
+        // senders, so the fragment can be parked
+        if (output_batch->num_rows() > 0 && PipelineScheduler::is_worker_thread() &&
+            !_stream_recvr->is_data_ready()) {
+            _input_batch = NULL;
+            *eos = false;
+            return Status::OK();
+        }
+
         RETURN_IF_ERROR(fill_input_row_batch(state));
         *eos = (_input_batch == NULL);
         if (*eos) {
@@ -202,6 +212,16 @@ Status ExchangeNode::get_next(RuntimeState* state, RowBatch* output_batch, bool*
     }
 }
 
+bool ExchangeNode::can_get_next() {
+    if (_stream_recvr == NULL || reached_limit()) {
+        return true;
+    }
+    if (!_is_merging && _input_batch != NULL && _next_row_idx < _input_batch->num_rows()) {
+        return true;
+    }
+    return _stream_recvr->is_data_ready();
+}
+
 Status ExchangeNode::get_next_merging(RuntimeState* state, RowBatch* output_batch, bool* eos) {
     DCHECK_EQ(output_batch->num_rows(), 0);
     RETURN_IF_CANCELLED(state);
@@ -50,6 +50,7 @@
 #include "exec/spill_sort_node.h"
 #include "exec/topn_node.h"
 #include "exec/union_node.h"
+#include "exprs/expr_column.h"
 #include "exprs/expr_context.h"
 #include "odbc_scan_node.h"
 #include "runtime/descriptors.h"
@@ -202,6 +203,15 @@ Status ExecNode::reset(RuntimeState* state) {
     return Status::OK();
 }
 
+bool ExecNode::can_get_next() {
+    for (auto child : _children) {
+        if (!child->is_closed() && !child->can_get_next()) {
+            return false;
+        }
+    }
+    return true;
+}
+
 Status ExecNode::collect_query_statistics(QueryStatistics* statistics) {
     DCHECK(statistics != nullptr);
     for (auto child_node : _children) {
@@ -500,6 +510,29 @@ bool ExecNode::eval_conjuncts(ExprContext* const* ctxs, int num_ctxs, TupleRow*
     return true;
 }
 
+int ExecNode::eval_conjuncts_batch(ExprContext* const* ctxs, int num_ctxs, TupleRow** rows,
+                                   int num_rows, int* sel) {
+    for (int i = 0; i < num_rows; ++i) {
+        sel[i] = i;
+    }
+    int num_sel = num_rows;
+    for (int i = 0; i < num_ctxs && num_sel > 0; ++i) {
+        const ExprColumn* column = ctxs[i]->evaluate_batch(rows, num_sel);
+        const bool* values = column->data<bool>();
+        const uint8_t* nulls = column->nulls();
+        int num_passed = 0;
+        for (int j = 0; j < num_sel; ++j) {
+            if (!nulls[j] && values[j]) {
+                sel[num_passed] = sel[j];
+                rows[num_passed] = rows[j];
+                ++num_passed;
+            }
+        }
+        num_sel = num_passed;
+    }
+    return num_sel;
+}
+
 void ExecNode::collect_nodes(TPlanNodeType::type node_type, std::vector<ExecNode*>* nodes) {
     if (_type == node_type) {
         nodes->push_back(this);
@@ -98,6 +98,12 @@ public:
     // TODO: AggregationNode and HashJoinNode cannot be "re-opened" yet.
     virtual Status get_next(RuntimeState* state, RowBatch* row_batch, bool* eos) = 0;
 
+    // Returns false if get_next() would block waiting for data from another fragment
+    // or from scanner threads. Used by the pipeline scheduler to park a fragment instead
+    // of a thread, so it may be called from another thread between get_next() calls.
+    // The default implementation asks the children that are not closed yet.
+    virtual bool can_get_next();
+
     // Resets the stream of row batches to be retrieved by subsequent GetNext() calls.
     // Clears all internal state, returning this node to the state it was in after calling
     // Prepare() and before calling Open(). This function must not clear memory
@@ -159,6 +165,14 @@ public:
     // out how to deal with declaring a templated std:vector type in IR
     static bool eval_conjuncts(ExprContext* const* ctxs, int num_ctxs, TupleRow* row);
 
+    // Evaluates exprs over 'num_rows' rows column-at-a-time, each expr only over the rows
+    // all the previous ones returned true for. Sets the first entries of 'sel', which has
+    // room for 'num_rows' entries, to the ascending indices of the rows all exprs return
+    // true for and returns their number. Moves these rows to the front of 'rows', the
+    // other entries are overwritten.
+    static int eval_conjuncts_batch(ExprContext* const* ctxs, int num_ctxs, TupleRow** rows,
+                                    int num_rows, int* sel);
+
     // Returns a string representation in DFS order of the plan rooted at this.
     std::string debug_string() const;
 
@@ -20,6 +20,7 @@
 #include <stdint.h>
 
 #include "common/status.h"
+#include "util/byte_buffer.h"
 
 namespace doris {
 
@@ -37,14 +38,12 @@ public:
     /**
      * This interface is used read a whole message, For example: read a message from kafka.
      *
-     * if read eof then return Status::OK and length is set 0 and buf is set NULL,
-     *  other return readed bytes.
+     * if read eof then return Status::OK and buf is set NULL,
+     * otherwise the message is the content of buf between buf->pos and buf->limit.
      *
-     * !! Important !!
-     * the buf must be deleted by user, otherwise leak memory
-     * !! Important !!
+     * The buffer may be handed out by the reader without copying, so it must not be modified.
      */
-    virtual Status read_one_message(uint8_t** buf, size_t* length) = 0;
+    virtual Status read_one_message(ByteBufferPtr* buf) = 0;
     virtual int64_t size() = 0;
     virtual Status seek(int64_t position) = 0;
     virtual Status tell(int64_t* position) = 0;
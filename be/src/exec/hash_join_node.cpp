@@ -19,13 +19,19 @@
 
 #include <sstream>
 
+#include "common/config.h"
 #include "exec/hash_table.hpp"
+#include "exec/shared_hash_table.h"
 #include "exprs/expr.h"
 #include "exprs/in_predicate.h"
 #include "exprs/slot_ref.h"
 #include "gen_cpp/PlanNodes_types.h"
+#include "runtime/buffered_tuple_stream2.inline.h"
+#include "runtime/plan_fragment_executor.h"
+#include "runtime/raw_value.h"
 #include "runtime/row_batch.h"
 #include "runtime/runtime_state.h"
+#include "util/hash_util.hpp"
 #include "util/runtime_profile.h"
 
 namespace doris {
@@ -36,13 +42,20 @@ HashJoinNode::HashJoinNode(ObjectPool* pool, const TPlanNode& tnode, const Descr
           _probe_eos(false),
           _process_build_batch_fn(NULL),
           _process_probe_batch_fn(NULL),
-          _anti_join_last_pos(NULL) {
+          _anti_join_last_pos(NULL),
+          _is_shared_build_owner(false),
+          _enable_spill(false),
+          _block_mgr_client(NULL),
+          _num_spilled_hash_partitions(0),
+          _input_partition(NULL) {
     _match_all_probe =
             (_join_op == TJoinOp::LEFT_OUTER_JOIN || _join_op == TJoinOp::FULL_OUTER_JOIN);
     _match_one_build = (_join_op == TJoinOp::LEFT_SEMI_JOIN);
     _match_all_build =
             (_join_op == TJoinOp::RIGHT_OUTER_JOIN || _join_op == TJoinOp::FULL_OUTER_JOIN);
     _is_push_down = tnode.hash_join_node.is_push_down;
+    _is_broadcast_join = tnode.hash_join_node.__isset.is_broadcast_join &&
+                         tnode.hash_join_node.is_broadcast_join;
     _build_unique = _join_op == TJoinOp::LEFT_ANTI_JOIN || _join_op == TJoinOp::LEFT_SEMI_JOIN;
 }
 
@@ -95,6 +108,11 @@ Status HashJoinNode::prepare(RuntimeState* state) {
     _probe_rows_counter = ADD_COUNTER(runtime_profile(), "ProbeRows", TUnit::UNIT);
     _hash_tbl_load_factor_counter =
             ADD_COUNTER(runtime_profile(), "LoadFactor", TUnit::DOUBLE_VALUE);
+    _spilled_partitions_counter = ADD_COUNTER(runtime_profile(), "SpilledPartitions", TUnit::UNIT);
+    _repartitions_counter = ADD_COUNTER(runtime_profile(), "RepartitionedPartitions", TUnit::UNIT);
+    _max_partition_level_counter =
+            ADD_COUNTER(runtime_profile(), "MaxPartitionLevel", TUnit::UNIT);
+    _shared_build_wait_timer = ADD_TIMER(runtime_profile(), "SharedBuildWaitTime");
 
     // build and probe exprs are evaluated in the context of the rows produced by our
     // right and left children, respectively
@@ -125,19 +143,54 @@ Status HashJoinNode::prepare(RuntimeState* state) {
     _probe_tuple_row_size = num_left_tuples * sizeof(Tuple*);
     _build_tuple_row_size = num_build_tuples * sizeof(Tuple*);
 
+    _enable_spill = state->enable_spill();
+    if (can_share_hash_table(state)) {
+        // the build is claimed in open()
+        _shared_hash_table = state->query_fragments_ctx()->get_shared_hash_table(id());
+    }
+    create_hash_table();
+
+    _probe_batch.reset(
+            new RowBatch(child(0)->row_desc(), state->batch_size(), mem_tracker().get()));
+
+    return Status::OK();
+}
+
+void HashJoinNode::create_hash_table() {
     // TODO: default buckets
     const bool stores_nulls =
             _join_op == TJoinOp::RIGHT_OUTER_JOIN || _join_op == TJoinOp::FULL_OUTER_JOIN ||
             _join_op == TJoinOp::RIGHT_ANTI_JOIN || _join_op == TJoinOp::RIGHT_SEMI_JOIN ||
             (std::find(_is_null_safe_eq_join.begin(), _is_null_safe_eq_join.end(), true) !=
              _is_null_safe_eq_join.end());
-    _hash_tbl.reset(new HashTable(_build_expr_ctxs, _probe_expr_ctxs, _build_tuple_size,
-                                  stores_nulls, _is_null_safe_eq_join, id(), mem_tracker(), 1024));
+    // The memory of a shared table must outlive this instance.
+    _hash_tbl.reset(new HashTable(
+            _build_expr_ctxs, _probe_expr_ctxs, _build_tuple_size, stores_nulls,
+            _is_null_safe_eq_join, id(),
+            _is_shared_build_owner ? _shared_hash_table->mem_tracker() : mem_tracker(), 1024));
+}
 
-    _probe_batch.reset(
-            new RowBatch(child(0)->row_desc(), state->batch_size(), mem_tracker().get()));
+bool HashJoinNode::can_share_hash_table(RuntimeState* state) {
+    if (!config::enable_shared_broadcast_hash_table || !_is_broadcast_join ||
+        state->query_fragments_ctx() == nullptr || _enable_spill) {
+        return false;
+    }
+    // The other instances must be able to stop receiving the build rows.
+    if (child(1)->type() != TPlanNodeType::EXCHANGE_NODE) {
+        return false;
+    }
+    // Joins that mark the matched build rows would write to the shared table.
+    return _join_op == TJoinOp::INNER_JOIN || _join_op == TJoinOp::LEFT_OUTER_JOIN ||
+           _join_op == TJoinOp::LEFT_SEMI_JOIN || _join_op == TJoinOp::LEFT_ANTI_JOIN;
+}
 
-    return Status::OK();
+void HashJoinNode::Partition::close() {
+    if (build_rows.get() != NULL) {
+        build_rows->close();
+    }
+    if (probe_rows.get() != NULL) {
+        probe_rows->close();
+    }
 }
 
 Status HashJoinNode::close(RuntimeState* state) {
@@ -152,9 +205,30 @@ Status HashJoinNode::close(RuntimeState* state) {
     if (_hash_tbl.get() != NULL) {
         _hash_tbl->close();
     }
+    if (_shared_hash_table != nullptr) {
+        if (_is_shared_build_owner && !_shared_hash_table->is_ready()) {
+            // never built, e.g. the instance failed before, release the waiting instances
+            _shared_hash_table->set_ready(Status::Cancelled("shared hash table not built"),
+                                          nullptr, nullptr);
+        }
+        _shared_hash_table.reset();
+    }
     if (_build_pool.get() != NULL) {
         _build_pool->free_all();
     }
+    for (int i = 0; i < _hash_partitions.size(); ++i) {
+        _hash_partitions[i]->close();
+    }
+    for (std::list<Partition*>::iterator it = _spilled_partitions.begin();
+         it != _spilled_partitions.end(); ++it) {
+        (*it)->close();
+    }
+    if (_input_partition != NULL) {
+        _input_partition->close();
+    }
+    if (_block_mgr_client != NULL) {
+        state->block_mgr2()->clear_reservations(_block_mgr_client);
+    }
 
     Expr::close(_build_expr_ctxs, state);
     Expr::close(_probe_expr_ctxs, state);
@@ -177,6 +251,55 @@ void HashJoinNode::build_side_thread(RuntimeState* state, boost::promise<Status>
 }
 
 Status HashJoinNode::construct_hash_table(RuntimeState* state) {
+    if (_enable_spill) {
+        return construct_hash_partitions(state);
+    }
+    if (_shared_hash_table != nullptr) {
+        // The first instance to get here builds the table. It is running already, so the
+        // others never wait for a builder queued behind them in the fragment pool.
+        _is_shared_build_owner = _shared_hash_table->claim_build(state);
+        add_runtime_exec_option(_is_shared_build_owner ? "Builds Shared Hash Table"
+                                                       : "Probes Shared Hash Table");
+        if (!_is_shared_build_owner) {
+            return use_shared_hash_table(state);
+        }
+        // track the table with the memory of the shared table
+        _hash_tbl->close();
+        create_hash_table();
+        return share_hash_table(build_hash_table(state));
+    }
+    return build_hash_table(state);
+}
+
+Status HashJoinNode::share_hash_table(const Status& build_status) {
+    if (!build_status.ok()) {
+        _shared_hash_table->set_ready(build_status, nullptr, nullptr);
+        return build_status;
+    }
+    std::shared_ptr<HashTable> hash_table(_hash_tbl.release());
+    _shared_hash_table->set_ready(Status::OK(), hash_table, _build_pool.get());
+    _hash_tbl.reset(new HashTable(hash_table, _build_expr_ctxs, _probe_expr_ctxs));
+    return Status::OK();
+}
+
+Status HashJoinNode::use_shared_hash_table(RuntimeState* state) {
+    // The build rows are in the shared table already, stop receiving them so the senders
+    // do not wait for this instance.
+    RETURN_IF_ERROR(child(1)->close(state));
+    {
+        SCOPED_TIMER(_shared_build_wait_timer);
+        RETURN_IF_ERROR(_shared_hash_table->wait(state));
+    }
+    _hash_tbl->close();
+    _hash_tbl.reset(new HashTable(_shared_hash_table->hash_table(), _build_expr_ctxs,
+                                  _probe_expr_ctxs));
+    COUNTER_SET(_build_rows_counter, _hash_tbl->size());
+    COUNTER_SET(_build_buckets_counter, _hash_tbl->num_buckets());
+    COUNTER_SET(_hash_tbl_load_factor_counter, _hash_tbl->load_factor());
+    return Status::OK();
+}
+
+Status HashJoinNode::build_hash_table(RuntimeState* state) {
     // Do a full scan of child(1) and store everything in _hash_tbl
     // The hash join node needs to keep in memory all build tuples, including the tuple
     // row ptrs.  The row ptrs are copied into the hash table's internal structure so they
@@ -226,6 +349,11 @@ Status HashJoinNode::open(RuntimeState* state) {
 
     _eos = false;
 
+    if (_enable_spill) {
+        RETURN_IF_ERROR(state->block_mgr2()->register_client(2, mem_tracker(), state,
+                                                             &_block_mgr_client));
+    }
+
     // TODO: fix problems with asynchronous cancellation
     // Kick-off the construction of the build-side table in a separate
     // thread, so that the left child can do any initialisation in parallel.
@@ -260,7 +388,11 @@ Status HashJoinNode::open(RuntimeState* state) {
         // phase.
         RETURN_IF_ERROR(thread_status.get_future().get());
 
-        if (_hash_tbl->size() == 0 && _join_op == TJoinOp::INNER_JOIN) {
+        if (!_spilled_partitions.empty()) {
+            // The hash table only holds the partitions that stayed in memory, its keys
+            // can not be used to filter the probe side.
+            _is_push_down = false;
+        } else if (_hash_tbl->size() == 0 && _join_op == TJoinOp::INNER_JOIN) {
             // Hash table size is zero
             LOG(INFO) << "No element need to push down, no need to read probe table";
             RETURN_IF_ERROR(child(0)->open(state));
@@ -275,7 +407,8 @@ Status HashJoinNode::open(RuntimeState* state) {
         }
 
         // TODO: this is used for Code Check, Remove this later
-        if (_is_push_down || 0 != child(1)->conjunct_ctxs().size()) {
+        if (_spilled_partitions.empty() &&
+            (_is_push_down || 0 != child(1)->conjunct_ctxs().size())) {
             for (int i = 0; i < _probe_expr_ctxs.size(); ++i) {
                 TExprNode node;
                 node.__set_node_type(TExprNodeType::IN_PRED);
@@ -345,8 +478,12 @@ Status HashJoinNode::open(RuntimeState* state) {
     }
 
     // seed probe batch and _current_probe_row, etc.
+    return prime_probe_batch(state);
+}
+
+Status HashJoinNode::prime_probe_batch(RuntimeState* state) {
     while (true) {
-        RETURN_IF_ERROR(child(0)->get_next(state, _probe_batch.get(), &_probe_eos));
+        RETURN_IF_ERROR(get_next_probe_batch(state));
         COUNTER_UPDATE(_probe_rows_counter, _probe_batch->num_rows());
         _probe_batch_pos = 0;
 
@@ -381,6 +518,20 @@ Status HashJoinNode::get_next(RuntimeState* state, RowBatch* out_batch, bool* eo
         return Status::OK();
     }
 
+    RETURN_IF_ERROR(join_get_next(state, out_batch, eos));
+    // Join the spilled partitions one by one once the current input is exhausted.
+    while (_enable_spill && *eos && !reached_limit()) {
+        RETURN_IF_ERROR(next_spilled_partition(state, out_batch, eos));
+        if (*eos || out_batch->at_capacity()) {
+            break;
+        }
+        RETURN_IF_ERROR(join_get_next(state, out_batch, eos));
+    }
+
+    return Status::OK();
+}
+
+Status HashJoinNode::join_get_next(RuntimeState* state, RowBatch* out_batch, bool* eos) {
     // These cases are simpler and use a more efficient processing loop
     if (!(_match_all_build || _join_op == TJoinOp::RIGHT_SEMI_JOIN ||
           _join_op == TJoinOp::RIGHT_ANTI_JOIN)) {
@@ -510,7 +661,8 @@ Status HashJoinNode::get_next(RuntimeState* state, RowBatch* out_batch, bool* eo
             _probe_batch->transfer_resource_ownership(out_batch);
             _probe_batch_pos = 0;
 
-            if (out_batch->is_full() || out_batch->at_resource_limit()) {
+            if (out_batch->is_full() || out_batch->at_resource_limit() ||
+                out_batch->need_to_return()) {
                 return Status::OK();
             }
 
@@ -518,7 +670,7 @@ Status HashJoinNode::get_next(RuntimeState* state, RowBatch* out_batch, bool* eo
             if (!_probe_eos) {
                 while (true) {
                     probe_timer.stop();
-                    RETURN_IF_ERROR(child(0)->get_next(state, _probe_batch.get(), &_probe_eos));
+                    RETURN_IF_ERROR(get_next_probe_batch(state));
                     probe_timer.start();
 
                     if (_probe_batch->num_rows() == 0) {
@@ -531,7 +683,8 @@ Status HashJoinNode::get_next(RuntimeState* state, RowBatch* out_batch, bool* eo
                             break;
                         }
 
-                        if (out_batch->is_full() || out_batch->at_resource_limit()) {
+                        if (out_batch->is_full() || out_batch->at_resource_limit() ||
+                            out_batch->need_to_return()) {
                             return Status::OK();
                         }
 
@@ -649,7 +802,8 @@ Status HashJoinNode::left_join_get_next(RuntimeState* state, RowBatch* out_batch
             _probe_batch->transfer_resource_ownership(out_batch);
             _probe_batch_pos = 0;
 
-            if (out_batch->is_full() || out_batch->at_resource_limit()) {
+            if (out_batch->is_full() || out_batch->at_resource_limit() ||
+                out_batch->need_to_return()) {
                 break;
             }
 
@@ -658,7 +812,7 @@ Status HashJoinNode::left_join_get_next(RuntimeState* state, RowBatch* out_batch
                 break;
             } else {
                 probe_timer.stop();
-                RETURN_IF_ERROR(child(0)->get_next(state, _probe_batch.get(), &_probe_eos));
+                RETURN_IF_ERROR(get_next_probe_batch(state));
                 probe_timer.start();
                 COUNTER_UPDATE(_probe_rows_counter, _probe_batch->num_rows());
             }
@@ -668,6 +822,359 @@ Status HashJoinNode::left_join_get_next(RuntimeState* state, RowBatch* out_batch
     return Status::OK();
 }
 
+Status HashJoinNode::get_next_probe_batch(RuntimeState* state) {
+    if (_input_partition == NULL) {
+        RETURN_IF_ERROR(child(0)->get_next(state, _probe_batch.get(), &_probe_eos));
+    } else {
+        BufferedTupleStream2* stream = _input_partition->probe_rows.get();
+        if (stream->rows_returned() == stream->num_rows()) {
+            _probe_eos = true;
+            return Status::OK();
+        }
+        RETURN_IF_ERROR(stream->get_next(_probe_batch.get(), &_probe_eos));
+    }
+
+    if (_num_spilled_hash_partitions > 0) {
+        RETURN_IF_ERROR(spill_probe_rows(state, _probe_batch.get()));
+    }
+    return Status::OK();
+}
+
+uint32_t HashJoinNode::partition_hash(const std::vector<ExprContext*>& ctxs, TupleRow* row,
+                                      int level) {
+    // FNV with a different seed per level is a different hash function, so rows of a
+    // partition are spread again when it is repartitioned.
+    uint32_t hash = HashUtil::fnv_hash(&level, sizeof(level), HashUtil::FNV_SEED);
+    for (int i = 0; i < ctxs.size(); ++i) {
+        void* val = ctxs[i]->get_value(row);
+        hash = RawValue::get_hash_value_fvn(val, ctxs[i]->root()->type(), hash);
+    }
+    return hash;
+}
+
+Status HashJoinNode::create_hash_partitions(RuntimeState* state, int level) {
+    DCHECK(_hash_partitions.empty());
+    for (int i = 0; i < PARTITION_FANOUT; ++i) {
+        Partition* partition = _pool->add(new Partition(level));
+        _hash_partitions.push_back(partition);
+        partition->build_rows.reset(new BufferedTupleStream2(state, child(1)->row_desc(),
+                                                             state->block_mgr2(),
+                                                             _block_mgr_client, true, false));
+        RETURN_IF_ERROR(partition->build_rows->init(id(), runtime_profile(), true));
+    }
+    _num_spilled_hash_partitions = 0;
+    if (level > _max_partition_level_counter->value()) {
+        COUNTER_SET(_max_partition_level_counter, static_cast<int64_t>(level));
+    }
+    return Status::OK();
+}
+
+Status HashJoinNode::partition_build_batch(RuntimeState* state, RowBatch* build_batch) {
+    DCHECK_EQ(_hash_partitions.size(), PARTITION_FANOUT);
+    const int level = _hash_partitions[0]->level;
+    for (int i = 0; i < build_batch->num_rows(); ++i) {
+        TupleRow* row = build_batch->get_row(i);
+        uint32_t hash = partition_hash(_build_expr_ctxs, row, level);
+        BufferedTupleStream2* stream =
+                _hash_partitions[hash >> (32 - NUM_PARTITIONING_BITS)]->build_rows.get();
+        Status status;
+        while (UNLIKELY(!stream->add_row(row, &status))) {
+            // add_row() returns false with an ok status if there is not enough memory
+            // for a new block. Switch from small buffers first, then spill partitions
+            // until the row fits.
+            RETURN_IF_ERROR(status);
+            if (stream->using_small_buffers()) {
+                bool got_buffer = false;
+                RETURN_IF_ERROR(stream->switch_to_io_buffers(&got_buffer));
+                if (got_buffer) {
+                    continue;
+                }
+            }
+            bool spilled = false;
+            RETURN_IF_ERROR(spill_partition(&spilled));
+            if (!spilled) {
+                // All partitions are spilled already, write out the current block of
+                // another one to make room for this row.
+                RETURN_IF_ERROR(release_write_block(stream, true, &spilled));
+            }
+            if (!spilled) {
+                return state->block_mgr2()->mem_limit_too_low_error(_block_mgr_client, id());
+            }
+        }
+    }
+    return Status::OK();
+}
+
+Status HashJoinNode::spill_partition(bool* spilled) {
+    Partition* victim = NULL;
+    int64_t max_bytes = 0;
+    for (int i = 0; i < _hash_partitions.size(); ++i) {
+        Partition* partition = _hash_partitions[i];
+        if (partition->is_spilled) {
+            continue;
+        }
+        int64_t bytes = partition->build_rows->bytes_in_mem(false);
+        if (victim == NULL || bytes > max_bytes) {
+            victim = partition;
+            max_bytes = bytes;
+        }
+    }
+    *spilled = (victim != NULL);
+    if (victim == NULL) {
+        return Status::OK();
+    }
+    return spill_partition(victim);
+}
+
+Status HashJoinNode::spill_partition(Partition* partition) {
+    DCHECK(!partition->is_spilled);
+    add_runtime_exec_option("Spilled");
+    const int64_t bytes = partition->build_rows->bytes_in_mem(false);
+    // Small buffers can not be unpinned, so switch to IO-sized buffers before unpinning.
+    bool got_buffer = false;
+    RETURN_IF_ERROR(partition->build_rows->switch_to_io_buffers(&got_buffer));
+    RETURN_IF_ERROR(partition->build_rows->unpin_stream(false));
+    partition->is_spilled = true;
+    ++_num_spilled_hash_partitions;
+    COUNTER_UPDATE(_spilled_partitions_counter, 1);
+    VLOG_QUERY << "Hash join node " << id() << " spilled a partition at level " << partition->level
+               << ", in memory bytes=" << bytes;
+    return Status::OK();
+}
+
+Status HashJoinNode::release_write_block(BufferedTupleStream2* stream, bool build,
+                                         bool* released) {
+    *released = false;
+    for (int i = 0; i < _hash_partitions.size(); ++i) {
+        Partition* partition = _hash_partitions[i];
+        if (!partition->is_spilled) {
+            continue;
+        }
+        BufferedTupleStream2* other =
+                build ? partition->build_rows.get() : partition->probe_rows.get();
+        if (other == NULL || other == stream || !other->has_write_block() ||
+            other->using_small_buffers()) {
+            continue;
+        }
+        // The stream gets a new write block when its next row is added.
+        RETURN_IF_ERROR(other->unpin_stream(true));
+        *released = true;
+        return Status::OK();
+    }
+    return Status::OK();
+}
+
+Status HashJoinNode::init_probe_stream(RuntimeState* state, Partition* partition) {
+    DCHECK(partition->is_spilled);
+    // The build rows are not needed until this partition is joined, release the write
+    // block as well.
+    RETURN_IF_ERROR(partition->build_rows->unpin_stream(true));
+    partition->probe_rows.reset(new BufferedTupleStream2(state, child(0)->row_desc(),
+                                                         state->block_mgr2(), _block_mgr_client,
+                                                         false, false));
+    RETURN_IF_ERROR(partition->probe_rows->init(id(), runtime_profile(), false));
+    _spilled_partitions.push_back(partition);
+    return Status::OK();
+}
+
+Status HashJoinNode::build_hash_table_from_partitions(RuntimeState* state) {
+    // Every spilled partition needs a write block for its probe rows. Spill more
+    // partitions until there are enough buffers for them, before any in-memory partition
+    // is inserted into the hash table and can not be spilled any more.
+    while (true) {
+        int num_probe_streams = 0;
+        for (int i = 0; i < _hash_partitions.size(); ++i) {
+            Partition* partition = _hash_partitions[i];
+            if (partition->is_spilled) {
+                RETURN_IF_ERROR(partition->build_rows->unpin_stream(true));
+                ++num_probe_streams;
+            }
+        }
+        if (state->block_mgr2()->available_buffers(_block_mgr_client) >= num_probe_streams) {
+            break;
+        }
+        bool spilled = false;
+        RETURN_IF_ERROR(spill_partition(&spilled));
+        if (!spilled) {
+            return state->block_mgr2()->mem_limit_too_low_error(_block_mgr_client, id());
+        }
+    }
+    for (int i = 0; i < _hash_partitions.size(); ++i) {
+        Partition* partition = _hash_partitions[i];
+        if (partition->is_spilled) {
+            RETURN_IF_ERROR(init_probe_stream(state, partition));
+        }
+    }
+
+    for (int i = 0; i < _hash_partitions.size(); ++i) {
+        Partition* partition = _hash_partitions[i];
+        if (partition->is_spilled || partition->build_rows->num_rows() == 0) {
+            continue;
+        }
+
+        // The stream is pinned, so the rows stay valid while they are in the hash table.
+        boost::scoped_ptr<RowBatch> build_batch;
+        bool got_rows = false;
+        RETURN_IF_ERROR(partition->build_rows->get_rows(&build_batch, &got_rows));
+        if (!got_rows) {
+            // Not enough memory to read the rows at once, join this partition later.
+            RETURN_IF_ERROR(spill_partition(partition));
+            RETURN_IF_ERROR(init_probe_stream(state, partition));
+            continue;
+        }
+        RETURN_IF_LIMIT_EXCEEDED(state, "Hash join, while constructing the hash table.");
+
+        if (_process_build_batch_fn == NULL) {
+            process_build_batch(build_batch.get());
+        } else {
+            _process_build_batch_fn(this, build_batch.get());
+        }
+    }
+
+    COUNTER_SET(_build_rows_counter, _hash_tbl->size());
+    COUNTER_SET(_build_buckets_counter, _hash_tbl->num_buckets());
+    COUNTER_SET(_hash_tbl_load_factor_counter, _hash_tbl->load_factor());
+    return Status::OK();
+}
+
+Status HashJoinNode::construct_hash_partitions(RuntimeState* state) {
+    RowBatch build_batch(child(1)->row_desc(), state->batch_size(), mem_tracker().get());
+    RETURN_IF_ERROR(child(1)->open(state));
+    RETURN_IF_ERROR(create_hash_partitions(state, 0));
+
+    while (true) {
+        RETURN_IF_CANCELLED(state);
+        bool eos = true;
+        RETURN_IF_ERROR(child(1)->get_next(state, &build_batch, &eos));
+        SCOPED_TIMER(_build_timer);
+        // The rows are copied into the partitions, so the batch can be reused.
+        RETURN_IF_ERROR(partition_build_batch(state, &build_batch));
+        build_batch.reset();
+
+        if (eos) {
+            break;
+        }
+    }
+
+    SCOPED_TIMER(_build_timer);
+    return build_hash_table_from_partitions(state);
+}
+
+Status HashJoinNode::spill_probe_rows(RuntimeState* state, RowBatch* probe_batch) {
+    DCHECK_EQ(_hash_partitions.size(), PARTITION_FANOUT);
+    const int level = _hash_partitions[0]->level;
+    int num_rows = 0;
+    for (int i = 0; i < probe_batch->num_rows(); ++i) {
+        TupleRow* row = probe_batch->get_row(i);
+        uint32_t hash = partition_hash(_probe_expr_ctxs, row, level);
+        Partition* partition = _hash_partitions[hash >> (32 - NUM_PARTITIONING_BITS)];
+        if (!partition->is_spilled) {
+            // Keep the row, compacting the batch in place.
+            if (num_rows != i) {
+                memcpy(probe_batch->get_row(num_rows), row, probe_batch->row_byte_size());
+            }
+            ++num_rows;
+            continue;
+        }
+        Status status;
+        while (UNLIKELY(!partition->probe_rows->add_row(row, &status))) {
+            // The in-memory partitions are in the hash table and can not be spilled now,
+            // write out the current block of another spilled partition instead.
+            RETURN_IF_ERROR(status);
+            bool released = false;
+            RETURN_IF_ERROR(release_write_block(partition->probe_rows.get(), false, &released));
+            if (!released) {
+                return state->block_mgr2()->mem_limit_too_low_error(_block_mgr_client, id());
+            }
+        }
+    }
+    probe_batch->set_num_rows(num_rows);
+    return Status::OK();
+}
+
+Status HashJoinNode::next_spilled_partition(RuntimeState* state, RowBatch* out_batch, bool* eos) {
+    // Rows returned so far may point into the streams of the input that was just joined,
+    // so the streams are handed to the out batch instead of being closed.
+    _probe_batch->transfer_resource_ownership(out_batch);
+    for (int i = 0; i < _hash_partitions.size(); ++i) {
+        Partition* partition = _hash_partitions[i];
+        if (!partition->is_spilled && partition->build_rows.get() != NULL) {
+            out_batch->add_tuple_stream(partition->build_rows.release());
+        }
+    }
+    _hash_partitions.clear();
+    _num_spilled_hash_partitions = 0;
+    if (_input_partition != NULL) {
+        out_batch->add_tuple_stream(_input_partition->probe_rows.release());
+        _input_partition->close();
+        _input_partition = NULL;
+    }
+
+    if (_spilled_partitions.empty()) {
+        *eos = true;
+        return Status::OK();
+    }
+    *eos = false;
+    // No more probe rows are added to the remaining spilled partitions, release their
+    // write blocks for joining the next one.
+    for (std::list<Partition*>::iterator it = _spilled_partitions.begin();
+         it != _spilled_partitions.end(); ++it) {
+        RETURN_IF_ERROR((*it)->probe_rows->unpin_stream(true));
+    }
+
+    _hash_tbl->close();
+    create_hash_table();
+    _joined_build_rows.clear();
+    _anti_join_last_pos = NULL;
+
+    Partition* partition = _spilled_partitions.front();
+    _spilled_partitions.pop_front();
+    _input_partition = partition;
+
+    {
+        SCOPED_TIMER(_build_timer);
+        bool pinned = false;
+        RETURN_IF_ERROR(partition->build_rows->pin_stream(false, &pinned));
+        if (pinned) {
+            // The build rows fit in memory now, join the partition as a whole.
+            partition->is_spilled = false;
+            _hash_partitions.push_back(partition);
+        } else {
+            if (partition->level >= MAX_PARTITION_DEPTH) {
+                std::stringstream msg;
+                msg << "Hash join node " << id() << " can not repartition a spilled partition "
+                    << "of " << partition->build_rows->num_rows() << " rows any further, "
+                    << "the join keys may be too skewed.";
+                return Status::MemoryLimitExceeded(msg.str());
+            }
+            RETURN_IF_ERROR(create_hash_partitions(state, partition->level + 1));
+            RETURN_IF_ERROR(partition->build_rows->prepare_for_read(true));
+            RowBatch build_batch(child(1)->row_desc(), state->batch_size(), mem_tracker().get());
+            bool build_eos = partition->build_rows->num_rows() == 0;
+            while (!build_eos) {
+                RETURN_IF_CANCELLED(state);
+                RETURN_IF_ERROR(partition->build_rows->get_next(&build_batch, &build_eos));
+                RETURN_IF_ERROR(partition_build_batch(state, &build_batch));
+                build_batch.reset();
+            }
+            partition->build_rows->close();
+            COUNTER_UPDATE(_repartitions_counter, 1);
+        }
+        RETURN_IF_ERROR(build_hash_table_from_partitions(state));
+    }
+
+    if (partition->probe_rows->num_rows() > 0) {
+        bool got_read_buffer = false;
+        RETURN_IF_ERROR(partition->probe_rows->prepare_for_read(true, &got_read_buffer));
+        if (!got_read_buffer) {
+            return state->block_mgr2()->mem_limit_too_low_error(_block_mgr_client, id());
+        }
+    }
+    _eos = false;
+    _probe_eos = false;
+    return prime_probe_batch(state);
+}
+
 std::string HashJoinNode::get_probe_row_output_string(TupleRow* probe_row) {
     std::stringstream out;
     out << "[";
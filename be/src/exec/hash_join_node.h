@@ -26,11 +26,14 @@
 #include "exec/exec_node.h"
 #include "exec/hash_table.h"
 #include "gen_cpp/PlanNodes_types.h"
+#include "runtime/buffered_block_mgr2.h"
+#include "runtime/buffered_tuple_stream2.h"
 
 namespace doris {
 
 class MemPool;
 class RowBatch;
+class SharedHashTable;
 class TupleRow;
 
 // Node for in-memory hash joins:
@@ -45,6 +48,17 @@ class TupleRow;
 //   multiple rows per left input row
 // - TODO: fix this, so in the case of 1x1/nx1 joins (for instance, fact to dimension tbl)
 //   we don't do these extra copies
+//
+// Spilling:
+// - If the query enables spilling, both inputs are hash partitioned on the join exprs
+//   into PARTITION_FANOUT partitions (a grace hash join). Build rows are buffered in
+//   pinned tuple streams; when the block mgr runs out of memory the largest in-memory
+//   partition is unpinned and written to disk. Only the in-memory partitions are
+//   inserted into the hash table, probe rows belonging to a spilled partition are
+//   buffered in that partition's probe stream instead of being probed.
+// - Once the probe input is exhausted, each spilled partition is joined in turn. If its
+//   build rows still do not fit in memory, it is partitioned again with a different
+//   hash seed, up to MAX_PARTITION_DEPTH levels.
 class HashJoinNode : public ExecNode {
 public:
     HashJoinNode(ObjectPool* pool, const TPlanNode& tnode, const DescriptorTbl& descs);
@@ -62,7 +76,32 @@ protected:
     void debug_string(int indentation_level, std::stringstream* out) const;
 
 private:
-    boost::scoped_ptr<HashTable> _hash_tbl;
+    // Number of partitions each input is split into when spilling is enabled.
+    static const int PARTITION_FANOUT = 16;
+    static const int NUM_PARTITIONING_BITS = 4;
+
+    // Maximum number of times a spilled partition is repartitioned before giving up.
+    static const int MAX_PARTITION_DEPTH = 4;
+
+    // One hash partition of the build and probe input, used when spilling is enabled.
+    struct Partition {
+        Partition(int level) : level(level), is_spilled(false) {}
+
+        // Closes the streams that are still owned by this partition.
+        void close();
+
+        // Number of times the input has been partitioned to produce this partition.
+        int level;
+
+        // True if the build rows have been unpinned. The probe rows of a spilled
+        // partition are buffered in 'probe_rows' and joined later.
+        bool is_spilled;
+
+        boost::scoped_ptr<BufferedTupleStream2> build_rows;
+        boost::scoped_ptr<BufferedTupleStream2> probe_rows;
+    };
+
+    std::unique_ptr<HashTable> _hash_tbl;
     HashTable::Iterator _hash_tbl_iterator;
     bool _is_push_down;
 
@@ -129,6 +168,31 @@ private:
     // record anti join pos in get_next()
     HashTable::Iterator* _anti_join_last_pos;
 
+    // Set for a broadcast join whose instances on this backend share one hash table. Only
+    // the instance that claimed the build (_is_shared_build_owner) reads child(1), the
+    // others close it and probe the shared table through a read-only _hash_tbl.
+    bool _is_broadcast_join;
+    std::shared_ptr<SharedHashTable> _shared_hash_table;
+    bool _is_shared_build_owner;
+
+    // True if the build side is hash partitioned and may spill, see the class comment.
+    bool _enable_spill;
+    BufferedBlockMgr2::Client* _block_mgr_client;
+
+    // Partitions of the input that is currently joined. The in-memory ones are in
+    // _hash_tbl. Owned by _pool.
+    std::vector<Partition*> _hash_partitions;
+
+    // Number of partitions in _hash_partitions that are spilled.
+    int _num_spilled_hash_partitions;
+
+    // Spilled partitions that still need to be joined.
+    std::list<Partition*> _spilled_partitions;
+
+    // The spilled partition whose rows are currently joined. If NULL, the probe rows
+    // come from child(0).
+    Partition* _input_partition;
+
     RuntimeProfile::Counter* _build_timer;     // time to build hash table
     RuntimeProfile::Counter* _push_down_timer; // time to build hash table
     RuntimeProfile::Counter* _push_compute_timer;
@@ -137,6 +201,10 @@ private:
     RuntimeProfile::Counter* _probe_rows_counter;    // num probe rows
     RuntimeProfile::Counter* _build_buckets_counter; // num buckets in hash table
     RuntimeProfile::Counter* _hash_tbl_load_factor_counter;
+    RuntimeProfile::Counter* _spilled_partitions_counter;
+    RuntimeProfile::Counter* _repartitions_counter;
+    RuntimeProfile::Counter* _max_partition_level_counter;
+    RuntimeProfile::Counter* _shared_build_wait_timer;
 
     // Supervises ConstructHashTable in a separate thread, and
     // returns its status in the promise parameter.
@@ -148,6 +216,75 @@ private:
     // same time.
     Status construct_hash_table(RuntimeState* state);
 
+    // Joins the probe rows against the current hash table.
+    Status join_get_next(RuntimeState* state, RowBatch* out_batch, bool* eos);
+
+    // Reads the next probe batch into _probe_batch, either from child(0) or from the
+    // spilled partition that is being joined. Probe rows of spilled hash partitions are
+    // moved out of the batch into their partition's probe stream.
+    Status get_next_probe_batch(RuntimeState* state);
+
+    // Fetches probe batches until the first probe row is found and looks it up.
+    Status prime_probe_batch(RuntimeState* state);
+
+    // Builds _hash_tbl from all the rows of child(1).
+    Status build_hash_table(RuntimeState* state);
+
+    // Returns true if the build side can be shared with the other instances of the join.
+    bool can_share_hash_table(RuntimeState* state);
+
+    // Hands the table built by this instance to _shared_hash_table, or 'build_status' if
+    // the build failed, and probes it through a read-only _hash_tbl afterwards.
+    Status share_hash_table(const Status& build_status);
+
+    // Waits for the table built by another instance and probes it.
+    Status use_shared_hash_table(RuntimeState* state);
+
+    // Creates a new, empty _hash_tbl.
+    void create_hash_table();
+
+    // Returns the hash of the join exprs used to assign 'row' to a partition at 'level'.
+    uint32_t partition_hash(const std::vector<ExprContext*>& ctxs, TupleRow* row, int level);
+
+    // Creates PARTITION_FANOUT empty partitions at 'level' in _hash_partitions.
+    Status create_hash_partitions(RuntimeState* state, int level);
+
+    // Adds all rows in 'build_batch' to their partition in _hash_partitions.
+    Status partition_build_batch(RuntimeState* state, RowBatch* build_batch);
+
+    // Unpins the build rows of the largest in-memory partition. *spilled is false if
+    // there was no partition left to spill.
+    Status spill_partition(bool* spilled);
+
+    // Unpins the build rows of the in-memory 'partition'.
+    Status spill_partition(Partition* partition);
+
+    // Writes out and unpins the current write block of a spilled partition's build stream,
+    // or probe stream if 'build' is false, other than 'stream', so that 'stream' can use
+    // its buffer. *released is false if there was no such block.
+    Status release_write_block(BufferedTupleStream2* stream, bool build, bool* released);
+
+    // Releases the build rows of the spilled 'partition', creates the stream for its
+    // probe rows and adds it to _spilled_partitions.
+    Status init_probe_stream(RuntimeState* state, Partition* partition);
+
+    // Inserts the build rows of the in-memory partitions into _hash_tbl and prepares the
+    // spilled partitions to receive their probe rows.
+    Status build_hash_table_from_partitions(RuntimeState* state);
+
+    // Partitions the build side of the input into _hash_partitions and builds the hash
+    // table from the partitions that stay in memory. Replaces construct_hash_table()
+    // when spilling is enabled.
+    Status construct_hash_partitions(RuntimeState* state);
+
+    // Moves the probe rows of spilled partitions out of 'probe_batch'.
+    Status spill_probe_rows(RuntimeState* state, RowBatch* probe_batch);
+
+    // Called when the current input has been joined. Hands the memory backing the rows
+    // that were returned to 'out_batch' and starts joining the next spilled partition.
+    // *eos is true if there is no spilled partition left.
+    Status next_spilled_partition(RuntimeState* state, RowBatch* out_batch, bool* eos);
+
     // GetNext helper function for the common join cases: Inner join, left semi and left
     // outer
     Status left_join_get_next(RuntimeState* state, RowBatch* row_batch, bool* eos);
@@ -49,10 +49,11 @@ HashTable::HashTable(const std::vector<ExprContext*>& build_expr_ctxs,
     DCHECK_EQ(_build_expr_ctxs.size(), _probe_expr_ctxs.size());
 
     DCHECK_EQ((num_buckets & (num_buckets - 1)), 0) << "num_buckets must be a power of 2";
-    _buckets.resize(num_buckets);
+    _bucket_storage.resize(num_buckets);
+    _buckets = _bucket_storage.data();
     _num_buckets = num_buckets;
     _num_buckets_till_resize = MAX_BUCKET_OCCUPANCY_FRACTION * _num_buckets;
-    _mem_tracker->Consume(_buckets.capacity() * sizeof(Bucket));
+    _mem_tracker->Consume(_bucket_storage.capacity() * sizeof(Bucket));
 
     // Compute the layout and buffer size to store the evaluated expr results
     _results_buffer_size = Expr::compute_results_layout(
@@ -71,15 +72,53 @@ HashTable::HashTable(const std::vector<ExprContext*>& build_expr_ctxs,
     }
 }
 
+HashTable::HashTable(const std::shared_ptr<HashTable>& shared_table,
+                     const std::vector<ExprContext*>& build_expr_ctxs,
+                     const std::vector<ExprContext*>& probe_expr_ctxs)
+        : _build_expr_ctxs(build_expr_ctxs),
+          _probe_expr_ctxs(probe_expr_ctxs),
+          _num_build_tuples(shared_table->_num_build_tuples),
+          _stores_nulls(shared_table->_stores_nulls),
+          _finds_nulls(shared_table->_finds_nulls),
+          _initial_seed(shared_table->_initial_seed),
+          _node_byte_size(shared_table->_node_byte_size),
+          _num_filled_buckets(shared_table->_num_filled_buckets),
+          _nodes(shared_table->_nodes),
+          _num_nodes(shared_table->_num_nodes),
+          _nodes_capacity(shared_table->_nodes_capacity),
+          _exceeded_limit(shared_table->_exceeded_limit),
+          _mem_tracker(shared_table->_mem_tracker),
+          _mem_limit_exceeded(shared_table->_mem_limit_exceeded),
+          _buckets(shared_table->_buckets),
+          _num_buckets(shared_table->_num_buckets),
+          _num_buckets_till_resize(shared_table->_num_buckets_till_resize),
+          _shared_table(shared_table) {
+    DCHECK_EQ(_build_expr_ctxs.size(), _probe_expr_ctxs.size());
+    DCHECK_EQ(_build_expr_ctxs.size(), shared_table->_build_expr_ctxs.size());
+
+    // Only the expr value buffers are private, the layout is the same as the shared one's.
+    _results_buffer_size = Expr::compute_results_layout(
+            _build_expr_ctxs, &_expr_values_buffer_offsets, &_var_result_begin);
+    DCHECK_EQ(_results_buffer_size, shared_table->_results_buffer_size);
+    _expr_values_buffer = new uint8_t[_results_buffer_size];
+    memset(_expr_values_buffer, 0, sizeof(uint8_t) * _results_buffer_size);
+    _expr_value_null_bits = new uint8_t[_build_expr_ctxs.size()];
+}
+
 HashTable::~HashTable() {}
 
 void HashTable::close() {
     // TODO: use tr1::array?
     delete[] _expr_values_buffer;
     delete[] _expr_value_null_bits;
+    if (_shared_table != nullptr) {
+        // the nodes and buckets belong to the shared table
+        _shared_table.reset();
+        return;
+    }
     free(_nodes);
     _mem_tracker->Release(_nodes_capacity * _node_byte_size);
-    _mem_tracker->Release(_buckets.size() * sizeof(Bucket));
+    _mem_tracker->Release(_bucket_storage.size() * sizeof(Bucket));
 }
 
 bool HashTable::eval_row(TupleRow* row, const std::vector<ExprContext*>& ctxs) {
@@ -187,7 +226,9 @@ void HashTable::resize_buckets(int64_t num_buckets) {
         return;
     }
 
-    _buckets.resize(num_buckets);
+    DCHECK(_shared_table == nullptr);
+    _bucket_storage.resize(num_buckets);
+    _buckets = _bucket_storage.data();
 
     // If we're doubling the number of buckets, all nodes in a particular bucket
     // either remain there, or move down to an analogous bucket in the other half.
@@ -261,7 +302,7 @@ std::string HashTable::debug_string(bool skip_empty, const RowDescriptor* desc)
     std::stringstream ss;
     ss << std::endl;
 
-    for (int i = 0; i < _buckets.size(); ++i) {
+    for (int i = 0; i < _num_buckets; ++i) {
         int64_t node_idx = _buckets[i]._node_idx;
         bool first = true;
 
@@ -19,6 +19,7 @@
 #define DORIS_BE_SRC_QUERY_EXEC_HASH_TABLE_H
 
 #include <boost/cstdint.hpp>
+#include <memory>
 #include <vector>
 
 #include "codegen/doris_ir.h"
@@ -51,7 +52,9 @@ using std::vector;
 // computation for hashing.  The implementation is also designed to allow codegen
 // for some paths.
 //
-// The hash table does not support removes. The hash table is not thread safe.
+// The hash table does not support removes. The hash table is not thread safe, but once
+// built its nodes and buckets can be probed concurrently by read-only tables created
+// from it, each with its own exprs and expr value buffers.
 //
 // The implementation is based on the boost multiset.  The hashtable is implemented by
 // two data structures: a vector of buckets and a vector of nodes.  Inserted values
@@ -94,6 +97,15 @@ public:
               const std::vector<bool>& finds_nulls, int32_t initial_seed,
               const std::shared_ptr<MemTracker>& mem_tracker, int64_t num_buckets);
 
+    // Create a read-only table over the nodes and buckets of 'shared_table', which must
+    // not be modified any more. Rows are evaluated with 'build_exprs' and 'probe_exprs',
+    // which must be equivalent to the exprs of 'shared_table'. Matched flags are shared
+    // too, so they must not be set through the table. 'shared_table' is closed by its
+    // owner once all the tables created from it are gone.
+    HashTable(const std::shared_ptr<HashTable>& shared_table,
+              const std::vector<ExprContext*>& build_exprs,
+              const std::vector<ExprContext*>& probe_exprs);
+
     ~HashTable();
 
     // Call to cleanup any resources. Must be called once.
@@ -128,11 +140,17 @@ public:
     // Returns HashTable::end() if there is no match.
     Iterator IR_ALWAYS_INLINE find(TupleRow* probe_row, bool probe = true);
 
+    // Same as find(), but evaluates 'probe_row' with 'probe_expr_ctxs' instead of
+    // _probe_expr_ctxs, for the inputs whose rows have another layout than the one of the
+    // probe exprs, e.g. the children of a set operation after the second one.
+    Iterator IR_ALWAYS_INLINE find(TupleRow* probe_row,
+                                   const std::vector<ExprContext*>& probe_expr_ctxs);
+
     // Returns number of elements in the hash table
     int64_t size() { return _num_nodes; }
 
     // Returns the number of buckets
-    int64_t num_buckets() { return _buckets.size(); }
+    int64_t num_buckets() { return _num_buckets; }
 
     // true if any of the MemTrackers was exceeded
     bool exceeded_limit() const { return _exceeded_limit; }
@@ -142,7 +160,7 @@ public:
 
     // Returns the number of bytes allocated to the hash table
     int64_t byte_size() const {
-        return _node_byte_size * _nodes_capacity + sizeof(Bucket) * _buckets.size();
+        return _node_byte_size * _nodes_capacity + sizeof(Bucket) * _num_buckets;
     }
 
     // Returns the results of the exprs at 'expr_idx' evaluated over the last row
@@ -191,6 +209,10 @@ public:
         // Returns Hash
         uint32_t get_hash() { return _table->get_node(_node_idx)->_hash; }
 
+        // Returns the index of the current node, nodes are numbered densely from 0 to
+        // size() - 1 in insertion order so callers can keep side state per node.
+        int64_t get_node_idx() { return _node_idx; }
+
         // Returns if the iterator is at the end
         bool has_next() { return _node_idx != -1; }
 
@@ -324,6 +346,10 @@ private:
     // This will be replaced by codegen.
     bool equals(TupleRow* build_row);
 
+    // Returns the iterator of the first node equal to the row cached in
+    // '_expr_values_buffer', 'has_nulls' is whether any of its values is NULL.
+    Iterator find_current_row(bool has_nulls);
+
     // Grow the node array.
     void grow_node_array();
 
@@ -370,9 +396,11 @@ private:
     // subsequent calls to Insert() will be ignored.
     bool _mem_limit_exceeded;
 
-    std::vector<Bucket> _buckets;
+    // points to _bucket_storage, or to the buckets of _shared_table
+    Bucket* _buckets;
+    std::vector<Bucket> _bucket_storage;
 
-    // equal to _buckets.size() but more efficient than the size function
+    // number of buckets in _buckets
     int64_t _num_buckets;
 
     // The number of filled buckets to trigger a resize.  This is cached for efficiency
@@ -395,6 +423,9 @@ private:
     // Use bytes instead of bools to be compatible with llvm.  This address must
     // not change once allocated.
     uint8_t* _expr_value_null_bits;
+
+    // the table whose nodes and buckets this read-only table probes, null if it owns them
+    std::shared_ptr<HashTable> _shared_table;
 };
 
 } // namespace doris
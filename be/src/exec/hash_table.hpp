@@ -24,7 +24,16 @@ namespace doris {
 
 inline HashTable::Iterator HashTable::find(TupleRow* probe_row, bool probe) {
     bool has_nulls = probe ? eval_probe_row(probe_row) : eval_build_row(probe_row);
+    return find_current_row(has_nulls);
+}
+
+inline HashTable::Iterator HashTable::find(TupleRow* probe_row,
+                                           const std::vector<ExprContext*>& probe_expr_ctxs) {
+    DCHECK_EQ(_build_expr_ctxs.size(), probe_expr_ctxs.size());
+    return find_current_row(eval_row(probe_row, probe_expr_ctxs));
+}
 
+inline HashTable::Iterator HashTable::find_current_row(bool has_nulls) {
     if (!_stores_nulls && has_nulls) {
         return end();
     }
@@ -73,6 +82,7 @@ inline HashTable::Bucket* HashTable::next_bucket(int64_t* bucket_idx) {
 }
 
 inline void HashTable::insert_impl(TupleRow* row) {
+    DCHECK(_shared_table == nullptr);
     bool has_null = eval_build_row(row);
 
     if (!_stores_nulls && has_null) {
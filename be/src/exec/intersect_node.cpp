@@ -39,59 +39,46 @@ Status IntersectNode::init(const TPlanNode& tnode, RuntimeState* state) {
 }
 
 // the actual intersect operation is in this function,
-// 1  build a hash table from child(0)
-// 2 probe with child(1), then filter the hash table and find the matched item, use them to rebuild a hash table
-// repeat [2] this for all the rest child
+// 1 build a hash table from child(0), removing duplicated rows
+// 2 probe with child(1), and record in a bitmap which of the rows still in the result
+//   it found, the rows not found are dropped from the result
+// repeat [2] this for all the rest child, the hash table is never rebuilt, the rows of
+// each child are evaluated with its own exprs instead. Stop once the result is empty,
+// and stop reading a child once it found all the rows in the result.
 Status IntersectNode::open(RuntimeState* state) {
     RETURN_IF_ERROR(SetOperationNode::open(state));
-    // if a table is empty, the result must be empty
-    if (_hash_tbl->size() == 0) {
-        _hash_tbl_iterator = _hash_tbl->begin();
-        return Status::OK();
-    }
-    bool eos = false;
+    int64_t num_valid = _hash_tbl->size();
+    // the rows still in the result, indexed by hash table node
+    std::vector<bool> valid(num_valid, true);
+    std::vector<bool> visited;
 
-    for (int i = 1; i < _children.size(); ++i) {
-        if (i > 1) {
-            SCOPED_TIMER(_build_timer);
-            std::unique_ptr<HashTable> temp_tbl(
-                    new HashTable(_child_expr_lists[0], _child_expr_lists[i], _build_tuple_size,
-                                  true, _find_nulls, id(), mem_tracker(), 1024));
-            _hash_tbl_iterator = _hash_tbl->begin();
-            while (_hash_tbl_iterator.has_next()) {
-                if (_hash_tbl_iterator.matched()) {
-                    VLOG_ROW << "rebuild row: "
-                             << get_row_output_string(_hash_tbl_iterator.get_row(),
-                                                      child(0)->row_desc());
-                    temp_tbl->insert(_hash_tbl_iterator.get_row());
-                }
-                _hash_tbl_iterator.next<false>();
-            }
-            _hash_tbl.swap(temp_tbl);
-            temp_tbl->close();
-            VLOG_ROW << "hash table content: "
-                     << _hash_tbl->debug_string(true, &child(0)->row_desc());
-            // if a table is empty, the result must be empty
-            if (_hash_tbl->size() == 0) {
-                break;
-            }
-        }
+    // if a table is empty, the result must be empty
+    for (int i = 1; i < _children.size() && num_valid > 0; ++i) {
+        visited.assign(valid.size(), false);
+        int64_t num_visited = 0;
         // probe
         _probe_batch.reset(
                 new RowBatch(child(i)->row_desc(), state->batch_size(), mem_tracker().get()));
         ScopedTimer<MonotonicStopWatch> probe_timer(_probe_timer);
         RETURN_IF_ERROR(child(i)->open(state));
-        eos = false;
-        while (!eos) {
+        bool eos = false;
+        while (!eos && num_visited < num_valid) {
             RETURN_IF_CANCELLED(state);
             RETURN_IF_ERROR(child(i)->get_next(state, _probe_batch.get(), &eos));
             RETURN_IF_LIMIT_EXCEEDED(state, " Intersect , while probing the hash table.");
             for (int j = 0; j < _probe_batch->num_rows(); ++j) {
                 VLOG_ROW << "probe row: "
                          << get_row_output_string(_probe_batch->get_row(j), child(i)->row_desc());
-                _hash_tbl_iterator = _hash_tbl->find(_probe_batch->get_row(j));
-                if (_hash_tbl_iterator != _hash_tbl->end()) {
-                    _hash_tbl_iterator.set_matched();
+                // the rows of every child have their own layout
+                _hash_tbl_iterator =
+                        _hash_tbl->find(_probe_batch->get_row(j), _child_expr_lists[i]);
+                if (_hash_tbl_iterator == _hash_tbl->end()) {
+                    continue;
+                }
+                int64_t idx = _hash_tbl_iterator.get_node_idx();
+                if (valid[idx] && !visited[idx]) {
+                    visited[idx] = true;
+                    ++num_visited;
                     VLOG_ROW << "probe matched: "
                              << get_row_output_string(_hash_tbl_iterator.get_row(),
                                                       child(0)->row_desc());
@@ -99,6 +86,19 @@ Status IntersectNode::open(RuntimeState* state) {
             }
             _probe_batch->reset();
         }
+        // only the rows found by this child stay in the result
+        valid.swap(visited);
+        num_valid = num_visited;
+    }
+
+    if (num_valid > 0) {
+        _hash_tbl_iterator = _hash_tbl->begin();
+        while (_hash_tbl_iterator.has_next()) {
+            if (valid[_hash_tbl_iterator.get_node_idx()]) {
+                _hash_tbl_iterator.set_matched();
+            }
+            _hash_tbl_iterator.next<false>();
+        }
     }
     _hash_tbl_iterator = _hash_tbl->begin();
     return Status::OK();
@@ -18,6 +18,8 @@
 #include "exec/json_scanner.h"
 
 #include <algorithm>
+#include <boost/bind.hpp>
+#include <cstring>
 
 #include "env/env.h"
 #include "exec/broker_reader.h"
@@ -90,6 +92,7 @@ Status JsonScanner::open_next_reader() {
         delete _cur_file_reader;
         _cur_file_reader = nullptr;
         if (_stream_load_pipe != nullptr) {
+            update_stream_load_pipe_counters(_stream_load_pipe.get());
             _stream_load_pipe.reset();
         }
     }
@@ -163,6 +166,7 @@ void JsonScanner::close() {
         delete _cur_file_reader;
         _cur_file_reader = nullptr;
         if (_stream_load_pipe != nullptr) {
+            update_stream_load_pipe_counters(_stream_load_pipe.get());
             _stream_load_pipe.reset();
         }
     }
@@ -199,9 +203,19 @@ JsonReader::JsonReader(
             _closed(false),
             _strip_outer_array(strip_outer_array),
             _num_as_string(num_as_string),
+            _value_allocator(_value_buffer, sizeof(_value_buffer)),
+            _origin_json_doc(&_value_allocator),
             _json_doc(nullptr) {
     _bytes_read_counter = ADD_COUNTER(_profile, "BytesRead", TUnit::BYTES);
     _read_timer = ADD_TIMER(_profile, "FileReadTime");
+    _parse_timer = ADD_TIMER(_profile, "JsonParseTime");
+    _parsed_bytes_counter = ADD_COUNTER(_profile, "JsonParsedBytes", TUnit::BYTES);
+    // returns NULL if another reader of this profile has already added it
+    _profile->add_derived_counter(
+            "JsonParseThroughput", TUnit::BYTES_PER_SECOND,
+            boost::bind<int64_t>(&RuntimeProfile::units_per_second, _parsed_bytes_counter,
+                                 _parse_timer),
+            "");
 }
 
 JsonReader::~JsonReader() {
@@ -259,6 +273,7 @@ void JsonReader::_close() {
     if (_closed) {
         return;
     }
+    _json_buf.reset();
     if (typeid(*_file_reader) == typeid(doris::BrokerReader) ||
         typeid(*_file_reader) == typeid(doris::LocalFileReader)) {
         _file_reader->close();
@@ -267,41 +282,89 @@ void JsonReader::_close() {
     _closed = true;
 }
 
-// read one json string from file read and parse it to json doc.
+// Parse the next json document to json doc.
+// A message read from file reader may contain several json documents separated by
+// whitespace, eg. newline delimited json. They are parsed one at a time from the same
+// buffer, and the next message is only read after all documents of this one are consumed.
 // return Status::DataQualityError() if data has quality error.
 // return other error if encounter other problemes.
 // return Status::OK() if parse succeed or reach EOF.
 Status JsonReader::_parse_json_doc(bool* eof) {
-    // read a whole message, must be delete json_str by `delete[]`
-    uint8_t* json_str = nullptr;
-    size_t length = 0;
-    RETURN_IF_ERROR(_file_reader->read_one_message(&json_str, &length));
-    if (length == 0) {
-        *eof = true;
-        return Status::OK();
+    if (_json_buf == nullptr) {
+        SCOPED_TIMER(_read_timer);
+        RETURN_IF_ERROR(_file_reader->read_one_message(&_json_buf));
+        if (_json_buf == nullptr || !_json_buf->has_remaining()) {
+            _json_buf.reset();
+            *eof = true;
+            return Status::OK();
+        }
+        COUNTER_UPDATE(_bytes_read_counter, _json_buf->remaining());
     }
 
-    bool has_parse_error = false;
+    const char* json_begin = _json_buf->ptr + _json_buf->pos;
+    size_t json_size = _json_buf->remaining();
+
+    // values of the last document are not referenced any more, reuse their memory.
+    _origin_json_doc.SetNull();
+    _value_allocator.Clear();
+
     // parse jsondata to JsonDoc
     // As the issue: https://github.com/Tencent/rapidjson/issues/1458
     // Now, rapidjson only support uint64_t, So lagreint load cause bug. We use kParseNumbersAsStringsFlag.
-    if (_num_as_string) {
-        has_parse_error = _origin_json_doc.Parse<rapidjson::kParseNumbersAsStringsFlag>((char*)json_str, length).HasParseError();
-    } else {
-        has_parse_error = _origin_json_doc.Parse((char*)json_str, length).HasParseError();
+    rapidjson::MemoryStream ms(json_begin, json_size);
+    rapidjson::EncodedInputStream<rapidjson::UTF8<>, rapidjson::MemoryStream> is(ms);
+    bool has_parse_error = false;
+    {
+        SCOPED_TIMER(_parse_timer);
+        if (_num_as_string) {
+            has_parse_error =
+                    _origin_json_doc
+                            .ParseStream<rapidjson::kParseStopWhenDoneFlag |
+                                                 rapidjson::kParseNumbersAsStringsFlag,
+                                         rapidjson::UTF8<>>(is)
+                            .HasParseError();
+        } else {
+            has_parse_error =
+                    _origin_json_doc
+                            .ParseStream<rapidjson::kParseStopWhenDoneFlag, rapidjson::UTF8<>>(is)
+                            .HasParseError();
+        }
     }
 
     if (has_parse_error) {
+        // Skip to the next line, the documents of a message with several of them are
+        // newline delimited. Not to the one after the error offset, rapidjson reports a
+        // document cut short at the first token of the next line.
+        const char* line_end =
+                reinterpret_cast<const char*>(memchr(json_begin, '\n', json_size));
+        size_t skipped = line_end == nullptr ? json_size : line_end - json_begin + 1;
         std::stringstream str_error;
         str_error << "Parse json data for JsonDoc failed. code = "
                   << _origin_json_doc.GetParseError() << ", error-info:"
                   << rapidjson::GetParseError_En(_origin_json_doc.GetParseError());
-        _state->append_error_msg_to_file(std::string((char*)json_str, length), str_error.str());
+        _state->append_error_msg_to_file(std::string(json_begin, skipped), str_error.str());
         _counter->num_rows_filtered++;
-        delete[] json_str;
+        while (skipped < json_size && isspace(static_cast<unsigned char>(json_begin[skipped]))) {
+            skipped++;
+        }
+        COUNTER_UPDATE(_parsed_bytes_counter, skipped);
+        _json_buf->pos += skipped;
+        if (!_json_buf->has_remaining()) {
+            _json_buf.reset();
+        }
         return Status::DataQualityError(str_error.str());
     }
-    delete[] json_str;
+
+    // skip the whitespaces after this document, release the message if nothing left.
+    size_t consumed = is.Tell();
+    while (consumed < json_size && isspace(static_cast<unsigned char>(json_begin[consumed]))) {
+        consumed++;
+    }
+    COUNTER_UPDATE(_parsed_bytes_counter, consumed);
+    _json_buf->pos += consumed;
+    if (!_json_buf->has_remaining()) {
+        _json_buf.reset();
+    }
 
     // set json root
     if (_parsed_json_root.size() != 0) {
@@ -373,7 +436,7 @@ void JsonReader::_write_data_to_tuple(rapidjson::Value::ConstValueIterator value
     switch (value->GetType()) {
     case rapidjson::Type::kStringType:
         str_value = value->GetString();
-        _fill_slot(tuple, desc, tuple_pool, (uint8_t*)str_value, strlen(str_value));
+        _fill_slot(tuple, desc, tuple_pool, (uint8_t*)str_value, value->GetStringLength());
         break;
     case rapidjson::Type::kNumberType:
         if (value->IsUint()) {
@@ -438,9 +501,10 @@ void JsonReader::_set_tuple_value(rapidjson::Value& objectValue, Tuple* tuple,
 
     int nullcount = 0;
     for (auto v : slot_descs) {
-        if (objectValue.HasMember(v->col_name().c_str())) {
-            rapidjson::Value& value = objectValue[v->col_name().c_str()];
-            _write_data_to_tuple(&value, v, tuple, tuple_pool, valid);
+        // look up the member only once, HasMember() and operator[] both scan the object
+        rapidjson::Value::ConstMemberIterator it = objectValue.FindMember(v->col_name().c_str());
+        if (it != objectValue.MemberEnd()) {
+            _write_data_to_tuple(&it->value, v, tuple, tuple_pool, valid);
             if (!(*valid)) {
                 return;
             }
@@ -597,12 +661,11 @@ Status JsonReader::_handle_nested_complex_json(Tuple* tuple,
         if (*eof) {
             return Status::OK(); // read over,then return
         }
-        break; // read a valid row
-    }
-    if (!_write_values_by_jsonpath(*_json_doc, tuple_pool, tuple, slot_descs)) {
-        // there is only one line in this case, so if it return false, just set eof = true
-        // so that the caller will continue reading next line.
-        *eof = true;
+        // there is only one row in each document, so if it return false,
+        // just continue to read next document.
+        if (_write_values_by_jsonpath(*_json_doc, tuple_pool, tuple, slot_descs)) {
+            break; // read a valid row
+        }
     }
     return Status::OK();
 }
@@ -19,7 +19,9 @@
 #define BE_SRC_JSON_SCANNER_H_
 
 #include <rapidjson/document.h>
+#include <rapidjson/encodedstream.h>
 #include <rapidjson/error/en.h>
+#include <rapidjson/memorystream.h>
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
 
@@ -154,10 +156,24 @@ private:
     bool _num_as_string;
     RuntimeProfile::Counter* _bytes_read_counter;
     RuntimeProfile::Counter* _read_timer;
+    RuntimeProfile::Counter* _parse_timer;
+    RuntimeProfile::Counter* _parsed_bytes_counter;
 
     std::vector<std::vector<JsonPath>> _parsed_jsonpaths;
     std::vector<JsonPath> _parsed_json_root;
 
+    // The message returned by the file reader. It may hold several json documents
+    // separated by whitespace (eg. one document per line), which are parsed one by one
+    // starting from _json_buf->pos.
+    ByteBufferPtr _json_buf;
+
+    // Values of the parsed document are allocated from _value_allocator, which is
+    // cleared before parsing the next document, so the memory of the first chunk
+    // is reused instead of growing with the number of documents.
+    static const size_t JSON_VALUE_BUFFER_SIZE = 64 * 1024;
+    char _value_buffer[JSON_VALUE_BUFFER_SIZE];
+    rapidjson::MemoryPoolAllocator<> _value_allocator;
+
     rapidjson::Document _origin_json_doc; // origin json document object from parsed json string
     rapidjson::Value* _json_doc; // _json_doc equals _final_json_doc iff not set `json_root`
 };
@@ -53,21 +53,23 @@ bool LocalFileReader::closed() {
 }
 
 // Read all bytes
-Status LocalFileReader::read_one_message(uint8_t** buf, size_t* length) {
+Status LocalFileReader::read_one_message(ByteBufferPtr* buf) {
     bool eof;
     int64_t file_size = size() - _current_offset;
     if (file_size <= 0) {
-        *buf = nullptr;
-        *length = 0;
+        buf->reset();
         return Status::OK();
     }
-    *length = file_size;
-    *buf = new uint8_t[file_size];
-    read(*buf, length, &eof);
-    if (*length == 0) {
-        delete *buf;
-        *buf = nullptr;
+    size_t length = file_size;
+    ByteBufferPtr file_buf = ByteBuffer::allocate(file_size);
+    read((uint8_t*)file_buf->ptr, &length, &eof);
+    if (length == 0) {
+        buf->reset();
+        return Status::OK();
     }
+    file_buf->pos = length;
+    file_buf->flip();
+    *buf = file_buf;
     return Status::OK();
 }
 
@@ -17,6 +17,8 @@
 
 #include "exec/olap_scan_node.h"
 
+#include <arrow/record_batch.h>
+
 #include <algorithm>
 #include <boost/foreach.hpp>
 #include <boost/variant.hpp>
@@ -33,10 +35,13 @@
 #include "exprs/in_predicate.h"
 #include "gen_cpp/PlanNodes_types.h"
 #include "runtime/exec_env.h"
+#include "runtime/pipeline_scheduler.h"
+#include "runtime/raw_value.h"
 #include "runtime/row_batch.h"
 #include "runtime/runtime_state.h"
 #include "runtime/string_value.h"
 #include "runtime/tuple_row.h"
+#include "util/arrow/row_batch.h"
 #include "util/debug_util.h"
 #include "util/priority_thread_pool.hpp"
 #include "util/runtime_profile.h"
@@ -146,6 +151,7 @@ Status OlapScanNode::prepare(RuntimeState* state) {
     _tablet_counter = ADD_COUNTER(runtime_profile(), "TabletCount ", TUnit::UNIT);
     _rows_pushed_cond_filtered_counter =
             ADD_COUNTER(_scanner_profile, "RowsPushedCondFiltered", TUnit::UNIT);
+    _rows_topn_filtered_counter = ADD_COUNTER(_scanner_profile, "RowsTopNFiltered", TUnit::UNIT);
     _init_counter(state);
     _tuple_desc = state->desc_tbl().get_tuple_descriptor(_tuple_id);
 
@@ -228,6 +234,7 @@ Status OlapScanNode::get_next(RuntimeState* state, RowBatch* row_batch, bool* eo
             }
 
             // use wait_for, not wait, in case to capture the state->is_cancelled()
+            PipelineScheduler::BlockingScope blocking;
             _row_batch_added_cv.wait_for(l, std::chrono::seconds(1));
         }
 
@@ -286,6 +293,15 @@ Status OlapScanNode::get_next(RuntimeState* state, RowBatch* row_batch, bool* eo
     return _status;
 }
 
+bool OlapScanNode::can_get_next() {
+    // scanners are started by the first get_next()
+    if (!_start || _eos) {
+        return true;
+    }
+    std::unique_lock<std::mutex> l(_row_batches_lock);
+    return !_materialized_row_batches.empty() || _transfer_done;
+}
+
 Status OlapScanNode::collect_query_statistics(QueryStatistics* statistics) {
     RETURN_IF_ERROR(ExecNode::collect_query_statistics(statistics));
     statistics->add_scan_bytes(_read_compressed_counter->value());
@@ -388,6 +404,8 @@ Status OlapScanNode::start_scan(RuntimeState* state) {
     // 5. Using `Key Column`'s ColumnValueRange to split ScanRange to several `Sub ScanRange`
     RETURN_IF_ERROR(build_scan_key());
 
+    RETURN_IF_ERROR(init_arrow_output(state));
+
     VLOG(1) << "StartScanThread";
     // 6. Start multi thread to read several `Sub Sub ScanRange`
     RETURN_IF_ERROR(start_scan_thread(state));
@@ -406,6 +424,94 @@ bool OlapScanNode::is_key_column(const std::string& key_name) {
     return res != _olap_scan_node.key_column_name.end();
 }
 
+bool OlapScanNode::register_topn_filter(SlotId slot_id, bool is_asc, bool nulls_first) {
+    if (!config::enable_topn_runtime_filter || _tuple_desc == nullptr) {
+        return false;
+    }
+    SlotDescriptor* slot = nullptr;
+    for (auto s : _tuple_desc->slots()) {
+        if (s->id() == slot_id && s->is_materialized()) {
+            slot = s;
+            break;
+        }
+    }
+    if (slot == nullptr) {
+        return false;
+    }
+    // the threshold drops NULLs, which is only right if they sort after every value
+    if (slot->is_nullable() && nulls_first) {
+        return false;
+    }
+    // value columns of agg and unique tables can only be filtered after merging
+    if (!is_key_column(slot->col_name())) {
+        return false;
+    }
+    switch (slot->type().type) {
+    case TYPE_TINYINT:
+    case TYPE_SMALLINT:
+    case TYPE_INT:
+    case TYPE_BIGINT:
+    case TYPE_LARGEINT:
+    case TYPE_DATE:
+    case TYPE_DATETIME:
+    case TYPE_DECIMALV2:
+    case TYPE_VARCHAR:
+        break;
+    default:
+        return false;
+    }
+    _topn_slot = slot;
+    _topn_is_asc = is_asc;
+    VLOG(2) << "register topn runtime filter on column " << slot->col_name()
+            << (is_asc ? " asc" : " desc");
+    return true;
+}
+
+void OlapScanNode::update_topn_threshold(const void* value) {
+    DCHECK(_topn_slot != nullptr);
+    DCHECK(value != nullptr);
+    std::string bytes;
+    if (_topn_slot->type().is_string_type()) {
+        const StringValue* str = reinterpret_cast<const StringValue*>(value);
+        bytes.assign(str->ptr, str->len);
+    } else {
+        bytes.assign(reinterpret_cast<const char*>(value), _topn_slot->type().get_slot_size());
+    }
+    std::lock_guard<SpinLock> guard(_topn_lock);
+    _topn_value.swap(bytes);
+    ++_topn_version;
+}
+
+int64_t OlapScanNode::get_topn_threshold(int64_t version, std::string* value) {
+    std::lock_guard<SpinLock> guard(_topn_lock);
+    if (_topn_version != version) {
+        *value = _topn_value;
+    }
+    return _topn_version;
+}
+
+bool OlapScanNode::get_topn_condition(TCondition* condition) {
+    if (_topn_slot == nullptr) {
+        return false;
+    }
+    std::string value;
+    if (get_topn_threshold(0, &value) == 0) {
+        return false;
+    }
+    std::string str;
+    if (_topn_slot->type().is_string_type()) {
+        str = value;
+    } else {
+        RawValue::print_value(value.data(), _topn_slot->type(), -1, &str);
+    }
+    condition->__set_column_name(_topn_slot->col_name());
+    // keep the rows equal to the threshold, the later sort keys may still let them in
+    condition->__set_condition_op(_topn_is_asc ? "<=" : ">=");
+    condition->condition_values.clear();
+    condition->condition_values.push_back(str);
+    return true;
+}
+
 void OlapScanNode::remove_pushed_conjuncts(RuntimeState *state) {
     if (_pushed_conjuncts_index.empty()) {
         return;
@@ -676,6 +782,27 @@ static Status get_hints(const TPaloScanRange& scan_range, int block_row_count,
     return Status::OK();
 }
 
+Status OlapScanNode::init_arrow_output(RuntimeState* state) {
+    if (!config::enable_columnar_external_scan ||
+        state->query_options().query_type != TQueryType::EXTERNAL) {
+        return Status::OK();
+    }
+    // every row read must be returned as is
+    if (limit() != -1 || !_conjunct_ctxs.empty() || row_desc().tuple_descriptors().size() != 1) {
+        return Status::OK();
+    }
+    for (auto slot : _tuple_desc->slots()) {
+        if (!slot->is_materialized()) {
+            return Status::OK();
+        }
+    }
+    // same schema as the one of MemoryScratchSink
+    RETURN_IF_ERROR(convert_to_arrow_schema(row_desc(), &_arrow_schema));
+    state->exec_env()->result_queue_mgr()->create_queue(state->fragment_instance_id(),
+                                                        &_arrow_queue);
+    return Status::OK();
+}
+
 Status OlapScanNode::start_scan_thread(RuntimeState* state) {
     if (_scan_ranges.empty()) {
         _transfer_done = true;
@@ -1305,6 +1432,7 @@ void OlapScanNode::transfer_thread(RuntimeState* state) {
     std::unique_lock<std::mutex> l(_row_batches_lock);
     _transfer_done = true;
     _row_batch_added_cv.notify_all();
+    PipelineScheduler::notify_blocked_tasks();
 }
 
 void OlapScanNode::scanner_thread(OlapScanner* scanner) {
@@ -1344,6 +1472,26 @@ void OlapScanNode::scanner_thread(OlapScanner* scanner) {
             LOG(INFO) << "Scan thread cancelled, cause query done, maybe reach limit.";
             break;
         }
+        if (_arrow_queue != nullptr) {
+            std::shared_ptr<arrow::RecordBatch> arrow_batch;
+            status = scanner->get_arrow_batch(_runtime_state, _arrow_schema, &arrow_batch, &eos);
+            if (!status.ok()) {
+                LOG(WARNING) << "Scan thread read OlapScanner failed: " << status.to_string();
+                eos = true;
+                break;
+            }
+            if (arrow_batch != nullptr) {
+                COUNTER_UPDATE(_rows_returned_counter, arrow_batch->num_rows());
+                // the queue is shut down when the client closes the scan
+                if (!_arrow_queue->blocking_put(arrow_batch)) {
+                    eos = true;
+                    status = Status::Cancelled("Cancelled");
+                    break;
+                }
+            }
+            raw_rows_read = scanner->raw_rows_read();
+            continue;
+        }
         RowBatch* row_batch = new RowBatch(this->row_desc(), state->batch_size(),
                                            _runtime_state->fragment_mem_tracker().get());
         row_batch->set_scanner_id(scanner->id());
@@ -1427,6 +1575,7 @@ Status OlapScanNode::add_one_batch(RowBatchInterface* row_batch) {
     }
     // remove one batch, notify main thread
     _row_batch_added_cv.notify_one();
+    PipelineScheduler::notify_blocked_tasks();
     return Status::OK();
 }
 
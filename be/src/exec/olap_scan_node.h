@@ -27,11 +27,16 @@
 #include "exec/olap_scanner.h"
 #include "exec/scan_node.h"
 #include "runtime/descriptors.h"
+#include "runtime/result_queue_mgr.h"
 #include "runtime/row_batch_interface.hpp"
 #include "runtime/vectorized_row_batch.h"
 #include "util/progress_updater.h"
 #include "util/spinlock.h"
 
+namespace arrow {
+class Schema;
+}
+
 namespace doris {
 
 enum TransferStatus {
@@ -52,11 +57,21 @@ public:
     virtual Status prepare(RuntimeState* state);
     virtual Status open(RuntimeState* state);
     virtual Status get_next(RuntimeState* state, RowBatch* row_batch, bool* eos);
+    bool can_get_next() override;
     Status collect_query_statistics(QueryStatistics* statistics) override;
     virtual Status close(RuntimeState* state);
     virtual Status set_scan_ranges(const std::vector<TScanRangeParams>& scan_ranges);
     inline void set_no_agg_finalize() { _need_agg_finalize = false; }
 
+    // Called by a parent TopNNode in prepare(). Asks this node to filter on the current
+    // boundary of the TopN heap, which is ordered by 'slot_id'. Returns false if the
+    // slot cannot be filtered in storage, in which case no threshold should be published.
+    bool register_topn_filter(SlotId slot_id, bool is_asc, bool nulls_first);
+
+    // Publishes a new TopN boundary. 'value' is a non-NULL value of the registered slot.
+    // Rows strictly worse than it can never enter the TopN heap.
+    void update_topn_threshold(const void* value);
+
 protected:
     typedef struct {
         Tuple* tuple;
@@ -144,6 +159,8 @@ protected:
     Status normalize_conjuncts();
     Status build_olap_filters();
     Status build_scan_key();
+    // Decides whether the scanners put arrow batches into the result queue directly.
+    Status init_arrow_output(RuntimeState* state);
     Status start_scan_thread(RuntimeState* state);
 
     template <class T>
@@ -172,6 +189,12 @@ private:
     void construct_is_null_pred_in_where_pred(Expr* expr, SlotDescriptor* slot,
                                               const std::string& is_null_str);
 
+    // Copies the current TopN boundary into 'value' if it is newer than 'version'.
+    // Returns the version of the boundary, 0 if no boundary has been published yet.
+    int64_t get_topn_threshold(int64_t version, std::string* value);
+    // Builds the storage condition of the current TopN boundary, false if there is none.
+    bool get_topn_condition(TCondition* condition);
+
     friend class OlapScanner;
 
     std::vector<TCondition> _is_null_vector;
@@ -247,6 +270,24 @@ private:
     RuntimeProfile::Counter* _tablet_counter;
     RuntimeProfile::Counter* _rows_pushed_cond_filtered_counter = nullptr;
     RuntimeProfile::Counter* _reader_init_timer = nullptr;
+    RuntimeProfile::Counter* _rows_topn_filtered_counter = nullptr;
+
+    // Runtime TopN threshold published by the parent TopNNode, see register_topn_filter().
+    // nullptr if no TopN filter was registered.
+    SlotDescriptor* _topn_slot = nullptr;
+    bool _topn_is_asc = true;
+    // protect _topn_value and _topn_version, written by the TopN and read by scanners
+    SpinLock _topn_lock;
+    // raw bytes of the threshold, for string slots the characters of the string
+    std::string _topn_value;
+    int64_t _topn_version = 0;
+
+    // The plan of an external scan is this node feeding a MemoryScratchSink, which converts
+    // the batches to arrow for the client. If not null, the scanners convert the storage
+    // blocks to arrow and put them into the sink's queue themselves, and this node returns
+    // no rows. See init_arrow_output().
+    BlockQueueSharedPtr _arrow_queue;
+    std::shared_ptr<arrow::Schema> _arrow_schema;
 
     TResourceInfo* _resource_info;
 
@@ -17,18 +17,25 @@
 
 #include "olap_scanner.h"
 
+#include <arrow/memory_pool.h>
+#include <arrow/record_batch.h>
+
 #include <cstring>
 #include <string>
 
 #include "gen_cpp/PaloInternalService_types.h"
 #include "olap/field.h"
+#include "olap/row_block2.h"
 #include "olap_scan_node.h"
 #include "olap_utils.h"
 #include "runtime/descriptors.h"
 #include "runtime/mem_pool.h"
 #include "runtime/mem_tracker.h"
+#include "runtime/raw_value.h"
 #include "runtime/runtime_state.h"
 #include "service/backend_options.h"
+#include "util/arrow/row_batch.h"
+#include "util/arrow/row_block.h"
 #include "util/doris_metrics.h"
 #include "util/mem_util.hpp"
 #include "util/network_util.h"
@@ -100,6 +107,7 @@ Status OlapScanner::prepare(const TPaloScanRange& scan_range,
                    << ", backend=" << BackendOptions::get_localhost();
                 return Status::InternalError(ss.str().c_str());
             }
+            _columnar_read = _can_read_columnar();
         }
     }
 
@@ -118,6 +126,12 @@ Status OlapScanner::open() {
         _use_pushdown_conjuncts = true;
     }
 
+    // scanners are opened lazily, so a TopN above may have already narrowed the range
+    TCondition topn_condition;
+    if (_parent->get_topn_condition(&topn_condition)) {
+        _params.conditions.push_back(topn_condition);
+    }
+
     auto res = _reader->init(_params);
     if (res != OLAP_SUCCESS) {
         OLAP_LOG_WARNING("fail to init reader.[res=%d]", res);
@@ -173,7 +187,8 @@ Status OlapScanner::_init_params(const std::vector<OlapScanRange*>& key_ranges,
              _params.rs_readers[1]->rowset()->rowset_meta()->num_rows() == 0 &&
              _params.rs_readers[1]->rowset()->start_version() == 2 &&
              !_params.rs_readers[1]->rowset()->rowset_meta()->is_segments_overlapping());
-    if (_aggregation || single_version) {
+    _params.columnar_read = _columnar_read;
+    if (_aggregation || single_version || _columnar_read) {
         _params.return_columns = _return_columns;
     } else {
         for (size_t i = 0; i < _tablet->num_key_columns(); ++i) {
@@ -244,6 +259,59 @@ Status OlapScanner::_init_return_columns() {
     return Status::OK();
 }
 
+bool OlapScanner::_can_read_columnar() const {
+    if (_parent->_arrow_queue == nullptr || _tablet->keys_type() != DUP_KEYS) {
+        return false;
+    }
+    for (auto& rs_reader : _params.rs_readers) {
+        if (rs_reader->rowset()->rowset_meta()->rowset_type() != BETA_ROWSET) {
+            return false;
+        }
+    }
+    // rows hit by a delete predicate are only filtered when they are read one by one
+    for (const auto& delete_pred : _tablet->delete_predicates()) {
+        if (delete_pred.version() <= _version) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Status OlapScanner::get_arrow_batch(RuntimeState* state,
+                                    const std::shared_ptr<arrow::Schema>& schema,
+                                    std::shared_ptr<arrow::RecordBatch>* result, bool* eof) {
+    result->reset();
+    if (!_columnar_read) {
+        RowBatch batch(_parent->row_desc(), state->batch_size(),
+                       state->fragment_mem_tracker().get());
+        RETURN_IF_ERROR(get_batch(state, &batch, eof));
+        if (batch.num_rows() == 0) {
+            return Status::OK();
+        }
+        return convert_to_arrow_batch(batch, schema, arrow::default_memory_pool(), result);
+    }
+
+    SCOPED_TIMER(_parent->_scan_timer);
+    std::shared_ptr<RowBlockV2> block;
+    do {
+        auto res = _reader->next_block(&block, eof);
+        if (res != OLAP_SUCCESS) {
+            std::stringstream ss;
+            ss << "Internal Error: read storage fail. res=" << res
+               << ", tablet=" << _tablet->full_name()
+               << ", backend=" << BackendOptions::get_localhost();
+            return Status::InternalError(ss.str());
+        }
+        _update_realtime_counter();
+        if (*eof) {
+            return Status::OK();
+        }
+    } while (block->num_rows() == 0);
+
+    _num_rows_read += block->num_rows();
+    return convert_to_arrow_batch(block, schema, arrow::default_memory_pool(), result);
+}
+
 Status OlapScanner::get_batch(RuntimeState* state, RowBatch* batch, bool* eof) {
     // 2. Allocate Row's Tuple buf
     uint8_t* tuple_buf =
@@ -255,6 +323,7 @@ Status OlapScanner::get_batch(RuntimeState* state, RowBatch* batch, bool* eof) {
     std::unique_ptr<MemPool> mem_pool(new MemPool(tracker.get()));
 
     int64_t raw_rows_threshold = raw_rows_read() + config::doris_scanner_row_num;
+    _refresh_topn_threshold();
     {
         SCOPED_TIMER(_parent->_scan_timer);
         while (true) {
@@ -291,6 +360,13 @@ Status OlapScanner::get_batch(RuntimeState* state, RowBatch* batch, bool* eof) {
             row->set_tuple(_tuple_idx, tuple);
 
             do {
+                // 3.5.0 Drop rows that can not enter the TopN above this scan node
+                if (_topn_threshold != nullptr && _is_topn_filtered(tuple)) {
+                    tuple->init(_tuple_desc->byte_size());
+                    _num_rows_topn_filtered++;
+                    break;
+                }
+
                 // 3.5.1 Using direct conjuncts to filter data
                 if (_eval_conjuncts_fn != nullptr) {
                     if (!_eval_conjuncts_fn(&_conjunct_ctxs[0], _direct_conjunct_size, row)) {
@@ -376,6 +452,36 @@ Status OlapScanner::get_batch(RuntimeState* state, RowBatch* batch, bool* eof) {
     return Status::OK();
 }
 
+void OlapScanner::_refresh_topn_threshold() {
+    const SlotDescriptor* slot = _parent->_topn_slot;
+    if (slot == nullptr) {
+        return;
+    }
+    int64_t version = _parent->get_topn_threshold(_topn_version, &_topn_value);
+    if (version == _topn_version) {
+        return;
+    }
+    _topn_version = version;
+    if (slot->type().is_string_type()) {
+        _topn_string_value = StringValue(const_cast<char*>(_topn_value.data()),
+                                         _topn_value.size());
+        _topn_threshold = &_topn_string_value;
+    } else {
+        _topn_threshold = _topn_value.data();
+    }
+}
+
+bool OlapScanner::_is_topn_filtered(Tuple* tuple) const {
+    const SlotDescriptor* slot = _parent->_topn_slot;
+    // NULLs are only filtered when they sort after every value
+    if (tuple->is_null(slot->null_indicator_offset())) {
+        return true;
+    }
+    int cmp = RawValue::compare(tuple->get_slot(slot->tuple_offset()), _topn_threshold,
+                                slot->type());
+    return _parent->_topn_is_asc ? cmp > 0 : cmp < 0;
+}
+
 void OlapScanner::_convert_row_to_tuple(Tuple* tuple) {
     size_t slots_size = _query_slots.size();
     for (int i = 0; i < slots_size; ++i) {
@@ -459,6 +565,7 @@ void OlapScanner::update_counter() {
     }
     COUNTER_UPDATE(_rows_read_counter, _num_rows_read);
     COUNTER_UPDATE(_rows_pushed_cond_filtered_counter, _num_rows_pushed_cond_filtered);
+    COUNTER_UPDATE(_parent->_rows_topn_filtered_counter, _num_rows_topn_filtered);
 
     COUNTER_UPDATE(_parent->_io_timer, _reader->stats().io_ns);
     COUNTER_UPDATE(_parent->_read_compressed_counter, _reader->stats().compressed_bytes_read);
@@ -36,9 +36,15 @@
 #include "olap/rowset/column_data.h"
 #include "olap/storage_engine.h"
 #include "runtime/descriptors.h"
+#include "runtime/string_value.h"
 #include "runtime/tuple.h"
 #include "runtime/vectorized_row_batch.h"
 
+namespace arrow {
+class RecordBatch;
+class Schema;
+} // namespace arrow
+
 namespace doris {
 
 class OlapScanNode;
@@ -61,6 +67,13 @@ public:
 
     Status get_batch(RuntimeState* state, RowBatch* batch, bool* eof);
 
+    // Reads the next rows as an arrow batch of 'schema', the schema of the parent's tuple.
+    // The storage blocks are converted to arrow directly when the tablet allows it, see
+    // _can_read_columnar(), otherwise the rows are read as tuples and then converted.
+    // '*result' is nullptr if no row is read.
+    Status get_arrow_batch(RuntimeState* state, const std::shared_ptr<arrow::Schema>& schema,
+                           std::shared_ptr<arrow::RecordBatch>* result, bool* eof);
+
     Status close(RuntimeState* state);
 
     RuntimeState* runtime_state() { return _runtime_state; }
@@ -83,7 +96,14 @@ private:
                         const std::vector<TCondition>& filters,
                         const std::vector<TCondition>& is_nulls);
     Status _init_return_columns();
+    // Whether the rows can be returned block by block as the storage reads them, i.e. there
+    // is nothing to merge, aggregate or delete. Must hold the tablet header lock.
+    bool _can_read_columnar() const;
     void _convert_row_to_tuple(Tuple* tuple);
+    // Refresh the TopN threshold published by the parent scan node.
+    void _refresh_topn_threshold();
+    // Returns true if the row in 'tuple' can no longer enter the TopN above the scan node.
+    bool _is_topn_filtered(Tuple* tuple) const;
 
     // Update profile that need to be reported in realtime.
     void _update_realtime_counter();
@@ -107,6 +127,8 @@ private:
 
     bool _use_pushdown_conjuncts = false;
 
+    // read by get_arrow_batch() with ReaderParams::columnar_read
+    bool _columnar_read = false;
     ReaderParams _params;
     std::unique_ptr<Reader> _reader;
 
@@ -131,6 +153,13 @@ private:
     // number rows filtered by pushed condition
     int64_t _num_rows_pushed_cond_filtered = 0;
 
+    // current TopN threshold of the parent scan node, see OlapScanNode::register_topn_filter()
+    int64_t _topn_version = 0;
+    std::string _topn_value;
+    StringValue _topn_string_value;
+    const void* _topn_threshold = nullptr;
+    int64_t _num_rows_topn_filtered = 0;
+
     bool _is_closed = false;
 };
 
@@ -95,6 +95,7 @@ Status ParquetScanner::open_next_reader() {
     // open_file_reader
     if (_cur_file_reader != nullptr) {
         if (_stream_load_pipe != nullptr) {
+            update_stream_load_pipe_counters(_stream_load_pipe.get());
             _stream_load_pipe.reset();
             _cur_file_reader = nullptr;
         } else {
@@ -174,6 +175,7 @@ Status ParquetScanner::open_next_reader() {
 void ParquetScanner::close() {
     if (_cur_file_reader != nullptr) {
         if (_stream_load_pipe != nullptr) {
+            update_stream_load_pipe_counters(_stream_load_pipe.get());
             _stream_load_pipe.reset();
             _cur_file_reader = nullptr;
         } else {
@@ -91,6 +91,30 @@ static const StreamingHtMinReductionEntry STREAMING_HT_MIN_REDUCTION[] = {
 static const int STREAMING_HT_MIN_REDUCTION_SIZE =
         sizeof(STREAMING_HT_MIN_REDUCTION) / sizeof(STREAMING_HT_MIN_REDUCTION[0]);
 
+/// The reduction of a streaming preaggregation changes with the locality of its input,
+/// e.g. a scan that moves on to data clustered by other keys. So every partition keeps
+/// sampling the reduction over windows of this many of its rows and decides per window
+/// whether it aggregates or passes its rows through.
+static const int64_t STREAMING_SAMPLE_WINDOW_ROWS = 16 * 1024;
+
+/// A partition whose hash table is full stops probing it if less than about one in ten
+/// rows of a window hit an existing group: the lookups cost more than they save.
+static const double STREAMING_PASSTHROUGH_MAX_REDUCTION = 1.1;
+
+/// A partition in passthrough mode resumes the aggregation once its rows repeat enough to
+/// justify expanding the hash table into main memory.
+static const double STREAMING_RESUME_MIN_REDUCTION =
+        STREAMING_HT_MIN_REDUCTION[STREAMING_HT_MIN_REDUCTION_SIZE - 1].streaming_ht_min_reduction;
+
+/// A partition aggregates for at least this many windows before it may pass its rows
+/// through, so that after resuming, the groups of the new input can replace the ones in
+/// the full hash table before its reduction is judged.
+static const int STREAMING_MIN_AGGREGATION_WINDOWS = 2;
+
+/// A partition that goes back to passthrough soon after resuming waits twice as many
+/// windows as before until it may resume again, up to this many.
+static const int STREAMING_MAX_PASSTHROUGH_WINDOWS = 64;
+
 PartitionedAggregationNode::PartitionedAggregationNode(ObjectPool* pool, const TPlanNode& tnode,
                                                        const DescriptorTbl& descs)
         : ExecNode(pool, tnode, descs),
@@ -126,7 +150,16 @@ PartitionedAggregationNode::PartitionedAggregationNode(ObjectPool* pool, const T
           num_passthrough_rows_(NULL),
           preagg_estimated_reduction_(NULL),
           preagg_streaming_ht_min_reduction_(NULL),
+          preagg_passthrough_switches_(NULL),
+          preagg_aggregation_switches_(NULL),
+          rows_in_sorted_runs_(NULL),
           //    estimated_input_cardinality_(tnode.agg_node.estimated_input_cardinality),
+          run_tuple_(NULL),
+          run_hash_(0),
+          run_agg_fn_evals_(NULL),
+          run_in_hash_tbl_(false),
+          num_rows_in_runs_(0),
+          num_passthrough_rows_in_runs_(0),
           singleton_output_tuple_(NULL),
           singleton_output_tuple_returned_(true),
           partition_eos_(false),
@@ -201,6 +234,7 @@ Status PartitionedAggregationNode::prepare(RuntimeState* state) {
     num_hash_travel_length_ = ADD_COUNTER(runtime_profile(), "HashTravelLength", TUnit::UNIT);
     num_hash_collisions_ = ADD_COUNTER(runtime_profile(), "HashCollisions", TUnit::UNIT);
     ht_resize_counter_ = ADD_COUNTER(runtime_profile(), "HTResize", TUnit::UNIT);
+    rows_in_sorted_runs_ = ADD_COUNTER(runtime_profile(), "RowsInSortedRuns", TUnit::UNIT);
     partitions_created_ = ADD_COUNTER(runtime_profile(), "PartitionsCreated", TUnit::UNIT);
     largest_partition_percent_ =
             runtime_profile()->AddHighWaterMarkCounter("LargestPartitionPercent", TUnit::UNIT);
@@ -219,6 +253,11 @@ Status PartitionedAggregationNode::prepare(RuntimeState* state) {
                 ADD_COUNTER(runtime_profile(), "ReductionFactorEstimate", TUnit::DOUBLE_VALUE);
         preagg_streaming_ht_min_reduction_ = ADD_COUNTER(
                 runtime_profile(), "ReductionFactorThresholdToExpand", TUnit::DOUBLE_VALUE);
+        preagg_passthrough_switches_ =
+                ADD_COUNTER(runtime_profile(), "PartitionsSwitchedToPassthrough", TUnit::UNIT);
+        preagg_aggregation_switches_ =
+                ADD_COUNTER(runtime_profile(), "PartitionsSwitchedToAggregation", TUnit::UNIT);
+        recent_hashes_.resize(STREAMING_RECENT_HASHES_SIZE, 0);
     } else {
         build_timer_ = ADD_TIMER(runtime_profile(), "BuildTime");
         num_row_repartitioned_ = ADD_COUNTER(runtime_profile(), "RowsRepartitioned", TUnit::UNIT);
@@ -502,7 +541,8 @@ Status PartitionedAggregationNode::GetRowsFromPartition(RuntimeState* state, Row
         }
     }
 
-    COUNTER_SET(num_processed_rows_, num_hash_probe_->value());
+    COUNTER_SET(num_processed_rows_, num_hash_probe_->value() + num_rows_in_runs_);
+    COUNTER_SET(rows_in_sorted_runs_, num_rows_in_runs_);
     COUNTER_SET(_rows_returned_counter, _num_rows_returned);
     partition_eos_ = reached_limit();
     if (output_iterator_.AtEnd()) row_batch->mark_needs_deep_copy();
@@ -529,11 +569,9 @@ Status PartitionedAggregationNode::GetRowsStreaming(RuntimeState* state, RowBatc
         SCOPED_TIMER(streaming_timer_);
 
         int remaining_capacity[PARTITION_FANOUT];
-        bool ht_needs_expansion = false;
         for (int i = 0; i < PARTITION_FANOUT; ++i) {
             PartitionedHashTable* hash_tbl = GetHashTable(i);
             remaining_capacity[i] = hash_tbl->NumInsertsBeforeResize();
-            ht_needs_expansion |= remaining_capacity[i] < child_batch_->num_rows();
         }
 
         // Stop expanding hash tables if we're not reducing the input sufficiently. As our
@@ -541,18 +579,17 @@ Status PartitionedAggregationNode::GetRowsStreaming(RuntimeState* state, RowBatc
         // will take longer. We also may not be able to expand hash tables because of memory
         // pressure. In this case HashTable::CheckAndResize() will fail. In either case we
         // should always use the remaining space in the hash table to avoid wasting memory.
-        if (ht_needs_expansion && ShouldExpandPreaggHashTables()) {
-            for (int i = 0; i < PARTITION_FANOUT; ++i) {
-                PartitionedHashTable* ht = GetHashTable(i);
-                if (remaining_capacity[i] < child_batch_->num_rows()) {
-                    SCOPED_TIMER(ht_resize_timer_);
-                    bool resized;
-                    RETURN_IF_ERROR(
-                            ht->CheckAndResize(child_batch_->num_rows(), ht_ctx_.get(), &resized));
-                    if (resized) {
-                        remaining_capacity[i] = ht->NumInsertsBeforeResize();
-                    }
-                }
+        for (int i = 0; i < PARTITION_FANOUT; ++i) {
+            if (remaining_capacity[i] >= child_batch_->num_rows() ||
+                !ShouldExpandPreaggHashTable(hash_partitions_[i])) {
+                continue;
+            }
+            PartitionedHashTable* ht = GetHashTable(i);
+            SCOPED_TIMER(ht_resize_timer_);
+            bool resized;
+            RETURN_IF_ERROR(ht->CheckAndResize(child_batch_->num_rows(), ht_ctx_.get(), &resized));
+            if (resized) {
+                remaining_capacity[i] = ht->NumInsertsBeforeResize();
             }
         }
 
@@ -565,6 +602,12 @@ Status PartitionedAggregationNode::GetRowsStreaming(RuntimeState* state, RowBatc
                                                   ht_ctx_.get(), remaining_capacity));
         }
 
+        for (int i = 0; i < PARTITION_FANOUT; ++i) {
+            if (hash_partitions_[i]->window_rows >= STREAMING_SAMPLE_WINDOW_ROWS) {
+                UpdateStreamingMode(hash_partitions_[i], remaining_capacity[i] == 0);
+            }
+        }
+
         child_batch_->reset(); // All rows from child_batch_ were processed.
     } while (out_batch->num_rows() == 0 && !child_eos_);
 
@@ -576,10 +619,18 @@ Status PartitionedAggregationNode::GetRowsStreaming(RuntimeState* state, RowBatc
 
     _num_rows_returned += out_batch->num_rows();
     COUNTER_SET(num_passthrough_rows_, _num_rows_returned);
+    COUNTER_SET(rows_in_sorted_runs_, num_rows_in_runs_);
     return Status::OK();
 }
 
-bool PartitionedAggregationNode::ShouldExpandPreaggHashTables() const {
+bool PartitionedAggregationNode::ShouldExpandPreaggHashTable(const Partition* partition) const {
+    // A partition in passthrough mode does not insert into its hash table.
+    if (partition->is_passthrough) return false;
+
+    // The tables of all partitions share the caches, so both the memory and the reduction
+    // are estimated over all of them. The sampled reduction of the partition only decides
+    // whether it probes its table at all, see UpdateStreamingMode().
+
     int64_t ht_mem = 0;
     int64_t ht_rows = 0;
     for (int i = 0; i < PARTITION_FANOUT; ++i) {
@@ -601,8 +652,7 @@ bool PartitionedAggregationNode::ShouldExpandPreaggHashTables() const {
     // Compare the number of rows in the hash table with the number of input rows that
     // were aggregated into it. Exclude passed through rows from this calculation since
     // they were not in hash tables.
-    const int64_t input_rows = _children[0]->rows_returned();
-    const int64_t aggregated_input_rows = input_rows - _num_rows_returned;
+    const int64_t aggregated_input_rows = NumAggregatedInputRows();
     // TODO chenhao
     //  const int64_t expected_input_rows = estimated_input_cardinality_ - num_rows_returned_;
     double current_reduction = static_cast<double>(aggregated_input_rows) / ht_rows;
@@ -623,11 +673,51 @@ bool PartitionedAggregationNode::ShouldExpandPreaggHashTables() const {
     double min_reduction = STREAMING_HT_MIN_REDUCTION[cache_level].streaming_ht_min_reduction;
 
     //  COUNTER_SET(preagg_estimated_reduction_, estimated_reduction);
+    COUNTER_SET(preagg_estimated_reduction_, current_reduction);
     COUNTER_SET(preagg_streaming_ht_min_reduction_, min_reduction);
     //  return estimated_reduction > min_reduction;
     return current_reduction > min_reduction;
 }
 
+int64_t PartitionedAggregationNode::NumAggregatedInputRows() const {
+    // Each passed through tuple is an output row. The rows of its run were aggregated into
+    // it, while the rows of a run of a hash table tuple were aggregated into the hash table
+    // without probing it.
+    return _children[0]->rows_returned() - _num_rows_returned - num_passthrough_rows_in_runs_;
+}
+
+void PartitionedAggregationNode::UpdateStreamingMode(Partition* partition, bool ht_full) {
+    DCHECK(is_streaming_preagg_);
+    DCHECK_GT(partition->window_rows, 0);
+    const int64_t new_groups =
+            std::max<int64_t>(1, partition->window_rows - partition->window_aggregated_rows);
+    partition->sampled_reduction = static_cast<double>(partition->window_rows) / new_groups;
+    ++partition->windows_in_mode;
+    if (partition->is_passthrough) {
+        if (partition->windows_in_mode >= partition->min_passthrough_windows &&
+            partition->sampled_reduction >= STREAMING_RESUME_MIN_REDUCTION) {
+            partition->is_passthrough = false;
+            partition->windows_in_mode = 0;
+            COUNTER_UPDATE(preagg_aggregation_switches_, 1);
+        }
+    } else if (ht_full && partition->windows_in_mode >= STREAMING_MIN_AGGREGATION_WINDOWS &&
+               partition->sampled_reduction < STREAMING_PASSTHROUGH_MAX_REDUCTION) {
+        // Back off if aggregating did not pay off for long, so a partition whose passed
+        // through rows repeat but do not hit its table does not switch every few windows.
+        if (partition->windows_in_mode < 2 * STREAMING_MIN_AGGREGATION_WINDOWS) {
+            partition->min_passthrough_windows = std::min(2 * partition->min_passthrough_windows,
+                                                          STREAMING_MAX_PASSTHROUGH_WINDOWS);
+        } else {
+            partition->min_passthrough_windows = 1;
+        }
+        partition->is_passthrough = true;
+        partition->windows_in_mode = 0;
+        COUNTER_UPDATE(preagg_passthrough_switches_, 1);
+    }
+    partition->window_rows = 0;
+    partition->window_aggregated_rows = 0;
+}
+
 void PartitionedAggregationNode::CleanupHashTbl(const vector<NewAggFnEvaluator*>& agg_fn_evals,
                                                 PartitionedHashTable::Iterator it) {
     if (!needs_finalize_ && !needs_serialize_) return;
@@ -662,6 +752,9 @@ Status PartitionedAggregationNode::reset(RuntimeState* state) {
         ht_ctx_->set_level(0);
         ClosePartitions();
     }
+    run_tuple_ = NULL;
+    num_rows_in_runs_ = 0;
+    num_passthrough_rows_in_runs_ = 0;
     return ExecNode::reset(state);
 }
 
@@ -1357,6 +1450,8 @@ Status PartitionedAggregationNode::ProcessStream(BufferedTupleStream3* input_str
 }
 
 Status PartitionedAggregationNode::SpillPartition(bool more_aggregate_rows) {
+    // the run tuple may live in the stream of the spilled partition
+    run_tuple_ = NULL;
     int64_t max_freed_mem = 0;
     int partition_idx = -1;
 
@@ -160,6 +160,9 @@ private:
     /// TODO: rethink this ?
     static const int64_t PAGG_DEFAULT_HASH_TABLE_SZ = 1024;
 
+    /// Number of slots in 'recent_hashes_'. Must be a power of 2.
+    static const int STREAMING_RECENT_HASHES_SIZE = 1024;
+
     /// Codegen doesn't allow for automatic Status variables because then exception
     /// handling code is needed to destruct the Status, and our function call substitution
     /// doesn't know how to deal with the LLVM IR 'invoke' instruction. Workaround that by
@@ -324,9 +327,41 @@ private:
     /// Expose the minimum reduction factor to continue growing the hash tables.
     RuntimeProfile::Counter* preagg_streaming_ht_min_reduction_;
 
+    /// Number of times a partition of the streaming preaggregation stopped probing its
+    /// hash table and started passing through its rows, and the other way round.
+    RuntimeProfile::Counter* preagg_passthrough_switches_;
+    RuntimeProfile::Counter* preagg_aggregation_switches_;
+
+    /// Number of input rows that had the same grouping values as the previous row and were
+    /// aggregated into 'run_tuple_'. Close to the number of input rows when the input is
+    /// ordered by the grouping exprs.
+    RuntimeProfile::Counter* rows_in_sorted_runs_;
+
     /// The estimated number of input rows from the planner.
     int64_t estimated_input_cardinality_;
 
+    /// The intermediate tuple the previous input row was aggregated into, the hash of its
+    /// grouping values and the evaluators that own it. Input ordered by the grouping exprs,
+    /// e.g. a scan over a prefix of the sort key, arrives in runs of rows with equal keys.
+    /// The rows of a run update this tuple without probing the hash tables, and a
+    /// streaming preaggregation collapses the passed through rows of a run into a single
+    /// output row. Only valid within one ProcessBatch() or ProcessBatchStreaming() call,
+    /// and reset whenever a partition is spilled. 'run_in_hash_tbl_' is false if the tuple
+    /// is passed through rather than in a hash table.
+    Tuple* run_tuple_;
+    uint32_t run_hash_;
+    NewAggFnEvaluator** run_agg_fn_evals_;
+    bool run_in_hash_tbl_;
+    int64_t num_rows_in_runs_;
+
+    /// The rows of 'num_rows_in_runs_' that were aggregated into passed through tuples.
+    int64_t num_passthrough_rows_in_runs_;
+
+    /// Hashes of the rows recently passed through by partitions in passthrough mode,
+    /// indexed by the low bits of the hash. A row whose hash is found here likely repeats
+    /// a recent row, which estimates the reduction the partition would get by aggregating.
+    std::vector<uint32_t> recent_hashes_;
+
     /////////////////////////////////////////
     /// BEGIN: Members that must be Reset()
 
@@ -381,7 +416,16 @@ private:
     /// require an unaggregated stream.
     struct Partition {
         Partition(PartitionedAggregationNode* parent, int level, int idx)
-                : parent(parent), is_closed(false), level(level), idx(idx) {}
+                : parent(parent),
+                  is_closed(false),
+                  level(level),
+                  idx(idx),
+                  window_rows(0),
+                  window_aggregated_rows(0),
+                  sampled_reduction(0),
+                  is_passthrough(false),
+                  windows_in_mode(0),
+                  min_passthrough_windows(1) {}
 
         ~Partition();
 
@@ -452,6 +496,24 @@ private:
         /// Always unpinned. Has a write buffer allocated when the partition is spilled and
         /// unaggregated rows are being processed.
         boost::scoped_ptr<BufferedTupleStream3> unaggregated_row_stream;
+
+        /// Only used by streaming pre-aggregations. The number of rows of the current
+        /// sampling window and how many of them were aggregated into an existing group, or
+        /// repeated a recently passed through row in passthrough mode.
+        int64_t window_rows;
+        int64_t window_aggregated_rows;
+
+        /// Reduction factor of the last completed sampling window, 0 before the first one.
+        double sampled_reduction;
+
+        /// If true, the rows of this partition do not probe the hash table and are passed
+        /// through, unless they continue a sorted run.
+        bool is_passthrough;
+
+        /// Number of windows completed since the partition last switched modes, and the
+        /// number of windows it has to stay in passthrough mode before it may resume.
+        int windows_in_mode;
+        int min_passthrough_windows;
     };
 
     /// Stream used to store serialized spilled rows. Only used if needs_serialize_
@@ -602,12 +664,25 @@ private:
     /// tuple format. Sets 'child_eos_' once all rows from child have been returned.
     Status GetRowsStreaming(RuntimeState* state, RowBatch* row_batch);
 
-    /// Return true if we should keep expanding hash tables in the preagg. If false,
-    /// the preagg should pass through any rows it can't fit in its tables.
-    bool ShouldExpandPreaggHashTables() const;
+    /// Return true if we should keep expanding the hash table of 'partition' in the
+    /// preagg. If false, the preagg should pass through any rows it can't fit in the table.
+    bool ShouldExpandPreaggHashTable(const Partition* partition) const;
+
+    /// Returns the number of input rows the streaming preaggregation aggregated into its
+    /// hash tables, by probing them or as part of a run of a hash table tuple.
+    int64_t NumAggregatedInputRows() const;
+
+    /// Called once 'partition' of a streaming preaggregation completed a sampling window.
+    /// Computes the reduction of the window and switches the partition to passthrough
+    /// mode if its hash table is full, 'ht_full', and hardly reduces its rows, or back to
+    /// aggregation if its passed through rows repeat often enough. Each mode is kept for
+    /// a few windows, longer for a partition that keeps switching. Starts the next window.
+    void UpdateStreamingMode(Partition* partition, bool ht_full);
 
     /// Streaming processing of in_batch from child. Rows from child are either aggregated
     /// into the hash table or added to 'out_batch' in the intermediate tuple format.
+    /// Rows of a partition in passthrough mode skip the hash table. Updates the sampling
+    /// window of each partition.
     /// 'in_batch' is processed entirely, and 'out_batch' must have enough capacity to
     /// store all of the rows in 'in_batch'.
     /// 'needs_serialize' is an argument so that codegen can replace it with a constant,
@@ -635,6 +710,21 @@ private:
                                             PartitionedHashTable* hash_tbl, TupleRow* in_row,
                                             uint32_t hash, int* remaining_capacity, Status* status);
 
+    /// If the current row of 'ht_ctx' with hash 'hash' has the same grouping values as the
+    /// previous row, aggregates 'row' into 'run_tuple_' and returns true.
+    bool IR_ALWAYS_INLINE TryAddToRun(PartitionedHashTableCtx* ht_ctx, TupleRow* row,
+                                      uint32_t hash);
+
+    /// Makes 'tuple', owned by 'agg_fn_evals', the tuple of the current run. 'in_hash_tbl'
+    /// is false if 'tuple' is passed through by a streaming preaggregation.
+    void ALWAYS_INLINE StartRun(Tuple* tuple, uint32_t hash, NewAggFnEvaluator** agg_fn_evals,
+                                bool in_hash_tbl) {
+        run_tuple_ = tuple;
+        run_hash_ = hash;
+        run_agg_fn_evals_ = agg_fn_evals;
+        run_in_hash_tbl_ = in_hash_tbl;
+    }
+
     /// Initializes hash_partitions_. 'level' is the level for the partitions to create.
     /// If 'single_partition_idx' is provided, it must be a number in range
     /// [0, PARTITION_FANOUT), and only that partition is created - all others point to it.
@@ -48,6 +48,7 @@ Status PartitionedAggregationNode::ProcessBatch(RowBatch* batch, PartitionedHash
     PartitionedHashTableCtx::ExprValuesCache* expr_vals_cache = ht_ctx->expr_values_cache();
     const int cache_size = expr_vals_cache->capacity();
     const int num_rows = batch->num_rows();
+    run_tuple_ = NULL;
     for (int group_start = 0; group_start < num_rows; group_start += cache_size) {
         EvalAndHashPrefetchGroup<AGGREGATED_ROWS>(batch, group_start, ht_ctx);
 
@@ -98,6 +99,8 @@ Status PartitionedAggregationNode::ProcessRow(TupleRow* row, PartitionedHashTabl
     const uint32_t hash = expr_vals_cache->CurExprValuesHash();
     const uint32_t partition_idx = hash >> (32 - NUM_PARTITIONING_BITS);
     if (expr_vals_cache->IsRowNull()) return Status::OK();
+    // Aggregated rows come from a hash table and are never equal to the previous row.
+    if (!AGGREGATED_ROWS && TryAddToRun(ht_ctx, row, hash)) return Status::OK();
     // To process this row, we first see if it can be aggregated or inserted into this
     // partition's hash table. If we need to insert it and that fails, due to OOM, we
     // spill the partition. The partition to spill is not necessarily dst_partition,
@@ -125,6 +128,7 @@ Status PartitionedAggregationNode::ProcessRow(TupleRow* row, PartitionedHashTabl
     } else if (found) {
         // Row is already in hash table. Do the aggregation and we're done.
         UpdateTuple(dst_partition->agg_fn_evals.data(), it.GetTuple(), row);
+        StartRun(it.GetTuple(), hash, dst_partition->agg_fn_evals.data(), true);
         return Status::OK();
     }
 
@@ -147,6 +151,9 @@ Status PartitionedAggregationNode::AddIntermediateTuple(Partition* partition, Tu
             UpdateTuple(partition->agg_fn_evals.data(), intermediate_tuple, row, AGGREGATED_ROWS);
             // After copying and initializing the tuple, insert it into the hash table.
             insert_it.SetTuple(intermediate_tuple, hash);
+            if (!AGGREGATED_ROWS) {
+                StartRun(intermediate_tuple, hash, partition->agg_fn_evals.data(), true);
+            }
             return Status::OK();
         } else if (!process_batch_status_.ok()) {
             return std::move(process_batch_status_);
@@ -172,6 +179,7 @@ Status PartitionedAggregationNode::ProcessBatchStreaming(bool needs_serialize, R
     PartitionedHashTableCtx::ExprValuesCache* expr_vals_cache = ht_ctx->expr_values_cache();
     const int num_rows = in_batch->num_rows();
     const int cache_size = expr_vals_cache->capacity();
+    run_tuple_ = NULL;
     for (int group_start = 0; group_start < num_rows; group_start += cache_size) {
         EvalAndHashPrefetchGroup<false>(in_batch, group_start, ht_ctx);
 
@@ -180,10 +188,25 @@ Status PartitionedAggregationNode::ProcessBatchStreaming(bool needs_serialize, R
             TupleRow* in_row = in_batch_iter.get();
             const uint32_t hash = expr_vals_cache->CurExprValuesHash();
             const uint32_t partition_idx = hash >> (32 - NUM_PARTITIONING_BITS);
-            if (!expr_vals_cache->IsRowNull() &&
-                !TryAddToHashTable(ht_ctx, hash_partitions_[partition_idx],
-                                   GetHashTable(partition_idx), in_row, hash,
-                                   &remaining_capacity[partition_idx], &process_batch_status_)) {
+            Partition* partition = hash_partitions_[partition_idx];
+            ++partition->window_rows;
+            bool aggregated = false;
+            if (!expr_vals_cache->IsRowNull()) {
+                if (TryAddToRun(ht_ctx, in_row, hash)) {
+                    ++partition->window_aggregated_rows;
+                    aggregated = true;
+                } else if (partition->is_passthrough) {
+                    uint32_t* recent_hash =
+                            &recent_hashes_[hash & (STREAMING_RECENT_HASHES_SIZE - 1)];
+                    partition->window_aggregated_rows += *recent_hash == hash;
+                    *recent_hash = hash;
+                } else {
+                    aggregated = TryAddToHashTable(ht_ctx, partition, GetHashTable(partition_idx),
+                                                   in_row, hash, &remaining_capacity[partition_idx],
+                                                   &process_batch_status_);
+                }
+            }
+            if (!aggregated) {
                 RETURN_IF_ERROR(std::move(process_batch_status_));
                 // Tuple is not going into hash table, add it to the output batch.
                 Tuple* intermediate_tuple = ConstructIntermediateTuple(
@@ -193,6 +216,7 @@ Status PartitionedAggregationNode::ProcessBatchStreaming(bool needs_serialize, R
                     return std::move(process_batch_status_);
                 }
                 UpdateTuple(agg_fn_evals_.data(), intermediate_tuple, in_row);
+                StartRun(intermediate_tuple, hash, agg_fn_evals_.data(), false);
                 out_batch_iterator.get()->set_tuple(0, intermediate_tuple);
                 out_batch_iterator.next();
                 out_batch->commit_last_row();
@@ -226,6 +250,7 @@ bool PartitionedAggregationNode::TryAddToHashTable(PartitionedHashTableCtx* ht_c
     Tuple* intermediate_tuple;
     if (found) {
         intermediate_tuple = it.GetTuple();
+        ++partition->window_aggregated_rows;
     } else if (*remaining_capacity == 0) {
         return false;
     } else {
@@ -241,6 +266,19 @@ bool PartitionedAggregationNode::TryAddToHashTable(PartitionedHashTableCtx* ht_c
         }
     }
     UpdateTuple(partition->agg_fn_evals.data(), intermediate_tuple, in_row);
+    StartRun(intermediate_tuple, hash, partition->agg_fn_evals.data(), true);
+    return true;
+}
+
+bool PartitionedAggregationNode::TryAddToRun(PartitionedHashTableCtx* ht_ctx, TupleRow* row,
+                                             uint32_t hash) {
+    if (run_tuple_ == NULL || hash != run_hash_ ||
+        !ht_ctx->Equals<true>(reinterpret_cast<TupleRow*>(&run_tuple_))) {
+        return false;
+    }
+    UpdateTuple(run_agg_fn_evals_, run_tuple_, row);
+    ++num_rows_in_runs_;
+    num_passthrough_rows_in_runs_ += !run_in_hash_tbl_;
     return true;
 }
 
@@ -19,6 +19,7 @@
 #define DORIS_BE_SRC_QUERY_EXEC_SELECT_NODE_H
 
 #include <boost/scoped_ptr.hpp>
+#include <vector>
 
 #include "exec/exec_node.h"
 #include "runtime/mem_pool.h"
@@ -43,12 +44,24 @@ private:
     // current row batch of child
     boost::scoped_ptr<RowBatch> _child_row_batch;
 
-    // index of current row in _child_row_batch
+    // the rows of _child_row_batch, the input of the column-at-a-time evaluation of the
+    // conjuncts
+    std::vector<TupleRow*> _child_rows;
+
+    // the indices of the rows of _child_row_batch the conjuncts return true for, the first
+    // _num_child_sel entries are valid
+    std::vector<int> _child_sel;
+    int _num_child_sel;
+
+    // index in _child_sel of the current row
     int _child_row_idx;
 
     // true if last get_next() call on child signalled eos
     bool _child_eos;
 
+    // Evaluates _conjuncts over all the rows of a new _child_row_batch and sets _child_sel.
+    void select_child_rows();
+
     // Copy rows from _child_row_batch for which _conjuncts evaluate to true to
     // output_batch, up to _limit.
     // Return true if limit was hit or output_batch should be returned, otherwise false.
@@ -0,0 +1,80 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "exec/shared_hash_table.h"
+
+#include "exec/hash_table.h"
+#include "runtime/mem_pool.h"
+#include "runtime/mem_tracker.h"
+#include "runtime/pipeline_scheduler.h"
+#include "runtime/runtime_state.h"
+
+namespace doris {
+
+SharedHashTable::SharedHashTable() : _build_claimed(false), _ready(false) {}
+
+SharedHashTable::~SharedHashTable() {
+    if (_hash_table != nullptr) {
+        _hash_table->close();
+    }
+    if (_build_pool != nullptr) {
+        _build_pool->free_all();
+    }
+}
+
+bool SharedHashTable::claim_build(RuntimeState* state) {
+    std::lock_guard<std::mutex> l(_lock);
+    if (_build_claimed) {
+        return false;
+    }
+    _build_claimed = true;
+    _mem_tracker = MemTracker::CreateTracker(-1, "SharedHashTable", state->query_mem_tracker());
+    _build_pool.reset(new MemPool(_mem_tracker.get()));
+    return true;
+}
+
+void SharedHashTable::set_ready(const Status& status, const std::shared_ptr<HashTable>& hash_table,
+                                MemPool* build_pool) {
+    {
+        std::lock_guard<std::mutex> l(_lock);
+        DCHECK(_build_claimed);
+        DCHECK(!_ready);
+        _status = status;
+        if (status.ok()) {
+            _hash_table = hash_table;
+            _build_pool->acquire_data(build_pool, false);
+        }
+        _ready = true;
+    }
+    _ready_cv.notify_all();
+}
+
+Status SharedHashTable::wait(RuntimeState* state) {
+    PipelineScheduler::BlockingScope blocking;
+    std::unique_lock<std::mutex> l(_lock);
+    // the builder belongs to another fragment instance, which is cancelled together with
+    // this one and then stops building
+    _ready_cv.wait(l, [this] { return _ready; });
+    return _status;
+}
+
+bool SharedHashTable::is_ready() {
+    std::lock_guard<std::mutex> l(_lock);
+    return _ready;
+}
+
+} // namespace doris
@@ -0,0 +1,81 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_EXEC_SHARED_HASH_TABLE_H
+#define DORIS_BE_SRC_EXEC_SHARED_HASH_TABLE_H
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+#include "common/status.h"
+
+namespace doris {
+
+class HashTable;
+class MemPool;
+class MemTracker;
+class RuntimeState;
+
+// The build side of a broadcast hash join, shared by the instances of the join in one
+// query on this backend, which all receive the same build rows. The first instance to
+// claim it builds the hash table, the others stop receiving the build rows and probe the
+// same table through read-only HashTables once it is ready. It is held by the instances
+// and looked up through QueryFragmentsCtx, and freed with the last instance.
+class SharedHashTable {
+public:
+    SharedHashTable();
+    ~SharedHashTable();
+
+    // Called by an instance once it starts to build its table. Returns true for the first
+    // caller, which has to build the table, so the builder is always an instance that
+    // runs already. Its memory must then be tracked by mem_tracker(), not by the builder
+    // which may finish first.
+    bool claim_build(RuntimeState* state);
+
+    // Called by the builder once the table is built, or with the error that stopped it.
+    // The data in 'build_pool', referenced by the table, is transferred to this object.
+    void set_ready(const Status& status, const std::shared_ptr<HashTable>& hash_table,
+                   MemPool* build_pool);
+
+    // Waits until the builder called set_ready() and returns its status. The builder
+    // always calls it, also when it fails or is cancelled, so this does not poll.
+    Status wait(RuntimeState* state);
+
+    bool is_ready();
+
+    std::shared_ptr<MemTracker> mem_tracker() { return _mem_tracker; }
+
+    // The built table, valid once wait() returned OK.
+    std::shared_ptr<HashTable> hash_table() { return _hash_table; }
+
+private:
+    std::mutex _lock;
+    std::condition_variable _ready_cv;
+    bool _build_claimed;
+    bool _ready;
+    Status _status;
+
+    std::shared_ptr<MemTracker> _mem_tracker;
+    // holds everything referenced in _hash_table
+    std::unique_ptr<MemPool> _build_pool;
+    std::shared_ptr<HashTable> _hash_table;
+};
+
+} // namespace doris
+
+#endif
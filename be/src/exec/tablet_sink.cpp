@@ -103,6 +103,18 @@ void NodeChannel::open() {
     request.set_need_gen_rollup(_parent->_need_gen_rollup);
     request.set_load_mem_limit(_parent->_load_mem_limit);
     request.set_load_channel_timeout_s(_parent->_load_channel_timeout_s);
+    for (auto& it : _slave_tablet_nodes) {
+        auto slave_tablet_nodes = request.add_slave_tablet_nodes();
+        slave_tablet_nodes->set_tablet_id(it.first);
+        for (auto slave_node_id : it.second) {
+            // all nodes have been checked in IndexChannel::init()
+            const NodeInfo* node_info = _parent->_nodes_info->find_node(slave_node_id);
+            auto pnode = slave_tablet_nodes->add_slave_nodes();
+            pnode->set_id(node_info->id);
+            pnode->set_host(node_info->host);
+            pnode->set_async_internal_port(node_info->brpc_port);
+        }
+    }
 
     _open_closure = new RefCountClosure<PTabletWriterOpenResult>();
     _open_closure->ref();
@@ -152,7 +164,9 @@ Status NodeChannel::open_wait() {
                         for (auto& tablet : result.tablet_vec()) {
                             TTabletCommitInfo commit_info;
                             commit_info.tabletId = tablet.tablet_id();
-                            commit_info.backendId = _node_id;
+                            // tablets synced to slave replicas are reported with their node id
+                            commit_info.backendId =
+                                    tablet.has_node_id() ? tablet.node_id() : _node_id;
                             _tablet_commit_infos.emplace_back(std::move(commit_info));
                         }
                         _add_batches_finished = true;
@@ -382,7 +396,26 @@ Status IndexChannel::init(RuntimeState* state, const std::vector<TTabletWithPart
             return Status::InternalError("unknown tablet");
         }
         std::vector<NodeChannel*> channels;
-        for (auto& node_id : location->node_ids) {
+        std::vector<int64_t> node_ids = location->node_ids;
+        std::vector<int64_t> slave_node_ids;
+        if (_parent->_write_single_replica && node_ids.size() > 1) {
+            // pick the master replica by tablet id, so that the cost of building
+            // rowsets spreads over all backends. the others are slaves.
+            size_t master_idx = tablet.tablet_id % node_ids.size();
+            for (size_t i = 0; i < node_ids.size(); ++i) {
+                if (i == master_idx) {
+                    continue;
+                }
+                if (_parent->_nodes_info->find_node(node_ids[i]) == nullptr) {
+                    std::stringstream ss;
+                    ss << "unknown node id, id=" << node_ids[i];
+                    return Status::InternalError(ss.str());
+                }
+                slave_node_ids.push_back(node_ids[i]);
+            }
+            node_ids = {node_ids[master_idx]};
+        }
+        for (auto& node_id : node_ids) {
             NodeChannel* channel = nullptr;
             auto it = _node_channels.find(node_id);
             if (it == std::end(_node_channels)) {
@@ -393,6 +426,9 @@ Status IndexChannel::init(RuntimeState* state, const std::vector<TTabletWithPart
                 channel = it->second;
             }
             channel->add_tablet(tablet);
+            if (!slave_node_ids.empty()) {
+                channel->add_slave_tablet_nodes(tablet.tablet_id, slave_node_ids);
+            }
             channels.push_back(channel);
         }
         _channels_by_tablet.emplace(tablet.tablet_id, std::move(channels));
@@ -422,6 +458,10 @@ Status IndexChannel::add_row(Tuple* tuple, int64_t tablet_id) {
 }
 
 bool IndexChannel::has_intolerable_failure() {
+    if (_parent->_write_single_replica) {
+        // every tablet is written by one node only, no failure can be tolerated
+        return !_failed_channels.empty();
+    }
     return _failed_channels.size() >= ((_parent->_num_replicas + 1) / 2);
 }
 
@@ -455,6 +495,8 @@ Status OlapTableSink::init(const TDataSink& t_sink) {
     _table_id = table_sink.table_id;
     _num_replicas = table_sink.num_replicas;
     _need_gen_rollup = table_sink.need_gen_rollup;
+    _write_single_replica =
+            table_sink.__isset.write_single_replica && table_sink.write_single_replica;
     _db_name = table_sink.db_name;
     _table_name = table_sink.table_name;
     _tuple_desc_id = table_sink.tuple_id;
@@ -147,6 +147,11 @@ public:
 
     // called before open, used to add tablet located in this backend
     void add_tablet(const TTabletWithPartition& tablet) { _all_tablets.emplace_back(tablet); }
+    // called before open, only in single replica load. the rowset of 'tablet_id' built
+    // on this backend will be synced to 'slave_nodes'
+    void add_slave_tablet_nodes(int64_t tablet_id, const std::vector<int64_t>& slave_nodes) {
+        _slave_tablet_nodes[tablet_id] = slave_nodes;
+    }
 
     Status init(RuntimeState* state);
 
@@ -234,6 +239,8 @@ private:
     ReusableClosure<PTabletWriterAddBatchResult>* _add_batch_closure = nullptr;
 
     std::vector<TTabletWithPartition> _all_tablets;
+    // tablet_id -> slave node ids, only used in single replica load
+    std::unordered_map<int64_t, std::vector<int64_t>> _slave_tablet_nodes;
     std::vector<TTabletCommitInfo> _tablet_commit_infos;
 
     AddBatchCounter _add_batch_counter;
@@ -332,6 +339,8 @@ private:
     int64_t _table_id = -1;
     int _num_replicas = -1;
     bool _need_gen_rollup = false;
+    // only the master replica of each tablet receives data, see IndexChannel::init()
+    bool _write_single_replica = false;
     std::string _db_name;
     std::string _table_name;
     int _tuple_desc_id = -1;
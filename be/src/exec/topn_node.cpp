@@ -21,7 +21,9 @@
 
 #include <sstream>
 
+#include "exec/olap_scan_node.h"
 #include "exprs/expr.h"
+#include "exprs/slot_ref.h"
 #include "gen_cpp/Exprs_types.h"
 #include "gen_cpp/PlanNodes_types.h"
 #include "runtime/descriptors.h"
@@ -41,6 +43,7 @@ TopNNode::TopNNode(ObjectPool* pool, const TPlanNode& tnode, const DescriptorTbl
           _offset(tnode.sort_node.__isset.offset ? tnode.sort_node.offset : 0),
           _materialized_tuple_desc(NULL),
           _tuple_row_less_than(NULL),
+          _topn_filter_scan_node(NULL),
           _tuple_pool(NULL),
           _num_rows_skipped(0),
           _priority_queue(NULL) {}
@@ -72,6 +75,9 @@ Status TopNNode::prepare(RuntimeState* state) {
     _abort_on_default_limit_exceeded =
             _abort_on_default_limit_exceeded && state->abort_on_default_limit_exceeded();
     _materialized_tuple_desc = _row_descriptor.tuple_descriptors()[0];
+    if (_limit > 0 && child(0)->type() == TPlanNodeType::OLAP_SCAN_NODE) {
+        init_topn_filter();
+    }
     return Status::OK();
 }
 
@@ -112,6 +118,9 @@ Status TopNNode::open(RuntimeState* state) {
             for (int i = 0; i < batch.num_rows(); ++i) {
                 insert_tuple_row(batch.get_row(i));
             }
+            if (_topn_filter_scan_node != NULL && _priority_queue->size() == _offset + _limit) {
+                publish_topn_threshold();
+            }
             RETURN_IF_CANCELLED(state);
             RETURN_IF_ERROR(state->check_query_state("Top n, while getting next from child 0."));
         } while (!eos);
@@ -209,6 +218,51 @@ void TopNNode::insert_tuple_row(TupleRow* input_row) {
     }
 }
 
+void TopNNode::init_topn_filter() {
+    Expr* ordering_expr = _sort_exec_exprs.lhs_ordering_expr_ctxs()[0]->root();
+    if (!ordering_expr->is_slotref()) {
+        return;
+    }
+    SlotId sort_slot_id = static_cast<SlotRef*>(ordering_expr)->slot_id();
+
+    // Find the expr materializing the first sort key, it must read a scan slot as is.
+    const std::vector<ExprContext*>& slot_expr_ctxs = _sort_exec_exprs.sort_tuple_slot_expr_ctxs();
+    Expr* source_expr = NULL;
+    int mat_idx = 0;
+    for (auto slot : _materialized_tuple_desc->slots()) {
+        if (!slot->is_materialized()) {
+            continue;
+        }
+        if (slot->id() == sort_slot_id) {
+            if (mat_idx < slot_expr_ctxs.size()) {
+                source_expr = slot_expr_ctxs[mat_idx]->root();
+            }
+            break;
+        }
+        ++mat_idx;
+    }
+    if (source_expr == NULL || !source_expr->is_slotref() ||
+        source_expr->type() != ordering_expr->type()) {
+        return;
+    }
+
+    OlapScanNode* scan_node = static_cast<OlapScanNode*>(child(0));
+    if (scan_node->register_topn_filter(static_cast<SlotRef*>(source_expr)->slot_id(),
+                                        _is_asc_order[0], _nulls_first[0])) {
+        _topn_filter_scan_node = scan_node;
+    }
+}
+
+void TopNNode::publish_topn_threshold() {
+    DCHECK(!_priority_queue->empty());
+    Tuple* top_tuple = _priority_queue->top();
+    void* value = _sort_exec_exprs.lhs_ordering_expr_ctxs()[0]->get_value(
+            reinterpret_cast<TupleRow*>(&top_tuple));
+    if (value != NULL) {
+        _topn_filter_scan_node->update_topn_threshold(value);
+    }
+}
+
 // Reverse the order of the tuples in the priority queue
 void TopNNode::prepare_for_output() {
     _sorted_top_n.resize(_priority_queue->size());
@@ -28,6 +28,7 @@
 namespace doris {
 
 class MemPool;
+class OlapScanNode;
 class RuntimeState;
 class Tuple;
 
@@ -61,6 +62,14 @@ private:
     // Flatten and reverse the priority queue.
     void prepare_for_output();
 
+    // If the child is an olap scan node and the first sort key is one of its slots,
+    // register a runtime TopN filter on that slot.
+    void init_topn_filter();
+
+    // Publish the first sort key of the current top of the full heap to the scan node,
+    // rows ordered after it can never enter the TopN.
+    void publish_topn_threshold();
+
     // number rows to skipped
     int64_t _offset;
 
@@ -84,6 +93,9 @@ private:
     // copied into the tuple pool and inserted into the priority queue.
     Tuple* _tmp_tuple;
 
+    // The scan node that accepted the runtime TopN filter, nullptr if there is none.
+    OlapScanNode* _topn_filter_scan_node;
+
     // Stores everything referenced in _priority_queue
     boost::scoped_ptr<MemPool> _tuple_pool;
 
@@ -17,6 +17,9 @@
 
 #include "exprs/arithmetic_expr.h"
 
+#include <cmath>
+
+#include "exprs/expr_column.h"
 #include "runtime/runtime_state.h"
 
 namespace doris {
@@ -159,4 +162,180 @@ BINARY_BIT_FNS(BitXorExpr, ^)
     BITNOT_OP_FN(LargeIntVal, get_large_int_val)
 
 BITNOT_FNS()
+
+bool ArithmeticExpr::children_have_own_type() const {
+    for (int i = 0; i < _children.size(); ++i) {
+        if (_children[i]->type().type != _type.type) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename T, typename OP, bool CHECK_ZERO>
+void ArithmeticExpr::evaluate_binary_batch(ExprContext* context, TupleRow** rows, int num_rows,
+                                           ExprColumn* result) {
+    const ExprColumn* lhs = evaluate_child_batch(context, 0, rows, nullptr, num_rows);
+    const ExprColumn* rhs = evaluate_child_batch(context, 1, rows, nullptr, num_rows);
+    result->reset(_type.type, num_rows);
+    const T* a = lhs->data<T>();
+    const T* b = rhs->data<T>();
+    const uint8_t* a_nulls = lhs->nulls();
+    const uint8_t* b_nulls = rhs->nulls();
+    T* values = result->data<T>();
+    uint8_t* nulls = result->nulls();
+    for (int i = 0; i < num_rows; ++i) {
+        nulls[i] = a_nulls[i] | b_nulls[i];
+    }
+    if (CHECK_ZERO) {
+        for (int i = 0; i < num_rows; ++i) {
+            if (nulls[i] || b[i] == 0) {
+                nulls[i] = 1;
+            } else {
+                values[i] = OP::apply(a[i], b[i]);
+            }
+        }
+    } else {
+        // the values of the null rows are computed too and ignored, so the loop has no
+        // branches
+        for (int i = 0; i < num_rows; ++i) {
+            values[i] = OP::apply(a[i], b[i]);
+        }
+    }
+}
+
+struct AddOp {
+    template <typename T>
+    static T apply(T a, T b) {
+        return a + b;
+    }
+};
+
+struct SubOp {
+    template <typename T>
+    static T apply(T a, T b) {
+        return a - b;
+    }
+};
+
+struct MulOp {
+    template <typename T>
+    static T apply(T a, T b) {
+        return a * b;
+    }
+};
+
+struct DivOp {
+    template <typename T>
+    static T apply(T a, T b) {
+        return a / b;
+    }
+};
+
+struct ModOp {
+    template <typename T>
+    static T apply(T a, T b) {
+        return a % b;
+    }
+    static float apply(float a, float b) { return fmod(a, b); }
+    static double apply(double a, double b) { return fmod(a, b); }
+};
+
+struct BitAndOp {
+    template <typename T>
+    static T apply(T a, T b) {
+        return a & b;
+    }
+};
+
+struct BitOrOp {
+    template <typename T>
+    static T apply(T a, T b) {
+        return a | b;
+    }
+};
+
+struct BitXorOp {
+    template <typename T>
+    static T apply(T a, T b) {
+        return a ^ b;
+    }
+};
+
+#define BINARY_INT_BATCH_CASES(OP, CHECK_ZERO)                                              \
+    case TYPE_TINYINT:                                                                      \
+        evaluate_binary_batch<int8_t, OP, CHECK_ZERO>(context, rows, num_rows, result);     \
+        return;                                                                             \
+    case TYPE_SMALLINT:                                                                     \
+        evaluate_binary_batch<int16_t, OP, CHECK_ZERO>(context, rows, num_rows, result);    \
+        return;                                                                             \
+    case TYPE_INT:                                                                          \
+        evaluate_binary_batch<int32_t, OP, CHECK_ZERO>(context, rows, num_rows, result);    \
+        return;                                                                             \
+    case TYPE_BIGINT:                                                                       \
+        evaluate_binary_batch<int64_t, OP, CHECK_ZERO>(context, rows, num_rows, result);    \
+        return;                                                                             \
+    case TYPE_LARGEINT:                                                                     \
+        evaluate_binary_batch<__int128, OP, CHECK_ZERO>(context, rows, num_rows, result);   \
+        return;
+
+#define BINARY_FLOAT_BATCH_CASES(OP, CHECK_ZERO)                                            \
+    case TYPE_FLOAT:                                                                        \
+        evaluate_binary_batch<float, OP, CHECK_ZERO>(context, rows, num_rows, result);      \
+        return;                                                                             \
+    case TYPE_DOUBLE:                                                                       \
+    case TYPE_TIME:                                                                         \
+        evaluate_binary_batch<double, OP, CHECK_ZERO>(context, rows, num_rows, result);     \
+        return;
+
+#define BINARY_ARITH_BATCH_FN(CLASS, OP, CHECK_ZERO)                                        \
+    void CLASS::evaluate_batch(ExprContext* context, TupleRow** rows, int num_rows,         \
+                               ExprColumn* result) {                                        \
+        if (children_have_own_type()) {                                                     \
+            switch (_type.type) {                                                           \
+                BINARY_INT_BATCH_CASES(OP, CHECK_ZERO)                                      \
+                BINARY_FLOAT_BATCH_CASES(OP, CHECK_ZERO)                                    \
+            default:                                                                        \
+                break;                                                                      \
+            }                                                                               \
+        }                                                                                   \
+        Expr::evaluate_batch(context, rows, num_rows, result);                              \
+    }
+
+BINARY_ARITH_BATCH_FN(AddExpr, AddOp, false)
+BINARY_ARITH_BATCH_FN(SubExpr, SubOp, false)
+BINARY_ARITH_BATCH_FN(MulExpr, MulOp, false)
+BINARY_ARITH_BATCH_FN(DivExpr, DivOp, true)
+
+// the modulo of floating point numbers does not check the divisor, like get_float_val()
+void ModExpr::evaluate_batch(ExprContext* context, TupleRow** rows, int num_rows,
+                             ExprColumn* result) {
+    if (children_have_own_type()) {
+        switch (_type.type) {
+            BINARY_INT_BATCH_CASES(ModOp, true)
+            BINARY_FLOAT_BATCH_CASES(ModOp, false)
+        default:
+            break;
+        }
+    }
+    Expr::evaluate_batch(context, rows, num_rows, result);
+}
+
+#define BINARY_BIT_BATCH_FN(CLASS, OP)                                                      \
+    void CLASS::evaluate_batch(ExprContext* context, TupleRow** rows, int num_rows,         \
+                               ExprColumn* result) {                                        \
+        if (children_have_own_type()) {                                                     \
+            switch (_type.type) {                                                           \
+                BINARY_INT_BATCH_CASES(OP, false)                                           \
+            default:                                                                        \
+                break;                                                                      \
+            }                                                                               \
+        }                                                                                   \
+        Expr::evaluate_batch(context, rows, num_rows, result);                              \
+    }
+
+BINARY_BIT_BATCH_FN(BitAndExpr, BitAndOp)
+BINARY_BIT_BATCH_FN(BitOrExpr, BitOrOp)
+BINARY_BIT_BATCH_FN(BitXorExpr, BitXorOp)
+
 } // namespace doris
@@ -42,6 +42,17 @@ protected:
 
     ArithmeticExpr(const TExprNode& node) : Expr(node) {}
     virtual ~ArithmeticExpr() {}
+
+    // Returns true if the children have the type of this expr, which the batch evaluation
+    // of the binary ops relies on.
+    bool children_have_own_type() const;
+
+    // Evaluates both children column-at-a-time and applies OP::apply() to their values of
+    // type T. A row is null if either value is null, or if CHECK_ZERO and the right one is
+    // zero.
+    template <typename T, typename OP, bool CHECK_ZERO>
+    void evaluate_binary_batch(ExprContext* context, TupleRow** rows, int num_rows,
+                               ExprColumn* result);
 };
 
 class AddExpr : public ArithmeticExpr {
@@ -56,6 +67,8 @@ public:
     virtual LargeIntVal get_large_int_val(ExprContext* context, TupleRow*);
     virtual FloatVal get_float_val(ExprContext* context, TupleRow*);
     virtual DoubleVal get_double_val(ExprContext* context, TupleRow*);
+    virtual void evaluate_batch(ExprContext* context, TupleRow** rows, int num_rows,
+                                ExprColumn* result) override;
 };
 
 class SubExpr : public ArithmeticExpr {
@@ -70,6 +83,8 @@ public:
     virtual LargeIntVal get_large_int_val(ExprContext* context, TupleRow*);
     virtual FloatVal get_float_val(ExprContext* context, TupleRow*);
     virtual DoubleVal get_double_val(ExprContext* context, TupleRow*);
+    virtual void evaluate_batch(ExprContext* context, TupleRow** rows, int num_rows,
+                                ExprColumn* result) override;
 };
 
 class MulExpr : public ArithmeticExpr {
@@ -84,6 +99,8 @@ public:
     virtual LargeIntVal get_large_int_val(ExprContext* context, TupleRow*);
     virtual FloatVal get_float_val(ExprContext* context, TupleRow*);
     virtual DoubleVal get_double_val(ExprContext* context, TupleRow*);
+    virtual void evaluate_batch(ExprContext* context, TupleRow** rows, int num_rows,
+                                ExprColumn* result) override;
 };
 
 class DivExpr : public ArithmeticExpr {
@@ -98,6 +115,8 @@ public:
     virtual LargeIntVal get_large_int_val(ExprContext* context, TupleRow*);
     virtual FloatVal get_float_val(ExprContext* context, TupleRow*);
     virtual DoubleVal get_double_val(ExprContext* context, TupleRow*);
+    virtual void evaluate_batch(ExprContext* context, TupleRow** rows, int num_rows,
+                                ExprColumn* result) override;
 };
 
 class ModExpr : public ArithmeticExpr {
@@ -112,6 +131,8 @@ public:
     virtual LargeIntVal get_large_int_val(ExprContext* context, TupleRow*);
     virtual FloatVal get_float_val(ExprContext* context, TupleRow*);
     virtual DoubleVal get_double_val(ExprContext* context, TupleRow*);
+    virtual void evaluate_batch(ExprContext* context, TupleRow** rows, int num_rows,
+                                ExprColumn* result) override;
 };
 
 class BitAndExpr : public ArithmeticExpr {
@@ -126,6 +147,8 @@ public:
     virtual IntVal get_int_val(ExprContext* context, TupleRow*);
     virtual BigIntVal get_big_int_val(ExprContext* context, TupleRow*);
     virtual LargeIntVal get_large_int_val(ExprContext* context, TupleRow*);
+    virtual void evaluate_batch(ExprContext* context, TupleRow** rows, int num_rows,
+                                ExprColumn* result) override;
 };
 
 class BitOrExpr : public ArithmeticExpr {
@@ -138,6 +161,8 @@ public:
     virtual IntVal get_int_val(ExprContext* context, TupleRow*);
     virtual BigIntVal get_big_int_val(ExprContext* context, TupleRow*);
     virtual LargeIntVal get_large_int_val(ExprContext* context, TupleRow*);
+    virtual void evaluate_batch(ExprContext* context, TupleRow** rows, int num_rows,
+                                ExprColumn* result) override;
 };
 
 class BitXorExpr : public ArithmeticExpr {
@@ -152,6 +177,8 @@ public:
     virtual IntVal get_int_val(ExprContext* context, TupleRow*);
     virtual BigIntVal get_big_int_val(ExprContext* context, TupleRow*);
     virtual LargeIntVal get_large_int_val(ExprContext* context, TupleRow*);
+    virtual void evaluate_batch(ExprContext* context, TupleRow** rows, int num_rows,
+                                ExprColumn* result) override;
 };
 
 class BitNotExpr : public ArithmeticExpr {
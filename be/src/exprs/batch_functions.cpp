@@ -0,0 +1,284 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "exprs/batch_functions.h"
+
+#include <cctype>
+#include <cmath>
+#include <unordered_map>
+
+#include "exprs/cast_functions.h"
+#include "exprs/expr_column.h"
+#include "exprs/string_functions.h"
+#include "exprs/timestamp_functions.h"
+#include "gutil/strings/numbers.h"
+#include "runtime/datetime_value.h"
+#include "runtime/string_value.h"
+#include "util/string_parser.hpp"
+
+namespace doris {
+
+// lower() and upper() of ascii strings, CONVERT is ::tolower or ::toupper
+template <int (*CONVERT)(int)>
+static void convert_case_batch(FunctionContext* context, const ExprColumn* const* args,
+                               int num_rows, ExprColumn* result) {
+    const ExprColumn* str = args[0];
+    const StringValue* values = str->data<StringValue>();
+    int64_t total_len = 0;
+    for (int i = 0; i < num_rows; ++i) {
+        if (!str->is_null(i)) {
+            total_len += values[i].len;
+        }
+    }
+    // one buffer for all the rows instead of one allocation per row
+    char* buf = reinterpret_cast<char*>(result->pool()->allocate(total_len));
+    StringValue* results = result->data<StringValue>();
+    uint8_t* nulls = result->nulls();
+    for (int i = 0; i < num_rows; ++i) {
+        nulls[i] = str->is_null(i);
+        if (nulls[i]) {
+            continue;
+        }
+        const uint8_t* ptr = reinterpret_cast<const uint8_t*>(values[i].ptr);
+        for (int j = 0; j < values[i].len; ++j) {
+            buf[j] = CONVERT(ptr[j]);
+        }
+        results[i] = StringValue(buf, values[i].len);
+        buf += values[i].len;
+    }
+}
+
+// Returns the byte offset of the character 'num_chars' characters after the one at byte
+// 'from' of 'str', or str.len if the string ends before.
+static int skip_utf8_chars(const StringValue& str, int from, int64_t num_chars) {
+    int i = from;
+    for (; i < str.len && num_chars > 0; --num_chars) {
+        i += get_utf8_byte_length(static_cast<unsigned char>(str.ptr[i]));
+    }
+    return std::min(i, str.len);
+}
+
+// StringFunctions::substring() without the index of the characters. Returns false if the
+// result is null.
+static bool substring_value(const StringValue& str, int pos, int len, StringValue* result) {
+    if (pos > str.len) {
+        return false;
+    }
+    if (len <= 0 || str.len == 0) {
+        *result = StringValue();
+        return true;
+    }
+    int64_t start_char = static_cast<int64_t>(pos) - 1;
+    if (pos < 0) {
+        // counts from the end of the string
+        int64_t num_chars = 0;
+        for (int i = 0; i < str.len;
+             i += get_utf8_byte_length(static_cast<unsigned char>(str.ptr[i]))) {
+            ++num_chars;
+        }
+        start_char = num_chars + pos;
+    }
+    if (start_char < 0) {
+        // a position of 0 or before the start of the string
+        *result = StringValue();
+        return true;
+    }
+    int start = skip_utf8_chars(str, 0, start_char);
+    if (start >= str.len) {
+        return false;
+    }
+    int end = skip_utf8_chars(str, start, len);
+    *result = StringValue(str.ptr + start, end - start);
+    return true;
+}
+
+static void substring_batch(FunctionContext* context, const ExprColumn* const* args,
+                            int num_rows, ExprColumn* result) {
+    const ExprColumn* str = args[0];
+    const ExprColumn* pos = args[1];
+    const ExprColumn* len = args[2];
+    const StringValue* strs = str->data<StringValue>();
+    const int32_t* positions = pos->data<int32_t>();
+    const int32_t* lens = len->data<int32_t>();
+    StringValue* results = result->data<StringValue>();
+    uint8_t* nulls = result->nulls();
+    for (int i = 0; i < num_rows; ++i) {
+        nulls[i] = str->is_null(i) || pos->is_null(i) || len->is_null(i) ||
+                   !substring_value(strs[i], positions[i], lens[i], &results[i]);
+    }
+}
+
+static void substring_to_end_batch(FunctionContext* context, const ExprColumn* const* args,
+                                   int num_rows, ExprColumn* result) {
+    const ExprColumn* str = args[0];
+    const ExprColumn* pos = args[1];
+    const StringValue* strs = str->data<StringValue>();
+    const int32_t* positions = pos->data<int32_t>();
+    StringValue* results = result->data<StringValue>();
+    uint8_t* nulls = result->nulls();
+    for (int i = 0; i < num_rows; ++i) {
+        nulls[i] = str->is_null(i) || pos->is_null(i) ||
+                   !substring_value(strs[i], positions[i], INT32_MAX, &results[i]);
+    }
+}
+
+struct YearField {
+    static int32_t get(const DateTimeValue& v) { return v.year(); }
+};
+
+struct MonthField {
+    static int32_t get(const DateTimeValue& v) { return v.month(); }
+};
+
+struct DayField {
+    static int32_t get(const DateTimeValue& v) { return v.day(); }
+};
+
+// year(), month() and day(), FIELD::get() extracts the field
+template <typename FIELD>
+static void datetime_field_batch(FunctionContext* context, const ExprColumn* const* args,
+                                 int num_rows, ExprColumn* result) {
+    const ExprColumn* ts = args[0];
+    const DateTimeValue* values = ts->data<DateTimeValue>();
+    int32_t* results = result->data<int32_t>();
+    memcpy(result->nulls(), ts->nulls(), num_rows);
+    // the fields of the null rows are read too and ignored, so the loop has no branches
+    for (int i = 0; i < num_rows; ++i) {
+        results[i] = FIELD::get(values[i]);
+    }
+}
+
+static void to_date_batch(FunctionContext* context, const ExprColumn* const* args, int num_rows,
+                          ExprColumn* result) {
+    const ExprColumn* ts = args[0];
+    const DateTimeValue* values = ts->data<DateTimeValue>();
+    DateTimeValue* results = result->data<DateTimeValue>();
+    memcpy(result->nulls(), ts->nulls(), num_rows);
+    for (int i = 0; i < num_rows; ++i) {
+        results[i] = values[i];
+        results[i].cast_to_date();
+    }
+}
+
+// Casts of the integers up to bigint to strings, the same digits as std::to_string()
+template <typename T>
+static void int_to_string_batch(FunctionContext* context, const ExprColumn* const* args,
+                                int num_rows, ExprColumn* result) {
+    const ExprColumn* num = args[0];
+    const T* values = num->data<T>();
+    // at most 20 characters per value, FastInt64ToBufferLeft() also writes a '\0' after it
+    char* buf = reinterpret_cast<char*>(
+            result->pool()->allocate(static_cast<int64_t>(num_rows) * 21 + kFastToBufferSize));
+    StringValue* results = result->data<StringValue>();
+    uint8_t* nulls = result->nulls();
+    for (int i = 0; i < num_rows; ++i) {
+        nulls[i] = num->is_null(i);
+        if (nulls[i]) {
+            continue;
+        }
+        char* end = FastInt64ToBufferLeft(values[i], buf);
+        results[i] = StringValue(buf, end - buf);
+        buf = end;
+    }
+}
+
+// Casts of strings to numbers, null if the string is not a number or is nan or inf
+template <typename T, T (*PARSE)(const char*, int, StringParser::ParseResult*)>
+static void string_to_number_batch(FunctionContext* context, const ExprColumn* const* args,
+                                   int num_rows, ExprColumn* result) {
+    const ExprColumn* str = args[0];
+    const StringValue* values = str->data<StringValue>();
+    T* results = result->data<T>();
+    uint8_t* nulls = result->nulls();
+    for (int i = 0; i < num_rows; ++i) {
+        if (str->is_null(i)) {
+            nulls[i] = 1;
+            continue;
+        }
+        StringParser::ParseResult parse_result;
+        results[i] = PARSE(values[i].ptr, values[i].len, &parse_result);
+        nulls[i] = parse_result != StringParser::PARSE_SUCCESS || std::isnan(results[i]) ||
+                   std::isinf(results[i]);
+    }
+}
+
+template <typename FN>
+static void* fn_ptr(FN fn) {
+    return reinterpret_cast<void*>(fn);
+}
+
+typedef StringVal (*StringFn)(FunctionContext*, const StringVal&);
+typedef StringVal (*SubstringFn)(FunctionContext*, const StringVal&, const IntVal&,
+                                 const IntVal&);
+typedef StringVal (*SubstringToEndFn)(FunctionContext*, const StringVal&, const IntVal&);
+
+static std::unordered_map<void*, BatchFn> create_batch_fns() {
+    std::unordered_map<void*, BatchFn> fns;
+    fns[fn_ptr<StringFn>(&StringFunctions::lower)] = &convert_case_batch<::tolower>;
+    fns[fn_ptr<StringFn>(&StringFunctions::upper)] = &convert_case_batch<::toupper>;
+    fns[fn_ptr<SubstringFn>(&StringFunctions::substring)] = &substring_batch;
+    fns[fn_ptr<SubstringToEndFn>(&StringFunctions::substring)] = &substring_to_end_batch;
+
+    fns[fn_ptr(&TimestampFunctions::year)] = &datetime_field_batch<YearField>;
+    fns[fn_ptr(&TimestampFunctions::month)] = &datetime_field_batch<MonthField>;
+    fns[fn_ptr(&TimestampFunctions::day_of_month)] = &datetime_field_batch<DayField>;
+    fns[fn_ptr(&TimestampFunctions::to_date)] = &to_date_batch;
+
+    typedef StringVal (*BooleanToStringFn)(FunctionContext*, const BooleanVal&);
+    typedef StringVal (*TinyIntToStringFn)(FunctionContext*, const TinyIntVal&);
+    typedef StringVal (*SmallIntToStringFn)(FunctionContext*, const SmallIntVal&);
+    typedef StringVal (*IntToStringFn)(FunctionContext*, const IntVal&);
+    typedef StringVal (*BigIntToStringFn)(FunctionContext*, const BigIntVal&);
+    fns[fn_ptr<BooleanToStringFn>(&CastFunctions::cast_to_string_val)] =
+            &int_to_string_batch<bool>;
+    fns[fn_ptr<TinyIntToStringFn>(&CastFunctions::cast_to_string_val)] =
+            &int_to_string_batch<int8_t>;
+    fns[fn_ptr<SmallIntToStringFn>(&CastFunctions::cast_to_string_val)] =
+            &int_to_string_batch<int16_t>;
+    fns[fn_ptr<IntToStringFn>(&CastFunctions::cast_to_string_val)] =
+            &int_to_string_batch<int32_t>;
+    fns[fn_ptr<BigIntToStringFn>(&CastFunctions::cast_to_string_val)] =
+            &int_to_string_batch<int64_t>;
+
+    typedef TinyIntVal (*StringToTinyIntFn)(FunctionContext*, const StringVal&);
+    typedef SmallIntVal (*StringToSmallIntFn)(FunctionContext*, const StringVal&);
+    typedef IntVal (*StringToIntFn)(FunctionContext*, const StringVal&);
+    typedef BigIntVal (*StringToBigIntFn)(FunctionContext*, const StringVal&);
+    typedef FloatVal (*StringToFloatFn)(FunctionContext*, const StringVal&);
+    typedef DoubleVal (*StringToDoubleFn)(FunctionContext*, const StringVal&);
+    fns[fn_ptr<StringToTinyIntFn>(&CastFunctions::cast_to_tiny_int_val)] =
+            &string_to_number_batch<int8_t, &StringParser::string_to_int<int8_t>>;
+    fns[fn_ptr<StringToSmallIntFn>(&CastFunctions::cast_to_small_int_val)] =
+            &string_to_number_batch<int16_t, &StringParser::string_to_int<int16_t>>;
+    fns[fn_ptr<StringToIntFn>(&CastFunctions::cast_to_int_val)] =
+            &string_to_number_batch<int32_t, &StringParser::string_to_int<int32_t>>;
+    fns[fn_ptr<StringToBigIntFn>(&CastFunctions::cast_to_big_int_val)] =
+            &string_to_number_batch<int64_t, &StringParser::string_to_int<int64_t>>;
+    fns[fn_ptr<StringToFloatFn>(&CastFunctions::cast_to_float_val)] =
+            &string_to_number_batch<float, &StringParser::string_to_float<float>>;
+    fns[fn_ptr<StringToDoubleFn>(&CastFunctions::cast_to_double_val)] =
+            &string_to_number_batch<double, &StringParser::string_to_float<double>>;
+    return fns;
+}
+
+BatchFn BatchFunctions::get(void* scalar_fn) {
+    static const std::unordered_map<void*, BatchFn> fns = create_batch_fns();
+    auto it = fns.find(scalar_fn);
+    return it == fns.end() ? nullptr : it->second;
+}
+
+} // namespace doris
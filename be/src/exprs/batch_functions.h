@@ -0,0 +1,44 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_EXPRS_BATCH_FUNCTIONS_H
+#define DORIS_BE_SRC_EXPRS_BATCH_FUNCTIONS_H
+
+#include "udf/udf.h"
+
+namespace doris {
+
+class ExprColumn;
+
+// Computes a builtin over a batch of rows column-at-a-time. 'args' are the columns of the
+// arguments and 'result' is already reset to the return type and the number of rows. The
+// results are the ones of the row-at-a-time builtin.
+typedef void (*BatchFn)(doris_udf::FunctionContext* context, const ExprColumn* const* args,
+                        int num_rows, ExprColumn* result);
+
+// The column-at-a-time versions of the most used builtins, which ScalarFnCall calls instead
+// of the row-at-a-time ones when evaluating a batch.
+class BatchFunctions {
+public:
+    // Returns the batch version of the row-at-a-time builtin 'scalar_fn', or nullptr if
+    // there is none.
+    static BatchFn get(void* scalar_fn);
+};
+
+} // namespace doris
+
+#endif
@@ -17,8 +17,11 @@
 
 #include "exprs/binary_predicate.h"
 
+#include <functional>
 #include <sstream>
+#include <type_traits>
 
+#include "exprs/expr_column.h"
 #include "gen_cpp/Exprs_types.h"
 #include "runtime/datetime_value.h"
 #include "runtime/decimal_value.h"
@@ -477,4 +480,69 @@ BooleanVal EqForNullStringValPred::get_boolean_val(ExprContext* ctx, TupleRow* r
     return BooleanVal(string_compare((char*)v1.ptr, v1.len, (char*)v2.ptr, v2.len, v1.len) == 0);
 }
 
+template <typename T, typename CMP>
+void BinaryPredicate::evaluate_compare_batch(ExprContext* context, TupleRow** rows, int num_rows,
+                                             ExprColumn* result) {
+    if (_children[0]->type().type == TYPE_NULL || _children[1]->type().type == TYPE_NULL) {
+        Expr::evaluate_batch(context, rows, num_rows, result);
+        return;
+    }
+    const ExprColumn* lhs = evaluate_child_batch(context, 0, rows, nullptr, num_rows);
+    const ExprColumn* rhs = evaluate_child_batch(context, 1, rows, nullptr, num_rows);
+    DCHECK_EQ(sizeof(T), lhs->byte_size());
+    DCHECK_EQ(sizeof(T), rhs->byte_size());
+    result->reset(TYPE_BOOLEAN, num_rows);
+    const T* a = lhs->data<T>();
+    const T* b = rhs->data<T>();
+    const uint8_t* a_nulls = lhs->nulls();
+    const uint8_t* b_nulls = rhs->nulls();
+    bool* values = result->data<bool>();
+    uint8_t* nulls = result->nulls();
+    CMP cmp;
+    for (int i = 0; i < num_rows; ++i) {
+        nulls[i] = a_nulls[i] | b_nulls[i];
+    }
+    if (std::is_arithmetic<T>::value) {
+        // the values of the null rows are compared too and ignored, so the loop has no
+        // branches
+        for (int i = 0; i < num_rows; ++i) {
+            values[i] = cmp(a[i], b[i]);
+        }
+    } else {
+        // the values of the null rows are undefined, eg. strings pointing nowhere
+        for (int i = 0; i < num_rows; ++i) {
+            if (!nulls[i]) {
+                values[i] = cmp(a[i], b[i]);
+            }
+        }
+    }
+}
+
+#define BINARY_PRED_BATCH_FN(CLASS, T, CMP)                                                  \
+    void CLASS::evaluate_batch(ExprContext* context, TupleRow** rows, int num_rows,          \
+                               ExprColumn* result) {                                         \
+        evaluate_compare_batch<T, CMP<T>>(context, rows, num_rows, result);                  \
+    }
+
+#define BINARY_PRED_BATCH_FNS(TYPE, T)                                \
+    BINARY_PRED_BATCH_FN(Eq##TYPE##Pred, T, std::equal_to)            \
+    BINARY_PRED_BATCH_FN(Ne##TYPE##Pred, T, std::not_equal_to)        \
+    BINARY_PRED_BATCH_FN(Lt##TYPE##Pred, T, std::less)                \
+    BINARY_PRED_BATCH_FN(Le##TYPE##Pred, T, std::less_equal)          \
+    BINARY_PRED_BATCH_FN(Gt##TYPE##Pred, T, std::greater)             \
+    BINARY_PRED_BATCH_FN(Ge##TYPE##Pred, T, std::greater_equal)
+
+BINARY_PRED_BATCH_FNS(BooleanVal, bool)
+BINARY_PRED_BATCH_FNS(TinyIntVal, int8_t)
+BINARY_PRED_BATCH_FNS(SmallIntVal, int16_t)
+BINARY_PRED_BATCH_FNS(IntVal, int32_t)
+BINARY_PRED_BATCH_FNS(BigIntVal, int64_t)
+BINARY_PRED_BATCH_FNS(LargeIntVal, __int128)
+BINARY_PRED_BATCH_FNS(FloatVal, float)
+BINARY_PRED_BATCH_FNS(DoubleVal, double)
+BINARY_PRED_BATCH_FNS(StringVal, StringValue)
+BINARY_PRED_BATCH_FNS(DateTimeVal, DateTimeValue)
+BINARY_PRED_BATCH_FNS(DecimalVal, DecimalValue)
+BINARY_PRED_BATCH_FNS(DecimalV2Val, DecimalV2Value)
+
 } // namespace doris
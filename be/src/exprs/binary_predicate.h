@@ -38,18 +38,26 @@ protected:
 
     // virtual Status prepare(RuntimeState* state, const RowDescriptor& desc);
     virtual std::string debug_string() const;
+
+    // Evaluates both children column-at-a-time and compares their values, which have the
+    // slot representation T, with CMP. A row is null if either value is null.
+    template <typename T, typename CMP>
+    void evaluate_compare_batch(ExprContext* context, TupleRow** rows, int num_rows,
+                                ExprColumn* result);
 };
 
-#define BIN_PRED_CLASS_DEFINE(CLASS)                                             \
-    class CLASS : public BinaryPredicate {                                       \
-    public:                                                                      \
-        CLASS(const TExprNode& node) : BinaryPredicate(node) {}                  \
-        virtual ~CLASS() {}                                                      \
-        virtual Expr* clone(ObjectPool* pool) const override {                   \
-            return pool->add(new CLASS(*this));                                  \
-        }                                                                        \
-                                                                                 \
-        virtual BooleanVal get_boolean_val(ExprContext* context, TupleRow* row); \
+#define BIN_PRED_CLASS_DEFINE(CLASS)                                                     \
+    class CLASS : public BinaryPredicate {                                               \
+    public:                                                                              \
+        CLASS(const TExprNode& node) : BinaryPredicate(node) {}                          \
+        virtual ~CLASS() {}                                                              \
+        virtual Expr* clone(ObjectPool* pool) const override {                           \
+            return pool->add(new CLASS(*this));                                          \
+        }                                                                                \
+                                                                                         \
+        virtual BooleanVal get_boolean_val(ExprContext* context, TupleRow* row);         \
+        virtual void evaluate_batch(ExprContext* context, TupleRow** rows, int num_rows, \
+                                    ExprColumn* result) override;                        \
     };
 
 #define BIN_PRED_CLASSES_DEFINE(TYPE)     \
@@ -18,7 +18,9 @@
 #include "exprs/case_expr.h"
 
 #include "exprs/anyval_util.h"
+#include "exprs/expr_column.h"
 #include "gen_cpp/Exprs_types.h"
+#include "runtime/raw_value.h"
 #include "runtime/runtime_state.h"
 
 namespace doris {
@@ -228,4 +230,71 @@ CASE_COMPUTE_FN_WRAPPER(DateTimeVal, datetime_val)
 CASE_COMPUTE_FN_WRAPPER(DecimalVal, decimal_val)
 CASE_COMPUTE_FN_WRAPPER(DecimalV2Val, decimalv2_val)
 
+// Each when expr is evaluated over the rows no previous one matched, and each then expr over
+// the rows its when expr matched.
+void CaseExpr::evaluate_batch(ExprContext* ctx, TupleRow** rows, int num_rows,
+                              ExprColumn* result) {
+    int num_children = _children.size();
+    const ExprColumn* case_column = nullptr;
+    // the rows that go to the else expr
+    std::vector<int> else_rows;
+    // the rows no when value matched so far
+    std::vector<int> unmatched_rows;
+    if (has_case_expr()) {
+        case_column = evaluate_child_batch(ctx, 0, rows, nullptr, num_rows);
+        for (int i = 0; i < num_rows; ++i) {
+            if (case_column->is_null(i)) {
+                else_rows.push_back(i);
+            } else {
+                unmatched_rows.push_back(i);
+            }
+        }
+    } else {
+        unmatched_rows.resize(num_rows);
+        for (int i = 0; i < num_rows; ++i) {
+            unmatched_rows[i] = i;
+        }
+    }
+    result->reset(_type.type, num_rows);
+
+    std::vector<int> matched_rows;
+    std::vector<int> still_unmatched_rows;
+    int loop_start = has_case_expr() ? 1 : 0;
+    int loop_end = has_else_expr() ? num_children - 1 : num_children;
+    for (int i = loop_start; i < loop_end && !unmatched_rows.empty(); i += 2) {
+        const ExprColumn* when_column = evaluate_child_batch(
+                ctx, i, rows, unmatched_rows.data(), unmatched_rows.size());
+        matched_rows.clear();
+        still_unmatched_rows.clear();
+        for (int j = 0; j < unmatched_rows.size(); ++j) {
+            int row = unmatched_rows[j];
+            bool matched = false;
+            if (!when_column->is_null(j)) {
+                // if there's no case expression, the when values are compared to "true"
+                matched = has_case_expr() ? RawValue::eq(case_column->value(row),
+                                                         when_column->value(j),
+                                                         _children[0]->type())
+                                          : when_column->data<bool>()[j];
+            }
+            if (matched) {
+                matched_rows.push_back(row);
+            } else {
+                still_unmatched_rows.push_back(row);
+            }
+        }
+        scatter_child_batch(ctx, i + 1, rows, matched_rows.data(), matched_rows.size(), result);
+        unmatched_rows.swap(still_unmatched_rows);
+    }
+
+    else_rows.insert(else_rows.end(), unmatched_rows.begin(), unmatched_rows.end());
+    if (has_else_expr()) {
+        scatter_child_batch(ctx, num_children - 1, rows, else_rows.data(), else_rows.size(),
+                            result);
+    } else {
+        for (int i : else_rows) {
+            result->set(i, nullptr);
+        }
+    }
+}
+
 } // namespace doris
@@ -43,6 +43,9 @@ public:
     virtual DecimalVal get_decimal_val(ExprContext* ctx, TupleRow* row);
     virtual DecimalV2Val get_decimalv2_val(ExprContext* ctx, TupleRow* row);
 
+    virtual void evaluate_batch(ExprContext* ctx, TupleRow** rows, int num_rows,
+                                ExprColumn* result) override;
+
 protected:
     friend class Expr;
     friend class ComputeFunctions;
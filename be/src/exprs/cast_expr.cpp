@@ -17,6 +17,7 @@
 
 #include "exprs/cast_expr.h"
 
+#include "exprs/expr_column.h"
 #include "runtime/runtime_state.h"
 
 namespace doris {
@@ -152,4 +153,87 @@ CAST_FROM_DOUBLE(IntVal, get_int_val)
 CAST_FROM_DOUBLE(BigIntVal, get_big_int_val)
 CAST_FROM_DOUBLE(LargeIntVal, get_large_int_val)
 CAST_FROM_DOUBLE(FloatVal, get_float_val)
+
+template <typename FROM, typename TO>
+void CastExpr::cast_batch(ExprContext* context, TupleRow** rows, int num_rows,
+                          ExprColumn* result) {
+    const ExprColumn* child = evaluate_child_batch(context, 0, rows, nullptr, num_rows);
+    result->reset(_type.type, num_rows);
+    const FROM* from = child->data<FROM>();
+    TO* to = result->data<TO>();
+    memcpy(result->nulls(), child->nulls(), num_rows);
+    // the values of the null rows are converted too and ignored, so the loop has no
+    // branches
+    for (int i = 0; i < num_rows; ++i) {
+        to[i] = static_cast<TO>(from[i]);
+    }
+}
+
+template <typename FROM>
+void CastExpr::cast_batch_from(ExprContext* context, TupleRow** rows, int num_rows,
+                               ExprColumn* result) {
+    switch (_type.type) {
+    case TYPE_BOOLEAN:
+        cast_batch<FROM, bool>(context, rows, num_rows, result);
+        return;
+    case TYPE_TINYINT:
+        cast_batch<FROM, int8_t>(context, rows, num_rows, result);
+        return;
+    case TYPE_SMALLINT:
+        cast_batch<FROM, int16_t>(context, rows, num_rows, result);
+        return;
+    case TYPE_INT:
+        cast_batch<FROM, int32_t>(context, rows, num_rows, result);
+        return;
+    case TYPE_BIGINT:
+        cast_batch<FROM, int64_t>(context, rows, num_rows, result);
+        return;
+    case TYPE_LARGEINT:
+        cast_batch<FROM, __int128>(context, rows, num_rows, result);
+        return;
+    case TYPE_FLOAT:
+        cast_batch<FROM, float>(context, rows, num_rows, result);
+        return;
+    case TYPE_DOUBLE:
+        cast_batch<FROM, double>(context, rows, num_rows, result);
+        return;
+    default:
+        Expr::evaluate_batch(context, rows, num_rows, result);
+        return;
+    }
+}
+
+void CastExpr::evaluate_batch(ExprContext* context, TupleRow** rows, int num_rows,
+                              ExprColumn* result) {
+    switch (_children[0]->type().type) {
+    case TYPE_BOOLEAN:
+        cast_batch_from<bool>(context, rows, num_rows, result);
+        return;
+    case TYPE_TINYINT:
+        cast_batch_from<int8_t>(context, rows, num_rows, result);
+        return;
+    case TYPE_SMALLINT:
+        cast_batch_from<int16_t>(context, rows, num_rows, result);
+        return;
+    case TYPE_INT:
+        cast_batch_from<int32_t>(context, rows, num_rows, result);
+        return;
+    case TYPE_BIGINT:
+        cast_batch_from<int64_t>(context, rows, num_rows, result);
+        return;
+    case TYPE_LARGEINT:
+        cast_batch_from<__int128>(context, rows, num_rows, result);
+        return;
+    case TYPE_FLOAT:
+        cast_batch_from<float>(context, rows, num_rows, result);
+        return;
+    case TYPE_DOUBLE:
+        cast_batch_from<double>(context, rows, num_rows, result);
+        return;
+    default:
+        Expr::evaluate_batch(context, rows, num_rows, result);
+        return;
+    }
+}
+
 } // namespace doris
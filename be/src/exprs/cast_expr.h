@@ -28,6 +28,18 @@ public:
     CastExpr(const TExprNode& node) : Expr(node) {}
     virtual ~CastExpr() {}
     static Expr* from_thrift(const TExprNode& node);
+
+    virtual void evaluate_batch(ExprContext* context, TupleRow** rows, int num_rows,
+                                ExprColumn* result) override;
+
+private:
+    // Dispatches on the type of this expr, the child has the slot representation FROM.
+    template <typename FROM>
+    void cast_batch_from(ExprContext* context, TupleRow** rows, int num_rows,
+                         ExprColumn* result);
+
+    template <typename FROM, typename TO>
+    void cast_batch(ExprContext* context, TupleRow** rows, int num_rows, ExprColumn* result);
 };
 
 #define CAST_EXPR_DEFINE(CLASS)                                                 \
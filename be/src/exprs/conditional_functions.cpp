@@ -20,6 +20,7 @@
 #include "exprs/anyval_util.h"
 #include "exprs/case_expr.h"
 #include "exprs/expr.h"
+#include "exprs/expr_column.h"
 #include "runtime/tuple_row.h"
 #include "udf/udf.h"
 
@@ -34,4 +35,71 @@ CTOR_DCTOR_FUN(IfNullExpr);
 CTOR_DCTOR_FUN(NullIfExpr);
 CTOR_DCTOR_FUN(IfExpr);
 CTOR_DCTOR_FUN(CoalesceExpr);
+
+// The children of the conditional functions are evaluated column-at-a-time only over the rows
+// that need them, so they short-circuit like the get_*_val() functions.
+
+void IfNullExpr::evaluate_batch(ExprContext* context, TupleRow** rows, int num_rows,
+                                ExprColumn* result) {
+    DCHECK_EQ(_children.size(), 2);
+    const ExprColumn* first = evaluate_child_batch(context, 0, rows, nullptr, num_rows);
+    result->reset(_type.type, num_rows);
+    std::vector<int> null_rows;
+    for (int i = 0; i < num_rows; ++i) {
+        if (first->is_null(i)) {
+            null_rows.push_back(i);
+        } else {
+            result->set(i, first->value(i));
+        }
+    }
+    scatter_child_batch(context, 1, rows, null_rows.data(), null_rows.size(), result);
+}
+
+void IfExpr::evaluate_batch(ExprContext* context, TupleRow** rows, int num_rows,
+                            ExprColumn* result) {
+    DCHECK_EQ(_children.size(), 3);
+    const ExprColumn* cond = evaluate_child_batch(context, 0, rows, nullptr, num_rows);
+    result->reset(_type.type, num_rows);
+    std::vector<int> then_rows;
+    std::vector<int> else_rows;
+    const bool* conds = cond->data<bool>();
+    for (int i = 0; i < num_rows; ++i) {
+        if (!cond->is_null(i) && conds[i]) {
+            then_rows.push_back(i);
+        } else {
+            else_rows.push_back(i);
+        }
+    }
+    scatter_child_batch(context, 1, rows, then_rows.data(), then_rows.size(), result);
+    scatter_child_batch(context, 2, rows, else_rows.data(), else_rows.size(), result);
+}
+
+void CoalesceExpr::evaluate_batch(ExprContext* context, TupleRow** rows, int num_rows,
+                                  ExprColumn* result) {
+    DCHECK_GE(_children.size(), 1);
+    result->reset(_type.type, num_rows);
+    // the rows whose values are null so far
+    std::vector<int> null_rows(num_rows);
+    for (int i = 0; i < num_rows; ++i) {
+        null_rows[i] = i;
+    }
+    std::vector<int> still_null_rows;
+    for (int c = 0; c < _children.size() && !null_rows.empty(); ++c) {
+        const ExprColumn* column = evaluate_child_batch(
+                context, c, rows, c == 0 ? nullptr : null_rows.data(), null_rows.size());
+        still_null_rows.clear();
+        for (int j = 0; j < null_rows.size(); ++j) {
+            if (column->is_null(j)) {
+                still_null_rows.push_back(null_rows[j]);
+            } else {
+                result->set(null_rows[j], column->value(j));
+            }
+        }
+        null_rows.swap(still_null_rows);
+    }
+    for (int i : null_rows) {
+        result->set(i, nullptr);
+    }
+}
+
 } // namespace doris
@@ -54,6 +54,9 @@ public:
     virtual DecimalV2Val get_decimalv2_val(ExprContext* context, TupleRow* row);
     virtual LargeIntVal get_large_int_val(ExprContext* context, TupleRow* row);
 
+    virtual void evaluate_batch(ExprContext* context, TupleRow** rows, int num_rows,
+                                ExprColumn* result) override;
+
     virtual std::string debug_string() const { return Expr::debug_string("IfNullExpr"); }
 
 protected:
@@ -103,6 +106,9 @@ public:
     virtual DecimalV2Val get_decimalv2_val(ExprContext* context, TupleRow* row);
     virtual LargeIntVal get_large_int_val(ExprContext* context, TupleRow* row);
 
+    virtual void evaluate_batch(ExprContext* context, TupleRow** rows, int num_rows,
+                                ExprColumn* result) override;
+
     virtual std::string debug_string() const { return Expr::debug_string("IfExpr"); }
 
 protected:
@@ -130,6 +136,9 @@ public:
     virtual DecimalV2Val get_decimalv2_val(ExprContext* context, TupleRow* row);
     virtual LargeIntVal get_large_int_val(ExprContext* context, TupleRow* row);
 
+    virtual void evaluate_batch(ExprContext* context, TupleRow** rows, int num_rows,
+                                ExprColumn* result) override;
+
     virtual std::string debug_string() const { return Expr::debug_string("CoalesceExpr"); }
 
 protected:
@@ -32,6 +32,7 @@
 #include "exprs/cast_expr.h"
 #include "exprs/compound_predicate.h"
 #include "exprs/conditional_functions.h"
+#include "exprs/expr_column.h"
 #include "exprs/in_predicate.h"
 #include "exprs/info_func.h"
 #include "exprs/is_null_predicate.h"
@@ -815,6 +816,53 @@ DecimalV2Val Expr::get_decimalv2_val(ExprContext* context, TupleRow* row) {
     return val;
 }
 
+void Expr::evaluate_batch(ExprContext* context, TupleRow** rows, int num_rows,
+                          ExprColumn* result) {
+    result->reset(_type.type, num_rows);
+    bool is_constant = this->is_constant();
+    for (int i = 0; i < num_rows; ++i) {
+        if (is_constant && i > 0) {
+            result->set(i, result->is_null(0) ? nullptr : result->value(0));
+            continue;
+        }
+        void* value = context->get_value(this, rows[i]);
+        if (value != nullptr && _type.is_string_type()) {
+            // the string may be in a buffer the next call reuses, eg. the temp string of a
+            // FunctionContext
+            StringValue* sv = reinterpret_cast<StringValue*>(value);
+            char* ptr = reinterpret_cast<char*>(result->pool()->allocate(sv->len));
+            memcpy(ptr, sv->ptr, sv->len);
+            sv->ptr = ptr;
+        }
+        result->set(i, value);
+    }
+}
+
+const ExprColumn* Expr::evaluate_child_batch(ExprContext* context, int i, TupleRow** rows,
+                                             const int* sel, int num_rows) {
+    ExprColumn* column = context->batch_column(_children[i]);
+    if (sel == nullptr) {
+        _children[i]->evaluate_batch(context, rows, num_rows, column);
+        return column;
+    }
+    std::vector<TupleRow*>* sel_rows = context->batch_rows(_children[i]);
+    sel_rows->resize(num_rows);
+    for (int j = 0; j < num_rows; ++j) {
+        (*sel_rows)[j] = rows[sel[j]];
+    }
+    _children[i]->evaluate_batch(context, sel_rows->data(), num_rows, column);
+    return column;
+}
+
+void Expr::scatter_child_batch(ExprContext* context, int i, TupleRow** rows, const int* sel,
+                               int num_sel, ExprColumn* result) {
+    if (num_sel == 0) {
+        return;
+    }
+    const ExprColumn* column = evaluate_child_batch(context, i, rows, sel, num_sel);
+    result->scatter(*column, sel, num_sel);
+}
+
 Status Expr::get_fn_context_error(ExprContext* ctx) {
     if (_fn_context_index != -1) {
         FunctionContext* fn_ctx = ctx->fn_context(_fn_context_index);
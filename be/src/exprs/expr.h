@@ -46,6 +46,7 @@ USING_DORIS_UDF;
 namespace doris {
 
 class Expr;
+class ExprColumn;
 class ObjectPool;
 class RowDescriptor;
 class RuntimeState;
@@ -115,6 +116,13 @@ public:
     virtual DecimalVal get_decimal_val(ExprContext* context, TupleRow*);
     virtual DecimalV2Val get_decimalv2_val(ExprContext* context, TupleRow*);
 
+    /// Evaluates this expr over 'num_rows' rows column-at-a-time and writes the values into
+    /// 'result', which is reset to the type of this expr. Exprs with a batch implementation
+    /// override this, the default one calls the Get*Val() function of each row, once for
+    /// all the rows if the expr is constant. Called through ExprContext::evaluate_batch().
+    virtual void evaluate_batch(ExprContext* context, TupleRow** rows, int num_rows,
+                                ExprColumn* result);
+
     // Get the number of digits after the decimal that should be displayed for this
     // value. Returns -1 if no scale has been specified (currently the scale is only set for
     // doubles set by RoundUpTo). get_value() must have already been called.
@@ -300,6 +308,17 @@ protected:
 
     int fn_ctx_idx() const { return _fn_ctx_idx; }
 
+    /// Evaluates child 'i' column-at-a-time into a column owned by 'context'. If 'sel' is not
+    /// null, only over the rows at its 'num_rows' indices, value j being the one of row
+    /// rows[sel[j]]. Otherwise over the first 'num_rows' rows.
+    const ExprColumn* evaluate_child_batch(ExprContext* context, int i, TupleRow** rows,
+                                           const int* sel, int num_rows);
+
+    /// Evaluates child 'i' over the rows at the 'num_sel' indices of 'sel' and sets these
+    /// rows of 'result' to its values.
+    void scatter_child_batch(ExprContext* context, int i, TupleRow** rows, const int* sel,
+                             int num_sel, ExprColumn* result);
+
     Expr(const TypeDescriptor& type);
     Expr(const TypeDescriptor& type, bool is_slotref);
     Expr(const TExprNode& node);
@@ -0,0 +1,111 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_EXPRS_EXPR_COLUMN_H
+#define DORIS_BE_SRC_EXPRS_EXPR_COLUMN_H
+
+#include <cstring>
+#include <vector>
+
+#include "common/logging.h"
+#include "runtime/mem_pool.h"
+#include "runtime/primitive_type.h"
+
+namespace doris {
+
+class MemTracker;
+
+// The values of an expr over a batch of rows, evaluated column-at-a-time. The values have
+// the in-memory representation of a slot of their type (eg. int32_t, StringValue,
+// DateTimeValue) and are stored contiguously, with a null map beside them. A value of a
+// null row is undefined.
+//
+// String values either point into their inputs or into pool(), which is cleared by
+// reset().
+class ExprColumn {
+public:
+    explicit ExprColumn(MemTracker* tracker)
+            : _type(INVALID_TYPE), _num_rows(0), _byte_size(0), _pool(tracker) {}
+
+    // Sets the type and the number of rows. The values and the null map are undefined.
+    void reset(PrimitiveType type, int num_rows) {
+        _type = type;
+        _num_rows = num_rows;
+        // TIME values are evaluated as doubles
+        _byte_size = type == TYPE_TIME ? sizeof(double) : get_slot_size(type);
+        _data.resize(static_cast<size_t>(num_rows) * _byte_size);
+        _nulls.resize(num_rows);
+        _pool.clear();
+    }
+
+    PrimitiveType type() const { return _type; }
+    int num_rows() const { return _num_rows; }
+    int byte_size() const { return _byte_size; }
+
+    template <typename T>
+    T* data() {
+        return reinterpret_cast<T*>(_data.data());
+    }
+    template <typename T>
+    const T* data() const {
+        return reinterpret_cast<const T*>(_data.data());
+    }
+
+    // 1 for the null rows, 0 for the others
+    uint8_t* nulls() { return _nulls.data(); }
+    const uint8_t* nulls() const { return _nulls.data(); }
+
+    bool is_null(int i) const { return _nulls[i]; }
+    void* value(int i) { return _data.data() + static_cast<size_t>(i) * _byte_size; }
+    const void* value(int i) const {
+        return _data.data() + static_cast<size_t>(i) * _byte_size;
+    }
+
+    // Sets row 'i' to the slot value at 'v', or to null if 'v' is nullptr.
+    void set(int i, const void* v) {
+        _nulls[i] = v == nullptr;
+        if (v != nullptr) {
+            memcpy(value(i), v, _byte_size);
+        }
+    }
+
+    // Copies row j of 'src', which has the representation of this column or is a column of
+    // NULL literals, to row sel[j] for each of the 'num_sel' indices of 'sel'.
+    void scatter(const ExprColumn& src, const int* sel, int num_sel) {
+        DCHECK(src._type == TYPE_NULL || src._byte_size == _byte_size);
+        for (int j = 0; j < num_sel; ++j) {
+            _nulls[sel[j]] = src._nulls[j];
+            if (!src._nulls[j]) {
+                memcpy(value(sel[j]), src.value(j), _byte_size);
+            }
+        }
+    }
+
+    MemPool* pool() { return &_pool; }
+
+private:
+    PrimitiveType _type;
+    int _num_rows;
+    int _byte_size;
+    std::vector<uint8_t> _data;
+    std::vector<uint8_t> _nulls;
+    MemPool _pool;
+};
+
+} // namespace doris
+
+#endif
@@ -23,7 +23,9 @@
 
 #include "exprs/anyval_util.h"
 #include "exprs/expr.h"
+#include "exprs/expr_column.h"
 #include "exprs/slot_ref.h"
+#include "exprs/specialized_predicate.h"
 #include "runtime/mem_pool.h"
 #include "runtime/mem_tracker.h"
 #include "runtime/raw_value.h"
@@ -71,7 +73,9 @@ Status ExprContext::open(RuntimeState* state) {
     // original's fragment state and only need to have thread-local state initialized.
     FunctionContext::FunctionStateScope scope =
             _is_clone ? FunctionContext::THREAD_LOCAL : FunctionContext::FRAGMENT_LOCAL;
-    return _root->open(state, this, scope);
+    RETURN_IF_ERROR(_root->open(state, this, scope));
+    _specialized_predicate.reset(SpecializedPredicate::create(this));
+    return Status::OK();
 }
 
 // TODO chenhao , replace ExprContext with ScalarExprEvaluator
@@ -91,6 +95,9 @@ void ExprContext::close(RuntimeState* state) {
     for (int i = 0; i < _fn_contexts.size(); ++i) {
         _fn_contexts[i]->impl()->close();
     }
+    _batch_columns.clear();
+    _batch_rows.clear();
+    _specialized_predicate.reset();
     // _pool can be NULL if Prepare() was never called
     if (_pool != NULL) {
         _pool->free_all();
@@ -124,7 +131,9 @@ Status ExprContext::clone(RuntimeState* state, ExprContext** new_ctx) {
     (*new_ctx)->_prepared = true;
     (*new_ctx)->_opened = true;
 
-    return _root->open(state, *new_ctx, FunctionContext::THREAD_LOCAL);
+    RETURN_IF_ERROR(_root->open(state, *new_ctx, FunctionContext::THREAD_LOCAL));
+    (*new_ctx)->_specialized_predicate.reset(SpecializedPredicate::create(*new_ctx));
+    return Status::OK();
 }
 
 Status ExprContext::clone(RuntimeState* state, ExprContext** new_ctx, Expr* root) {
@@ -143,7 +152,9 @@ Status ExprContext::clone(RuntimeState* state, ExprContext** new_ctx, Expr* root
     (*new_ctx)->_prepared = true;
     (*new_ctx)->_opened = true;
 
-    return root->open(state, *new_ctx, FunctionContext::THREAD_LOCAL);
+    RETURN_IF_ERROR(root->open(state, *new_ctx, FunctionContext::THREAD_LOCAL));
+    (*new_ctx)->_specialized_predicate.reset(SpecializedPredicate::create(*new_ctx));
+    return Status::OK();
 }
 
 void ExprContext::free_local_allocations() {
@@ -258,6 +269,30 @@ bool ExprContext::is_nullable() {
     return false;
 }
 
+const ExprColumn* ExprContext::evaluate_batch(TupleRow** rows, int num_rows) {
+    ExprColumn* column = batch_column(_root);
+    if (_specialized_predicate != nullptr) {
+        column->reset(TYPE_BOOLEAN, num_rows);
+        _specialized_predicate->eval_batch(rows, num_rows, column->data<bool>(),
+                                           column->nulls());
+        return column;
+    }
+    _root->evaluate_batch(this, rows, num_rows, column);
+    return column;
+}
+
+ExprColumn* ExprContext::batch_column(const Expr* expr) {
+    std::unique_ptr<ExprColumn>& column = _batch_columns[expr];
+    if (column == nullptr) {
+        column.reset(new ExprColumn(_pool->mem_tracker()));
+    }
+    return column.get();
+}
+
+std::vector<TupleRow*>* ExprContext::batch_rows(const Expr* expr) {
+    return &_batch_rows[expr];
+}
+
 void* ExprContext::get_value(Expr* e, TupleRow* row) {
     switch (e->_type.type) {
     case TYPE_NULL: {
@@ -413,6 +448,9 @@ void ExprContext::print_value(TupleRow* row, std::stringstream* stream) {
 }
 
 BooleanVal ExprContext::get_boolean_val(TupleRow* row) {
+    if (_specialized_predicate != nullptr) {
+        return _specialized_predicate->eval(row);
+    }
     return _root->get_boolean_val(this, row);
 }
 
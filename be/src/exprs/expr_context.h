@@ -19,6 +19,8 @@
 #define DORIS_BE_SRC_QUERY_EXPRS_EXPR_CONTEXT_H
 
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "common/status.h"
 #include "exprs/expr_value.h"
@@ -33,10 +35,12 @@ USING_DORIS_UDF;
 namespace doris {
 
 class Expr;
+class ExprColumn;
 class MemPool;
 class MemTracker;
 class RuntimeState;
 class RowDescriptor;
+class SpecializedPredicate;
 class TColumnValue;
 class TupleRow;
 
@@ -79,6 +83,12 @@ public:
     /// result in result_.
     void* get_value(TupleRow* row);
 
+    /// Evaluates the expr tree over 'num_rows' rows column-at-a-time, see
+    /// Expr::evaluate_batch(). The returned column is owned by this context. It and the
+    /// string values in it, which may point into the rows or into the columns of the
+    /// children, are valid until the next call or until the local allocations are freed.
+    const ExprColumn* evaluate_batch(TupleRow** rows, int num_rows);
+
     /// Convenience function: extract value into col_val and sets the
     /// appropriate __isset flag.
     /// If the value is NULL and as_ascii is false, nothing is set.
@@ -120,6 +130,10 @@ public:
 
     Expr* root() { return _root; }
 
+    /// The specialized version of the root predicate built when this context is opened or
+    /// cloned, nullptr if the root has none. See SpecializedPredicate.
+    SpecializedPredicate* specialized_predicate() { return _specialized_predicate.get(); }
+
     bool closed() { return _closed; }
 
     bool is_nullable();
@@ -173,6 +187,7 @@ private:
     friend class OlapScanNode;
     friend class EsScanNode;
     friend class EsPredicate;
+    friend class SpecializedPredicate;
 
     /// FunctionContexts for each registered expression. The FunctionContexts are created
     /// and owned by this ExprContext.
@@ -204,6 +219,25 @@ private:
     /// Calls the appropriate Get*Val() function on 'e' and stores the result in result_.
     /// This is used by Exprs to call GetValue() on a child expr, rather than root_.
     void* get_value(Expr* e, TupleRow* row);
+
+    /// Returns the column 'expr' is evaluated into by evaluate_batch(), created on the first
+    /// call.
+    ExprColumn* batch_column(const Expr* expr);
+
+    /// Returns the buffer the rows 'expr' is evaluated over are gathered into when its
+    /// parent evaluates it over a selection of its rows.
+    std::vector<TupleRow*>* batch_rows(const Expr* expr);
+
+    /// The columns of the exprs of the tree evaluated column-at-a-time. An expr is evaluated
+    /// at most once per evaluate_batch() call, so its column is not overwritten before its
+    /// parent is done with it.
+    std::unordered_map<const Expr*, std::unique_ptr<ExprColumn>> _batch_columns;
+
+    /// The row buffers of batch_rows(), kept to not allocate one on every batch.
+    std::unordered_map<const Expr*, std::vector<TupleRow*>> _batch_rows;
+
+    /// Evaluates the root instead of the exprs if not nullptr.
+    std::unique_ptr<SpecializedPredicate> _specialized_predicate;
 };
 
 } // namespace doris
@@ -91,6 +91,9 @@ public:
         return false;
     }
 
+    // find() for the callers that know T, without the virtual call
+    bool contains(const T& value) const { return _set.find(value) != _set.end(); }
+
     template <class _iT>
     class Iterator : public IteratorBase {
     public:
@@ -148,6 +151,10 @@ public:
         return false;
     }
 
+    bool contains(const StringValue& value) const {
+        return _set.find(std::string(value.ptr, value.len)) != _set.end();
+    }
+
     class Iterator : public IteratorBase {
     public:
         Iterator(std::unordered_set<std::string>::iterator begin,
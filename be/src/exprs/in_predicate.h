@@ -54,6 +54,9 @@ public:
 
     bool is_not_in() const { return _is_not_in; }
 
+    // true if the list has a NULL, which makes the predicate NULL for the values not in it
+    bool null_in_set() const { return _null_in_set; }
+
 protected:
     friend class Expr;
     friend class HashJoinNode;
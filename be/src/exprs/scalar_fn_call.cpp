@@ -17,9 +17,11 @@
 
 #include "exprs/scalar_fn_call.h"
 
+#include <boost/algorithm/string/predicate.hpp>
 #include <vector>
 
 #include "exprs/anyval_util.h"
+#include "exprs/expr_column.h"
 #include "exprs/expr_context.h"
 #include "runtime/runtime_state.h"
 #include "runtime/user_function_cache.h"
@@ -35,7 +37,8 @@ ScalarFnCall::ScalarFnCall(const TExprNode& node)
           _scalar_fn_wrapper(NULL),
           _prepare_fn(NULL),
           _close_fn(NULL),
-          _scalar_fn(NULL) {
+          _scalar_fn(NULL),
+          _batch_fn(nullptr) {
     DCHECK_NE(_fn.binary_type, TFunctionBinaryType::HIVE);
 }
 
@@ -143,6 +146,9 @@ Status ScalarFnCall::prepare(RuntimeState* state, const RowDescriptor& desc, Exp
         codegen->AddFunctionToJit(ir_udf_wrapper, &_scalar_fn_wrapper);
     }
 #endif
+    if (status.ok() && _scalar_fn != NULL && _vararg_start_idx == -1) {
+        _batch_fn = BatchFunctions::get(_scalar_fn);
+    }
     if (_fn.scalar_fn.__isset.prepare_fn_symbol) {
         RETURN_IF_ERROR(get_function(state, _fn.scalar_fn.prepare_fn_symbol,
                                      reinterpret_cast<void**>(&_prepare_fn)));
@@ -225,8 +231,17 @@ void ScalarFnCall::close(RuntimeState* state, ExprContext* context,
     Expr::close(state, context, scope);
 }
 
+// Returns true for the builtins that may return a different value on each call with the
+// same arguments, like FunctionCallExpr.isConstantImpl() of the FE.
+static bool is_nondeterministic_builtin(const std::string& name) {
+    return boost::iequals(name, "rand") || boost::iequals(name, "random") ||
+           boost::iequals(name, "uuid") || boost::iequals(name, "sleep");
+}
+
 bool ScalarFnCall::is_constant() const {
-    if (_fn.name.function_name == "rand") {
+    // nothing is known about the result of a user function
+    if (_fn.binary_type != TFunctionBinaryType::BUILTIN ||
+        is_nondeterministic_builtin(_fn.name.function_name)) {
         return false;
     }
     return Expr::is_constant();
@@ -546,6 +561,26 @@ DecimalV2Val ScalarFnCall::get_decimalv2_val(ExprContext* context, TupleRow* row
     return fn(context, row);
 }
 
+void ScalarFnCall::evaluate_batch(ExprContext* context, TupleRow** rows, int num_rows,
+                                  ExprColumn* result) {
+    // a constant is computed once by the row-at-a-time function
+    bool use_batch_fn = _batch_fn != nullptr && !is_constant();
+    for (int i = 0; use_batch_fn && i < _children.size(); ++i) {
+        // a NULL literal argument is not in the representation of the argument type
+        use_batch_fn = _children[i]->type().type != TYPE_NULL;
+    }
+    if (!use_batch_fn) {
+        Expr::evaluate_batch(context, rows, num_rows, result);
+        return;
+    }
+    std::vector<const ExprColumn*> args(_children.size());
+    for (int i = 0; i < _children.size(); ++i) {
+        args[i] = evaluate_child_batch(context, i, rows, nullptr, num_rows);
+    }
+    result->reset(_type.type, num_rows);
+    _batch_fn(context->fn_context(_fn_context_index), args.data(), num_rows, result);
+}
+
 std::string ScalarFnCall::debug_string() const {
     std::stringstream out;
     out << "ScalarFnCall(udf_type=" << _fn.binary_type << " location=" << _fn.hdfs_location
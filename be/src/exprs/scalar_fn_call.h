@@ -21,6 +21,7 @@
 #include <string>
 
 #include "common/object_pool.h"
+#include "exprs/batch_functions.h"
 #include "exprs/expr.h"
 #include "udf/udf.h"
 
@@ -80,6 +81,10 @@ protected:
     virtual doris_udf::DecimalV2Val get_decimalv2_val(ExprContext* context, TupleRow*);
     // virtual doris_udf::ArrayVal GetArrayVal(ExprContext* context, TupleRow*);
 
+    /// Calls the batch version of the function if it has one, see BatchFunctions.
+    virtual void evaluate_batch(ExprContext* context, TupleRow** rows, int num_rows,
+                                ExprColumn* result) override;
+
 private:
     /// If this function has var args, children()[_vararg_start_idx] is the first vararg
     /// argument.
@@ -104,6 +109,10 @@ private:
     /// scalar function.
     void* _scalar_fn;
 
+    /// The column-at-a-time version of _scalar_fn, nullptr if there is none or if the
+    /// function has var args. Set in Prepare().
+    BatchFn _batch_fn;
+
     /// Returns the number of non-vararg arguments
     int num_fixed_args() const {
         return _vararg_start_idx >= 0 ? _vararg_start_idx : _children.size();
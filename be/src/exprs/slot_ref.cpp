@@ -19,6 +19,7 @@
 
 #include <sstream>
 
+#include "exprs/expr_column.h"
 #include "gen_cpp/Exprs_types.h"
 #include "runtime/runtime_state.h"
 #include "util/types.h"
@@ -245,4 +246,47 @@ DecimalV2Val SlotRef::get_decimalv2_val(ExprContext* context, TupleRow* row) {
     return DecimalV2Val(reinterpret_cast<PackedInt128*>(t->get_slot(_slot_offset))->value);
 }
 
+// Copies the slots at 'slot_offset' of the tuples at 'tuple_idx' of 'rows' to 'result'.
+// BYTE_SIZE is the size of the slots, or 0 if it is not one of the common ones.
+template <int BYTE_SIZE>
+static void gather_slots(TupleRow** rows, int num_rows, int tuple_idx, int slot_offset,
+                         const NullIndicatorOffset& null_indicator_offset, ExprColumn* result) {
+    int byte_size = BYTE_SIZE > 0 ? BYTE_SIZE : result->byte_size();
+    uint8_t* nulls = result->nulls();
+    uint8_t* values = result->data<uint8_t>();
+    for (int i = 0; i < num_rows; ++i) {
+        Tuple* t = rows[i]->get_tuple(tuple_idx);
+        nulls[i] = t == nullptr || t->is_null(null_indicator_offset);
+        if (!nulls[i]) {
+            memcpy(values + i * byte_size, t->get_slot(slot_offset), byte_size);
+        }
+    }
+}
+
+void SlotRef::evaluate_batch(ExprContext* context, TupleRow** rows, int num_rows,
+                             ExprColumn* result) {
+    result->reset(_type.type, num_rows);
+    switch (result->byte_size()) {
+    case 1:
+        gather_slots<1>(rows, num_rows, _tuple_idx, _slot_offset, _null_indicator_offset, result);
+        break;
+    case 2:
+        gather_slots<2>(rows, num_rows, _tuple_idx, _slot_offset, _null_indicator_offset, result);
+        break;
+    case 4:
+        gather_slots<4>(rows, num_rows, _tuple_idx, _slot_offset, _null_indicator_offset, result);
+        break;
+    case 8:
+        gather_slots<8>(rows, num_rows, _tuple_idx, _slot_offset, _null_indicator_offset, result);
+        break;
+    case 16:
+        gather_slots<16>(rows, num_rows, _tuple_idx, _slot_offset, _null_indicator_offset,
+                         result);
+        break;
+    default:
+        gather_slots<0>(rows, num_rows, _tuple_idx, _slot_offset, _null_indicator_offset, result);
+        break;
+    }
+}
+
 } // namespace doris
@@ -55,6 +55,8 @@ public:
     virtual bool is_bound(std::vector<TupleId>* tuple_ids) const;
     virtual int get_slot_ids(std::vector<SlotId>* slot_ids) const;
     SlotId slot_id() const { return _slot_id; }
+    int tuple_idx() const { return _tuple_idx; }
+    int slot_offset() const { return _slot_offset; }
     inline NullIndicatorOffset null_indicator_offset() const { return _null_indicator_offset; }
 
     virtual doris_udf::BooleanVal get_boolean_val(ExprContext* context, TupleRow*);
@@ -71,6 +73,9 @@ public:
     virtual doris_udf::DecimalV2Val get_decimalv2_val(ExprContext* context, TupleRow*);
     // virtual doris_udf::ArrayVal GetArrayVal(ExprContext* context, TupleRow*);
 
+    virtual void evaluate_batch(ExprContext* context, TupleRow** rows, int num_rows,
+                                ExprColumn* result) override;
+
 private:
     int _tuple_idx;                             // within row
     int _slot_offset;                           // within tuple
@@ -0,0 +1,458 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "exprs/specialized_predicate.h"
+
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include "common/logging.h"
+#include "exprs/expr.h"
+#include "exprs/expr_context.h"
+#include "exprs/hybrid_set.h"
+#include "exprs/in_predicate.h"
+#include "exprs/slot_ref.h"
+#include "gen_cpp/Exprs_types.h"
+#include "runtime/datetime_value.h"
+#include "runtime/decimalv2_value.h"
+#include "runtime/descriptors.h"
+#include "runtime/string_value.h"
+#include "runtime/tuple.h"
+#include "runtime/tuple_row.h"
+
+namespace doris {
+
+// A leaf on a single slot of type T. TEST is called with the non-NULL values and is
+// inlined into the loops.
+template <typename T, typename TEST>
+class SlotPredicate : public SpecializedPredicate {
+public:
+    SlotPredicate(const SlotRef* slot, const TEST& test)
+            : _tuple_idx(slot->tuple_idx()),
+              _slot_offset(slot->slot_offset()),
+              _null_indicator_offset(slot->null_indicator_offset()),
+              _test(test) {}
+
+    BooleanVal eval(TupleRow* row) override {
+        const void* slot = get_slot(row);
+        if (slot == nullptr) {
+            return BooleanVal::null();
+        }
+        return BooleanVal(_test(read(slot)));
+    }
+
+    void eval_batch(TupleRow** rows, int num_rows, bool* values, uint8_t* nulls) override {
+        for (int i = 0; i < num_rows; ++i) {
+            const void* slot = get_slot(rows[i]);
+            nulls[i] = slot == nullptr;
+            values[i] = slot != nullptr && _test(read(slot));
+        }
+    }
+
+private:
+    const void* get_slot(TupleRow* row) const {
+        Tuple* tuple = row->get_tuple(_tuple_idx);
+        if (tuple == nullptr || tuple->is_null(_null_indicator_offset)) {
+            return nullptr;
+        }
+        return tuple->get_slot(_slot_offset);
+    }
+
+    // the slots of LARGEINT are not aligned
+    static T read(const void* slot) {
+        T value;
+        memcpy(&value, slot, sizeof(T));
+        return value;
+    }
+
+    const int _tuple_idx;
+    const int _slot_offset;
+    const NullIndicatorOffset _null_indicator_offset;
+    const TEST _test;
+};
+
+template <typename T, typename TEST>
+static SpecializedPredicate* new_slot_predicate(const SlotRef* slot, const TEST& test) {
+    return new SlotPredicate<T, TEST>(slot, test);
+}
+
+template <typename T, typename CMP>
+class CompareTest {
+public:
+    explicit CompareTest(const T& value) : _value(value) {}
+    bool operator()(const T& v) const { return CMP()(v, _value); }
+
+private:
+    const T _value;
+};
+
+template <typename T, typename LOWER_CMP, typename UPPER_CMP>
+class RangeTest {
+public:
+    RangeTest(const T& lower, const T& upper) : _lower(lower), _upper(upper) {}
+    bool operator()(const T& v) const { return LOWER_CMP()(v, _lower) && UPPER_CMP()(v, _upper); }
+
+private:
+    const T _lower;
+    const T _upper;
+};
+
+// The set HybridSetBase::create_set() creates for T.
+template <typename T>
+struct InSet {
+    typedef HybridSet<T> type;
+};
+
+template <>
+struct InSet<StringValue> {
+    typedef StringValueSet type;
+};
+
+// Only for the lists without NULL, so that a value not in the list is never NULL.
+template <typename T>
+class InTest {
+public:
+    InTest(const HybridSetBase* set, bool is_not_in)
+            : _set(static_cast<const typename InSet<T>::type*>(set)), _is_not_in(is_not_in) {}
+    bool operator()(const T& v) const { return _set->contains(v) != _is_not_in; }
+
+private:
+    const typename InSet<T>::type* _set;
+    const bool _is_not_in;
+};
+
+template <bool IS_AND>
+class CompoundSpecializedPredicate : public SpecializedPredicate {
+public:
+    CompoundSpecializedPredicate(SpecializedPredicate* left, SpecializedPredicate* right)
+            : _left(left), _right(right), _capacity(0) {}
+
+    BooleanVal eval(TupleRow* row) override {
+        // a false AND or a true OR decides the result
+        BooleanVal left = _left->eval(row);
+        if (!left.is_null && left.val != IS_AND) {
+            return left;
+        }
+        BooleanVal right = _right->eval(row);
+        if (!right.is_null && right.val != IS_AND) {
+            return right;
+        }
+        if (left.is_null || right.is_null) {
+            return BooleanVal::null();
+        }
+        return BooleanVal(IS_AND);
+    }
+
+    void eval_batch(TupleRow** rows, int num_rows, bool* values, uint8_t* nulls) override {
+        if (_capacity < num_rows) {
+            _right_values.reset(new bool[num_rows]);
+            _right_nulls.reset(new uint8_t[num_rows]);
+            _capacity = num_rows;
+        }
+        _left->eval_batch(rows, num_rows, values, nulls);
+        _right->eval_batch(rows, num_rows, _right_values.get(), _right_nulls.get());
+        for (int i = 0; i < num_rows; ++i) {
+            bool decided = (!nulls[i] && values[i] != IS_AND) ||
+                           (!_right_nulls[i] && _right_values[i] != IS_AND);
+            bool is_null = !decided && (nulls[i] || _right_nulls[i]);
+            nulls[i] = is_null;
+            values[i] = IS_AND ? !decided && !is_null : decided;
+        }
+    }
+
+private:
+    std::unique_ptr<SpecializedPredicate> _left;
+    std::unique_ptr<SpecializedPredicate> _right;
+    std::unique_ptr<bool[]> _right_values;
+    std::unique_ptr<uint8_t[]> _right_nulls;
+    int _capacity;
+};
+
+template <typename T>
+static SpecializedPredicate* create_compare(const SlotRef* slot, TExprOpcode::type op,
+                                            const void* literal) {
+    T value;
+    memcpy(&value, literal, sizeof(T));
+    switch (op) {
+    case TExprOpcode::EQ:
+        return new_slot_predicate<T>(slot, CompareTest<T, std::equal_to<T>>(value));
+    case TExprOpcode::NE:
+        return new_slot_predicate<T>(slot, CompareTest<T, std::not_equal_to<T>>(value));
+    case TExprOpcode::LT:
+        return new_slot_predicate<T>(slot, CompareTest<T, std::less<T>>(value));
+    case TExprOpcode::LE:
+        return new_slot_predicate<T>(slot, CompareTest<T, std::less_equal<T>>(value));
+    case TExprOpcode::GT:
+        return new_slot_predicate<T>(slot, CompareTest<T, std::greater<T>>(value));
+    case TExprOpcode::GE:
+        return new_slot_predicate<T>(slot, CompareTest<T, std::greater_equal<T>>(value));
+    default:
+        return nullptr;
+    }
+}
+
+template <typename T, typename LOWER_CMP>
+static SpecializedPredicate* create_range_with_lower(const SlotRef* slot, const T& lower,
+                                                     TExprOpcode::type upper_op,
+                                                     const T& upper) {
+    switch (upper_op) {
+    case TExprOpcode::LT:
+        return new_slot_predicate<T>(slot, RangeTest<T, LOWER_CMP, std::less<T>>(lower, upper));
+    case TExprOpcode::LE:
+        return new_slot_predicate<T>(slot,
+                                     RangeTest<T, LOWER_CMP, std::less_equal<T>>(lower, upper));
+    default:
+        return nullptr;
+    }
+}
+
+template <typename T>
+static SpecializedPredicate* create_range(const SlotRef* slot, TExprOpcode::type lower_op,
+                                          const void* lower_literal, TExprOpcode::type upper_op,
+                                          const void* upper_literal) {
+    T lower;
+    T upper;
+    memcpy(&lower, lower_literal, sizeof(T));
+    memcpy(&upper, upper_literal, sizeof(T));
+    switch (lower_op) {
+    case TExprOpcode::GT:
+        return create_range_with_lower<T, std::greater<T>>(slot, lower, upper_op, upper);
+    case TExprOpcode::GE:
+        return create_range_with_lower<T, std::greater_equal<T>>(slot, lower, upper_op, upper);
+    default:
+        return nullptr;
+    }
+}
+
+template <typename T>
+static SpecializedPredicate* create_in(const SlotRef* slot, const InPredicate* pred) {
+    return new_slot_predicate<T>(slot, InTest<T>(pred->hybrid_set(), pred->is_not_in()));
+}
+
+// Calls FN<T>(args) for the T of the slots of 'type', or returns nullptr if it is not
+// supported.
+#define DISPATCH_SLOT_TYPE(TYPE, FN, ...)                \
+    switch (TYPE) {                                      \
+    case TYPE_BOOLEAN:                                   \
+        return FN<bool>(__VA_ARGS__);                    \
+    case TYPE_TINYINT:                                   \
+        return FN<int8_t>(__VA_ARGS__);                  \
+    case TYPE_SMALLINT:                                  \
+        return FN<int16_t>(__VA_ARGS__);                 \
+    case TYPE_INT:                                       \
+        return FN<int32_t>(__VA_ARGS__);                 \
+    case TYPE_BIGINT:                                    \
+        return FN<int64_t>(__VA_ARGS__);                 \
+    case TYPE_LARGEINT:                                  \
+        return FN<__int128>(__VA_ARGS__);                \
+    case TYPE_FLOAT:                                     \
+        return FN<float>(__VA_ARGS__);                   \
+    case TYPE_DOUBLE:                                    \
+        return FN<double>(__VA_ARGS__);                  \
+    case TYPE_DATE:                                      \
+    case TYPE_DATETIME:                                  \
+        return FN<DateTimeValue>(__VA_ARGS__);           \
+    case TYPE_DECIMALV2:                                 \
+        return FN<DecimalV2Value>(__VA_ARGS__);          \
+    case TYPE_CHAR:                                      \
+    case TYPE_VARCHAR:                                   \
+        return FN<StringValue>(__VA_ARGS__);             \
+    default:                                             \
+        return nullptr;                                  \
+    }
+
+// The type of the slots holding the values of 'type' if it is one of DISPATCH_SLOT_TYPE,
+// INVALID_TYPE otherwise.
+static PrimitiveType slot_representation(PrimitiveType type) {
+    switch (type) {
+    case TYPE_BOOLEAN:
+    case TYPE_TINYINT:
+    case TYPE_SMALLINT:
+    case TYPE_INT:
+    case TYPE_BIGINT:
+    case TYPE_LARGEINT:
+    case TYPE_FLOAT:
+    case TYPE_DOUBLE:
+    case TYPE_DECIMALV2:
+        return type;
+    case TYPE_DATE:
+    case TYPE_DATETIME:
+        return TYPE_DATETIME;
+    case TYPE_CHAR:
+    case TYPE_VARCHAR:
+        return TYPE_VARCHAR;
+    default:
+        return INVALID_TYPE;
+    }
+}
+
+static bool is_literal(const Expr* expr) {
+    switch (expr->node_type()) {
+    case TExprNodeType::BOOL_LITERAL:
+    case TExprNodeType::INT_LITERAL:
+    case TExprNodeType::LARGE_INT_LITERAL:
+    case TExprNodeType::FLOAT_LITERAL:
+    case TExprNodeType::DECIMAL_LITERAL:
+    case TExprNodeType::DATE_LITERAL:
+    case TExprNodeType::STRING_LITERAL:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// The comparison of 'b' with 'a' for 'a op b'.
+static TExprOpcode::type swap_comparison(TExprOpcode::type op) {
+    switch (op) {
+    case TExprOpcode::LT:
+        return TExprOpcode::GT;
+    case TExprOpcode::LE:
+        return TExprOpcode::GE;
+    case TExprOpcode::GT:
+        return TExprOpcode::LT;
+    case TExprOpcode::GE:
+        return TExprOpcode::LE;
+    default:
+        return op;
+    }
+}
+
+static bool is_lower_bound(TExprOpcode::type op) {
+    return op == TExprOpcode::GT || op == TExprOpcode::GE;
+}
+
+static bool is_upper_bound(TExprOpcode::type op) {
+    return op == TExprOpcode::LT || op == TExprOpcode::LE;
+}
+
+SpecializedPredicate* SpecializedPredicate::create(ExprContext* context) {
+    DCHECK(context->opened());
+    if (context->root()->type().type != TYPE_BOOLEAN) {
+        return nullptr;
+    }
+    return create(context, context->root());
+}
+
+bool SpecializedPredicate::get_comparison(ExprContext* context, Expr* expr, SlotRef** slot,
+                                          TExprOpcode::type* op, LiteralValue* literal) {
+    if (expr->node_type() != TExprNodeType::BINARY_PRED || expr->get_num_children() != 2) {
+        return false;
+    }
+    switch (expr->op()) {
+    case TExprOpcode::EQ:
+    case TExprOpcode::NE:
+    case TExprOpcode::LT:
+    case TExprOpcode::LE:
+    case TExprOpcode::GT:
+    case TExprOpcode::GE:
+        break;
+    default:
+        // EQ_FOR_NULL is true for two NULLs
+        return false;
+    }
+    Expr* slot_expr = expr->get_child(0);
+    Expr* literal_expr = expr->get_child(1);
+    *op = expr->op();
+    if (is_literal(slot_expr)) {
+        std::swap(slot_expr, literal_expr);
+        *op = swap_comparison(*op);
+    }
+    *slot = dynamic_cast<SlotRef*>(slot_expr);
+    if (*slot == nullptr || !is_literal(literal_expr)) {
+        return false;
+    }
+    PrimitiveType type = slot_representation((*slot)->type().type);
+    if (type == INVALID_TYPE || type != slot_representation(literal_expr->type().type)) {
+        return false;
+    }
+    // a literal is evaluated without a row, and its string values are owned by the expr
+    void* value = context->get_value(literal_expr, nullptr);
+    if (value == nullptr) {
+        return false;
+    }
+    DCHECK_LE(get_slot_size(type), sizeof(literal->data));
+    memcpy(literal->data, value, get_slot_size(type));
+    return true;
+}
+
+SpecializedPredicate* SpecializedPredicate::create(ExprContext* context, Expr* expr) {
+    switch (expr->node_type()) {
+    case TExprNodeType::BINARY_PRED: {
+        SlotRef* slot = nullptr;
+        TExprOpcode::type op;
+        LiteralValue literal;
+        if (!get_comparison(context, expr, &slot, &op, &literal)) {
+            return nullptr;
+        }
+        DISPATCH_SLOT_TYPE(slot->type().type, create_compare, slot, op, literal.data);
+    }
+    case TExprNodeType::IN_PRED: {
+        InPredicate* pred = dynamic_cast<InPredicate*>(expr);
+        if (pred == nullptr || pred->null_in_set() || pred->hybrid_set() == nullptr) {
+            return nullptr;
+        }
+        SlotRef* slot = dynamic_cast<SlotRef*>(pred->get_child(0));
+        if (slot == nullptr) {
+            return nullptr;
+        }
+        DISPATCH_SLOT_TYPE(slot->type().type, create_in, slot, pred);
+    }
+    case TExprNodeType::COMPOUND_PRED: {
+        if (expr->get_num_children() != 2) {
+            return nullptr;
+        }
+        bool is_and = expr->op() == TExprOpcode::COMPOUND_AND;
+        if (!is_and && expr->op() != TExprOpcode::COMPOUND_OR) {
+            return nullptr;
+        }
+        SlotRef* slots[2];
+        TExprOpcode::type ops[2];
+        LiteralValue literals[2];
+        if (is_and &&
+            get_comparison(context, expr->get_child(0), &slots[0], &ops[0], &literals[0]) &&
+            get_comparison(context, expr->get_child(1), &slots[1], &ops[1], &literals[1]) &&
+            slots[0]->tuple_idx() == slots[1]->tuple_idx() &&
+            slots[0]->slot_offset() == slots[1]->slot_offset()) {
+            // a lower and an upper bound of the same slot are tested together
+            int lower = is_lower_bound(ops[0]) ? 0 : 1;
+            int upper = 1 - lower;
+            if (is_lower_bound(ops[lower]) && is_upper_bound(ops[upper])) {
+                DISPATCH_SLOT_TYPE(slots[0]->type().type, create_range, slots[0], ops[lower],
+                                   literals[lower].data, ops[upper], literals[upper].data);
+            }
+        }
+        std::unique_ptr<SpecializedPredicate> left(create(context, expr->get_child(0)));
+        if (left == nullptr) {
+            return nullptr;
+        }
+        std::unique_ptr<SpecializedPredicate> right(create(context, expr->get_child(1)));
+        if (right == nullptr) {
+            return nullptr;
+        }
+        if (is_and) {
+            return new CompoundSpecializedPredicate<true>(left.release(), right.release());
+        }
+        return new CompoundSpecializedPredicate<false>(left.release(), right.release());
+    }
+    default:
+        return nullptr;
+    }
+}
+
+} // namespace doris
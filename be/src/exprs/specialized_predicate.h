@@ -0,0 +1,76 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_EXPRS_SPECIALIZED_PREDICATE_H
+#define DORIS_BE_SRC_EXPRS_SPECIALIZED_PREDICATE_H
+
+#include <cstdint>
+
+#include "gen_cpp/Opcodes_types.h"
+#include "udf/udf.h"
+
+namespace doris {
+
+class Expr;
+class ExprContext;
+class SlotRef;
+class TupleRow;
+
+// A predicate tree of the most common shapes, evaluated by code instantiated for the type
+// of its slot at compile time instead of by the virtual get_*_val() calls of the exprs:
+//   - slot op literal, op being one of =, !=, <, <=, >, >=
+//   - slot >[=] literal AND slot <[=] literal on the same slot, which BETWEEN is
+//     rewritten to
+//   - slot [NOT] IN (literals)
+//   - AND and OR of the above
+// Each leaf reads its slot straight from the tuple and tests it without boxing it into
+// an AnyVal. The results follow the three-valued logic of the exprs it replaces.
+//
+// Not thread-safe, each ExprContext has its own.
+class SpecializedPredicate {
+public:
+    virtual ~SpecializedPredicate() {}
+
+    // Returns the specialized version of the root predicate of the opened 'context', or
+    // nullptr if it does not have one of the shapes above.
+    static SpecializedPredicate* create(ExprContext* context);
+
+    virtual doris_udf::BooleanVal eval(TupleRow* row) = 0;
+
+    // Evaluates the predicate over 'num_rows' rows. Sets nulls[i] to 1 if it is NULL for
+    // row i, otherwise to 0 and values[i] to its value. values[i] is false for the NULL
+    // rows.
+    virtual void eval_batch(TupleRow** rows, int num_rows, bool* values, uint8_t* nulls) = 0;
+
+private:
+    // The slot value of a literal, for the types with a specialized version.
+    struct LiteralValue {
+        alignas(16) uint8_t data[16];
+    };
+
+    static SpecializedPredicate* create(ExprContext* context, Expr* expr);
+
+    // If 'expr' is a binary predicate of a slot and a literal of the same type, sets 'slot'
+    // and 'literal' to them and 'op' to the comparison of the slot with the literal, and
+    // returns true.
+    static bool get_comparison(ExprContext* context, Expr* expr, SlotRef** slot,
+                               TExprOpcode::type* op, LiteralValue* literal);
+};
+
+} // namespace doris
+
+#endif
@@ -34,6 +34,9 @@ class Expr;
 class OpcodeRegistry;
 class TupleRow;
 
+// Returns the number of bytes of the utf8 character starting with 'byte'.
+size_t get_utf8_byte_length(unsigned char byte);
+
 class StringFunctions {
 public:
     static void init();
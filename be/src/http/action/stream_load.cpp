@@ -20,6 +20,7 @@
 #include <deque>
 #include <future>
 #include <sstream>
+#include <vector>
 
 // use string iequal
 #include <event2/buffer.h>
@@ -277,20 +278,23 @@ void StreamLoadAction::on_chunk_data(HttpRequest* req) {
     auto evbuf = evhttp_request_get_input_buffer(ev_req);
 
     int64_t start_read_data_time = MonotonicNanos();
-    while (evbuffer_get_length(evbuf) > 0) {
-        auto bb = ByteBuffer::allocate(4096);
-        auto remove_bytes = evbuffer_remove(evbuf, bb->ptr, bb->capacity);
-        bb->pos = remove_bytes;
-        bb->flip();
-        auto st = ctx->body_sink->append(bb);
+    // append the data from the memory of evbuffer directly, without copying
+    // it to a temporary buffer first.
+    size_t length = evbuffer_get_length(evbuf);
+    int num_vecs = evbuffer_peek(evbuf, length, nullptr, nullptr, 0);
+    std::vector<evbuffer_iovec> vecs(num_vecs);
+    evbuffer_peek(evbuf, length, nullptr, vecs.data(), num_vecs);
+    for (auto& vec : vecs) {
+        auto st = ctx->body_sink->append((const char*)vec.iov_base, vec.iov_len);
         if (!st.ok()) {
             LOG(WARNING) << "append body content failed. errmsg=" << st.get_error_msg()
                          << ctx->brief();
             ctx->status = st;
             return;
         }
-        ctx->receive_bytes += remove_bytes;
+        ctx->receive_bytes += vec.iov_len;
     }
+    evbuffer_drain(evbuf, length);
     ctx->read_data_cost_nanos += (MonotonicNanos() - start_read_data_time);
 }
 
@@ -321,9 +325,12 @@ Status StreamLoadAction::_process_put(HttpRequest* http_req, StreamLoadContext*
     request.formatType = ctx->format;
     request.__set_loadId(ctx->id.to_thrift());
     if (ctx->use_streaming) {
+        // json data is read as a whole message, so the total length is needed,
+        // other formats are read as a stream.
+        int64_t total_length = ctx->format == TFileFormatType::FORMAT_JSON ? ctx->body_bytes : -1;
         auto pipe = std::make_shared<StreamLoadPipe>(1024 * 1024 /* max_buffered_bytes */,
                                                      64 * 1024 /* min_chunk_size */,
-                                                     ctx->body_bytes /* total_length */);
+                                                     total_length /* total_length */);
         RETURN_IF_ERROR(_exec_env->load_stream_mgr()->put(ctx->id, pipe));
         request.fileType = TFileType::FILE_STREAM;
         ctx->body_sink = pipe;
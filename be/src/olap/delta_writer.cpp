@@ -21,9 +21,11 @@
 #include "olap/memtable.h"
 #include "olap/memtable_flush_executor.h"
 #include "olap/rowset/rowset_factory.h"
+#include "olap/rowset_sync_handler.h"
 #include "olap/schema.h"
 #include "olap/schema_change.h"
 #include "olap/storage_engine.h"
+#include "runtime/exec_env.h"
 
 namespace doris {
 
@@ -109,6 +111,15 @@ OLAPStatus DeltaWriter::init() {
         return OLAP_ERR_TABLE_NOT_FOUND;
     }
 
+    if (!_req.slave_nodes.empty() &&
+        _tablet->tablet_meta()->preferred_rowset_type() != BETA_ROWSET) {
+        // segment files of alpha rowset are not self-described, they can not be synced
+        // to slave replicas.
+        LOG(WARNING) << "single replica load only supports beta rowset. tablet: "
+                     << _tablet->full_name();
+        return OLAP_ERR_FUNC_NOT_IMPLEMENTED;
+    }
+
     {
         ReadLock base_migration_rlock(_tablet->get_migration_lock_ptr(), TRY_LOCK);
         if (!base_migration_rlock.own_lock()) {
@@ -135,6 +146,12 @@ OLAPStatus DeltaWriter::init() {
                                  << ", new_schema_hash=" << new_schema_hash;
                     return OLAP_ERR_TABLE_NOT_FOUND;
                 }
+                if (!_req.slave_nodes.empty() &&
+                    _new_tablet->tablet_meta()->preferred_rowset_type() != BETA_ROWSET) {
+                    LOG(WARNING) << "single replica load only supports beta rowset. tablet: "
+                                 << _new_tablet->full_name();
+                    return OLAP_ERR_FUNC_NOT_IMPLEMENTED;
+                }
                 ReadLock new_migration_rlock(_new_tablet->get_migration_lock_ptr(), TRY_LOCK);
                 if (!new_migration_rlock.own_lock()) {
                     return OLAP_ERR_RWLOCK_ERROR;
@@ -286,6 +303,19 @@ OLAPStatus DeltaWriter::close_wait(google::protobuf::RepeatedPtrField<PTabletInf
         tablet_info->set_schema_hash(_new_tablet->schema_hash());
     }
 #endif
+    if (!_req.slave_nodes.empty()) {
+        BrpcStubCache* stub_cache = ExecEnv::GetInstance()->brpc_stub_cache();
+        _rowset_syncers.emplace_back(new RowsetSyncer(stub_cache, _tablet, _cur_rowset,
+                                                      _req.load_id, _req.txn_id,
+                                                      _req.partition_id, _req.slave_nodes));
+        // the shadow replicas of a schema change are on the backends of the base replicas,
+        // they miss the version unless the converted rowset is synced to them too
+        if (_new_tablet != nullptr) {
+            _rowset_syncers.emplace_back(new RowsetSyncer(stub_cache, _new_tablet, _new_rowset,
+                                                          _req.load_id, _req.txn_id,
+                                                          _req.partition_id, _req.slave_nodes));
+        }
+    }
 
     _delta_written_success = true;
 
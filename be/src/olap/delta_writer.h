@@ -18,6 +18,9 @@
 #ifndef DORIS_BE_SRC_DELTA_WRITER_H
 #define DORIS_BE_SRC_DELTA_WRITER_H
 
+#include <memory>
+#include <vector>
+
 #include "gen_cpp/internal_service.pb.h"
 #include "olap/rowset/rowset_writer.h"
 #include "olap/tablet.h"
@@ -27,6 +30,7 @@ namespace doris {
 class FlushToken;
 class MemTable;
 class MemTracker;
+class RowsetSyncer;
 class Schema;
 class StorageEngine;
 class Tuple;
@@ -46,6 +50,9 @@ struct WriteRequest {
     TupleDescriptor* tuple_desc;
     // slots are in order of tablet's schema
     const std::vector<SlotDescriptor*>* slots;
+    // only set in single replica load, the rowset built by this writer
+    // will be synced to these replicas after committed
+    std::vector<PNodeInfo> slave_nodes;
 };
 
 // Writer for a particular (load, index, tablet).
@@ -79,6 +86,13 @@ public:
 
     int64_t mem_consumption() const;
 
+    // In single replica load, the syncers of the rowsets committed by close_wait(), which
+    // send them to slave replicas: the one of the tablet and, during a schema change, the
+    // one of the new tablet. Empty if there is no slave replica.
+    const std::vector<std::unique_ptr<RowsetSyncer>>& rowset_syncers() const {
+        return _rowset_syncers;
+    }
+
 private:
     DeltaWriter(WriteRequest* req, const std::shared_ptr<MemTracker>& parent,
                 StorageEngine* storage_engine);
@@ -106,6 +120,7 @@ private:
     StorageEngine* _storage_engine;
     std::unique_ptr<FlushToken> _flush_token;
     std::shared_ptr<MemTracker> _mem_tracker;
+    std::vector<std::unique_ptr<RowsetSyncer>> _rowset_syncers;
 };
 
 } // namespace doris
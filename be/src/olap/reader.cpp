@@ -385,6 +385,11 @@ OLAPStatus Reader::_capture_rs_readers(const ReaderParams& read_params) {
     _reader_context.use_page_cache = read_params.use_page_cache;
     for (auto& rs_reader : *rs_readers) {
         RETURN_NOT_OK(rs_reader->init(&_reader_context));
+        if (_columnar_read) {
+            // read by next_block() one rowset after another, nothing to merge
+            _rs_readers.push_back(rs_reader);
+            continue;
+        }
         OLAPStatus res = _collect_iter->add_child(rs_reader);
         if (res != OLAP_SUCCESS && res != OLAP_ERR_DATA_EOF) {
             LOG(WARNING) << "failed to add child to iterator, err=" << res;
@@ -394,15 +399,38 @@ OLAPStatus Reader::_capture_rs_readers(const ReaderParams& read_params) {
             _rs_readers.push_back(rs_reader);
         }
     }
+    if (_columnar_read) {
+        return OLAP_SUCCESS;
+    }
     _collect_iter->build_heap();
     _next_key = _collect_iter->current_row(&_next_delete_flag);
     return OLAP_SUCCESS;
 }
 
+OLAPStatus Reader::next_block(std::shared_ptr<RowBlockV2>* block, bool* eof) {
+    DCHECK(_columnar_read);
+    while (_cur_rs_reader_idx < _rs_readers.size()) {
+        auto res = _rs_readers[_cur_rs_reader_idx]->next_block(block);
+        if (res == OLAP_SUCCESS) {
+            *eof = false;
+            return OLAP_SUCCESS;
+        }
+        if (res != OLAP_ERR_DATA_EOF) {
+            LOG(WARNING) << "failed to read next block, res=" << res
+                         << ", tablet=" << _tablet->full_name();
+            return res;
+        }
+        ++_cur_rs_reader_idx;
+    }
+    *eof = true;
+    return OLAP_SUCCESS;
+}
+
 OLAPStatus Reader::_init_params(const ReaderParams& read_params) {
     read_params.check_validation();
 
     _aggregation = read_params.aggregation;
+    _columnar_read = read_params.columnar_read;
     _need_agg_finalize = read_params.need_agg_finalize;
     _reader_type = read_params.reader_type;
     _tablet = read_params.tablet;
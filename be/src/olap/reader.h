@@ -44,6 +44,7 @@ namespace doris {
 class Tablet;
 class RowCursor;
 class RowBlock;
+class RowBlockV2;
 class CollectIterator;
 class RuntimeState;
 
@@ -71,6 +72,10 @@ struct ReaderParams {
     // The ColumnData will be set when using Merger, eg Cumulative, BE.
     std::vector<RowsetReaderSharedPtr> rs_readers;
     std::vector<uint32_t> return_columns;
+    // read the rowsets one after another with next_block(), rows are neither merged nor
+    // aggregated and delete predicates are not applied. every rowset must support
+    // RowsetReader::next_block(std::shared_ptr<RowBlockV2>*).
+    bool columnar_read = false;
     RuntimeProfile* profile = nullptr;
     RuntimeState* runtime_state = nullptr;
 
@@ -98,6 +103,11 @@ public:
         return (this->*_next_row_func)(row_cursor, mem_pool, agg_pool, eof);
     }
 
+    // Read next block of rows when initialized with ReaderParams::columnar_read.
+    // Only the selected rows of the block, see RowBlockV2::selection_vector(), are returned.
+    // Return OLAP_SUCCESS and set `*eof` to true when no more blocks can be read.
+    OLAPStatus next_block(std::shared_ptr<RowBlockV2>* block, bool* eof);
+
     uint64_t merged_rows() const { return _merged_rows; }
 
     uint64_t filtered_rows() const {
@@ -165,6 +175,8 @@ private:
 
     TabletSharedPtr _tablet;
     std::vector<RowsetReaderSharedPtr> _rs_readers;
+    // the rowset read by next_block()
+    size_t _cur_rs_reader_idx = 0;
     RowsetReaderContext _reader_context;
     KeysParam _keys_param;
     std::vector<bool> _is_lower_keys_included;
@@ -178,6 +190,7 @@ private:
                                          ObjectPool* agg_pool, bool* eof) = nullptr;
 
     bool _aggregation = false;
+    bool _columnar_read = false;
     // for agg query, we don't need to finalize when scan agg object data
     bool _need_agg_finalize = true;
     ReaderType _reader_type = READER_QUERY;
@@ -151,4 +151,25 @@ OLAPStatus BetaRowsetReader::next_block(RowBlock** block) {
     return OLAP_SUCCESS;
 }
 
+OLAPStatus BetaRowsetReader::next_block(std::shared_ptr<RowBlockV2>* block) {
+    SCOPED_RAW_TIMER(&_stats->block_fetch_ns);
+    if (_shared_block == nullptr || _shared_block.use_count() > 1) {
+        // the caller may still use the data of the last block, e.g. in arrow buffers
+        _shared_block.reset(new RowBlockV2(*_input_block->schema(), _input_block->capacity()));
+    } else {
+        _shared_block->clear();
+    }
+    auto s = _iterator->next_batch(_shared_block.get());
+    if (!s.ok()) {
+        block->reset();
+        if (s.is_end_of_file()) {
+            return OLAP_ERR_DATA_EOF;
+        }
+        LOG(WARNING) << "failed to read next block: " << s.to_string();
+        return OLAP_ERR_ROWSET_READ_FAILED;
+    }
+    *block = _shared_block;
+    return OLAP_SUCCESS;
+}
+
 } // namespace doris
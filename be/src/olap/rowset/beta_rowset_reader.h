@@ -40,6 +40,8 @@ public:
     // It's ok, because we only get ref here, the block's owner is this reader.
     OLAPStatus next_block(RowBlock** block) override;
 
+    OLAPStatus next_block(std::shared_ptr<RowBlockV2>* block) override;
+
     bool delete_flag() override { return _rowset->delete_flag(); }
 
     Version version() override { return _rowset->version(); }
@@ -65,6 +67,8 @@ private:
     std::unique_ptr<RowwiseIterator> _iterator;
 
     std::unique_ptr<RowBlockV2> _input_block;
+    // returned by next_block(std::shared_ptr<RowBlockV2>*), reused once the caller releases it
+    std::shared_ptr<RowBlockV2> _shared_block;
     std::unique_ptr<RowBlock> _output_block;
     std::unique_ptr<RowCursor> _row;
 };
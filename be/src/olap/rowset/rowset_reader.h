@@ -27,6 +27,7 @@
 namespace doris {
 
 class RowBlock;
+class RowBlockV2;
 class RowsetReader;
 using RowsetReaderSharedPtr = std::shared_ptr<RowsetReader>;
 
@@ -44,6 +45,14 @@ public:
     //      Others when error happens.
     virtual OLAPStatus next_block(RowBlock** block) = 0;
 
+    // read next block of columnar data into *block, without converting it to rows.
+    // the block is not reused by the reader while the caller still holds a reference to it.
+    // Returns the same as next_block(RowBlock**), OLAP_ERR_FUNC_NOT_IMPLEMENTED if the
+    // rowset type can't be read column-wise.
+    virtual OLAPStatus next_block(std::shared_ptr<RowBlockV2>* block) {
+        return OLAP_ERR_FUNC_NOT_IMPLEMENTED;
+    }
+
     virtual bool delete_flag() = 0;
 
     virtual Version version() = 0;
@@ -0,0 +1,317 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "olap/rowset_sync_handler.h"
+
+#include <algorithm>
+
+#include "common/config.h"
+#include "env/env.h"
+#include "gutil/strings/substitute.h"
+#include "olap/data_dir.h"
+#include "olap/rowset/beta_rowset.h"
+#include "olap/rowset/rowset_factory.h"
+#include "olap/rowset/rowset_meta.h"
+#include "olap/storage_engine.h"
+#include "olap/tablet_manager.h"
+#include "olap/txn_manager.h"
+#include "util/brpc_stub_cache.h"
+#include "util/time.h"
+
+namespace doris {
+
+std::mutex RowsetSyncHandler::_pending_lock;
+std::map<std::string, RowsetSyncHandler::PendingRowset> RowsetSyncHandler::_pending_rowsets;
+
+Status RowsetSyncHandler::process(const PTabletWriterSyncRowsetRequest& request,
+                                  const butil::IOBuf& data) {
+    _expire_pending_rowsets();
+    TabletSharedPtr tablet = _storage_engine->tablet_manager()->get_tablet(
+            request.tablet_id(), request.schema_hash());
+    if (tablet == nullptr) {
+        return Status::NotFound(strings::Substitute("tablet not found, tablet_id=$0, schema_hash=$1",
+                                                    request.tablet_id(), request.schema_hash()));
+    }
+    if (request.has_rowset_meta()) {
+        return _commit_rowset(tablet, request);
+    }
+    return _write_segment_chunk(tablet, request, data);
+}
+
+Status RowsetSyncHandler::_write_segment_chunk(const TabletSharedPtr& tablet,
+                                               const PTabletWriterSyncRowsetRequest& request,
+                                               const butil::IOBuf& data) {
+    if (!request.has_rowset_id() || !request.has_segment_id() || !request.has_offset()) {
+        return Status::InvalidArgument("rowset_id, segment_id and offset are required");
+    }
+    RowsetId rowset_id;
+    rowset_id.init(request.rowset_id());
+    // rowset id is generated by the master replica, protect the files from being
+    // garbage collected until the rowset is committed.
+    const std::string pending_id = ROWSET_ID_PREFIX + rowset_id.to_string();
+    _add_pending_rowset(tablet->data_dir(), pending_id);
+
+    std::string path = BetaRowset::segment_file_path(tablet->tablet_path(), rowset_id,
+                                                     request.segment_id());
+    RandomRWFileOptions opts;
+    opts.mode = request.offset() == 0 ? Env::CREATE_OR_OPEN_WITH_TRUNCATE : Env::MUST_EXIST;
+    std::unique_ptr<RandomRWFile> file;
+    Status st = Env::Default()->new_random_rw_file(opts, path, &file);
+    if (st.ok()) {
+        // write the blocks of attachment directly, avoid flattening it
+        std::vector<Slice> slices;
+        slices.reserve(data.backing_block_num());
+        for (size_t i = 0; i < data.backing_block_num(); ++i) {
+            auto block = data.backing_block(i);
+            slices.emplace_back(block.data(), block.size());
+        }
+        st = file->writev_at(request.offset(), slices.data(), slices.size());
+    }
+    if (st.ok()) {
+        st = file->close();
+    }
+    if (!st.ok()) {
+        // master replica stops syncing this rowset to us after a failed chunk, the rowset
+        // will never be committed, let path gc remove its files.
+        _remove_pending_rowset(pending_id);
+    }
+    return st;
+}
+
+Status RowsetSyncHandler::_commit_rowset(const TabletSharedPtr& tablet,
+                                         const PTabletWriterSyncRowsetRequest& request) {
+    RowsetMetaSharedPtr rowset_meta(new RowsetMeta());
+    if (!rowset_meta->init_from_pb(request.rowset_meta())) {
+        return Status::Corruption("failed to parse rowset meta");
+    }
+    if (rowset_meta->rowset_type() != BETA_ROWSET) {
+        return Status::NotSupported("only beta rowset can be synced from master replica");
+    }
+    // tablet uid is different on every replica
+    rowset_meta->set_tablet_uid(tablet->tablet_uid());
+    const std::string pending_id = ROWSET_ID_PREFIX + rowset_meta->rowset_id().to_string();
+
+    RowsetSharedPtr rowset;
+    OLAPStatus res = RowsetFactory::create_rowset(&tablet->tablet_schema(), tablet->tablet_path(),
+                                                  rowset_meta, &rowset);
+    if (res == OLAP_SUCCESS) {
+        // check all segment files are received
+        res = rowset->load();
+    }
+    TxnManager* txn_mgr = _storage_engine->txn_manager();
+    if (res == OLAP_SUCCESS) {
+        MutexLock push_lock(tablet->get_push_lock());
+        res = txn_mgr->prepare_txn(request.partition_id(), tablet, request.txn_id(),
+                                   request.id());
+    }
+    if (res == OLAP_SUCCESS) {
+        res = txn_mgr->commit_txn(request.partition_id(), tablet, request.txn_id(), request.id(),
+                                  rowset, false);
+        if (res == OLAP_ERR_PUSH_TRANSACTION_ALREADY_EXIST) {
+            res = OLAP_SUCCESS;
+        }
+    }
+    _remove_pending_rowset(pending_id);
+    if (res != OLAP_SUCCESS) {
+        if (rowset != nullptr) {
+            txn_mgr->rollback_txn(request.partition_id(), tablet, request.txn_id());
+            _storage_engine->add_unused_rowset(rowset);
+        }
+        return Status::InternalError(strings::Substitute(
+                "failed to commit synced rowset, tablet_id=$0, txn_id=$1, rowset_id=$2, err=$3",
+                tablet->tablet_id(), request.txn_id(), rowset_meta->rowset_id().to_string(), res));
+    }
+    LOG(INFO) << "commit rowset synced from master replica, tablet_id=" << tablet->tablet_id()
+              << ", txn_id=" << request.txn_id() << ", rowset_id=" << rowset_meta->rowset_id();
+    return Status::OK();
+}
+
+void RowsetSyncHandler::_add_pending_rowset(DataDir* data_dir, const std::string& pending_id) {
+    std::lock_guard<std::mutex> l(_pending_lock);
+    auto it = _pending_rowsets.find(pending_id);
+    if (it == _pending_rowsets.end()) {
+        data_dir->add_pending_ids(pending_id);
+        it = _pending_rowsets.emplace(pending_id, PendingRowset{data_dir, 0}).first;
+    }
+    it->second.last_active_sec = MonotonicSeconds();
+}
+
+void RowsetSyncHandler::_remove_pending_rowset(const std::string& pending_id) {
+    std::lock_guard<std::mutex> l(_pending_lock);
+    auto it = _pending_rowsets.find(pending_id);
+    if (it == _pending_rowsets.end()) {
+        return;
+    }
+    it->second.data_dir->remove_pending_ids(pending_id);
+    _pending_rowsets.erase(it);
+}
+
+void RowsetSyncHandler::_expire_pending_rowsets() {
+    // the chunks of a rowset are sent one after another, each within the rpc timeout
+    const int64_t expire_sec =
+            MonotonicSeconds() - 2 * config::single_replica_load_sync_rpc_timeout_sec;
+    std::lock_guard<std::mutex> l(_pending_lock);
+    for (auto it = _pending_rowsets.begin(); it != _pending_rowsets.end();) {
+        if (it->second.last_active_sec < expire_sec) {
+            LOG(INFO) << "expire pending rowset synced from master replica: " << it->first;
+            it->second.data_dir->remove_pending_ids(it->first);
+            it = _pending_rowsets.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+RowsetSyncer::RowsetSyncer(BrpcStubCache* stub_cache, const TabletSharedPtr& tablet,
+                           const RowsetSharedPtr& rowset, const PUniqueId& load_id,
+                           int64_t txn_id, int64_t partition_id,
+                           const std::vector<PNodeInfo>& slave_nodes)
+        : _tablet(tablet), _rowset(rowset), _txn_id(txn_id), _slave_nodes(slave_nodes) {
+    for (auto& node : _slave_nodes) {
+        auto stub = stub_cache->get_stub(node.host(), node.async_internal_port());
+        _stubs.push_back(stub);
+        _slave_status.emplace_back(stub == nullptr ? Status::InternalError("get rpc stub failed")
+                                                   : Status::OK());
+    }
+    _closures.resize(_stubs.size(), nullptr);
+
+    _base_request.mutable_id()->CopyFrom(load_id);
+    _base_request.set_txn_id(txn_id);
+    _base_request.set_partition_id(partition_id);
+    _base_request.set_tablet_id(tablet->tablet_id());
+    _base_request.set_schema_hash(tablet->schema_hash());
+}
+
+RowsetSyncer::~RowsetSyncer() {
+    wait();
+}
+
+bool RowsetSyncer::send() {
+    if (_meta_sent) {
+        return false;
+    }
+    if (_seg_id < _rowset->num_segments()) {
+        Slice data;
+        Status st = _read_next_chunk(&data);
+        if (!st.ok()) {
+            LOG(WARNING) << "failed to read segment files of rowset " << _rowset->rowset_id()
+                         << ", tablet=" << _tablet->tablet_id() << ", err=" << st.to_string();
+            for (auto& slave_st : _slave_status) {
+                if (slave_st.ok()) {
+                    slave_st = st;
+                }
+            }
+            _meta_sent = true;
+            return false;
+        }
+        PTabletWriterSyncRowsetRequest request = _base_request;
+        request.set_rowset_id(_rowset->rowset_id().to_string());
+        request.set_segment_id(_seg_id);
+        request.set_offset(_offset);
+        _send_to_slaves(request, data);
+
+        _offset += data.size;
+        if (_offset >= _file_size) {
+            _file.reset();
+            _offset = 0;
+            ++_seg_id;
+        }
+        return true;
+    }
+
+    // commit the rowset on slaves
+    PTabletWriterSyncRowsetRequest request = _base_request;
+    _rowset->rowset_meta()->to_rowset_pb(request.mutable_rowset_meta());
+    _send_to_slaves(request, Slice());
+    _meta_sent = true;
+    return true;
+}
+
+Status RowsetSyncer::_read_next_chunk(Slice* data) {
+    if (_file == nullptr) {
+        std::string path = BetaRowset::segment_file_path(_tablet->tablet_path(),
+                                                         _rowset->rowset_id(), _seg_id);
+        RETURN_IF_ERROR(Env::Default()->new_random_access_file(path, &_file));
+        RETURN_IF_ERROR(_file->size(&_file_size));
+    }
+    // an empty segment file is sent as one empty chunk, so that slaves create it
+    const int64_t chunk_bytes = std::max<int64_t>(config::single_replica_load_sync_chunk_bytes, 1);
+    size_t len = std::min<uint64_t>(chunk_bytes, _file_size - _offset);
+    _buf.resize(len);
+    *data = Slice(_buf.data(), len);
+    return _file->read_at(_offset, *data);
+}
+
+void RowsetSyncer::_send_to_slaves(const PTabletWriterSyncRowsetRequest& request,
+                                   const Slice& data) {
+    for (size_t i = 0; i < _stubs.size(); ++i) {
+        if (!_slave_status[i].ok()) {
+            continue;
+        }
+        auto closure = new RefCountClosure<PTabletWriterSyncRowsetResult>();
+        // one for this object, one for rpc
+        closure->ref();
+        closure->ref();
+        closure->cntl.set_timeout_ms(config::single_replica_load_sync_rpc_timeout_sec * 1000);
+        if (data.size > 0) {
+            // the attachment owns a copy of 'data', the buffer is reused for next chunk
+            closure->cntl.request_attachment().append(data.data, data.size);
+        }
+        _stubs[i]->tablet_writer_sync_rowset(&closure->cntl, &request, &closure->result,
+                                             closure);
+        _closures[i] = closure;
+    }
+}
+
+void RowsetSyncer::wait() {
+    for (size_t i = 0; i < _closures.size(); ++i) {
+        auto closure = _closures[i];
+        if (closure == nullptr) {
+            continue;
+        }
+        closure->join();
+        if (closure->cntl.Failed()) {
+            _slave_status[i] = Status::InternalError(closure->cntl.ErrorText());
+        } else {
+            _slave_status[i] = Status(closure->result.status());
+        }
+        if (closure->unref()) {
+            delete closure;
+        }
+        _closures[i] = nullptr;
+    }
+}
+
+void RowsetSyncer::get_committed_tablets(
+        google::protobuf::RepeatedPtrField<PTabletInfo>* tablet_vec) {
+    for (size_t i = 0; i < _stubs.size(); ++i) {
+        auto& node = _slave_nodes[i];
+        if (!_meta_sent || !_slave_status[i].ok()) {
+            LOG(WARNING) << "failed to sync rowset to slave replica, tablet="
+                         << _tablet->tablet_id() << ", txn_id=" << _txn_id
+                         << ", node=" << node.host() << ":" << node.async_internal_port()
+                         << ", err=" << _slave_status[i].to_string();
+            continue;
+        }
+        PTabletInfo* tablet_info = tablet_vec->Add();
+        tablet_info->set_tablet_id(_tablet->tablet_id());
+        tablet_info->set_schema_hash(_tablet->schema_hash());
+        tablet_info->set_node_id(node.id());
+    }
+}
+
+} // namespace doris
@@ -0,0 +1,131 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_OLAP_ROWSET_SYNC_HANDLER_H
+#define DORIS_BE_SRC_OLAP_ROWSET_SYNC_HANDLER_H
+
+#include <butil/iobuf.h>
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "common/status.h"
+#include "env/env.h"
+#include "gen_cpp/internal_service.pb.h"
+#include "olap/rowset/rowset.h"
+#include "olap/tablet.h"
+#include "util/ref_count_closure.h"
+
+namespace doris {
+
+class BrpcStubCache;
+class DataDir;
+class StorageEngine;
+
+// Receives the rowset built by the master replica in single replica load.
+// The master sends every segment file chunk by chunk, then sends the rowset
+// meta, at which point the rowset is committed to the txn of local tablet,
+// just like it is written by a DeltaWriter.
+class RowsetSyncHandler {
+public:
+    RowsetSyncHandler(StorageEngine* storage_engine) : _storage_engine(storage_engine) {}
+
+    // 'data' is the content of segment file chunk, empty if the request carries rowset meta.
+    Status process(const PTabletWriterSyncRowsetRequest& request, const butil::IOBuf& data);
+
+private:
+    Status _write_segment_chunk(const TabletSharedPtr& tablet,
+                                const PTabletWriterSyncRowsetRequest& request,
+                                const butil::IOBuf& data);
+
+    Status _commit_rowset(const TabletSharedPtr& tablet,
+                          const PTabletWriterSyncRowsetRequest& request);
+
+    // Protects the files of rowset 'pending_id' from path gc until it is committed,
+    // the rowset id is added to the pending ids of 'data_dir' only once.
+    static void _add_pending_rowset(DataDir* data_dir, const std::string& pending_id);
+    static void _remove_pending_rowset(const std::string& pending_id);
+    // Removes the pending rowsets which have not received any chunk for a long time,
+    // whose master replica has failed or given up syncing them.
+    static void _expire_pending_rowsets();
+
+    StorageEngine* _storage_engine;
+
+    struct PendingRowset {
+        DataDir* data_dir;
+        int64_t last_active_sec;
+    };
+    static std::mutex _pending_lock;
+    // pending rowset id -> its data dir and the time its last chunk is received
+    static std::map<std::string, PendingRowset> _pending_rowsets;
+};
+
+// Sends the rowset committed on the master replica to slave replicas in single replica
+// load, see RowsetSyncHandler for the receiving side. send() starts the rpcs of one
+// request to all slaves and returns without waiting for them, so that the rowsets of
+// several tablets can be synced in parallel.
+//
+// Not thread-safe.
+class RowsetSyncer {
+public:
+    RowsetSyncer(BrpcStubCache* stub_cache, const TabletSharedPtr& tablet,
+                 const RowsetSharedPtr& rowset,
+                 const PUniqueId& load_id, int64_t txn_id, int64_t partition_id,
+                 const std::vector<PNodeInfo>& slave_nodes);
+
+    // Waits for the rpcs in flight.
+    ~RowsetSyncer();
+
+    // Starts the rpcs of the next segment file chunk or, after all of them, of the rowset
+    // meta. Returns false if there is nothing left to send.
+    bool send();
+
+    // Waits for the rpcs started by the last send().
+    void wait();
+
+    // Adds the tablets committed on slaves successfully to 'tablet_vec'.
+    void get_committed_tablets(google::protobuf::RepeatedPtrField<PTabletInfo>* tablet_vec);
+
+private:
+    void _send_to_slaves(const PTabletWriterSyncRowsetRequest& request, const Slice& data);
+
+    // Reads the next chunk of current segment file into '_buf', opening the file first
+    // if it is not opened yet.
+    Status _read_next_chunk(Slice* data);
+
+    TabletSharedPtr _tablet;
+    RowsetSharedPtr _rowset;
+    int64_t _txn_id;
+    std::vector<PNodeInfo> _slave_nodes;
+
+    std::vector<PBackendService_Stub*> _stubs;
+    std::vector<Status> _slave_status;
+    std::vector<RefCountClosure<PTabletWriterSyncRowsetResult>*> _closures;
+    PTabletWriterSyncRowsetRequest _base_request;
+
+    int _seg_id = 0;
+    uint64_t _offset = 0;
+    std::unique_ptr<RandomAccessFile> _file;
+    uint64_t _file_size = 0;
+    std::string _buf;
+    bool _meta_sent = false;
+};
+
+} // namespace doris
+
+#endif // DORIS_BE_SRC_OLAP_ROWSET_SYNC_HANDLER_H
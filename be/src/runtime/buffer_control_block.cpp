@@ -19,6 +19,7 @@
 
 #include "gen_cpp/PaloInternalService_types.h"
 #include "gen_cpp/internal_service.pb.h"
+#include "runtime/pipeline_scheduler.h"
 #include "runtime/raw_value.h"
 #include "service/brpc.h"
 #include "util/thrift_util.h"
@@ -92,6 +93,7 @@ Status BufferControlBlock::add_batch(TFetchDataResult* result) {
     int num_rows = result->result_batch.rows.size();
 
     while ((!_batch_queue.empty() && (num_rows + _buffer_rows) > _buffer_limit) && !_is_cancelled) {
+        PipelineScheduler::BlockingScope blocking;
         _data_removal.wait(l);
     }
 
@@ -113,6 +115,11 @@ Status BufferControlBlock::add_batch(TFetchDataResult* result) {
     return Status::OK();
 }
 
+bool BufferControlBlock::can_add_batch() {
+    boost::unique_lock<boost::mutex> l(_lock);
+    return _is_cancelled || _batch_queue.empty() || _buffer_rows < _buffer_limit;
+}
+
 Status BufferControlBlock::get_batch(TFetchDataResult* result) {
     TFetchDataResult* item = NULL;
     {
@@ -148,6 +155,7 @@ Status BufferControlBlock::get_batch(TFetchDataResult* result) {
         _batch_queue.pop_front();
         _buffer_rows -= item->result_batch.rows.size();
         _data_removal.notify_one();
+        PipelineScheduler::notify_blocked_tasks();
     }
     *result = *item;
     result->__set_packet_num(_packet_num);
@@ -175,6 +183,7 @@ void BufferControlBlock::get_batch(GetResultBatchCtx* ctx) {
         _batch_queue.pop_front();
         _buffer_rows -= result->result_batch.rows.size();
         _data_removal.notify_one();
+        PipelineScheduler::notify_blocked_tasks();
 
         ctx->on_data(result, _packet_num);
         _packet_num++;
@@ -219,6 +228,7 @@ Status BufferControlBlock::cancel() {
     _is_cancelled = true;
     _data_removal.notify_all();
     _data_arrival.notify_all();
+    PipelineScheduler::notify_blocked_tasks();
     for (auto& ctx : _waiting_rpc) {
         ctx->on_failure(Status::Cancelled("Cancelled"));
     }
@@ -64,6 +64,8 @@ public:
 
     Status init();
     Status add_batch(TFetchDataResult* result);
+    // Returns true if add_batch() would not wait for the client to fetch results.
+    bool can_add_batch();
 
     // get result from batch, use timeout?
     Status get_batch(TFetchDataResult* result);
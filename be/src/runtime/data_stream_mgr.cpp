@@ -17,11 +17,14 @@
 
 #include "runtime/data_stream_mgr.h"
 
+#include <butil/iobuf.h>
+
 #include <boost/functional/hash.hpp>
 #include <boost/thread/locks.hpp>
 #include <boost/thread/thread.hpp>
 #include <iostream>
 
+#include "common/config.h"
 #include "gen_cpp/BackendService.h"
 #include "gen_cpp/PaloInternalService_types.h"
 #include "gen_cpp/types.pb.h" // PUniqueId
@@ -30,6 +33,7 @@
 #include "runtime/row_batch.h"
 #include "runtime/runtime_state.h"
 #include "util/doris_metrics.h"
+#include "util/threadpool.h"
 #include "util/uid_util.h"
 
 namespace doris {
@@ -44,6 +48,17 @@ using boost::try_mutex;
 using boost::lock_guard;
 
 DataStreamMgr::DataStreamMgr() {
+    // the pool defaults to one thread per core
+    ThreadPoolBuilder builder("ExchangeMergeThreadPool");
+    builder.set_min_threads(0);
+    if (config::exchange_merge_thread_num > 0) {
+        builder.set_max_threads(config::exchange_merge_thread_num);
+    }
+    Status status = builder.build(&_merge_thread_pool);
+    if (!status.ok()) {
+        LOG(WARNING) << "failed to create the exchange merge thread pool: "
+                     << status.get_error_msg();
+    }
     REGISTER_HOOK_METRIC(data_stream_receiver_count, [this]() {
         lock_guard<mutex> l(_lock);
         return _receiver_map.size();
@@ -55,6 +70,9 @@ DataStreamMgr::DataStreamMgr() {
 }
 
 DataStreamMgr::~DataStreamMgr() {
+    if (_merge_thread_pool) {
+        _merge_thread_pool->shutdown();
+    }
     DEREGISTER_HOOK_METRIC(data_stream_receiver_count);
     DEREGISTER_HOOK_METRIC(fragment_endpoint_count);
 }
@@ -110,6 +128,8 @@ shared_ptr<DataStreamRecvr> DataStreamMgr::find_recvr(const TUniqueId& fragment_
 }
 
 Status DataStreamMgr::transmit_data(const PTransmitDataParams* request,
+                                    const butil::IOBuf* attachment,
+                                    PTransmitDataResult* response,
                                     ::google::protobuf::Closure** done) {
     const PUniqueId& finst_id = request->finst_id();
     TUniqueId t_finst_id;
@@ -136,9 +156,19 @@ Status DataStreamMgr::transmit_data(const PTransmitDataParams* request,
 
     bool eos = request->eos();
     if (request->has_row_batch()) {
-        recvr->add_batch(request->row_batch(), request->sender_id(), request->be_number(),
-                         request->packet_seq(), eos ? nullptr : done);
+        const butil::IOBuf* tuple_data = request->transfer_by_attachment() ? attachment : nullptr;
+        Status st = recvr->add_batch(request->row_batch(), tuple_data, request->sender_id(),
+                                     request->be_number(), request->packet_seq(),
+                                     eos ? nullptr : done);
+        if (!st.ok()) {
+            // fail the sender, the receiver cannot make up for the lost batch
+            st.to_protobuf(response->mutable_status());
+            return st;
+        }
     }
+    // the response may be sent later when the closure is deferred, the credit is taken
+    // now and therefore errs on the low side
+    response->set_credit_bytes(recvr->sender_credit_bytes());
 
     if (eos) {
         recvr->remove_sender(request->sender_id(), request->be_number());
@@ -146,6 +176,47 @@ Status DataStreamMgr::transmit_data(const PTransmitDataParams* request,
     return Status::OK();
 }
 
+Status DataStreamMgr::transmit_data_batch(const PTransmitDataBatchParams* request,
+                                          const butil::IOBuf* attachment,
+                                          PTransmitDataBatchResult* response) {
+    if (request->attachment_sizes_size() != request->params_size()) {
+        return Status::InvalidArgument("the attachment sizes do not match the packets");
+    }
+    // The response is never deferred, it would hold back the acks of the other packets,
+    // whose receivers may wait for the receivers of this one. A packet whose receiver
+    // would defer its ack is refused instead, and the sender sends it again in an rpc of
+    // its own.
+    butil::IOBuf remaining(*attachment);
+    for (int i = 0; i < request->params_size(); ++i) {
+        const PTransmitDataParams& params = request->params(i);
+        butil::IOBuf packet_attachment;
+        remaining.cutn(&packet_attachment, request->attachment_sizes(i));
+        PTransmitDataResult* result = response->add_results();
+        if (params.has_row_batch() && !params.eos()) {
+            TUniqueId finst_id;
+            finst_id.hi = params.finst_id().hi();
+            finst_id.lo = params.finst_id().lo();
+            shared_ptr<DataStreamRecvr> recvr = find_recvr(finst_id, params.node_id());
+            int64_t batch_size = RowBatch::get_batch_size(params.row_batch());
+            if (params.transfer_by_attachment()) {
+                batch_size += packet_attachment.size();
+            }
+            // an empty receiver takes any batch, like add_batch() does
+            if (recvr != nullptr && recvr->_num_buffered_bytes > 0 &&
+                recvr->exceeds_limit(batch_size)) {
+                result->set_resend(true);
+                continue;
+            }
+        }
+        Status st = transmit_data(&params, &packet_attachment, result, nullptr);
+        if (!st.ok()) {
+            LOG(WARNING) << "transmit_data failed, fragment_instance_id="
+                         << print_id(params.finst_id()) << ", error=" << st.get_error_msg();
+        }
+    }
+    return Status::OK();
+}
+
 Status DataStreamMgr::deregister_recvr(const TUniqueId& fragment_instance_id, PlanNodeId node_id) {
     boost::shared_ptr<DataStreamRecvr> targert_recvr;
     VLOG_QUERY << "deregister_recvr(): fragment_instance_id=" << fragment_instance_id
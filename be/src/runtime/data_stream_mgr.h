@@ -24,6 +24,7 @@
 #include <boost/unordered_map.hpp>
 #include <boost/unordered_set.hpp>
 #include <list>
+#include <memory>
 #include <set>
 
 #include "common/object_pool.h"
@@ -41,6 +42,10 @@ class Closure;
 }
 } // namespace google
 
+namespace butil {
+class IOBuf;
+}
+
 namespace doris {
 
 class DescriptorTbl;
@@ -49,6 +54,7 @@ class RowBatch;
 class RuntimeState;
 class PRowBatch;
 class PUniqueId;
+class ThreadPool;
 
 // Singleton class which manages all incoming data streams at a backend node. It
 // provides both producer and consumer functionality for each data stream.
@@ -81,14 +87,37 @@ public:
             int buffer_size, RuntimeProfile* profile, bool is_merging,
             std::shared_ptr<QueryStatisticsRecvr> sub_plan_query_statistics_recvr);
 
-    Status transmit_data(const PTransmitDataParams* request, ::google::protobuf::Closure** done);
+    // 'attachment' is the attachment of the rpc, it holds the tuple data of the row batch
+    // if request->transfer_by_attachment() is set. The credit of the sender is set in
+    // 'response'.
+    Status transmit_data(const PTransmitDataParams* request, const butil::IOBuf* attachment,
+                         PTransmitDataResult* response, ::google::protobuf::Closure** done);
+
+    // Hands each packet of a multiplexed rpc to transmit_data(), with its part of the
+    // attachment. Never defers the response: a packet whose receiver is full is not taken
+    // but marked to be resent in its result.
+    Status transmit_data_batch(const PTransmitDataBatchParams* request,
+                               const butil::IOBuf* attachment, PTransmitDataBatchResult* response);
 
     // Closes all receivers registered for fragment_instance_id immediately.
     void cancel(const TUniqueId& fragment_instance_id);
 
+    // Returns the receiver for a sender running on this backend, which bypasses
+    // transmit_data(). NULL if the receiver has already been closed.
+    boost::shared_ptr<DataStreamRecvr> find_local_recvr(const TUniqueId& fragment_instance_id,
+                                                        PlanNodeId node_id) {
+        return find_recvr(fragment_instance_id, node_id);
+    }
+
+    // The pool pre-merging the groups of senders of the merging receivers, NULL if it
+    // could not be created, in which case the receivers merge the groups themselves.
+    ThreadPool* merge_thread_pool() { return _merge_thread_pool.get(); }
+
 private:
     friend class DataStreamRecvr;
 
+    std::unique_ptr<ThreadPool> _merge_thread_pool;
+
     // protects all fields below
     boost::mutex _lock;
 
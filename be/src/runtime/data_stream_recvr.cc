@@ -17,21 +17,30 @@
 
 #include "runtime/data_stream_recvr.h"
 
+#include <butil/iobuf.h>
 #include <google/protobuf/stubs/common.h>
 
+#include <atomic>
 #include <boost/thread/locks.hpp>
 #include <boost/thread/mutex.hpp>
+#include <condition_variable>
 #include <deque>
+#include <map>
 #include <unordered_map>
 #include <unordered_set>
 
+#include "common/config.h"
 #include "gen_cpp/data.pb.h"
 #include "runtime/data_stream_mgr.h"
+#include "runtime/pipeline_scheduler.h"
 #include "runtime/row_batch.h"
+#include "runtime/runtime_state.h"
 #include "runtime/sorted_run_merger.h"
+#include "util/blocking_queue.hpp"
 #include "util/debug_util.h"
 #include "util/logging.h"
 #include "util/runtime_profile.h"
+#include "util/threadpool.h"
 
 using std::list;
 using std::vector;
@@ -70,8 +79,16 @@ public:
     // blocks if this will make the stream exceed its buffer limit.
     // If the total size of the batches in this queue would exceed the allowed buffer size,
     // the queue is considered full and the call blocks until a batch is dequeued.
-    void add_batch(const PRowBatch& pb_batch, int be_number, int64_t packet_seq,
-                   ::google::protobuf::Closure** done);
+    // Returns an error if the batch cannot be deserialized.
+    Status add_batch(const PRowBatch& pb_batch, const butil::IOBuf* tuple_data, int be_number,
+                     int64_t packet_seq, ::google::protobuf::Closure** done);
+
+    // Adds the rows of 'batch' to this sender queue. Moves them and their memory out of
+    // 'batch' if 'transfer' is true, otherwise deep copies them. Like add_batch(), never
+    // blocks, but takes '*done' and delays it while the buffer limit is exceeded. Returns
+    // the bytes of the rows added.
+    int add_local_batch(RowBatch* batch, int be_number, bool transfer,
+                        ::google::protobuf::Closure** done);
 
     // Decrement the number of remaining senders for this queue and signal eos ("new data")
     // if the count drops to 0. The number of senders will be 1 for a merging
@@ -85,6 +102,12 @@ public:
     // Must be called once to cleanup any queued resources.
     void close();
 
+    // Returns true if get_batch() would return without waiting.
+    bool is_data_ready() {
+        lock_guard<mutex> l(_lock);
+        return _is_cancelled || !_batch_queue.empty() || _num_remaining_senders <= 0;
+    }
+
     // Returns the current batch from this queue being processed by a consumer.
     RowBatch* current_batch() const {
         { return _current_batch.get(); }
@@ -125,6 +148,9 @@ private:
 
     std::unordered_set<int> _sender_eos_set;          // sender_id
     std::unordered_map<int, int64_t> _packet_seq_map; // be_number => packet_seq
+    // be_number => (packet_seq => (batch length, batch)), batches which arrived before
+    // the packets preceding them. Counted in the buffered bytes of the receiver.
+    std::unordered_map<int, std::map<int64_t, pair<int, RowBatch*>>> _early_batches;
 
     std::deque<std::pair<google::protobuf::Closure*, MonotonicStopWatch>> _pending_closures;
 };
@@ -142,6 +168,7 @@ Status DataStreamRecvr::SenderQueue::get_batch(RowBatch** next_batch) {
     while (!_is_cancelled && _batch_queue.empty() && _num_remaining_senders > 0) {
         VLOG_ROW << "wait arrival fragment_instance_id=" << _recvr->fragment_instance_id()
                  << " node=" << _recvr->dest_node_id();
+        PipelineScheduler::BlockingScope blocking;
         // Don't count time spent waiting on the sender as active time.
         CANCEL_SAFE_SCOPED_TIMER(_recvr->_data_arrival_timer, &_is_cancelled);
         CANCEL_SAFE_SCOPED_TIMER(
@@ -185,26 +212,29 @@ Status DataStreamRecvr::SenderQueue::get_batch(RowBatch** next_batch) {
     return Status::OK();
 }
 
-void DataStreamRecvr::SenderQueue::add_batch(const PRowBatch& pb_batch, int be_number,
-                                             int64_t packet_seq,
-                                             ::google::protobuf::Closure** done) {
+Status DataStreamRecvr::SenderQueue::add_batch(const PRowBatch& pb_batch,
+                                               const butil::IOBuf* tuple_data, int be_number,
+                                               int64_t packet_seq,
+                                               ::google::protobuf::Closure** done) {
     unique_lock<mutex> l(_lock);
     if (_is_cancelled) {
-        return;
+        return Status::OK();
     }
+    // A sender keeps several rpcs in flight, so a packet may arrive before the ones sent
+    // earlier. Packets of a sender are numbered from 0.
     auto iter = _packet_seq_map.find(be_number);
-    if (iter != _packet_seq_map.end()) {
-        if (iter->second >= packet_seq) {
-            LOG(WARNING) << "packet already exist [cur_packet_id= " << iter->second
-                         << " receive_packet_id=" << packet_seq << "]";
-            return;
-        }
-        iter->second = packet_seq;
-    } else {
-        _packet_seq_map.emplace(be_number, packet_seq);
+    int64_t last_seq = iter == _packet_seq_map.end() ? -1 : iter->second;
+    auto& early_batches = _early_batches[be_number];
+    if (packet_seq <= last_seq || early_batches.count(packet_seq) > 0) {
+        LOG(WARNING) << "packet already exist [cur_packet_id= " << last_seq
+                     << " receive_packet_id=" << packet_seq << "]";
+        return Status::OK();
     }
 
     int batch_size = RowBatch::get_batch_size(pb_batch);
+    if (tuple_data != nullptr) {
+        batch_size += tuple_data->size();
+    }
     COUNTER_UPDATE(_recvr->_bytes_received_counter, batch_size);
 
     // Following situation will match the following condition.
@@ -215,7 +245,7 @@ void DataStreamRecvr::SenderQueue::add_batch(const PRowBatch& pb_batch, int be_n
     // DCHECK_GT(_num_remaining_senders, 0);
     if (_num_remaining_senders <= 0) {
         DCHECK(_sender_eos_set.end() != _sender_eos_set.find(be_number));
-        return;
+        return Status::OK();
     }
 
     // We always accept the batch regardless of buffer limit, to avoid rpc pipeline stall.
@@ -230,20 +260,37 @@ void DataStreamRecvr::SenderQueue::add_batch(const PRowBatch& pb_batch, int be_n
     //  if the merger is waiting for data from an empty queue that cannot be filled
     //  because the limit has been reached.
     if (_is_cancelled) {
-        return;
+        return Status::OK();
     }
 
     RowBatch* batch = NULL;
     {
         SCOPED_TIMER(_recvr->_deserialize_row_batch_timer);
-        // Note: if this function makes a row batch, the batch *must* be added
-        // to _batch_queue. It is not valid to create the row batch and destroy
-        // it in this thread.
-        batch = new RowBatch(_recvr->row_desc(), pb_batch, _recvr->mem_tracker().get());
+        std::unique_ptr<RowBatch> new_batch;
+        Status st = RowBatch::create(_recvr->row_desc(), pb_batch, tuple_data,
+                                     _recvr->mem_tracker().get(), &new_batch);
+        if (!st.ok()) {
+            LOG(WARNING) << "failed to deserialize a row batch of packet " << packet_seq
+                         << " from be " << be_number << ": " << st.get_error_msg();
+            return st;
+        }
+        batch = new_batch.release();
     }
 
     VLOG_ROW << "added #rows=" << batch->num_rows() << " batch_size=" << batch_size << "\n";
-    _batch_queue.emplace_back(batch_size, batch);
+    if (packet_seq > last_seq + 1) {
+        // hold it back until the packets before it arrived
+        early_batches.emplace(packet_seq, std::make_pair(batch_size, batch));
+    } else {
+        _batch_queue.emplace_back(batch_size, batch);
+        last_seq = packet_seq;
+        while (!early_batches.empty() && early_batches.begin()->first == last_seq + 1) {
+            _batch_queue.push_back(early_batches.begin()->second);
+            early_batches.erase(early_batches.begin());
+            ++last_seq;
+        }
+        _packet_seq_map[be_number] = last_seq;
+    }
     // if done is nullptr, this function can't delay this response
     if (done != nullptr && _recvr->exceeds_limit(batch_size)) {
         MonotonicStopWatch monotonicStopWatch;
@@ -254,6 +301,49 @@ void DataStreamRecvr::SenderQueue::add_batch(const PRowBatch& pb_batch, int be_n
     }
     _recvr->_num_buffered_bytes += batch_size;
     _data_arrival_cv.notify_one();
+    PipelineScheduler::notify_blocked_tasks();
+    return Status::OK();
+}
+
+int DataStreamRecvr::SenderQueue::add_local_batch(RowBatch* batch, int be_number,
+                                                  bool transfer,
+                                                  ::google::protobuf::Closure** done) {
+    unique_lock<mutex> l(_lock);
+    // The mem tracker of the receiver is valid as long as it is not cancelled.
+    if (_is_cancelled || _num_remaining_senders <= 0 ||
+        _sender_eos_set.end() != _sender_eos_set.find(be_number)) {
+        return 0;
+    }
+
+    RowBatch* local_batch = nullptr;
+    // acquire_state() swaps the tuple pointers of 'batch' only if they were malloc'ed,
+    // otherwise they belong to its tuple data pool and 'batch' could not be reused.
+    if (transfer && config::enable_partitioned_aggregation) {
+        local_batch = new RowBatch(_recvr->row_desc(), batch->capacity(),
+                                   _recvr->mem_tracker().get());
+        local_batch->acquire_state(batch);
+    } else {
+        local_batch = new RowBatch(_recvr->row_desc(), batch->num_rows(),
+                                   _recvr->mem_tracker().get());
+        batch->deep_copy_to(local_batch);
+    }
+    int batch_size = local_batch->total_byte_size();
+    COUNTER_UPDATE(_recvr->_bytes_received_counter, batch_size);
+
+    VLOG_ROW << "added local #rows=" << local_batch->num_rows() << " batch_size=" << batch_size;
+    _batch_queue.emplace_back(batch_size, local_batch);
+    // same as add_batch(), the sender waits for 'done' before it sends the next batch
+    if (done != nullptr && _recvr->exceeds_limit(batch_size)) {
+        MonotonicStopWatch monotonicStopWatch;
+        monotonicStopWatch.start();
+        DCHECK(*done != nullptr);
+        _pending_closures.emplace_back(*done, monotonicStopWatch);
+        *done = nullptr;
+    }
+    _recvr->_num_buffered_bytes += batch_size;
+    _data_arrival_cv.notify_one();
+    PipelineScheduler::notify_blocked_tasks();
+    return batch_size;
 }
 
 void DataStreamRecvr::SenderQueue::decrement_senders(int be_number) {
@@ -268,6 +358,7 @@ void DataStreamRecvr::SenderQueue::decrement_senders(int be_number) {
               << " node_id=" << _recvr->dest_node_id() << " #senders=" << _num_remaining_senders;
     if (_num_remaining_senders == 0) {
         _data_arrival_cv.notify_one();
+        PipelineScheduler::notify_blocked_tasks();
     }
 }
 
@@ -285,6 +376,7 @@ void DataStreamRecvr::SenderQueue::cancel() {
     // notice that the stream is cancelled and handle it.
     _data_arrival_cv.notify_all();
     // _data_removal_cv.notify_all();
+    PipelineScheduler::notify_blocked_tasks();
     // PeriodicCounterUpdater::StopTimeSeriesCounter(
     //         _recvr->_bytes_received_time_series_counter);
 
@@ -315,10 +407,254 @@ void DataStreamRecvr::SenderQueue::close() {
     for (RowBatchQueue::iterator it = _batch_queue.begin(); it != _batch_queue.end(); ++it) {
         delete it->second;
     }
+    for (auto& sender_batches : _early_batches) {
+        for (auto& batch : sender_batches.second) {
+            delete batch.second.second;
+        }
+    }
+    _early_batches.clear();
 
     _current_batch.reset();
 }
 
+// Pre-merges the streams of a group of senders into a queue of sorted batches read by the
+// merger of the receiver. The rows are deep copied, so the merger does not hold the
+// batches of the sender queues, which the group replaces.
+// The group runs as a task of the merge thread pool of the DataStreamMgr, which is shared
+// by all the receivers of the backend. If no thread of the pool has picked the task up
+// when the receiver asks for the first batch of the group, the receiver merges the group
+// on its own thread instead, so a busy pool delays the pre-merge but never the query.
+class DataStreamRecvr::MergeGroup {
+public:
+    MergeGroup(DataStreamRecvr* recvr, const std::vector<SenderQueue*>& sender_queues)
+            : _recvr(recvr),
+              _sender_queues(sender_queues),
+              _state(NULL),
+              _output_batches(MAX_OUTPUT_BATCHES),
+              _run_state(PENDING) {}
+
+    ~MergeGroup() { close(); }
+
+    // Clones the sort exprs for the group and submits it to 'thread_pool'. The group holds
+    // a reference to itself in the task, so a task which starts after close() does not
+    // touch freed memory.
+    static Status start(const std::shared_ptr<MergeGroup>& group, ThreadPool* thread_pool,
+                        RuntimeState* state, const SortExecExprs& sort_exprs,
+                        const std::vector<bool>& is_asc, const std::vector<bool>& nulls_first,
+                        RuntimeProfile* profile) {
+        group->_state = state;
+        RETURN_IF_ERROR(Expr::clone_if_not_exists(sort_exprs.lhs_ordering_expr_ctxs(), state,
+                                                  &group->_lhs_ordering_expr_ctxs));
+        RETURN_IF_ERROR(Expr::clone_if_not_exists(sort_exprs.rhs_ordering_expr_ctxs(), state,
+                                                  &group->_rhs_ordering_expr_ctxs));
+        TupleRowComparator less_than(group->_lhs_ordering_expr_ctxs,
+                                     group->_rhs_ordering_expr_ctxs, is_asc, nulls_first);
+        group->_merger.reset(
+                new SortedRunMerger(less_than, &group->_recvr->_row_desc, profile, true));
+        if (thread_pool == NULL) {
+            return Status::OK();
+        }
+        Status status = thread_pool->submit_func([group]() { group->_run(); });
+        if (!status.ok()) {
+            // the receiver merges the group itself
+            LOG(WARNING) << "failed to submit a merge group: " << status.get_error_msg();
+        }
+        return Status::OK();
+    }
+
+    // Returns the next merged batch, NULL at the end of the stream. The batch is owned by
+    // the group until the next call, like SenderQueue::get_batch().
+    Status get_batch(RowBatch** next_batch) {
+        _current_batch.reset();
+        *next_batch = NULL;
+        bool is_inline = false;
+        {
+            std::lock_guard<std::mutex> l(_run_lock);
+            if (_run_state == PENDING) {
+                _run_state = INLINE;
+            }
+            is_inline = _run_state == INLINE;
+        }
+        if (is_inline) {
+            if (_inline_eos) {
+                return Status::OK();
+            }
+            std::unique_ptr<RowBatch> batch;
+            RETURN_IF_ERROR(_merge_next(&batch));
+            if (batch == NULL) {
+                _inline_eos = true;
+                return Status::OK();
+            }
+            _current_batch = std::move(batch);
+            *next_batch = _current_batch.get();
+            return Status::OK();
+        }
+
+        RowBatch* batch = NULL;
+        bool has_batch = false;
+        {
+            PipelineScheduler::BlockingScope blocking;
+            has_batch = _output_batches.blocking_get(&batch);
+        }
+        if (!has_batch) {
+            std::lock_guard<std::mutex> l(_run_lock);
+            return _status;
+        }
+        _current_batch.reset(batch);
+        *next_batch = batch;
+        return Status::OK();
+    }
+
+    // Returns true if get_batch() would return without waiting. Conservative for a group
+    // merged by the receiver, which may need more than one batch of a sender.
+    bool is_data_ready() {
+        {
+            std::lock_guard<std::mutex> l(_run_lock);
+            if (_run_state == FINISHED) {
+                return true;
+            }
+            if (_run_state == RUNNING) {
+                return _output_batches.get_size() > 0;
+            }
+        }
+        if (_inline_eos) {
+            return true;
+        }
+        for (SenderQueue* queue : _sender_queues) {
+            if (!queue->is_data_ready()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    RowBatch* current_batch() const { return _current_batch.get(); }
+
+    // Stops the group. A task still running must be woken up, i.e. the sender queues
+    // must have been cancelled if it may wait on them.
+    void close() {
+        _output_batches.shutdown();
+        {
+            std::unique_lock<std::mutex> l(_run_lock);
+            if (_run_state == PENDING) {
+                _run_state = CLOSED;
+            }
+            while (_run_state == RUNNING) {
+                _run_cv.wait(l);
+            }
+        }
+        RowBatch* batch = NULL;
+        while (_output_batches.blocking_get(&batch)) {
+            delete batch;
+        }
+        _current_batch.reset();
+        _merger.reset();
+        if (_state != NULL) {
+            Expr::close(_lhs_ordering_expr_ctxs, _state);
+            Expr::close(_rhs_ordering_expr_ctxs, _state);
+            _state = NULL;
+        }
+    }
+
+private:
+    // Bounds the memory held by the merged batches the receiver has not consumed yet.
+    static const int MAX_OUTPUT_BATCHES = 2;
+
+    enum RunState {
+        // submitted, neither the pool nor the receiver merges the group yet
+        PENDING,
+        // merged by a thread of the pool into _output_batches
+        RUNNING,
+        // merged by the receiver in get_batch()
+        INLINE,
+        // the task of the pool is done
+        FINISHED,
+        // closed before anyone merged the group
+        CLOSED
+    };
+
+    // Merges the next batch of rows, sets 'batch' to NULL at the end of the stream.
+    Status _merge_next(std::unique_ptr<RowBatch>* batch) {
+        batch->reset();
+        if (!_prepared) {
+            std::vector<SortedRunMerger::RunBatchSupplier> input_batch_suppliers;
+            for (SenderQueue* queue : _sender_queues) {
+                input_batch_suppliers.push_back(
+                        bind(mem_fn(&SenderQueue::get_batch), queue, _1));
+            }
+            _prepared = true;
+            RETURN_IF_ERROR(_merger->prepare(input_batch_suppliers));
+        }
+        bool eos = false;
+        while (!eos) {
+            std::unique_ptr<RowBatch> next(new RowBatch(
+                    _recvr->_row_desc, _state->batch_size(), _recvr->_mem_tracker.get()));
+            RETURN_IF_ERROR(_merger->get_next(next.get(), &eos));
+            if (next->num_rows() > 0) {
+                *batch = std::move(next);
+                return Status::OK();
+            }
+        }
+        return Status::OK();
+    }
+
+    // The task run by the pool.
+    void _run() {
+        {
+            std::lock_guard<std::mutex> l(_run_lock);
+            if (_run_state != PENDING) {
+                // merged by the receiver, or closed
+                return;
+            }
+            _run_state = RUNNING;
+        }
+        Status status;
+        while (true) {
+            std::unique_ptr<RowBatch> batch;
+            status = _merge_next(&batch);
+            if (!status.ok() || batch == NULL) {
+                break;
+            }
+            if (!_output_batches.blocking_put(batch.get())) {
+                // closed by the receiver
+                break;
+            }
+            batch.release();
+        }
+        {
+            std::lock_guard<std::mutex> l(_run_lock);
+            _status = status;
+            _run_state = FINISHED;
+            _output_batches.shutdown();
+        }
+        _run_cv.notify_all();
+    }
+
+    DataStreamRecvr* _recvr;
+    std::vector<SenderQueue*> _sender_queues;
+    RuntimeState* _state;
+
+    // the clones of the sort exprs evaluated by the group
+    std::vector<ExprContext*> _lhs_ordering_expr_ctxs;
+    std::vector<ExprContext*> _rhs_ordering_expr_ctxs;
+    boost::scoped_ptr<SortedRunMerger> _merger;
+    // whether _merger has been prepared, by whoever merges the group
+    bool _prepared = false;
+    // whether the receiver merged the group to the end, only used in INLINE
+    bool _inline_eos = false;
+
+    BlockingQueue<RowBatch*> _output_batches;
+    // the batch most recently returned by get_batch()
+    std::unique_ptr<RowBatch> _current_batch;
+
+    // protects _run_state and _status
+    std::mutex _run_lock;
+    std::condition_variable _run_cv;
+    RunState _run_state;
+    // the status the task of the pool finished with
+    Status _status;
+};
+
 Status DataStreamRecvr::create_merger(const TupleRowComparator& less_than) {
     DCHECK(_is_merging);
     vector<SortedRunMerger::RunBatchSupplier> input_batch_suppliers;
@@ -335,7 +671,48 @@ Status DataStreamRecvr::create_merger(const TupleRowComparator& less_than) {
     return Status::OK();
 }
 
+Status DataStreamRecvr::create_merger(RuntimeState* state, const SortExecExprs& sort_exprs,
+                                      const std::vector<bool>& is_asc,
+                                      const std::vector<bool>& nulls_first) {
+    DCHECK(_is_merging);
+    TupleRowComparator less_than(sort_exprs, is_asc, nulls_first);
+    int fan_in = config::exchange_merge_fan_in;
+    if (fan_in <= 1 || _sender_queues.size() <= fan_in) {
+        return create_merger(less_than);
+    }
+
+    // groups of at most 'fan_in' senders, as even as possible
+    int num_groups = (_sender_queues.size() + fan_in - 1) / fan_in;
+    RuntimeProfile* pre_merge_profile = _profile->create_child("PreMerge");
+    vector<SortedRunMerger::RunBatchSupplier> input_batch_suppliers;
+    input_batch_suppliers.reserve(num_groups);
+    for (int i = 0; i < num_groups; ++i) {
+        vector<SenderQueue*> sender_queues;
+        for (int j = i; j < _sender_queues.size(); j += num_groups) {
+            sender_queues.push_back(_sender_queues[j]);
+        }
+        std::shared_ptr<MergeGroup> group(new MergeGroup(this, sender_queues));
+        _merge_groups.push_back(group);
+        RETURN_IF_ERROR(MergeGroup::start(group, _mgr->merge_thread_pool(), state, sort_exprs,
+                                          is_asc, nulls_first, pre_merge_profile));
+        input_batch_suppliers.push_back(bind(mem_fn(&MergeGroup::get_batch), group.get(), _1));
+    }
+
+    _merger.reset(new SortedRunMerger(less_than, &_row_desc, _profile, false));
+    RETURN_IF_ERROR(_merger->prepare(input_batch_suppliers));
+    return Status::OK();
+}
+
 void DataStreamRecvr::transfer_all_resources(RowBatch* transfer_batch) {
+    if (!_merge_groups.empty()) {
+        // the sender queues are read by the groups
+        for (auto& group : _merge_groups) {
+            if (group->current_batch() != NULL) {
+                group->current_batch()->transfer_resource_ownership(transfer_batch);
+            }
+        }
+        return;
+    }
     BOOST_FOREACH (SenderQueue* sender_queue, _sender_queues) {
         if (sender_queue->current_batch() != NULL) {
             sender_queue->current_batch()->transfer_resource_ownership(transfer_batch);
@@ -354,6 +731,7 @@ DataStreamRecvr::DataStreamRecvr(
           _dest_node_id(dest_node_id),
           _total_buffer_limit(total_buffer_limit),
           _row_desc(row_desc),
+          _num_senders(std::max(num_senders, 1)),
           _is_merging(is_merging),
           _num_buffered_bytes(0),
           _profile(profile),
@@ -385,11 +763,19 @@ Status DataStreamRecvr::get_next(RowBatch* output_batch, bool* eos) {
     return _merger->get_next(output_batch, eos);
 }
 
-void DataStreamRecvr::add_batch(const PRowBatch& batch, int sender_id, int be_number,
-                                int64_t packet_seq, ::google::protobuf::Closure** done) {
+Status DataStreamRecvr::add_batch(const PRowBatch& batch, const butil::IOBuf* tuple_data,
+                                  int sender_id, int be_number, int64_t packet_seq,
+                                  ::google::protobuf::Closure** done) {
     int use_sender_id = _is_merging ? sender_id : 0;
     // Add all batches to the same queue if _is_merging is false.
-    _sender_queues[use_sender_id]->add_batch(batch, be_number, packet_seq, done);
+    return _sender_queues[use_sender_id]->add_batch(batch, tuple_data, be_number, packet_seq,
+                                                    done);
+}
+
+int DataStreamRecvr::add_local_batch(RowBatch* batch, int sender_id, int be_number,
+                                     bool transfer, ::google::protobuf::Closure** done) {
+    int use_sender_id = _is_merging ? sender_id : 0;
+    return _sender_queues[use_sender_id]->add_local_batch(batch, be_number, transfer, done);
 }
 
 void DataStreamRecvr::remove_sender(int sender_id, int be_number) {
@@ -404,6 +790,14 @@ void DataStreamRecvr::cancel_stream() {
 }
 
 void DataStreamRecvr::close() {
+    if (!_merge_groups.empty()) {
+        // wake up the groups which still wait on the senders
+        cancel_stream();
+        for (auto& group : _merge_groups) {
+            group->close();
+        }
+        _merge_groups.clear();
+    }
     for (int i = 0; i < _sender_queues.size(); ++i) {
         _sender_queues[i]->close();
     }
@@ -420,6 +814,23 @@ DataStreamRecvr::~DataStreamRecvr() {
     DCHECK(_mgr == NULL) << "Must call close()";
 }
 
+bool DataStreamRecvr::is_data_ready() {
+    if (!_merge_groups.empty()) {
+        for (auto& group : _merge_groups) {
+            if (!group->is_data_ready()) {
+                return false;
+            }
+        }
+        return true;
+    }
+    for (auto queue : _sender_queues) {
+        if (!queue->is_data_ready()) {
+            return false;
+        }
+    }
+    return true;
+}
+
 Status DataStreamRecvr::get_batch(RowBatch** next_batch) {
     DCHECK(!_is_merging);
     DCHECK_EQ(_sender_queues.size(), 1);
@@ -18,8 +18,10 @@
 #ifndef DORIS_BE_SRC_RUNTIME_DATA_STREAM_RECVR_H
 #define DORIS_BE_SRC_RUNTIME_DATA_STREAM_RECVR_H
 
+#include <algorithm>
 #include <boost/scoped_ptr.hpp>
 #include <boost/thread/mutex.hpp>
+#include <memory>
 
 #include "common/object_pool.h"
 #include "common/status.h"
@@ -34,6 +36,10 @@ class Closure;
 }
 } // namespace google
 
+namespace butil {
+class IOBuf;
+}
+
 namespace doris {
 
 class DataStreamMgr;
@@ -41,6 +47,8 @@ class SortedRunMerger;
 class MemTracker;
 class RowBatch;
 class RuntimeProfile;
+class RuntimeState;
+class SortExecExprs;
 class PRowBatch;
 
 // Single receiver of an m:n data stream.
@@ -64,6 +72,10 @@ class PRowBatch;
 // The receiver sets deep_copy to false on the merger - resources are transferred from
 // the input batches from each sender queue to the merger to the output batch by the
 // merger itself as it processes each run.
+// With more senders than config::exchange_merge_fan_in, the merger created by
+// create_merger(RuntimeState*, ...) does not read the sender queues itself. Groups of
+// senders are pre-merged on a thread pool shared by the receivers of the backend, as soon
+// as their batches arrive, and the merger only merges the outputs of the groups.
 //
 // DataStreamRecvr::close() must be called by the caller of CreateRecvr() to remove the
 // recvr instance from the tracking structure of its DataStreamMgr in all cases.
@@ -79,6 +91,10 @@ public:
     // Refactor so both merging and non-merging exchange use get_next(RowBatch*, bool* eos).
     Status get_batch(RowBatch** next_batch);
 
+    // Returns true if get_batch() or get_next() would not block, i.e. every sender queue
+    // has a batch or is finished. For a merging receiver this is conservative.
+    bool is_data_ready();
+
     // Deregister from DataStreamMgr instance, which shares ownership of this instance.
     void close();
 
@@ -87,6 +103,12 @@ public:
     // queues. The exprs used in less_than must have already been prepared and opened.
     Status create_merger(const TupleRowComparator& less_than);
 
+    // Same as above, but pre-merges groups of senders in parallel if there are more than
+    // config::exchange_merge_fan_in of them. 'sort_exprs' must have already been opened,
+    // every group evaluates its own clone of them.
+    Status create_merger(RuntimeState* state, const SortExecExprs& sort_exprs,
+                         const std::vector<bool>& is_asc, const std::vector<bool>& nulls_first);
+
     // Fill output_batch with the next batch of rows obtained by merging the per-sender
     // input streams. Must only be called if _is_merging is true.
     Status get_next(RowBatch* output_batch, bool* eos);
@@ -104,9 +126,24 @@ public:
         _sub_plan_query_statistics_recvr->insert(statistics, sender_id);
     }
 
+    // Adds a batch from a sender fragment instance running on this backend, which skips
+    // the serialization of the rpc path. If 'transfer' is true, the rows and their memory
+    // are moved out of 'batch' without copying, otherwise they are deep copied. Either way
+    // the sender may reuse 'batch' once this returns. Never blocks: while the buffer limit
+    // is exceeded, '*done' is taken and run later, the way the ack of a remote sender's
+    // rpc is delayed. If '*done' is not taken, the caller must run it. Returns the bytes of
+    // the rows added, 0 if the stream is cancelled or the sender is done.
+    int add_local_batch(RowBatch* batch, int sender_id, int be_number, bool transfer,
+                         ::google::protobuf::Closure** done);
+
+    // Indicate that a particular sender is done. Delegated to the appropriate
+    // sender queue. Called from DataStreamMgr and from local senders.
+    void remove_sender(int sender_id, int be_number);
+
 private:
     friend class DataStreamMgr;
     class SenderQueue;
+    class MergeGroup;
 
     DataStreamRecvr(DataStreamMgr* stream_mgr, const std::shared_ptr<MemTracker>& parent_tracker,
                     const RowDescriptor& row_desc, const TUniqueId& fragment_instance_id,
@@ -114,13 +151,11 @@ private:
                     int total_buffer_limit, RuntimeProfile* profile,
                     std::shared_ptr<QueryStatisticsRecvr> sub_plan_query_statistics_recvr);
 
-    // If receive queue is full, done is enqueue pending, and return with *done is nullptr
-    void add_batch(const PRowBatch& batch, int sender_id, int be_number, int64_t packet_seq,
-                   ::google::protobuf::Closure** done);
-
-    // Indicate that a particular sender is done. Delegated to the appropriate
-    // sender queue. Called from DataStreamMgr.
-    void remove_sender(int sender_id, int be_number);
+    // If receive queue is full, done is enqueue pending, and return with *done is nullptr.
+    // If tuple_data is not nullptr, it holds the tuple data of batch. Returns an error if
+    // the batch cannot be deserialized, the batch is dropped then.
+    Status add_batch(const PRowBatch& batch, const butil::IOBuf* tuple_data, int sender_id,
+                     int be_number, int64_t packet_seq, ::google::protobuf::Closure** done);
 
     // Empties the sender queues and notifies all waiting consumers of cancellation.
     void cancel_stream();
@@ -131,6 +166,12 @@ private:
         return _num_buffered_bytes + batch_size > _total_buffer_limit;
     }
 
+    // Returns the bytes a sender may have in flight, its share of the free buffer.
+    int64_t sender_credit_bytes() {
+        int64_t free_bytes = _total_buffer_limit - _num_buffered_bytes;
+        return std::max<int64_t>(free_bytes, 0) / _num_senders;
+    }
+
     // DataStreamMgr instance used to create this recvr. (Not owned)
     DataStreamMgr* _mgr;
 
@@ -146,6 +187,9 @@ private:
     // Row schema, copied from the caller of CreateRecvr().
     RowDescriptor _row_desc;
 
+    // Number of senders of this stream.
+    int _num_senders;
+
     // True if this reciver merges incoming rows from different senders. Per-sender
     // row batch queues are maintained in this case.
     bool _is_merging;
@@ -165,6 +209,10 @@ private:
     // SortedRunMerger used to merge rows from different senders.
     boost::scoped_ptr<SortedRunMerger> _merger;
 
+    // Groups of sender queues pre-merged on the merge thread pool of _mgr, empty if
+    // _merger reads the sender queues directly.
+    std::vector<std::shared_ptr<MergeGroup>> _merge_groups;
+
     // Pool of sender queues.
     ObjectPool _sender_queue_pool;
 
@@ -20,10 +20,17 @@
 #include <arpa/inet.h>
 #include <thrift/protocol/TDebugProtocol.h>
 
+#include <atomic>
+#include <boost/algorithm/string.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/thread/thread.hpp>
+#include <condition_variable>
+#include <deque>
 #include <iostream>
+#include <limits>
+#include <mutex>
 
+#include "common/config.h"
 #include "common/logging.h"
 #include "exprs/expr.h"
 #include "gen_cpp/BackendService.h"
@@ -33,8 +40,11 @@
 #include "runtime/client_cache.h"
 #include "runtime/descriptors.h"
 #include "runtime/dpp_sink_internal.h"
+#include "runtime/exchange_stream.h"
 #include "runtime/exec_env.h"
 #include "runtime/mem_tracker.h"
+#include "runtime/pipeline_scheduler.h"
+#include "runtime/plan_fragment_executor.h"
 #include "runtime/raw_value.h"
 #include "runtime/row_batch.h"
 #include "runtime/runtime_state.h"
@@ -50,13 +60,70 @@
 
 namespace doris {
 
+// The closure of a transmit_data rpc. Wakes up the fragments that wait on the pipeline
+// scheduler for the rpc to finish.
+class TransmitDataClosure : public RefCountClosure<PTransmitDataResult> {
+public:
+    void Run() override {
+        RefCountClosure<PTransmitDataResult>::Run();
+        PipelineScheduler::notify_blocked_tasks();
+    }
+};
+
+// The ack of a batch handed to a receiver on this backend. The receiver delays it while
+// its buffer is full, the same as the closure of a transmit_data rpc, and the sender
+// waits for it before it hands over the next batch. The sender and the receiver hold one
+// reference each.
+class LocalAckClosure : public google::protobuf::Closure {
+public:
+    LocalAckClosure() : _refs(2), _acked(false) {}
+
+    // If unref() returns true, this object should be delete
+    bool unref() { return _refs.fetch_sub(1) == 1; }
+
+    void Run() override {
+        {
+            std::lock_guard<std::mutex> l(_lock);
+            _acked = true;
+        }
+        _acked_cv.notify_all();
+        PipelineScheduler::notify_blocked_tasks();
+        if (unref()) {
+            delete this;
+        }
+    }
+
+    bool is_acked() const { return _acked.load(); }
+
+    void wait() {
+        if (is_acked()) {
+            return;
+        }
+        PipelineScheduler::BlockingScope blocking;
+        std::unique_lock<std::mutex> l(_lock);
+        while (!_acked) {
+            _acked_cv.wait(l);
+        }
+    }
+
+private:
+    std::atomic<int> _refs;
+    std::atomic<bool> _acked;
+    std::mutex _lock;
+    std::condition_variable _acked_cv;
+};
+
 // A channel sends data asynchronously via calls to transmit_data
 // to a single destination ipaddress/node.
 // It has a fixed-capacity buffer and allows the caller either to add rows to
 // that buffer individually (AddRow()), or circumvent the buffer altogether and send
-// TRowBatches directly (SendBatch()). Either way, there can only be one in-flight RPC
-// at any one time (ie, sending will block if the most recent rpc hasn't finished,
-// which allows the receiver node to throttle the sender by withholding acks).
+// TRowBatches directly (SendBatch()). Either way, up to
+// config::exchange_max_in_flight_rpcs rpcs may be in flight, as long as their batches fit
+// into the credit granted by the receiver with each response (ie, sending will block until
+// the oldest rpc has finished, which allows the receiver node to throttle the sender by
+// withholding acks and credits).
+// With config::enable_exchange_multiplexing, the packets go through the ExchangeStream
+// the channels of the query to the same backend share, instead of rpcs of their own.
 // *Not* thread-safe.
 class DataStreamSender::Channel {
 public:
@@ -81,8 +148,13 @@ public:
               _send_query_statistics_with_every_batch(send_query_statistics_with_every_batch) {}
 
     virtual ~Channel() {
-        if (_closure != nullptr && _closure->unref()) {
-            delete _closure;
+        if (_local_ack != nullptr && _local_ack->unref()) {
+            delete _local_ack;
+        }
+        for (auto& rpc : _in_flight_rpcs) {
+            if (rpc.closure != nullptr && rpc.closure->unref()) {
+                delete rpc.closure;
+            }
         }
         // release this before request desctruct
         _brpc_request.release_finst_id();
@@ -95,13 +167,26 @@ public:
     // Copies a single row into this channel's output buffer and flushes buffer
     // if it reaches capacity.
     // Returns error status if any of the preceding rpcs failed, OK otherwise.
-    Status add_row(TupleRow* row);
+    Status add_row(TupleRow* row) { return add_rows(&row, 1); }
+
+    // Copies 'num_rows' rows into this channel's output buffer, like add_row().
+    Status add_rows(TupleRow** rows, int num_rows);
 
     // Asynchronously sends a row batch.
     // Returns the status of the most recently finished transmit_data
     // rpc (or OK if there wasn't one that hasn't been reported yet).
-    // if batch is nullptr, send the eof packet
-    Status send_batch(PRowBatch* batch, bool eos = false);
+    // if batch is nullptr, send the eof packet. if tuple_data is not nullptr, it holds
+    // the tuple data of batch and is sent as attachment.
+    Status send_batch(PRowBatch* batch, const butil::IOBuf* tuple_data, bool eos = false);
+
+    // Hands a row batch to the receiver on this backend without serializing it, only
+    // valid if is_local(). Moves the rows out of batch if transfer is true, which needs
+    // batch to own the memory of its rows, otherwise the receiver copies them. Waits for
+    // the ack of the previous batch first. if batch is nullptr, only send the eos
+    Status send_local_batch(RowBatch* batch, bool transfer, bool eos = false);
+
+    // Returns true if the receiver runs on this backend.
+    bool is_local() const { return _is_local; }
 
     // Flush buffered rows and close channel. This function don't wait the response
     // of close operation, client should call close_wait() to finish channel's close.
@@ -116,6 +201,10 @@ public:
 
     PRowBatch* pb_batch() { return &_pb_batch; }
 
+    // where to serialize the tuple data of pb_batch(), nullptr if it is not sent as
+    // attachment
+    butil::IOBuf* tuple_data() { return _parent->_transfer_by_attachment ? &_tuple_data : nullptr; }
+
     std::string get_fragment_instance_id_str() {
         UniqueId uid(_fragment_instance_id);
         return uid.to_string();
@@ -123,21 +212,52 @@ public:
 
     TUniqueId get_fragment_instance_id() { return _fragment_instance_id; }
 
+    // Returns true if sending another batch would wait for an rpc in flight.
+    bool is_rpc_running() const {
+        if (_is_local) {
+            return _local_ack != nullptr && !_local_ack->is_acked();
+        }
+        // send_batch() releases the finished rpcs at the head of the window first
+        bool running = !_in_flight_rpcs.empty() &&
+                       _in_flight_rpcs.front().is_running() && _is_window_full(0);
+        if (running && _stream != nullptr) {
+            // the caller waits for the packets without waiting on the stream, send them
+            _stream->flush();
+        }
+        return running;
+    }
+
 private:
-    inline Status _wait_last_brpc() {
-        auto cntl = &_closure->cntl;
-        brpc::Join(cntl->call_id());
-        if (cntl->Failed()) {
-            std::stringstream ss;
-            ss << "failed to send brpc batch, error=" << berror(cntl->ErrorCode())
-               << ", error_text=" << cntl->ErrorText()
-               << ", client: " << BackendOptions::get_localhost();
-            LOG(WARNING) << ss.str();
-            return Status::ThriftRpcError(ss.str());
+    // An rpc of this channel, or a packet of this channel multiplexed by _stream.
+    struct InFlightRpc {
+        RefCountClosure<PTransmitDataResult>* closure;
+        std::shared_ptr<ExchangePacket> packet;
+        int64_t bytes;
+
+        bool is_running() const {
+            return closure != nullptr ? closure->is_rpc_running() : !packet->is_done();
+        }
+    };
+
+    // Waits for the oldest rpc in flight to finish and releases it.
+    Status _wait_oldest_rpc();
+
+    // Releases the finished rpcs at the head of the window without waiting.
+    Status _release_finished_rpcs() {
+        while (!_in_flight_rpcs.empty() && !_in_flight_rpcs.front().is_running()) {
+            RETURN_IF_ERROR(_wait_oldest_rpc());
         }
         return Status::OK();
     }
 
+    // Returns true if a batch of 'bytes' can not be sent before an rpc in flight finished.
+    // One rpc is always allowed, otherwise a batch larger than the credit never goes.
+    bool _is_window_full(int64_t bytes) const {
+        return !_in_flight_rpcs.empty() &&
+               (static_cast<int>(_in_flight_rpcs.size()) >= config::exchange_max_in_flight_rpcs ||
+                _in_flight_bytes + bytes > _credit_bytes);
+    }
+
 private:
     // Serialize _batch into _thrift_batch and send via send_batch().
     // Returns send_batch() status.
@@ -166,13 +286,25 @@ private:
     // TODO(zc): initused for brpc
     PUniqueId _finst_id;
     PRowBatch _pb_batch;
+    butil::IOBuf _tuple_data;
     PTransmitDataParams _brpc_request;
     PBackendService_Stub* _brpc_stub = nullptr;
-    RefCountClosure<PTransmitDataResult>* _closure = nullptr;
+    // rpcs in flight, oldest first
+    std::deque<InFlightRpc> _in_flight_rpcs;
+    int64_t _in_flight_bytes = 0;
+    // the bytes the receiver can take, granted by the response of the last finished rpc
+    int64_t _credit_bytes = std::numeric_limits<int64_t>::max();
     int32_t _brpc_timeout_ms = 500;
     // whether the dest can be treated as query statistics transfer chain.
     bool _is_transfer_chain;
     bool _send_query_statistics_with_every_batch;
+    // the dest is on this backend, batches are passed through the DataStreamMgr directly
+    bool _is_local = false;
+    // the ack of the last batch passed to a local dest, nullptr once it has been waited for
+    LocalAckClosure* _local_ack = nullptr;
+    // multiplexes the packets with the ones of the other channels of the query to the dest,
+    // nullptr if this channel sends rpcs of its own
+    std::shared_ptr<ExchangeStream> _stream;
 };
 
 Status DataStreamSender::Channel::init(RuntimeState* state) {
@@ -198,18 +330,66 @@ Status DataStreamSender::Channel::init(RuntimeState* state) {
 
     _brpc_timeout_ms = std::min(3600, state->query_options().query_timeout) * 1000;
     _brpc_stub = state->exec_env()->brpc_stub_cache()->get_stub(_brpc_dest_addr);
+    _is_local = config::enable_local_exchange &&
+                _brpc_dest_addr.hostname == BackendOptions::get_localhost() &&
+                _brpc_dest_addr.port == config::brpc_port;
+    if (!_is_local && config::enable_exchange_multiplexing &&
+        state->query_fragments_ctx() != nullptr) {
+        _stream = state->query_fragments_ctx()->get_exchange_stream(_brpc_dest_addr, _brpc_stub,
+                                                                    _brpc_timeout_ms);
+    }
 
     _need_close = true;
     return Status::OK();
 }
 
-Status DataStreamSender::Channel::send_batch(PRowBatch* batch, bool eos) {
-    if (_closure == nullptr) {
-        _closure = new RefCountClosure<PTransmitDataResult>();
-        _closure->ref();
-    } else {
-        RETURN_IF_ERROR(_wait_last_brpc());
-        _closure->cntl.Reset();
+Status DataStreamSender::Channel::_wait_oldest_rpc() {
+    InFlightRpc rpc = _in_flight_rpcs.front();
+    _in_flight_bytes -= rpc.bytes;
+    _in_flight_rpcs.pop_front();
+    if (rpc.packet != nullptr) {
+        _stream->wait(rpc.packet.get());
+        if (rpc.packet->status().ok() && rpc.packet->result().has_credit_bytes()) {
+            _credit_bytes = rpc.packet->result().credit_bytes();
+        }
+        return rpc.packet->status();
+    }
+    RefCountClosure<PTransmitDataResult>* closure = rpc.closure;
+    if (closure->is_rpc_running()) {
+        PipelineScheduler::BlockingScope blocking;
+        closure->join();
+    }
+    Status st = Status::OK();
+    if (closure->cntl.Failed()) {
+        std::stringstream ss;
+        ss << "failed to send brpc batch, error=" << berror(closure->cntl.ErrorCode())
+           << ", error_text=" << closure->cntl.ErrorText()
+           << ", client: " << BackendOptions::get_localhost();
+        LOG(WARNING) << ss.str();
+        st = Status::ThriftRpcError(ss.str());
+    } else if (closure->result.has_status()) {
+        st = Status(closure->result.status());
+    }
+    if (st.ok() && closure->result.has_credit_bytes()) {
+        _credit_bytes = closure->result.credit_bytes();
+    }
+    if (closure->unref()) {
+        delete closure;
+    }
+    return st;
+}
+
+Status DataStreamSender::Channel::send_batch(PRowBatch* batch, const butil::IOBuf* tuple_data,
+                                             bool eos) {
+    int64_t bytes = 0;
+    if (batch != nullptr) {
+        bytes = RowBatch::get_batch_size(*batch) + (tuple_data != nullptr ? tuple_data->size() : 0);
+    }
+    RETURN_IF_ERROR(_release_finished_rpcs());
+    // The receiver removes the sender on eos, so the eos packet must not overtake
+    // the batches in flight.
+    while (eos ? !_in_flight_rpcs.empty() : _is_window_full(bytes)) {
+        RETURN_IF_ERROR(_wait_oldest_rpc());
     }
     VLOG_ROW << "Channel::send_batch() instance_id=" << _fragment_instance_id
              << " dest_node=" << _dest_node_id;
@@ -222,56 +402,126 @@ Status DataStreamSender::Channel::send_batch(PRowBatch* batch, bool eos) {
     if (batch != nullptr) {
         _brpc_request.set_allocated_row_batch(batch);
     }
+    _brpc_request.set_transfer_by_attachment(batch != nullptr && tuple_data != nullptr);
     _brpc_request.set_packet_seq(_packet_seq++);
 
-    _closure->ref();
-    _closure->cntl.set_timeout_ms(_brpc_timeout_ms);
-    _brpc_stub->transmit_data(&_closure->cntl, &_brpc_request, &_closure->result, _closure);
+    // the request is copied or serialized before this returns, so it can be reused while
+    // the rpc is in flight
+    InFlightRpc rpc {nullptr, nullptr, bytes};
+    if (_stream != nullptr) {
+        rpc.packet = _stream->send(_brpc_request,
+                                   _brpc_request.transfer_by_attachment() ? tuple_data : nullptr);
+        _in_flight_rpcs.push_back(rpc);
+    } else {
+        rpc.closure = new TransmitDataClosure();
+        rpc.closure->ref();
+        // the attachment shares the blocks of tuple_data, no copy
+        if (_brpc_request.transfer_by_attachment()) {
+            rpc.closure->cntl.request_attachment().append(*tuple_data);
+        }
+        _in_flight_rpcs.push_back(rpc);
+        rpc.closure->ref();
+        rpc.closure->cntl.set_timeout_ms(_brpc_timeout_ms);
+        _brpc_stub->transmit_data(&rpc.closure->cntl, &_brpc_request, &rpc.closure->result,
+                                  rpc.closure);
+    }
+    _in_flight_bytes += bytes;
     if (batch != nullptr) {
         _brpc_request.release_row_batch();
     }
     return Status::OK();
 }
 
-Status DataStreamSender::Channel::add_row(TupleRow* row) {
-    if (_fragment_instance_id.lo == -1) {
+Status DataStreamSender::Channel::send_local_batch(RowBatch* batch, bool transfer, bool eos) {
+    DCHECK(_is_local);
+    VLOG_ROW << "Channel::send_local_batch() instance_id=" << _fragment_instance_id
+             << " dest_node=" << _dest_node_id;
+    boost::shared_ptr<DataStreamRecvr> recvr =
+            _parent->_state->exec_env()->stream_mgr()->find_local_recvr(_fragment_instance_id,
+                                                                        _dest_node_id);
+    if (recvr == nullptr) {
+        // the receiver has finished, e.g. it reached its limit, same as transmit_data()
         return Status::OK();
     }
-    int row_num = _batch->add_row();
-
-    if (row_num == RowBatch::INVALID_ROW_INDEX) {
-        // _batch is full, let's send it; but first wait for an ongoing
-        // transmission to finish before modifying _thrift_batch
-        RETURN_IF_ERROR(send_current_batch());
-        row_num = _batch->add_row();
-        DCHECK_NE(row_num, RowBatch::INVALID_ROW_INDEX);
+    if (_is_transfer_chain && (_send_query_statistics_with_every_batch || eos)) {
+        PQueryStatistics statistics;
+        _parent->_query_statistics->to_pb(&statistics);
+        recvr->add_sub_plan_statistics(statistics, _parent->_sender_id);
+    }
+    if (batch != nullptr && batch->num_rows() > 0) {
+        SCOPED_TIMER(_parent->_local_send_timer);
+        if (_local_ack != nullptr) {
+            _local_ack->wait();
+            if (_local_ack->unref()) {
+                delete _local_ack;
+            }
+            _local_ack = nullptr;
+        }
+        LocalAckClosure* ack = new LocalAckClosure();
+        google::protobuf::Closure* done = ack;
+        int bytes = recvr->add_local_batch(batch, _parent->_sender_id, _be_number, transfer,
+                                           &done);
+        if (done == nullptr) {
+            _local_ack = ack;
+        } else {
+            // acked at once, no one else refers to it
+            delete ack;
+        }
+        COUNTER_UPDATE(_parent->_bytes_sent_counter, bytes);
+        COUNTER_UPDATE(_parent->_uncompressed_bytes_counter, bytes);
+    }
+    if (eos) {
+        recvr->remove_sender(_parent->_sender_id, _be_number);
     }
+    return Status::OK();
+}
 
-    TupleRow* dest = _batch->get_row(row_num);
-    _batch->copy_row(row, dest);
+Status DataStreamSender::Channel::add_rows(TupleRow** rows, int num_rows) {
+    if (_fragment_instance_id.lo == -1) {
+        return Status::OK();
+    }
     const std::vector<TupleDescriptor*>& descs = _row_desc.tuple_descriptors();
+    int num_tuples = descs.size();
+    for (int i = 0; i < num_rows; ++i) {
+        int row_num = _batch->add_row();
+        if (row_num == RowBatch::INVALID_ROW_INDEX) {
+            // _batch is full, let's send it; but first wait for an ongoing
+            // transmission to finish before modifying _thrift_batch
+            RETURN_IF_ERROR(send_current_batch());
+            row_num = _batch->add_row();
+            DCHECK_NE(row_num, RowBatch::INVALID_ROW_INDEX);
+        }
 
-    for (int i = 0; i < descs.size(); ++i) {
-        if (UNLIKELY(row->get_tuple(i) == NULL)) {
-            dest->set_tuple(i, NULL);
-        } else {
-            dest->set_tuple(i, row->get_tuple(i)->deep_copy(*descs[i], _batch->tuple_data_pool()));
+        TupleRow* row = rows[i];
+        TupleRow* dest = _batch->get_row(row_num);
+        for (int j = 0; j < num_tuples; ++j) {
+            Tuple* tuple = row->get_tuple(j);
+            if (UNLIKELY(tuple == NULL)) {
+                dest->set_tuple(j, NULL);
+            } else {
+                dest->set_tuple(j, tuple->deep_copy(*descs[j], _batch->tuple_data_pool()));
+            }
         }
-    }
 
-    _batch->commit_last_row();
+        _batch->commit_last_row();
+        // the capacity of _batch only bounds the fixed-length part of the rows, bound the
+        // bytes as well
+        if (_batch->tuple_data_pool()->total_allocated_bytes() >= _buffer_size) {
+            RETURN_IF_ERROR(send_current_batch());
+        }
+    }
     return Status::OK();
 }
 
 Status DataStreamSender::Channel::send_current_batch(bool eos) {
-    {
-        SCOPED_TIMER(_parent->_serialize_batch_timer);
-        int uncompressed_bytes = _batch->serialize(&_pb_batch);
-        COUNTER_UPDATE(_parent->_bytes_sent_counter, RowBatch::get_batch_size(_pb_batch));
-        COUNTER_UPDATE(_parent->_uncompressed_bytes_counter, uncompressed_bytes);
+    if (_is_local) {
+        RETURN_IF_ERROR(send_local_batch(_batch.get(), true, eos));
+        _batch->reset();
+        return Status::OK();
     }
+    RETURN_IF_ERROR(_parent->serialize_batch(_batch.get(), &_pb_batch, tuple_data()));
     _batch->reset();
-    RETURN_IF_ERROR(send_batch(&_pb_batch, eos));
+    RETURN_IF_ERROR(send_batch(&_pb_batch, tuple_data(), eos));
     return Status::OK();
 }
 
@@ -284,8 +534,10 @@ Status DataStreamSender::Channel::close_internal() {
              << " #rows= " << ((_batch == nullptr) ? 0 : _batch->num_rows());
     if (_batch != NULL && _batch->num_rows() > 0) {
         RETURN_IF_ERROR(send_current_batch(true));
+    } else if (_is_local) {
+        RETURN_IF_ERROR(send_local_batch(nullptr, false, true));
     } else {
-        RETURN_IF_ERROR(send_batch(nullptr, true));
+        RETURN_IF_ERROR(send_batch(nullptr, nullptr, true));
     }
     // Don't wait for the last packet to finish, left it to close_wait.
     return Status::OK();
@@ -300,10 +552,19 @@ Status DataStreamSender::Channel::close(RuntimeState* state) {
 }
 
 Status DataStreamSender::Channel::close_wait(RuntimeState* state) {
-    if (_need_close) {
-        Status st = _wait_last_brpc();
-        if (!st.ok()) {
-            state->log_error(st.get_error_msg());
+    if (_need_close && _is_local) {
+        // the local batches are in the receiver already, their acks are not waited for
+        _need_close = false;
+    } else if (_need_close) {
+        Status st = Status::OK();
+        while (!_in_flight_rpcs.empty()) {
+            Status rpc_st = _wait_oldest_rpc();
+            if (!rpc_st.ok()) {
+                state->log_error(rpc_st.get_error_msg());
+                if (st.ok()) {
+                    st = rpc_st;
+                }
+            }
         }
         _need_close = false;
         return st;
@@ -324,6 +585,8 @@ DataStreamSender::DataStreamSender(ObjectPool* pool, int sender_id, const RowDes
           _part_type(sink.output_partition.type),
           _ignore_not_found(sink.__isset.ignore_not_found ? sink.ignore_not_found : true),
           _current_pb_batch(&_pb_batch1),
+          _compression_type(segment_v2::CompressionTypePB::NO_COMPRESSION),
+          _transfer_by_attachment(false),
           _profile(NULL),
           _serialize_batch_timer(NULL),
           _bytes_sent_counter(NULL),
@@ -357,6 +620,25 @@ DataStreamSender::DataStreamSender(ObjectPool* pool, int sender_id, const RowDes
     }
 }
 
+// Maps the value of the session variable fragment_transmission_compression_codec.
+static Status get_compression_type(const std::string& codec_name,
+                                   segment_v2::CompressionTypePB* type) {
+    std::string name = boost::algorithm::to_lower_copy(codec_name);
+    if (name == "none") {
+        *type = segment_v2::CompressionTypePB::NO_COMPRESSION;
+    } else if (name == "snappy") {
+        *type = segment_v2::CompressionTypePB::SNAPPY;
+    } else if (name == "lz4") {
+        *type = segment_v2::CompressionTypePB::LZ4;
+    } else if (name == "zstd") {
+        *type = segment_v2::CompressionTypePB::ZSTD;
+    } else {
+        return Status::InvalidArgument("unknown fragment transmission compression codec: " +
+                                       codec_name);
+    }
+    return Status::OK();
+}
+
 // We use the ParttitionRange to compare here. It should not be a member function of PartitionInfo
 // class becaurce there are some other member in it.
 static bool compare_part_use_range(const PartitionInfo* v1, const PartitionInfo* v2) {
@@ -414,6 +696,15 @@ Status DataStreamSender::prepare(RuntimeState* state) {
     _mem_tracker = MemTracker::CreateTracker(_profile, -1, "DataStreamSender",
                                              state->instance_mem_tracker());
 
+    if (state->query_options().__isset.fragment_transmission_compression_codec) {
+        RETURN_IF_ERROR(get_compression_type(
+                state->query_options().fragment_transmission_compression_codec,
+                &_compression_type));
+    } else if (config::compress_rowbatches) {
+        _compression_type = segment_v2::CompressionTypePB::SNAPPY;
+    }
+    _transfer_by_attachment = config::transfer_data_by_brpc_attachment;
+
     if (_part_type == TPartitionType::UNPARTITIONED || _part_type == TPartitionType::RANDOM) {
         // Randomize the order we open/transmit to channels to avoid thundering herd problems.
         srand(reinterpret_cast<uint64_t>(this));
@@ -432,6 +723,7 @@ Status DataStreamSender::prepare(RuntimeState* state) {
     _uncompressed_bytes_counter = ADD_COUNTER(profile(), "UncompressedRowBatchSize", TUnit::BYTES);
     _ignore_rows = ADD_COUNTER(profile(), "IgnoreRows", TUnit::UNIT);
     _serialize_batch_timer = ADD_TIMER(profile(), "SerializeBatchTime");
+    _local_send_timer = ADD_TIMER(profile(), "LocalSendTime");
     _overall_throughput = profile()->add_derived_counter(
             "OverallThroughput", TUnit::BYTES_PER_SECOND,
             boost::bind<int64_t>(&RuntimeProfile::units_per_second, _bytes_sent_counter,
@@ -459,59 +751,77 @@ Status DataStreamSender::open(RuntimeState* state) {
     return Status::OK();
 }
 
+bool DataStreamSender::can_send() {
+    for (auto channel : _channels) {
+        if (channel->is_rpc_running()) {
+            return false;
+        }
+    }
+    return true;
+}
+
 Status DataStreamSender::send(RuntimeState* state, RowBatch* batch) {
     SCOPED_TIMER(_profile->total_time_counter());
 
     // Unpartition or _channel size
     if (_part_type == TPartitionType::UNPARTITIONED || _channels.size() == 1) {
-        RETURN_IF_ERROR(serialize_batch(batch, _current_pb_batch, _channels.size()));
+        // serialize once for all the remote channels. The local ones copy the batch, its
+        // rows may point to memory of the child that it does not own.
+        int num_remote_channels = 0;
         for (auto channel : _channels) {
-            RETURN_IF_ERROR(channel->send_batch(_current_pb_batch));
+            if (channel->is_local()) {
+                RETURN_IF_ERROR(channel->send_local_batch(batch, false));
+            } else {
+                ++num_remote_channels;
+            }
+        }
+        if (num_remote_channels > 0) {
+            butil::IOBuf* tuple_data = _transfer_by_attachment ? &_tuple_data : nullptr;
+            RETURN_IF_ERROR(
+                    serialize_batch(batch, _current_pb_batch, tuple_data, num_remote_channels));
+            for (auto channel : _channels) {
+                if (!channel->is_local()) {
+                    RETURN_IF_ERROR(channel->send_batch(_current_pb_batch, tuple_data));
+                }
+            }
+            _current_pb_batch = (_current_pb_batch == &_pb_batch1 ? &_pb_batch2 : &_pb_batch1);
         }
-        _current_pb_batch = (_current_pb_batch == &_pb_batch1 ? &_pb_batch2 : &_pb_batch1);
     } else if (_part_type == TPartitionType::RANDOM) {
         // Round-robin batches among channels. Wait for the current channel to finish its
         // rpc before overwriting its batch.
         Channel* current_channel = _channels[_current_channel_idx];
-        RETURN_IF_ERROR(serialize_batch(batch, current_channel->pb_batch()));
-        RETURN_IF_ERROR(current_channel->send_batch(current_channel->pb_batch()));
+        if (current_channel->is_local()) {
+            RETURN_IF_ERROR(current_channel->send_local_batch(batch, false));
+        } else {
+            RETURN_IF_ERROR(serialize_batch(batch, current_channel->pb_batch(),
+                                            current_channel->tuple_data()));
+            RETURN_IF_ERROR(current_channel->send_batch(current_channel->pb_batch(),
+                                                        current_channel->tuple_data()));
+        }
         _current_channel_idx = (_current_channel_idx + 1) % _channels.size();
     } else if (_part_type == TPartitionType::HASH_PARTITIONED) {
         // hash-partition batch's rows across channels
         int num_channels = _channels.size();
-
-        for (int i = 0; i < batch->num_rows(); ++i) {
-            TupleRow* row = batch->get_row(i);
-            size_t hash_val = 0;
-
-            for (auto ctx : _partition_expr_ctxs) {
-                void* partition_val = ctx->get_value(row);
-                // We can't use the crc hash function here because it does not result
-                // in uncorrelated hashes with different seeds.  Instead we must use
-                // fvn hash.
-                // TODO: fix crc hash/GetHashValue()
-                hash_val =
-                        RawValue::get_hash_value_fvn(partition_val, ctx->root()->type(), hash_val);
-            }
-            auto target_channel_id = hash_val % num_channels;
-            RETURN_IF_ERROR(_channels[target_channel_id]->add_row(row));
+        // We can't use the crc hash function here because it does not result
+        // in uncorrelated hashes with different seeds.  Instead we must use
+        // fvn hash.
+        // TODO: fix crc hash/GetHashValue()
+        hash_partition_batch(batch, num_channels, true);
+        for (int i = 0; i < num_channels; ++i) {
+            int begin = _part_offsets[i];
+            RETURN_IF_ERROR(_channels[i]->add_rows(_part_rows.data() + begin,
+                                                   _part_offsets[i + 1] - begin));
         }
     } else if (_part_type == TPartitionType::BUCKET_SHFFULE_HASH_PARTITIONED) {
         // hash-partition batch's rows across channels
         int num_channels = _channel_shared_ptrs.size();
-
-        for (int i = 0; i < batch->num_rows(); ++i) {
-            TupleRow* row = batch->get_row(i);
-            size_t hash_val = 0;
-
-            for (auto ctx : _partition_expr_ctxs) {
-                void* partition_val = ctx->get_value(row);
-                // We must use the crc hash function to make sure the hash val equal
-                // to left table data distribute hash val
-                hash_val = RawValue::zlib_crc32(partition_val, ctx->root()->type(), hash_val);
-            }
-            auto target_channel_id = hash_val % num_channels;
-            RETURN_IF_ERROR(_channel_shared_ptrs[target_channel_id]->add_row(row));
+        // We must use the crc hash function to make sure the hash val equal
+        // to left table data distribute hash val
+        hash_partition_batch(batch, num_channels, false);
+        for (int i = 0; i < num_channels; ++i) {
+            int begin = _part_offsets[i];
+            RETURN_IF_ERROR(_channel_shared_ptrs[i]->add_rows(_part_rows.data() + begin,
+                                                              _part_offsets[i + 1] - begin));
         }
     } else {
         // Range partition
@@ -535,6 +845,44 @@ Status DataStreamSender::send(RuntimeState* state, RowBatch* batch) {
     return Status::OK();
 }
 
+void DataStreamSender::hash_partition_batch(RowBatch* batch, int num_channels, bool use_fvn) {
+    int num_rows = batch->num_rows();
+    _hash_vals.assign(num_rows, 0);
+    for (auto ctx : _partition_expr_ctxs) {
+        const TypeDescriptor& type = ctx->root()->type();
+        if (use_fvn) {
+            for (int i = 0; i < num_rows; ++i) {
+                void* partition_val = ctx->get_value(batch->get_row(i));
+                _hash_vals[i] = RawValue::get_hash_value_fvn(partition_val, type, _hash_vals[i]);
+            }
+        } else {
+            for (int i = 0; i < num_rows; ++i) {
+                void* partition_val = ctx->get_value(batch->get_row(i));
+                _hash_vals[i] = RawValue::zlib_crc32(partition_val, type, _hash_vals[i]);
+            }
+        }
+    }
+
+    // counting sort of the rows by channel, keeping their order within a channel
+    _part_offsets.assign(num_channels + 1, 0);
+    for (int i = 0; i < num_rows; ++i) {
+        _hash_vals[i] %= num_channels;
+        ++_part_offsets[_hash_vals[i] + 1];
+    }
+    for (int i = 0; i < num_channels; ++i) {
+        _part_offsets[i + 1] += _part_offsets[i];
+    }
+    // _part_offsets[i] is the insert position of channel i, which ends up at its end
+    _part_rows.resize(num_rows);
+    for (int i = 0; i < num_rows; ++i) {
+        _part_rows[_part_offsets[_hash_vals[i]]++] = batch->get_row(i);
+    }
+    for (int i = num_channels; i > 0; --i) {
+        _part_offsets[i] = _part_offsets[i - 1];
+    }
+    _part_offsets[0] = 0;
+}
+
 int DataStreamSender::binary_find_partition(const PartRangeKey& key) const {
     int low = 0;
     int high = _partition_infos.size() - 1;
@@ -656,8 +1004,8 @@ Status DataStreamSender::close(RuntimeState* state, Status exec_status) {
     return final_st;
 }
 
-template <typename T>
-Status DataStreamSender::serialize_batch(RowBatch* src, T* dest, int num_receivers) {
+Status DataStreamSender::serialize_batch(RowBatch* src, PRowBatch* dest, butil::IOBuf* tuple_data,
+                                         int num_receivers) {
     VLOG_ROW << "serializing " << src->num_rows() << " rows";
     {
         // TODO(zc)
@@ -665,8 +1013,14 @@ Status DataStreamSender::serialize_batch(RowBatch* src, T* dest, int num_receive
         SCOPED_TIMER(_serialize_batch_timer);
         // TODO(zc)
         // RETURN_IF_ERROR(src->serialize(dest));
-        int uncompressed_bytes = src->serialize(dest);
+        if (tuple_data != nullptr) {
+            tuple_data->clear();
+        }
+        int uncompressed_bytes = src->serialize(dest, _compression_type, tuple_data);
         int bytes = RowBatch::get_batch_size(*dest);
+        if (tuple_data != nullptr) {
+            bytes += tuple_data->size();
+        }
         // TODO(zc)
         // int uncompressed_bytes = bytes - dest->tuple_data.size() + dest->uncompressed_size;
         // The size output_batch would be if we didn't compress tuple_data (will be equal to
@@ -18,6 +18,8 @@
 #ifndef DORIS_BE_RUNTIME_DATA_STREAM_SENDER_H
 #define DORIS_BE_RUNTIME_DATA_STREAM_SENDER_H
 
+#include <butil/iobuf.h>
+
 #include <string>
 #include <vector>
 
@@ -26,6 +28,7 @@
 #include "common/status.h"
 #include "exec/data_sink.h"
 #include "gen_cpp/data.pb.h" // for PRowBatch
+#include "gen_cpp/segment_v2.pb.h"
 #include "util/runtime_profile.h"
 
 namespace doris {
@@ -79,15 +82,19 @@ public:
     // send() call).
     virtual Status send(RuntimeState* state, RowBatch* batch);
 
+    // Returns false while any channel still has an rpc in flight.
+    bool can_send() override;
+
     // Flush all buffered data and close all existing channels to destination
     // hosts. Further send() calls are illegal after calling close().
     virtual Status close(RuntimeState* state, Status exec_status);
 
-    /// Serializes the src batch into the dest thrift batch. Maintains metrics.
+    /// Serializes the src batch into the dest protobuf batch. Maintains metrics.
+    /// If tuple_data is not nullptr, the tuple data is put there to be sent as attachment.
     /// num_receivers is the number of receivers this batch will be sent to. Only
     /// used to maintain metrics.
-    template <class T>
-    Status serialize_batch(RowBatch* src, T* dest, int num_receivers = 1);
+    Status serialize_batch(RowBatch* src, PRowBatch* dest, butil::IOBuf* tuple_data,
+                           int num_receivers = 1);
 
     // Return total number of bytes sent in TRowBatch.data. If batches are
     // broadcast to multiple receivers, they are counted once per receiver.
@@ -108,6 +115,12 @@ private:
     Status process_distribute(RuntimeState* state, TupleRow* row, const PartitionInfo* part,
                               size_t* hash_val);
 
+    // Hash partitions the rows of 'batch' into 'num_channels' channels, with fnv hash if
+    // 'use_fvn' and with crc32 otherwise. The partition exprs are evaluated one at a time
+    // over the whole batch, then the rows are grouped by channel into _part_rows,
+    // the rows of channel i being _part_rows[_part_offsets[i], _part_offsets[i + 1]).
+    void hash_partition_batch(RowBatch* batch, int num_channels, bool use_fvn);
+
     // Sender instance id, unique within a fragment.
     int _sender_id;
 
@@ -128,8 +141,20 @@ private:
     PRowBatch _pb_batch1;
     PRowBatch _pb_batch2;
     PRowBatch* _current_pb_batch = nullptr;
+    // tuple data of the broadcast batch, only used if sent as attachment. The rpcs share
+    // its blocks, so it can be reused as soon as the batch is handed to all channels.
+    butil::IOBuf _tuple_data;
+
+    // codec of the tuple data, chosen per query
+    segment_v2::CompressionTypePB _compression_type;
+    // whether the tuple data is sent as brpc attachment
+    bool _transfer_by_attachment;
 
     std::vector<ExprContext*> _partition_expr_ctxs; // compute per-row partition values
+    // per batch state of hash_partition_batch(), kept to save allocations
+    std::vector<uint32_t> _hash_vals;
+    std::vector<int> _part_offsets;
+    std::vector<TupleRow*> _part_rows;
 
     std::vector<Channel*> _channels;
     std::vector<std::shared_ptr<Channel>> _channel_shared_ptrs;
@@ -143,6 +168,8 @@ private:
     RuntimeProfile::Counter* _bytes_sent_counter;
     RuntimeProfile::Counter* _uncompressed_bytes_counter;
     RuntimeProfile::Counter* _ignore_rows;
+    // time spent handing batches to receivers on this backend
+    RuntimeProfile::Counter* _local_send_timer;
 
     std::shared_ptr<MemTracker> _mem_tracker;
 
@@ -0,0 +1,183 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "runtime/exchange_stream.h"
+
+#include <google/protobuf/stubs/common.h>
+
+#include <sstream>
+
+#include "common/logging.h"
+#include "runtime/pipeline_scheduler.h"
+#include "service/backend_options.h"
+#include "service/brpc.h"
+#include "util/uid_util.h"
+
+namespace doris {
+
+// A transmit_data_batch rpc and its packets. Holds the stream, which the channels may
+// have released before the rpc finishes.
+class ExchangeStream::BatchClosure : public google::protobuf::Closure {
+public:
+    explicit BatchClosure(std::shared_ptr<ExchangeStream> stream) : stream(std::move(stream)) {}
+
+    void Run() override {
+        std::shared_ptr<ExchangeStream> holder = std::move(stream);
+        holder->_on_rpc_finished(this);
+        delete this;
+    }
+
+    std::shared_ptr<ExchangeStream> stream;
+    brpc::Controller cntl;
+    PTransmitDataBatchParams request;
+    PTransmitDataBatchResult result;
+    std::vector<std::shared_ptr<ExchangePacket>> packets;
+    // the attachment of each packet, they share the blocks of the one of the rpc
+    std::vector<butil::IOBuf> attachments;
+};
+
+// A transmit_data rpc resending a packet the receiver did not take in a batch.
+class ExchangeStream::PacketClosure : public google::protobuf::Closure {
+public:
+    explicit PacketClosure(std::shared_ptr<ExchangePacket> packet) : packet(std::move(packet)) {}
+
+    void Run() override {
+        _finish_packet(packet.get(), _rpc_status(cntl), &result);
+        PipelineScheduler::notify_blocked_tasks();
+        delete this;
+    }
+
+    std::shared_ptr<ExchangePacket> packet;
+    brpc::Controller cntl;
+    PTransmitDataParams request;
+    PTransmitDataResult result;
+};
+
+Status ExchangeStream::_rpc_status(const brpc::Controller& cntl) {
+    if (!cntl.Failed()) {
+        return Status::OK();
+    }
+    std::stringstream ss;
+    ss << "failed to send brpc batch, error=" << berror(cntl.ErrorCode())
+       << ", error_text=" << cntl.ErrorText() << ", client: " << BackendOptions::get_localhost();
+    LOG(WARNING) << ss.str();
+    return Status::ThriftRpcError(ss.str());
+}
+
+std::shared_ptr<ExchangePacket> ExchangeStream::send(const PTransmitDataParams& request,
+                                                     const butil::IOBuf* attachment) {
+    std::shared_ptr<ExchangePacket> packet(new ExchangePacket());
+    bool send_now = false;
+    {
+        std::lock_guard<std::mutex> l(_lock);
+        if (_queued == nullptr) {
+            _queued.reset(new BatchClosure(shared_from_this()));
+        }
+        _queued->request.add_params()->CopyFrom(request);
+        if (attachment != nullptr) {
+            _queued->request.add_attachment_sizes(attachment->size());
+            _queued->cntl.request_attachment().append(*attachment);
+            _queued->attachments.push_back(*attachment);
+        } else {
+            _queued->request.add_attachment_sizes(0);
+            _queued->attachments.emplace_back();
+        }
+        _queued->packets.push_back(packet);
+        send_now = _num_in_flight_rpcs == 0;
+    }
+    if (send_now) {
+        flush();
+    }
+    return packet;
+}
+
+void ExchangeStream::wait(ExchangePacket* packet) {
+    if (packet->is_done()) {
+        return;
+    }
+    flush();
+    PipelineScheduler::BlockingScope blocking;
+    packet->_done.wait();
+}
+
+void ExchangeStream::flush() {
+    BatchClosure* closure = nullptr;
+    {
+        std::lock_guard<std::mutex> l(_lock);
+        if (_queued == nullptr) {
+            return;
+        }
+        closure = _queued.release();
+        ++_num_in_flight_rpcs;
+    }
+    VLOG_ROW << "ExchangeStream sends #packets=" << closure->packets.size();
+    closure->cntl.set_timeout_ms(_timeout_ms);
+    // the stub may run the closure before it returns, do not hold the lock
+    _stub->transmit_data_batch(&closure->cntl, &closure->request, &closure->result, closure);
+}
+
+void ExchangeStream::_on_rpc_finished(BatchClosure* closure) {
+    Status status = _rpc_status(closure->cntl);
+    if (status.ok() && closure->result.results_size() != closure->packets.size()) {
+        status = Status::InternalError("the responses do not match the packets");
+    }
+    for (int i = 0; i < closure->packets.size(); ++i) {
+        if (status.ok() && closure->result.results(i).resend()) {
+            // the receiver is full, the response to an rpc of the packet alone may wait
+            _resend(closure->packets[i], closure->request.params(i), closure->attachments[i]);
+            continue;
+        }
+        _finish_packet(closure->packets[i].get(), status,
+                       status.ok() ? closure->result.mutable_results(i) : nullptr);
+    }
+    PipelineScheduler::notify_blocked_tasks();
+
+    bool send_queued = false;
+    {
+        std::lock_guard<std::mutex> l(_lock);
+        --_num_in_flight_rpcs;
+        send_queued = _queued != nullptr;
+    }
+    if (send_queued) {
+        flush();
+    }
+}
+
+void ExchangeStream::_finish_packet(ExchangePacket* packet, const Status& status,
+                                    PTransmitDataResult* result) {
+    packet->_status = status;
+    if (status.ok()) {
+        packet->_result.Swap(result);
+        if (packet->_result.has_status()) {
+            packet->_status = Status(packet->_result.status());
+        }
+    }
+    packet->_done.count_down();
+}
+
+void ExchangeStream::_resend(const std::shared_ptr<ExchangePacket>& packet,
+                             const PTransmitDataParams& request, const butil::IOBuf& attachment) {
+    VLOG_ROW << "ExchangeStream resends packet " << request.packet_seq() << " of instance "
+             << print_id(request.finst_id());
+    PacketClosure* closure = new PacketClosure(packet);
+    closure->request.CopyFrom(request);
+    closure->cntl.request_attachment().append(attachment);
+    closure->cntl.set_timeout_ms(_timeout_ms);
+    _stub->transmit_data(&closure->cntl, &closure->request, &closure->result, closure);
+}
+
+} // namespace doris
@@ -0,0 +1,116 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_RUNTIME_EXCHANGE_STREAM_H
+#define DORIS_BE_RUNTIME_EXCHANGE_STREAM_H
+
+#include <butil/iobuf.h>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "common/status.h"
+#include "gen_cpp/internal_service.pb.h"
+#include "util/countdown_latch.h"
+
+namespace brpc {
+class Controller;
+}
+
+namespace doris {
+
+// A packet of an exchange channel sent through an ExchangeStream.
+class ExchangePacket {
+public:
+    ExchangePacket() : _done(1) {}
+
+    // Returns true once the rpc carrying this packet has finished.
+    bool is_done() const { return _done.count() == 0; }
+
+    // The status of the rpc and the response of the receiver, valid once is_done().
+    const Status& status() const { return _status; }
+    const PTransmitDataResult& result() const { return _result; }
+
+private:
+    friend class ExchangeStream;
+
+    CountDownLatch _done;
+    Status _status;
+    PTransmitDataResult _result;
+};
+
+// All the exchange channels of a query from this backend to the same backend share an
+// ExchangeStream, which multiplexes their packets into transmit_data_batch rpcs. A packet
+// is sent right away if no rpc of the stream is in flight. Otherwise it waits for one to
+// finish and goes with the other packets queued meanwhile, so a busy stream sends few
+// large rpcs instead of one small rpc per channel and batch.
+//
+// The receiver never defers the response to a transmit_data_batch rpc, which would hold
+// back the acks of the other packets. It refuses a packet whose receiver is full instead,
+// and the stream sends that packet again in a transmit_data rpc of its own, whose response
+// waits for the receiver like the one of a channel without a stream. The queued packets
+// are sent before any channel waits on the stream, so a wait never holds back the data of
+// another channel.
+//
+// Thread-safe.
+class ExchangeStream : public std::enable_shared_from_this<ExchangeStream> {
+public:
+    ExchangeStream(PBackendService_Stub* stub, int timeout_ms)
+            : _stub(stub), _timeout_ms(timeout_ms), _num_in_flight_rpcs(0) {}
+
+    // Queues 'request' and 'attachment' to be sent, they are copied. 'attachment' holds
+    // the tuple data if request.transfer_by_attachment(), nullptr otherwise.
+    std::shared_ptr<ExchangePacket> send(const PTransmitDataParams& request,
+                                         const butil::IOBuf* attachment);
+
+    // Waits until the rpc carrying 'packet' has finished.
+    void wait(ExchangePacket* packet);
+
+    // Sends the queued packets in one rpc, if any. Must be called before waiting for a
+    // packet other than by wait().
+    void flush();
+
+private:
+    class BatchClosure;
+    class PacketClosure;
+
+    static Status _rpc_status(const brpc::Controller& cntl);
+
+    // Sets the status and the result of 'packet', whose rpc finished with 'status'.
+    // 'result' is the response to the packet if 'status' is ok.
+    static void _finish_packet(ExchangePacket* packet, const Status& status,
+                               PTransmitDataResult* result);
+
+    void _on_rpc_finished(BatchClosure* closure);
+
+    // Sends 'packet' the receiver refused in a batch, 'request' and 'attachment' are copied.
+    void _resend(const std::shared_ptr<ExchangePacket>& packet,
+                 const PTransmitDataParams& request, const butil::IOBuf& attachment);
+
+    PBackendService_Stub* _stub;
+    const int _timeout_ms;
+
+    std::mutex _lock;
+    // the rpc of the packets queued so far, nullptr if there are none
+    std::unique_ptr<BatchClosure> _queued;
+    int _num_in_flight_rpcs;
+};
+
+} // namespace doris
+
+#endif
@@ -141,6 +141,9 @@ public:
     PluginMgr* plugin_mgr() { return _plugin_mgr; }
 
 private:
+    // Sets up the components needed by the exec nodes in tests, without init().
+    friend class TestEnv;
+
     Status _init(const std::vector<StorePath>& store_paths);
     void _destroy();
 
@@ -39,8 +39,10 @@
 #include "runtime/datetime_value.h"
 #include "runtime/descriptors.h"
 #include "runtime/exec_env.h"
+#include "runtime/pipeline_scheduler.h"
 #include "runtime/plan_fragment_executor.h"
 #include "service/backend_options.h"
+#include "util/cpu_info.h"
 #include "util/debug_util.h"
 #include "util/doris_metrics.h"
 #include "util/stopwatch.hpp"
@@ -90,6 +92,12 @@ public:
 
     Status execute();
 
+    // Pipeline execution: open_pipeline() opens the fragment, then execute_step() is
+    // called until it sets *done. The fragment is closed when either fails or is done.
+    Status open_pipeline();
+    bool can_execute_step() { return _executor.can_execute_step(); }
+    void execute_step(bool* done);
+
     Status cancel_before_execute();
 
     Status cancel(const PPlanFragmentCancelReason& reason);
@@ -132,6 +140,9 @@ public:
 private:
     void coordinator_callback(const Status& status, RuntimeProfile* profile, bool done);
 
+    // Closes the fragment after pipeline execution and records the metrics of execute().
+    void _finish_pipeline();
+
     // Id of this query
     TUniqueId _query_id;
     // Id of this instance
@@ -155,6 +166,9 @@ private:
 
     std::unique_ptr<std::thread> _exec_thread;
 
+    // measures the whole pipeline execution, which spans several threads
+    MonotonicStopWatch _pipeline_watch;
+
     // This context is shared by all fragments of this host in a query
     std::shared_ptr<QueryFragmentsCtx> _fragments_ctx;
 };
@@ -225,6 +239,34 @@ Status FragmentExecState::execute() {
     return Status::OK();
 }
 
+Status FragmentExecState::open_pipeline() {
+    _pipeline_watch.start();
+    CgroupsMgr::apply_system_cgroup();
+    Status status = _executor.open_pipeline();
+    if (!status.ok()) {
+        LOG(WARNING) << "Got error while opening fragment " << print_id(_fragment_instance_id)
+                     << ": " << status.to_string();
+        _finish_pipeline();
+    }
+    return status;
+}
+
+void FragmentExecState::execute_step(bool* done) {
+    WARN_IF_ERROR(_executor.execute_step(done),
+                  strings::Substitute("Got error while executing fragment $0",
+                                      print_id(_fragment_instance_id)));
+    if (*done) {
+        _finish_pipeline();
+    }
+}
+
+void FragmentExecState::_finish_pipeline() {
+    _executor.close();
+    DorisMetrics::instance()->fragment_requests_total->increment(1);
+    DorisMetrics::instance()->fragment_request_duration_us->increment(
+            _pipeline_watch.elapsed_time() / 1000);
+}
+
 Status FragmentExecState::cancel_before_execute() {
     // set status as 'abort', cuz cancel() won't effect the status arg of DataSink::close().
     _executor.set_abort();
@@ -239,6 +281,8 @@ Status FragmentExecState::cancel(const PPlanFragmentCancelReason& reason) {
         _executor.set_is_report_on_cancel(false);
     }
     _executor.cancel();
+    // a cancelled fragment is ready to run its last step
+    PipelineScheduler::notify_blocked_tasks();
     return Status::OK();
 }
 
@@ -396,6 +440,22 @@ FragmentMgr::FragmentMgr(ExecEnv* exec_env)
             .set_max_threads(config::fragment_pool_thread_num_max)
             .set_max_queue_size(config::fragment_pool_queue_size)
             .build(&_thread_pool);
+
+    if (config::enable_pipeline_execution) {
+        int num_workers = config::pipeline_executor_size > 0 ? config::pipeline_executor_size
+                                                             : CpuInfo::num_cores();
+        int max_extra_workers = config::pipeline_max_extra_workers > 0
+                                        ? config::pipeline_max_extra_workers
+                                        : num_workers;
+        _pipeline_scheduler.reset(
+                new PipelineScheduler(num_workers, num_workers + max_extra_workers));
+        Status st = _pipeline_scheduler->start();
+        if (!st.ok()) {
+            LOG(WARNING) << "failed to start pipeline scheduler, run fragments on the "
+                         << "fragment pool: " << st.get_error_msg();
+            _pipeline_scheduler.reset();
+        }
+    }
 }
 
 FragmentMgr::~FragmentMgr() {
@@ -406,6 +466,9 @@ FragmentMgr::~FragmentMgr() {
     }
     // Stop all the worker, should wait for a while?
     // _thread_pool->wait_for();
+    if (_pipeline_scheduler != nullptr) {
+        _pipeline_scheduler->shutdown();
+    }
     _thread_pool->shutdown();
 
     // Only me can delete
@@ -418,9 +481,55 @@ FragmentMgr::~FragmentMgr() {
 
 static void empty_function(PlanFragmentExecutor* exec) {}
 
+// Drives an opened fragment through its sink on the pipeline scheduler.
+class FragmentPipelineTask : public PipelineTask {
+public:
+    FragmentPipelineTask(std::shared_ptr<FragmentExecState> exec_state,
+                         std::function<void()> finish_cb)
+            : _exec_state(exec_state), _finish_cb(finish_cb) {}
+
+    bool is_ready() override { return _exec_state->can_execute_step(); }
+
+    void execute_step(bool* done) override {
+        _exec_state->execute_step(done);
+        if (*done) {
+            _finish_cb();
+        }
+    }
+
+    void cancel() override { _exec_state->cancel(PPlanFragmentCancelReason::INTERNAL_ERROR); }
+
+private:
+    std::shared_ptr<FragmentExecState> _exec_state;
+    std::function<void()> _finish_cb;
+};
+
 void FragmentMgr::_exec_actual(std::shared_ptr<FragmentExecState> exec_state, FinishCallback cb) {
     exec_state->execute();
+    _finish_fragment(exec_state, cb);
+}
 
+void FragmentMgr::_exec_pipeline(std::shared_ptr<FragmentExecState> exec_state,
+                                 FinishCallback cb) {
+    // open() may still block, e.g. building a hash table, so it runs on the fragment pool
+    if (!exec_state->open_pipeline().ok()) {
+        _finish_fragment(exec_state, cb);
+        return;
+    }
+
+    std::shared_ptr<PipelineTask> task(new FragmentPipelineTask(
+            exec_state, [this, exec_state, cb]() { _finish_fragment(exec_state, cb); }));
+    if (!_pipeline_scheduler->submit(task).ok()) {
+        // the scheduler is shutting down, finish the fragment on this thread
+        bool done = false;
+        while (!done) {
+            task->execute_step(&done);
+        }
+    }
+}
+
+void FragmentMgr::_finish_fragment(std::shared_ptr<FragmentExecState> exec_state,
+                                   FinishCallback cb) {
     std::shared_ptr<QueryFragmentsCtx> fragments_ctx = exec_state->get_fragments_ctx();
     bool all_done = false;
     if (fragments_ctx != nullptr) {
@@ -521,8 +630,14 @@ Status FragmentMgr::exec_plan_fragment(const TExecPlanFragmentParams& params, Fi
         _fragment_map.insert(std::make_pair(params.params.fragment_instance_id, exec_state));
     }
 
-    auto st = _thread_pool->submit_func(
-            std::bind<void>(&FragmentMgr::_exec_actual, this, exec_state, cb));
+    Status st;
+    if (_pipeline_scheduler != nullptr && exec_state->executor()->has_sink()) {
+        st = _thread_pool->submit_func(
+                std::bind<void>(&FragmentMgr::_exec_pipeline, this, exec_state, cb));
+    } else {
+        st = _thread_pool->submit_func(
+                std::bind<void>(&FragmentMgr::_exec_actual, this, exec_state, cb));
+    }
     if (!st.ok()) {
         {
             // Remove the exec state added
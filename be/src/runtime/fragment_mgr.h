@@ -41,6 +41,7 @@ namespace doris {
 class QueryFragmentsCtx;
 class ExecEnv;
 class FragmentExecState;
+class PipelineScheduler;
 class PlanFragmentExecutor;
 class ThreadPool;
 class TExecPlanFragmentParams;
@@ -85,6 +86,12 @@ public:
 private:
     void _exec_actual(std::shared_ptr<FragmentExecState> exec_state, FinishCallback cb);
 
+    // Opens the fragment on the calling thread, then hands it to _pipeline_scheduler.
+    void _exec_pipeline(std::shared_ptr<FragmentExecState> exec_state, FinishCallback cb);
+
+    // Removes a finished fragment and invokes its callback.
+    void _finish_fragment(std::shared_ptr<FragmentExecState> exec_state, FinishCallback cb);
+
     // This is input params
     ExecEnv* _exec_env;
 
@@ -99,6 +106,8 @@ private:
     scoped_refptr<Thread> _cancel_thread;
     // every job is a pool
     std::unique_ptr<ThreadPool> _thread_pool;
+    // runs opened fragments if config::enable_pipeline_execution is set
+    std::unique_ptr<PipelineScheduler> _pipeline_scheduler;
 
     std::shared_ptr<MetricEntity> _entity = nullptr;
     UIntGauge* timeout_canceled_fragment_count = nullptr;
@@ -33,14 +33,9 @@ namespace doris {
 MysqlResultWriter::MysqlResultWriter(BufferControlBlock* sinker,
                                      const std::vector<ExprContext*>& output_expr_ctxs,
                                      RuntimeProfile* parent_profile)
-        : _sinker(sinker),
-          _output_expr_ctxs(output_expr_ctxs),
-          _row_buffer(NULL),
-          _parent_profile(parent_profile) {}
+        : _sinker(sinker), _output_expr_ctxs(output_expr_ctxs), _parent_profile(parent_profile) {}
 
-MysqlResultWriter::~MysqlResultWriter() {
-    delete _row_buffer;
-}
+MysqlResultWriter::~MysqlResultWriter() {}
 
 Status MysqlResultWriter::init(RuntimeState* state) {
     _init_profile();
@@ -48,11 +43,15 @@ Status MysqlResultWriter::init(RuntimeState* state) {
         return Status::InternalError("sinker is NULL pointer.");
     }
 
-    _row_buffer = new (std::nothrow) MysqlRowBuffer();
-
-    if (NULL == _row_buffer) {
-        return Status::InternalError("no memory to alloc.");
+    int num_columns = _output_expr_ctxs.size();
+    _column_buffers.resize(num_columns);
+    for (int i = 0; i < num_columns; ++i) {
+        _column_buffers[i].reset(new (std::nothrow) MysqlRowBuffer());
+        if (NULL == _column_buffers[i]) {
+            return Status::InternalError("no memory to alloc.");
+        }
     }
+    _cell_offsets.resize(num_columns);
 
     return Status::OK();
 }
@@ -64,140 +63,159 @@ void MysqlResultWriter::_init_profile() {
     _sent_rows_counter = ADD_COUNTER(_parent_profile, "NumSentRows", TUnit::UNIT);
 }
 
-Status MysqlResultWriter::_add_one_row(TupleRow* row) {
-    SCOPED_TIMER(_convert_tuple_timer);
-    _row_buffer->reset();
-    int num_columns = _output_expr_ctxs.size();
-    int buf_ret = 0;
+// Appends the non-null value 'item' of an output column of 'type' to 'buffer'. 'type' is a
+// template argument, so that the switch is resolved once per column instead of once per cell.
+template <PrimitiveType type>
+static int push_value(const void* item, int output_scale, MysqlRowBuffer* buffer) {
+    switch (type) {
+    case TYPE_BOOLEAN:
+    case TYPE_TINYINT:
+        return buffer->push_tinyint(*static_cast<const int8_t*>(item));
+
+    case TYPE_SMALLINT:
+        return buffer->push_smallint(*static_cast<const int16_t*>(item));
+
+    case TYPE_INT:
+        return buffer->push_int(*static_cast<const int32_t*>(item));
+
+    case TYPE_BIGINT:
+        return buffer->push_bigint(*static_cast<const int64_t*>(item));
+
+    case TYPE_LARGEINT: {
+        char buf[48];
+        int len = 48;
+        char* v = LargeIntValue::to_string(reinterpret_cast<const PackedInt128*>(item)->value,
+                                           buf, &len);
+        return buffer->push_string(v, len);
+    }
 
-    for (int i = 0; 0 == buf_ret && i < num_columns; ++i) {
-        void* item = _output_expr_ctxs[i]->get_value(row);
+    case TYPE_FLOAT:
+        return buffer->push_float(*static_cast<const float*>(item));
 
-        if (NULL == item) {
-            buf_ret = _row_buffer->push_null();
-            continue;
-        }
+    case TYPE_DOUBLE:
+        return buffer->push_double(*static_cast<const double*>(item));
 
-        switch (_output_expr_ctxs[i]->root()->type().type) {
-        case TYPE_BOOLEAN:
-        case TYPE_TINYINT:
-            buf_ret = _row_buffer->push_tinyint(*static_cast<int8_t*>(item));
-            break;
-
-        case TYPE_SMALLINT:
-            buf_ret = _row_buffer->push_smallint(*static_cast<int16_t*>(item));
-            break;
-
-        case TYPE_INT:
-            buf_ret = _row_buffer->push_int(*static_cast<int32_t*>(item));
-            break;
-
-        case TYPE_BIGINT:
-            buf_ret = _row_buffer->push_bigint(*static_cast<int64_t*>(item));
-            break;
-
-        case TYPE_LARGEINT: {
-            char buf[48];
-            int len = 48;
-            char* v = LargeIntValue::to_string(reinterpret_cast<const PackedInt128*>(item)->value,
-                                               buf, &len);
-            buf_ret = _row_buffer->push_string(v, len);
-            break;
-        }
+    case TYPE_TIME: {
+        double time = *static_cast<const double*>(item);
+        std::string time_str = time_str_from_double(time);
+        return buffer->push_string(time_str.c_str(), time_str.size());
+    }
 
-        case TYPE_FLOAT:
-            buf_ret = _row_buffer->push_float(*static_cast<float*>(item));
-            break;
+    case TYPE_DATE:
+    case TYPE_DATETIME:
+        return buffer->push_datetime(*static_cast<const DateTimeValue*>(item));
 
-        case TYPE_DOUBLE:
-            buf_ret = _row_buffer->push_double(*static_cast<double*>(item));
-            break;
+    case TYPE_HLL:
+    case TYPE_OBJECT:
+        return buffer->push_null();
 
-        case TYPE_TIME: {
-            double time = *static_cast<double*>(item);
-            std::string time_str = time_str_from_double(time);
-            buf_ret = _row_buffer->push_string(time_str.c_str(), time_str.size());
-            break;
-        }
+    case TYPE_VARCHAR:
+    case TYPE_CHAR: {
+        const StringValue* string_val = (const StringValue*)(item);
 
-        case TYPE_DATE:
-        case TYPE_DATETIME: {
-            char buf[64];
-            const DateTimeValue* time_val = (const DateTimeValue*)(item);
-            // TODO(zhaochun), this function has core risk
-            char* pos = time_val->to_string(buf);
-            buf_ret = _row_buffer->push_string(buf, pos - buf - 1);
-            break;
-        }
-
-        case TYPE_HLL:
-        case TYPE_OBJECT: {
-            buf_ret = _row_buffer->push_null();
-            break;
+        if (string_val->ptr == NULL) {
+            if (string_val->len == 0) {
+                // 0x01 is a magic num, not useful actually, just for present ""
+                char* tmp_val = reinterpret_cast<char*>(0x01);
+                return buffer->push_string(tmp_val, string_val->len);
+            }
+            return buffer->push_null();
         }
+        return buffer->push_string(string_val->ptr, string_val->len);
+    }
 
-        case TYPE_VARCHAR:
-        case TYPE_CHAR: {
-            const StringValue* string_val = (const StringValue*)(item);
-
-            if (string_val->ptr == NULL) {
-                if (string_val->len == 0) {
-                    // 0x01 is a magic num, not useful actually, just for present ""
-                    char* tmp_val = reinterpret_cast<char*>(0x01);
-                    buf_ret = _row_buffer->push_string(tmp_val, string_val->len);
-                } else {
-                    buf_ret = _row_buffer->push_null();
-                }
-            } else {
-                buf_ret = _row_buffer->push_string(string_val->ptr, string_val->len);
-            }
+    case TYPE_DECIMAL: {
+        const DecimalValue* decimal_val = reinterpret_cast<const DecimalValue*>(item);
+        std::string decimal_str;
 
-            break;
+        if (output_scale > 0 && output_scale <= 30) {
+            decimal_str = decimal_val->to_string(output_scale);
+        } else {
+            decimal_str = decimal_val->to_string();
         }
 
-        case TYPE_DECIMAL: {
-            const DecimalValue* decimal_val = reinterpret_cast<const DecimalValue*>(item);
-            std::string decimal_str;
-            int output_scale = _output_expr_ctxs[i]->root()->output_scale();
+        return buffer->push_string(decimal_str.c_str(), decimal_str.length());
+    }
 
-            if (output_scale > 0 && output_scale <= 30) {
-                decimal_str = decimal_val->to_string(output_scale);
-            } else {
-                decimal_str = decimal_val->to_string();
-            }
+    case TYPE_DECIMALV2: {
+        DecimalV2Value decimal_val(reinterpret_cast<const PackedInt128*>(item)->value);
+        std::string decimal_str;
 
-            buf_ret = _row_buffer->push_string(decimal_str.c_str(), decimal_str.length());
-            break;
+        if (output_scale > 0 && output_scale <= 30) {
+            decimal_str = decimal_val.to_string(output_scale);
+        } else {
+            decimal_str = decimal_val.to_string();
         }
 
-        case TYPE_DECIMALV2: {
-            DecimalV2Value decimal_val(reinterpret_cast<const PackedInt128*>(item)->value);
-            std::string decimal_str;
-            int output_scale = _output_expr_ctxs[i]->root()->output_scale();
-
-            if (output_scale > 0 && output_scale <= 30) {
-                decimal_str = decimal_val.to_string(output_scale);
-            } else {
-                decimal_str = decimal_val.to_string();
-            }
+        return buffer->push_string(decimal_str.c_str(), decimal_str.length());
+    }
 
-            buf_ret = _row_buffer->push_string(decimal_str.c_str(), decimal_str.length());
-            break;
-        }
+    default:
+        return -1;
+    }
+}
 
-        default:
-            LOG(WARNING) << "can't convert this type to mysql type. type = "
-                         << _output_expr_ctxs[i]->root()->type();
-            buf_ret = -1;
-            break;
+template <PrimitiveType type>
+Status MysqlResultWriter::_add_column(const RowBatch& batch, int column_idx) {
+    ExprContext* ctx = _output_expr_ctxs[column_idx];
+    MysqlRowBuffer* buffer = _column_buffers[column_idx].get();
+    std::vector<int>& offsets = _cell_offsets[column_idx];
+    int output_scale = ctx->root()->output_scale();
+    int num_rows = batch.num_rows();
+
+    buffer->reset();
+    offsets.resize(num_rows + 1);
+    offsets[0] = 0;
+    for (int i = 0; i < num_rows; ++i) {
+        void* item = ctx->get_value(batch.get_row(i));
+        int buf_ret = NULL == item ? buffer->push_null()
+                                   : push_value<type>(item, output_scale, buffer);
+        if (0 != buf_ret) {
+            return Status::InternalError("pack mysql buffer failed.");
         }
+        offsets[i + 1] = buffer->length();
     }
+    return Status::OK();
+}
 
-    if (0 != buf_ret) {
+Status MysqlResultWriter::_add_one_column(const RowBatch& batch, int column_idx) {
+    SCOPED_TIMER(_convert_tuple_timer);
+    switch (_output_expr_ctxs[column_idx]->root()->type().type) {
+    case TYPE_BOOLEAN:
+    case TYPE_TINYINT:
+        return _add_column<TYPE_TINYINT>(batch, column_idx);
+    case TYPE_SMALLINT:
+        return _add_column<TYPE_SMALLINT>(batch, column_idx);
+    case TYPE_INT:
+        return _add_column<TYPE_INT>(batch, column_idx);
+    case TYPE_BIGINT:
+        return _add_column<TYPE_BIGINT>(batch, column_idx);
+    case TYPE_LARGEINT:
+        return _add_column<TYPE_LARGEINT>(batch, column_idx);
+    case TYPE_FLOAT:
+        return _add_column<TYPE_FLOAT>(batch, column_idx);
+    case TYPE_DOUBLE:
+        return _add_column<TYPE_DOUBLE>(batch, column_idx);
+    case TYPE_TIME:
+        return _add_column<TYPE_TIME>(batch, column_idx);
+    case TYPE_DATE:
+    case TYPE_DATETIME:
+        return _add_column<TYPE_DATETIME>(batch, column_idx);
+    case TYPE_HLL:
+    case TYPE_OBJECT:
+        return _add_column<TYPE_HLL>(batch, column_idx);
+    case TYPE_VARCHAR:
+    case TYPE_CHAR:
+        return _add_column<TYPE_VARCHAR>(batch, column_idx);
+    case TYPE_DECIMAL:
+        return _add_column<TYPE_DECIMAL>(batch, column_idx);
+    case TYPE_DECIMALV2:
+        return _add_column<TYPE_DECIMALV2>(batch, column_idx);
+    default:
+        LOG(WARNING) << "can't convert this type to mysql type. type = "
+                     << _output_expr_ctxs[column_idx]->root()->type();
         return Status::InternalError("pack mysql buffer failed.");
     }
-
-    return Status::OK();
 }
 
 Status MysqlResultWriter::append_row_batch(const RowBatch* batch) {
@@ -207,24 +225,36 @@ Status MysqlResultWriter::append_row_batch(const RowBatch* batch) {
     }
 
     Status status;
-    // convert one batch
+    // convert one batch, a column at a time
+    int num_columns = _output_expr_ctxs.size();
+    for (int i = 0; status.ok() && i < num_columns; ++i) {
+        status = _add_one_column(*batch, i);
+    }
+    if (!status.ok()) {
+        LOG(WARNING) << "convert row to mysql result failed.";
+        return status;
+    }
+
     TFetchDataResult* result = new (std::nothrow) TFetchDataResult();
     int num_rows = batch->num_rows();
     result->result_batch.rows.resize(num_rows);
-
-    for (int i = 0; status.ok() && i < num_rows; ++i) {
-        TupleRow* row = batch->get_row(i);
-        status = _add_one_row(row);
-
-        if (status.ok()) {
-            result->result_batch.rows[i].assign(_row_buffer->buf(), _row_buffer->length());
-        } else {
-            LOG(WARNING) << "convert row to mysql result failed.";
-            break;
+    {
+        SCOPED_TIMER(_convert_tuple_timer);
+        for (int i = 0; i < num_rows; ++i) {
+            int row_length = 0;
+            for (int j = 0; j < num_columns; ++j) {
+                row_length += _cell_offsets[j][i + 1] - _cell_offsets[j][i];
+            }
+            std::string& row = result->result_batch.rows[i];
+            row.reserve(row_length);
+            for (int j = 0; j < num_columns; ++j) {
+                row.append(_column_buffers[j]->buf() + _cell_offsets[j][i],
+                           _cell_offsets[j][i + 1] - _cell_offsets[j][i]);
+            }
         }
     }
 
-    if (status.ok()) {
+    {
         SCOPED_TIMER(_result_send_timer);
         // push this batch to back
         status = _sinker->add_batch(result);
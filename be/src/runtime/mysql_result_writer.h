@@ -17,6 +17,10 @@
 
 #pragma once
 
+#include <memory>
+#include <vector>
+
+#include "runtime/primitive_type.h"
 #include "runtime/result_writer.h"
 #include "runtime/runtime_state.h"
 
@@ -45,13 +49,19 @@ public:
 
 private:
     void _init_profile();
-    // convert one tuple row
-    Status _add_one_row(TupleRow* row);
+    // convert one output column of all the rows in 'batch' to mysql cells
+    Status _add_one_column(const RowBatch& batch, int column_idx);
+    template <PrimitiveType type>
+    Status _add_column(const RowBatch& batch, int column_idx);
 
 private:
     BufferControlBlock* _sinker;
     const std::vector<ExprContext*>& _output_expr_ctxs;
-    MysqlRowBuffer* _row_buffer;
+    // cells of each output column in the current batch, the cell of row i in column c is
+    // [_cell_offsets[c][i], _cell_offsets[c][i + 1]) of _column_buffers[c].
+    // the buffers are reused by the following batches.
+    std::vector<std::unique_ptr<MysqlRowBuffer>> _column_buffers;
+    std::vector<std::vector<int>> _cell_offsets;
 
     RuntimeProfile* _parent_profile; // parent profile from result sink. not owned
     // total time cost on append batch operation
@@ -0,0 +1,332 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "runtime/pipeline_scheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <vector>
+
+#include "common/logging.h"
+#include "util/stopwatch.hpp"
+#include "util/threadpool.h"
+
+namespace doris {
+
+// A worker gives up a ready task after running it for this long, so that one busy
+// fragment can not hold a worker while others wait in the ready queue.
+static const int64_t TASK_TIME_SLICE_NS = 100 * 1000 * 1000L;
+// Blocked tasks are checked when a dependency notifies the scheduler. This interval only
+// bounds the wait of the tasks whose dependencies do not notify.
+static const int64_t BLOCKED_CHECK_INTERVAL_MS = 100;
+
+// The scheduler whose worker is the current thread, nullptr outside of the workers.
+static __thread PipelineScheduler* t_scheduler = nullptr;
+// Whether the current worker is inside a BlockingScope.
+static __thread bool t_blocking = false;
+
+// The running schedulers, woken up by notify_blocked_tasks().
+static std::atomic<int> s_num_schedulers {0};
+
+static std::mutex& schedulers_lock() {
+    static std::mutex lock;
+    return lock;
+}
+
+static std::vector<PipelineScheduler*>& schedulers() {
+    static std::vector<PipelineScheduler*> schedulers;
+    return schedulers;
+}
+
+PipelineScheduler::BlockingScope::BlockingScope()
+        : _scheduler(t_blocking ? nullptr : t_scheduler) {
+    if (_scheduler != nullptr) {
+        // nested scopes count once
+        t_blocking = true;
+        _scheduler->_enter_blocking();
+    }
+}
+
+PipelineScheduler::BlockingScope::~BlockingScope() {
+    if (_scheduler != nullptr) {
+        _scheduler->_exit_blocking();
+        t_blocking = false;
+    }
+}
+
+PipelineScheduler::PipelineScheduler(int num_workers, int max_threads)
+        : _num_workers(num_workers),
+          _max_threads(std::max(num_workers, max_threads)),
+          _num_threads(0),
+          _num_blocked(0),
+          _stopped(false),
+          _has_event(false),
+          _poller_stopped(false) {}
+
+PipelineScheduler::~PipelineScheduler() {
+    shutdown();
+}
+
+Status PipelineScheduler::start() {
+    {
+        std::lock_guard<std::mutex> l(schedulers_lock());
+        schedulers().push_back(this);
+        ++s_num_schedulers;
+    }
+    RETURN_IF_ERROR(ThreadPoolBuilder("PipelineScheduler")
+                            .set_min_threads(_num_workers)
+                            .set_max_threads(_max_threads)
+                            .build(&_worker_pool));
+    {
+        std::lock_guard<std::mutex> l(_lock);
+        for (int i = 0; i < _num_workers; ++i) {
+            ++_num_threads;
+            Status st = _worker_pool->submit_func(
+                    std::bind<void>(&PipelineScheduler::_worker_loop, this));
+            if (!st.ok()) {
+                --_num_threads;
+                return st;
+            }
+        }
+    }
+    return Thread::create(
+            "PipelineScheduler", "poll_blocked_tasks", [this]() { this->_poll_blocked_tasks(); },
+            &_poller);
+}
+
+void PipelineScheduler::shutdown() {
+    {
+        std::lock_guard<std::mutex> l(_lock);
+        if (_stopped) {
+            return;
+        }
+        _stopped = true;
+    }
+    {
+        std::lock_guard<std::mutex> l(schedulers_lock());
+        auto iter = std::find(schedulers().begin(), schedulers().end(), this);
+        if (iter != schedulers().end()) {
+            schedulers().erase(iter);
+            --s_num_schedulers;
+        }
+    }
+    _ready_cv.notify_all();
+    {
+        std::lock_guard<std::mutex> l(_blocked_lock);
+        _poller_stopped = true;
+    }
+    _blocked_cv.notify_all();
+    if (_poller) {
+        _poller->join();
+    }
+    if (_worker_pool) {
+        _worker_pool->shutdown();
+    }
+
+    // No thread takes tasks from the lists any more, cancel the tasks left so that
+    // they release their resources and report to their callers.
+    std::vector<std::shared_ptr<PipelineTask>> tasks;
+    {
+        std::lock_guard<std::mutex> l(_lock);
+        tasks.insert(tasks.end(), _ready_tasks.begin(), _ready_tasks.end());
+        _ready_tasks.clear();
+        std::lock_guard<std::mutex> blocked_l(_blocked_lock);
+        tasks.insert(tasks.end(), _blocked_tasks.begin(), _blocked_tasks.end());
+        _blocked_tasks.clear();
+    }
+    for (auto& task : tasks) {
+        task->cancel();
+        bool done = false;
+        while (!done) {
+            task->execute_step(&done);
+        }
+    }
+}
+
+Status PipelineScheduler::submit(std::shared_ptr<PipelineTask> task) {
+    // a stale answer is fine, a blocked task is checked again once it is in the list
+    bool ready = task->is_ready();
+    std::lock_guard<std::mutex> l(_lock);
+    // checked under the lock, so shutdown() finishes every task submitted before it
+    if (_stopped) {
+        return Status::InternalError("pipeline scheduler is stopped");
+    }
+    if (ready) {
+        _ready_tasks.push_back(std::move(task));
+        _try_add_worker();
+        _ready_cv.notify_one();
+    } else {
+        std::lock_guard<std::mutex> blocked_l(_blocked_lock);
+        _blocked_tasks.push_back(std::move(task));
+        _has_event = true;
+        _blocked_cv.notify_one();
+    }
+    return Status::OK();
+}
+
+void PipelineScheduler::notify_blocked_tasks() {
+    if (s_num_schedulers.load() == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> l(schedulers_lock());
+    for (auto scheduler : schedulers()) {
+        scheduler->_wake_up_poller();
+    }
+}
+
+bool PipelineScheduler::is_worker_thread() {
+    return t_scheduler != nullptr;
+}
+
+void PipelineScheduler::_add_ready_task(std::shared_ptr<PipelineTask> task) {
+    {
+        std::lock_guard<std::mutex> l(_lock);
+        _ready_tasks.push_back(std::move(task));
+        _try_add_worker();
+    }
+    _ready_cv.notify_one();
+}
+
+void PipelineScheduler::_add_blocked_task(std::shared_ptr<PipelineTask> task) {
+    {
+        std::lock_guard<std::mutex> l(_blocked_lock);
+        _blocked_tasks.push_back(std::move(task));
+        // the dependency may have notified between is_ready() and now
+        _has_event = true;
+    }
+    _blocked_cv.notify_one();
+}
+
+void PipelineScheduler::_wake_up_poller() {
+    {
+        // set even if the list is empty, the poller may be checking the tasks it took
+        std::lock_guard<std::mutex> l(_blocked_lock);
+        _has_event = true;
+    }
+    _blocked_cv.notify_one();
+}
+
+void PipelineScheduler::_try_add_worker() {
+    if (_stopped || _ready_tasks.empty() || _num_threads - _num_blocked >= _num_workers ||
+        _num_threads >= _max_threads) {
+        return;
+    }
+    ++_num_threads;
+    Status st = _worker_pool->submit_func(std::bind<void>(&PipelineScheduler::_worker_loop, this));
+    if (!st.ok()) {
+        --_num_threads;
+        LOG(WARNING) << "failed to start pipeline worker: " << st.get_error_msg();
+    }
+}
+
+void PipelineScheduler::_enter_blocking() {
+    std::lock_guard<std::mutex> l(_lock);
+    ++_num_blocked;
+    _try_add_worker();
+}
+
+void PipelineScheduler::_exit_blocking() {
+    std::lock_guard<std::mutex> l(_lock);
+    --_num_blocked;
+}
+
+void PipelineScheduler::_worker_loop() {
+    t_scheduler = this;
+    while (true) {
+        std::shared_ptr<PipelineTask> task;
+        {
+            std::unique_lock<std::mutex> l(_lock);
+            while (true) {
+                // Retire when stopped, or when a blocked worker came back and there are
+                // more running workers than configured.
+                if (_stopped || _num_threads - _num_blocked > _num_workers) {
+                    --_num_threads;
+                    t_scheduler = nullptr;
+                    return;
+                }
+                if (!_ready_tasks.empty()) {
+                    break;
+                }
+                _ready_cv.wait(l);
+            }
+            task = std::move(_ready_tasks.front());
+            _ready_tasks.pop_front();
+        }
+        _run_task(std::move(task));
+    }
+}
+
+void PipelineScheduler::_run_task(std::shared_ptr<PipelineTask> task) {
+    MonotonicStopWatch watch;
+    watch.start();
+    bool ready = true;
+    while (true) {
+        bool done = false;
+        task->execute_step(&done);
+        if (done) {
+            return;
+        }
+        ready = task->is_ready();
+        if (!ready || watch.elapsed_time() >= TASK_TIME_SLICE_NS) {
+            break;
+        }
+    }
+
+    if (ready) {
+        _add_ready_task(std::move(task));
+    } else {
+        _add_blocked_task(std::move(task));
+    }
+}
+
+void PipelineScheduler::_poll_blocked_tasks() {
+    std::list<std::shared_ptr<PipelineTask>> tasks;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> l(_blocked_lock);
+            // put back the tasks that are still blocked
+            _blocked_tasks.splice(_blocked_tasks.end(), tasks);
+            auto has_event = [this] { return _poller_stopped || _has_event; };
+            if (_blocked_tasks.empty()) {
+                _blocked_cv.wait(l, has_event);
+            } else {
+                _blocked_cv.wait_for(l, std::chrono::milliseconds(BLOCKED_CHECK_INTERVAL_MS),
+                                     has_event);
+            }
+            if (_poller_stopped) {
+                return;
+            }
+            _has_event = false;
+            tasks.swap(_blocked_tasks);
+        }
+        // Checked without _blocked_lock, the dependencies may notify while holding the
+        // locks is_ready() takes.
+        auto iter = tasks.begin();
+        while (iter != tasks.end()) {
+            if ((*iter)->is_ready()) {
+                _add_ready_task(std::move(*iter));
+                iter = tasks.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+    }
+}
+
+} // namespace doris
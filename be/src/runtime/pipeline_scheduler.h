@@ -0,0 +1,142 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_RUNTIME_PIPELINE_SCHEDULER_H
+#define DORIS_BE_RUNTIME_PIPELINE_SCHEDULER_H
+
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+
+#include "common/status.h"
+#include "gutil/ref_counted.h"
+#include "util/thread.h"
+
+namespace doris {
+
+class ThreadPool;
+
+// A unit of work driven by the PipelineScheduler. A task runs as a sequence of short
+// steps and does not hold a thread between two steps.
+class PipelineTask {
+public:
+    virtual ~PipelineTask() {}
+
+    // Returns false if the next step would block waiting for a dependency, e.g. an
+    // exchange without data or a sink whose previous rpc is still in flight.
+    // Never called concurrently with execute_step().
+    virtual bool is_ready() = 0;
+
+    // Runs one step. Sets *done to true once the task has finished, the scheduler
+    // drops its reference to the task then.
+    virtual void execute_step(bool* done) = 0;
+
+    // Asks the task to finish, so that its next steps do not wait for dependencies.
+    // Called on the tasks left when the scheduler shuts down, whose steps are then run
+    // on the shutting down thread until they are done.
+    virtual void cancel() = 0;
+};
+
+// PipelineScheduler runs PipelineTasks on a fixed number of workers, one per core by
+// default. A worker keeps running a task while it is ready, for at most one time slice,
+// then puts it back to the ready queue, or to the blocked list if it is waiting on a
+// dependency. The dependencies call notify_blocked_tasks() when they change, e.g. when
+// an exchange receives a batch or an rpc finishes, and a poller thread then moves the
+// blocked tasks that became ready back to the ready queue.
+//
+// Readiness is best effort: a step may still block, e.g. when it needs more than one
+// batch from an exchange. Waits on other fragments are wrapped in a BlockingScope, and
+// while a worker is blocked the scheduler starts an extra one, up to 'max_threads', so
+// blocked workers do not starve the fragments they wait for.
+class PipelineScheduler {
+public:
+    // Marks the current thread as blocked for the lifetime of the scope if it is a
+    // worker of a PipelineScheduler, no-op otherwise.
+    class BlockingScope {
+    public:
+        BlockingScope();
+        ~BlockingScope();
+
+    private:
+        PipelineScheduler* _scheduler;
+    };
+
+    // 'num_workers' is the number of running workers, 'max_threads' bounds the number of
+    // threads including the extra workers started for blocked ones.
+    PipelineScheduler(int num_workers, int max_threads);
+    ~PipelineScheduler();
+
+    Status start();
+
+    // Stops the workers and the poller, then cancels the tasks not finished yet and runs
+    // them to the end on the calling thread.
+    void shutdown();
+
+    Status submit(std::shared_ptr<PipelineTask> task);
+
+    // Wakes up the blocked tasks of the running schedulers to check if they are ready.
+    // Called by the dependencies of the tasks, no-op if no scheduler is running.
+    static void notify_blocked_tasks();
+
+    // Returns true if the current thread is a worker of a PipelineScheduler.
+    static bool is_worker_thread();
+
+private:
+    void _worker_loop();
+    void _run_task(std::shared_ptr<PipelineTask> task);
+    void _poll_blocked_tasks();
+
+    void _add_ready_task(std::shared_ptr<PipelineTask> task);
+    void _add_blocked_task(std::shared_ptr<PipelineTask> task);
+    // Starts another worker if the ready tasks lack running workers. Must hold _lock.
+    void _try_add_worker();
+
+    void _enter_blocking();
+    void _exit_blocking();
+
+    // Makes the poller check the blocked tasks.
+    void _wake_up_poller();
+
+    const int _num_workers;
+    const int _max_threads;
+
+    // protect the ready queue and the worker counters
+    std::mutex _lock;
+    std::condition_variable _ready_cv;
+    std::deque<std::shared_ptr<PipelineTask>> _ready_tasks;
+    // number of alive workers and how many of them are inside a BlockingScope
+    int _num_threads;
+    int _num_blocked;
+    bool _stopped;
+
+    // protect the blocked list, only taken after _lock
+    std::mutex _blocked_lock;
+    std::condition_variable _blocked_cv;
+    std::list<std::shared_ptr<PipelineTask>> _blocked_tasks;
+    // set when the blocked tasks need to be checked
+    bool _has_event;
+    bool _poller_stopped;
+
+    std::unique_ptr<ThreadPool> _worker_pool;
+    scoped_refptr<Thread> _poller;
+};
+
+} // namespace doris
+
+#endif
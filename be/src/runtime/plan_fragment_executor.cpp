@@ -29,9 +29,11 @@
 #include "exec/exchange_node.h"
 #include "exec/exec_node.h"
 #include "exec/scan_node.h"
+#include "exec/shared_hash_table.h"
 #include "exprs/expr.h"
 #include "runtime/data_stream_mgr.h"
 #include "runtime/descriptors.h"
+#include "runtime/exchange_stream.h"
 #include "runtime/exec_env.h"
 #include "runtime/mem_tracker.h"
 #include "runtime/result_buffer_mgr.h"
@@ -69,7 +71,7 @@ PlanFragmentExecutor::~PlanFragmentExecutor() {
 }
 
 Status PlanFragmentExecutor::prepare(const TExecPlanFragmentParams& request,
-                                     const QueryFragmentsCtx* fragments_ctx) {
+                                     QueryFragmentsCtx* fragments_ctx) {
     const TPlanFragmentExecParams& params = request.params;
     _query_id = params.query_id;
 
@@ -148,6 +150,7 @@ Status PlanFragmentExecutor::prepare(const TExecPlanFragmentParams& request,
         RETURN_IF_ERROR(DescriptorTbl::create(obj_pool(), request.desc_tbl, &desc_tbl));
     }
     _runtime_state->set_desc_tbl(desc_tbl);
+    _runtime_state->set_query_fragments_ctx(fragments_ctx);
 
     // set up plan
     DCHECK(request.__isset.fragment);
@@ -240,6 +243,43 @@ Status PlanFragmentExecutor::open() {
     // may block
     // TODO: if no report thread is started, make sure to send a final profile
     // at end, otherwise the coordinator hangs in case we finish w/ an error
+    start_report_thread();
+
+    Status status = open_internal();
+    log_and_update_status(status);
+    return status;
+}
+
+Status PlanFragmentExecutor::open_pipeline() {
+    LOG(INFO) << "open_pipeline(): fragment_instance_id="
+              << print_id(_runtime_state->fragment_instance_id());
+    DCHECK(_sink.get() != NULL);
+    start_report_thread();
+
+    Status status = open_plan();
+    log_and_update_status(status);
+    return status;
+}
+
+bool PlanFragmentExecutor::can_execute_step() {
+    // a cancelled fragment runs its next step to finish
+    if (_runtime_state->is_cancelled()) {
+        return true;
+    }
+    return _plan->can_get_next() && _sink->can_send();
+}
+
+Status PlanFragmentExecutor::execute_step(bool* done) {
+    *done = false;
+    Status status = send_next_batch(done);
+    if (!status.ok()) {
+        *done = true;
+        log_and_update_status(status);
+    }
+    return status;
+}
+
+void PlanFragmentExecutor::start_report_thread() {
     if (!_report_status_cb.empty() && config::status_report_interval > 0) {
         boost::unique_lock<boost::mutex> l(_report_thread_lock);
         _report_thread = boost::thread(&PlanFragmentExecutor::report_profile, this);
@@ -248,9 +288,9 @@ Status PlanFragmentExecutor::open() {
         _report_thread_started_cv.wait(l);
         _report_thread_active = true;
     }
+}
 
-    Status status = open_internal();
-
+void PlanFragmentExecutor::log_and_update_status(const Status& status) {
     if (!status.ok() && !status.is_cancelled() && _runtime_state->log_has_space()) {
         // Log error message in addition to returning in Status. Queries that do not
         // fetch results (e.g. insert) may not receive the message directly and can
@@ -259,10 +299,25 @@ Status PlanFragmentExecutor::open() {
     }
 
     update_status(status);
-    return status;
 }
 
 Status PlanFragmentExecutor::open_internal() {
+    RETURN_IF_ERROR(open_plan());
+
+    if (_sink.get() == NULL) {
+        return Status::OK();
+    }
+
+    // If there is a sink, do all the work of driving it here, so that
+    // when this returns the query has actually finished
+    bool eos = false;
+    while (!eos) {
+        RETURN_IF_ERROR(send_next_batch(&eos));
+    }
+    return Status::OK();
+}
+
+Status PlanFragmentExecutor::open_plan() {
     {
         SCOPED_TIMER(profile()->total_time_counter());
         RETURN_IF_ERROR(_plan->open(_runtime_state.get()));
@@ -271,37 +326,37 @@ Status PlanFragmentExecutor::open_internal() {
     if (_sink.get() == NULL) {
         return Status::OK();
     }
-    RETURN_IF_ERROR(_sink->open(runtime_state()));
+    return _sink->open(runtime_state());
+}
 
-    // If there is a sink, do all the work of driving it here, so that
-    // when this returns the query has actually finished
+Status PlanFragmentExecutor::send_next_batch(bool* eos) {
     RowBatch* batch = NULL;
+    RETURN_IF_ERROR(get_next_internal(&batch));
 
-    while (true) {
-        RETURN_IF_ERROR(get_next_internal(&batch));
-
-        if (batch == NULL) {
-            break;
-        }
+    if (batch == NULL) {
+        *eos = true;
+        return close_sink();
+    }
 
-        if (VLOG_ROW_IS_ON) {
-            VLOG_ROW << "open_internal: #rows=" << batch->num_rows()
-                     << " desc=" << row_desc().debug_string();
+    if (VLOG_ROW_IS_ON) {
+        VLOG_ROW << "open_internal: #rows=" << batch->num_rows()
+                 << " desc=" << row_desc().debug_string();
 
-            for (int i = 0; i < batch->num_rows(); ++i) {
-                TupleRow* row = batch->get_row(i);
-                VLOG_ROW << row->to_string(row_desc());
-            }
+        for (int i = 0; i < batch->num_rows(); ++i) {
+            TupleRow* row = batch->get_row(i);
+            VLOG_ROW << row->to_string(row_desc());
         }
+    }
 
-        SCOPED_TIMER(profile()->total_time_counter());
-        // Collect this plan and sub plan statistics, and send to parent plan.
-        if (_collect_query_statistics_with_every_batch) {
-            collect_query_statistics();
-        }
-        RETURN_IF_ERROR(_sink->send(runtime_state(), batch));
+    SCOPED_TIMER(profile()->total_time_counter());
+    // Collect this plan and sub plan statistics, and send to parent plan.
+    if (_collect_query_statistics_with_every_batch) {
+        collect_query_statistics();
     }
+    return _sink->send(runtime_state(), batch);
+}
 
+Status PlanFragmentExecutor::close_sink() {
     // Close the sink *before* stopping the report thread. Close may
     // need to add some important information to the last report that
     // gets sent. (e.g. table sinks record the files they have written
@@ -580,4 +635,28 @@ void PlanFragmentExecutor::close() {
     _closed = true;
 }
 
+std::shared_ptr<SharedHashTable> QueryFragmentsCtx::get_shared_hash_table(int node_id) {
+    std::lock_guard<std::mutex> l(_shared_hash_tables_lock);
+    std::weak_ptr<SharedHashTable>& entry = _shared_hash_tables[node_id];
+    std::shared_ptr<SharedHashTable> table = entry.lock();
+    if (table == nullptr) {
+        table.reset(new SharedHashTable());
+        entry = table;
+    }
+    return table;
+}
+
+std::shared_ptr<ExchangeStream> QueryFragmentsCtx::get_exchange_stream(
+        const TNetworkAddress& dest, PBackendService_Stub* stub, int timeout_ms) {
+    std::string key = dest.hostname + ":" + std::to_string(dest.port);
+    std::lock_guard<std::mutex> l(_exchange_streams_lock);
+    std::weak_ptr<ExchangeStream>& entry = _exchange_streams[key];
+    std::shared_ptr<ExchangeStream> stream = entry.lock();
+    if (stream == nullptr) {
+        stream.reset(new ExchangeStream(stub, timeout_ms));
+        entry = stream;
+    }
+    return stream;
+}
+
 } // namespace doris
@@ -20,6 +20,9 @@
 
 #include <boost/function.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 #include "common/object_pool.h"
@@ -32,6 +35,9 @@
 namespace doris {
 
 class QueryFragmentsCtx;
+class ExchangeStream;
+class PBackendService_Stub;
+class SharedHashTable;
 class HdfsFsCache;
 class ExecNode;
 class RowDescriptor;
@@ -95,7 +101,7 @@ public:
     // The query will be aborted (MEM_LIMIT_EXCEEDED) if it goes over that limit.
     // If fragments_ctx is not null, some components will be got from fragments_ctx.
     Status prepare(const TExecPlanFragmentParams& request,
-                   const QueryFragmentsCtx* fragments_ctx = nullptr);
+                   QueryFragmentsCtx* fragments_ctx = nullptr);
 
     // Start execution. Call this prior to get_next().
     // If this fragment has a sink, open() will send all rows produced
@@ -108,6 +114,17 @@ public:
     // time when open() returns, and the status-reporting thread will have been stopped.
     Status open();
 
+    // Pipeline execution, see PipelineScheduler. Instead of open(), a fragment with a
+    // sink can call open_pipeline(), which opens the plan and the sink and may block,
+    // then call execute_step() until it sets *done. Each step sends one batch to the
+    // sink; it does not block if can_execute_step() returned true. On error *done is
+    // set and the status is recorded as by open().
+    Status open_pipeline();
+    bool can_execute_step();
+    Status execute_step(bool* done);
+
+    bool has_sink() const { return _sink.get() != NULL; }
+
     // Return results through 'batch'. Sets '*batch' to NULL if no more results.
     // '*batch' is owned by PlanFragmentExecutor and must not be deleted.
     // When *batch == NULL, get_next() should not be called anymore. Also, report_status_cb
@@ -248,6 +265,22 @@ private:
     // have been stopped. _sink will be set to NULL after successful execution.
     Status open_internal();
 
+    // Opens the plan and the sink, if any.
+    Status open_plan();
+
+    // Pulls one batch from the plan and sends it to the sink. Sets *eos and closes the
+    // sink as described in open_internal() once the plan is exhausted.
+    Status send_next_batch(bool* eos);
+
+    // Closes the sink after the last batch and sends the final report.
+    Status close_sink();
+
+    // Starts the profile-reporting thread if there is a report callback.
+    void start_report_thread();
+
+    // Logs an error status of open() or execute_step() and records it in _status.
+    void log_and_update_status(const Status& status);
+
     // Executes get_next() logic and returns resulting status.
     Status get_next_internal(RowBatch** batch);
 
@@ -282,6 +315,16 @@ public:
         return false;
     }
 
+    // Returns the build side shared by the instances of broadcast hash join 'node_id' on
+    // this backend, a new one if no instance holds it any more.
+    std::shared_ptr<SharedHashTable> get_shared_hash_table(int node_id);
+
+    // Returns the stream shared by the exchange channels of this query to the backend at
+    // 'dest', a new one sending through 'stub' if no channel holds it any more.
+    std::shared_ptr<ExchangeStream> get_exchange_stream(const TNetworkAddress& dest,
+                                                        PBackendService_Stub* stub,
+                                                        int timeout_ms);
+
 public:
     TUniqueId query_id;
     DescriptorTbl* desc_tbl;
@@ -304,6 +347,15 @@ public:
 
 private:
     DateTimeValue _start_time;
+
+    std::mutex _shared_hash_tables_lock;
+    // not owned, the tables are freed with the last join instance that uses them
+    std::unordered_map<int, std::weak_ptr<SharedHashTable>> _shared_hash_tables;
+
+    std::mutex _exchange_streams_lock;
+    // host:port => stream, not owned, the streams are freed with the last channel and rpc
+    // that use them
+    std::unordered_map<std::string, std::weak_ptr<ExchangeStream>> _exchange_streams;
 };
 
 } // namespace doris
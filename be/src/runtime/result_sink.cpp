@@ -93,6 +93,10 @@ Status ResultSink::open(RuntimeState* state) {
     return Expr::open(_output_expr_ctxs, state);
 }
 
+bool ResultSink::can_send() {
+    return _sender == nullptr || _sender->can_add_batch();
+}
+
 Status ResultSink::send(RuntimeState* state, RowBatch* batch) {
     return _writer->append_row_batch(batch);
 }
@@ -49,6 +49,8 @@ public:
     // send data in 'batch' to this backend stream mgr
     // Blocks until all rows in batch are placed in the buffer
     virtual Status send(RuntimeState* state, RowBatch* batch);
+    // Returns false while the result buffer is full.
+    bool can_send() override;
     // Flush all buffered data and close all existing channels to destination
     // hosts. Further send() calls are illegal after calling close().
     virtual Status close(RuntimeState* state, Status exec_status);
@@ -17,9 +17,12 @@
 
 #include "runtime/row_batch.h"
 
+#include <butil/iobuf.h>
 #include <snappy/snappy.h>
 #include <stdint.h> // for intptr_t
 
+#include <memory>
+
 #include "runtime/buffered_tuple_stream2.inline.h"
 #include "runtime/exec_env.h"
 #include "runtime/runtime_state.h"
@@ -28,6 +31,7 @@
 //#include "runtime/mem_tracker.h"
 #include "gen_cpp/Data_types.h"
 #include "gen_cpp/data.pb.h"
+#include "util/block_compression.h"
 #include "util/debug_util.h"
 
 using std::vector;
@@ -70,6 +74,15 @@ RowBatch::RowBatch(const RowDescriptor& row_desc, int capacity, MemTracker* mem_
 //              xfer += iprot->readString(this->tuple_data[_i9]);
 // to allocated string data in special mempool
 // (change via python script that runs over Data_types.cc)
+Status RowBatch::create(const RowDescriptor& row_desc, const PRowBatch& input_batch,
+                        const butil::IOBuf* tuple_data, MemTracker* tracker,
+                        std::unique_ptr<RowBatch>* batch) {
+    std::unique_ptr<RowBatch> new_batch(new RowBatch(row_desc, input_batch, tracker));
+    RETURN_IF_ERROR(new_batch->deserialize(input_batch, tuple_data));
+    *batch = std::move(new_batch);
+    return Status::OK();
+}
+
 RowBatch::RowBatch(const RowDescriptor& row_desc, const PRowBatch& input_batch, MemTracker* tracker)
         : _mem_tracker(tracker),
           _has_in_flight_row(false),
@@ -94,24 +107,53 @@ RowBatch::RowBatch(const RowDescriptor& row_desc, const PRowBatch& input_batch,
     } else {
         _tuple_ptrs = reinterpret_cast<Tuple**>(_tuple_data_pool->allocate(_tuple_ptrs_size));
     }
+}
 
+Status RowBatch::deserialize(const PRowBatch& input_batch, const butil::IOBuf* tuple_data_buf) {
     uint8_t* tuple_data = nullptr;
+    size_t data_size = tuple_data_buf != nullptr ? tuple_data_buf->size()
+                                                 : input_batch.tuple_data().size();
     if (input_batch.is_compressed()) {
-        // Decompress tuple data into data pool
-        const char* compressed_data = input_batch.tuple_data().c_str();
-        size_t compressed_size = input_batch.tuple_data().size();
+        // Decompress tuple data into data pool. The blocks of an attachment are only
+        // copied to be contiguous if the data spans more than one of them.
+        std::unique_ptr<char[]> flattened;
+        const char* compressed_data = nullptr;
+        if (tuple_data_buf != nullptr) {
+            flattened.reset(new char[data_size]);
+            compressed_data =
+                    static_cast<const char*>(tuple_data_buf->fetch(flattened.get(), data_size));
+        } else {
+            compressed_data = input_batch.tuple_data().c_str();
+        }
+        const BlockCompressionCodec* codec = nullptr;
         size_t uncompressed_size = 0;
-        bool success =
-                snappy::GetUncompressedLength(compressed_data, compressed_size, &uncompressed_size);
-        DCHECK(success) << "snappy::GetUncompressedLength failed";
+        if (input_batch.has_compression_type()) {
+            RETURN_IF_ERROR(get_block_compression_codec(input_batch.compression_type(), &codec));
+            uncompressed_size = input_batch.uncompressed_size();
+        } else {
+            RETURN_IF_ERROR(
+                    get_block_compression_codec(segment_v2::CompressionTypePB::SNAPPY, &codec));
+            if (!snappy::GetUncompressedLength(compressed_data, data_size, &uncompressed_size)) {
+                return Status::Corruption("snappy::GetUncompressedLength failed");
+            }
+        }
+        if (codec == nullptr) {
+            std::stringstream ss;
+            ss << "invalid compression type " << input_batch.compression_type()
+               << " of a compressed row batch";
+            return Status::Corruption(ss.str());
+        }
         tuple_data = reinterpret_cast<uint8_t*>(_tuple_data_pool->allocate(uncompressed_size));
-        success = snappy::RawUncompress(compressed_data, compressed_size,
-                                        reinterpret_cast<char*>(tuple_data));
-        DCHECK(success) << "snappy::RawUncompress failed";
+        Slice uncompressed(tuple_data, uncompressed_size);
+        RETURN_IF_ERROR(codec->decompress(Slice(compressed_data, data_size), &uncompressed));
     } else {
         // Tuple data uncompressed, copy directly into data pool
-        tuple_data = _tuple_data_pool->allocate(input_batch.tuple_data().size());
-        memcpy(tuple_data, input_batch.tuple_data().c_str(), input_batch.tuple_data().size());
+        tuple_data = _tuple_data_pool->allocate(data_size);
+        if (tuple_data_buf != nullptr) {
+            tuple_data_buf->copy_to(tuple_data, data_size);
+        } else {
+            memcpy(tuple_data, input_batch.tuple_data().c_str(), data_size);
+        }
     }
 
     // convert input_batch.tuple_offsets into pointers
@@ -126,7 +168,7 @@ RowBatch::RowBatch(const RowDescriptor& row_desc, const PRowBatch& input_batch,
 
     // Check whether we have slots that require offset-to-pointer conversion.
     if (!_row_desc.has_varlen_slots()) {
-        return;
+        return Status::OK();
     }
     const std::vector<TupleDescriptor*>& tuple_descs = _row_desc.tuple_descriptors();
 
@@ -160,6 +202,7 @@ RowBatch::RowBatch(const RowDescriptor& row_desc, const PRowBatch& input_batch,
             }
         }
     }
+    return Status::OK();
 }
 
 // TODO: we want our input_batch's tuple_data to come from our (not yet implemented)
@@ -366,6 +409,14 @@ int RowBatch::serialize(TRowBatch* output_batch) {
 }
 
 int RowBatch::serialize(PRowBatch* output_batch) {
+    return serialize(output_batch,
+                     config::compress_rowbatches ? segment_v2::CompressionTypePB::SNAPPY
+                                                 : segment_v2::CompressionTypePB::NO_COMPRESSION,
+                     nullptr);
+}
+
+int RowBatch::serialize(PRowBatch* output_batch, segment_v2::CompressionTypePB compression_type,
+                        butil::IOBuf* tuple_data_buf) {
     // num_rows
     output_batch->set_num_rows(_num_rows);
     // row_tuples
@@ -375,15 +426,25 @@ int RowBatch::serialize(PRowBatch* output_batch) {
     output_batch->mutable_tuple_offsets()->Reserve(_num_rows * _num_tuples_per_row);
     // is_compressed
     output_batch->set_is_compressed(false);
-    // tuple data
+    output_batch->clear_compression_type();
+    output_batch->clear_uncompressed_size();
+    // tuple data, written to a malloc'ed buffer which is handed over to 'tuple_data_buf'
+    // if the data is sent as attachment
     int size = total_byte_size();
     auto mutable_tuple_data = output_batch->mutable_tuple_data();
-    mutable_tuple_data->resize(size);
+    char* data = nullptr;
+    if (tuple_data_buf == nullptr) {
+        mutable_tuple_data->resize(size);
+        data = const_cast<char*>(mutable_tuple_data->data());
+    } else {
+        mutable_tuple_data->clear();
+        data = reinterpret_cast<char*>(malloc(size));
+    }
 
     // Copy tuple data, including strings, into output_batch (converting string
     // pointers into offsets in the process)
     int offset = 0; // current offset into output_batch->tuple_data
-    char* tuple_data = const_cast<char*>(mutable_tuple_data->data());
+    char* tuple_data = data;
     for (int i = 0; i < _num_rows; ++i) {
         TupleRow* row = get_row(i);
         const std::vector<TupleDescriptor*>& tuple_descs = _row_desc.tuple_descriptors();
@@ -403,26 +464,56 @@ int RowBatch::serialize(PRowBatch* output_batch) {
 
     DCHECK_EQ(offset, size);
 
-    if (config::compress_rowbatches && size > 0) {
-        // Try compressing tuple_data to _compression_scratch, swap if compressed data is
-        // smaller
-        int max_compressed_size = snappy::MaxCompressedLength(size);
-
-        if (_compression_scratch.size() < max_compressed_size) {
-            _compression_scratch.resize(max_compressed_size);
+    const BlockCompressionCodec* codec = nullptr;
+    if (size > 0 && !get_block_compression_codec(compression_type, &codec).ok()) {
+        LOG(WARNING) << "unknown compression type " << compression_type
+                     << ", send row batch uncompressed";
+        codec = nullptr;
+    }
+    size_t data_size = size;
+    if (codec != nullptr) {
+        // Try compressing tuple_data to _compression_scratch, or to a new buffer for the
+        // attachment, keep it if compressed data is smaller
+        size_t max_compressed_size = codec->max_compressed_len(size);
+        char* compressed_output = nullptr;
+        if (tuple_data_buf == nullptr) {
+            if (_compression_scratch.size() < max_compressed_size) {
+                _compression_scratch.resize(max_compressed_size);
+            }
+            compressed_output = const_cast<char*>(_compression_scratch.c_str());
+        } else {
+            compressed_output = reinterpret_cast<char*>(malloc(max_compressed_size));
         }
 
-        size_t compressed_size = 0;
-        char* compressed_output = const_cast<char*>(_compression_scratch.c_str());
-        snappy::RawCompress(mutable_tuple_data->data(), size, compressed_output, &compressed_size);
-
-        if (LIKELY(compressed_size < size)) {
-            _compression_scratch.resize(compressed_size);
-            mutable_tuple_data->swap(_compression_scratch);
+        Slice compressed(compressed_output, max_compressed_size);
+        Status st = codec->compress(Slice(data, size), &compressed);
+        if (LIKELY(st.ok() && compressed.size < size)) {
             output_batch->set_is_compressed(true);
+            output_batch->set_compression_type(compression_type);
+            output_batch->set_uncompressed_size(size);
+            if (tuple_data_buf == nullptr) {
+                _compression_scratch.resize(compressed.size);
+                mutable_tuple_data->swap(_compression_scratch);
+            } else {
+                std::swap(data, compressed_output);
+                data_size = compressed.size;
+            }
+        }
+        if (tuple_data_buf != nullptr) {
+            free(compressed_output);
         }
 
-        VLOG_ROW << "uncompressed size: " << size << ", compressed size: " << compressed_size;
+        VLOG_ROW << "uncompressed size: " << size << ", compressed size: " << compressed.size;
+    }
+
+    if (tuple_data_buf != nullptr) {
+        if (data_size == 0) {
+            free(data);
+        } else if (tuple_data_buf->append_user_data(data, data_size, free) != 0) {
+            tuple_data_buf->append(data, data_size);
+            free(data);
+        }
+        return get_batch_size(*output_batch) + size;
     }
 
     // The size output_batch would be if we didn't compress tuple_data (will be equal to
@@ -567,6 +658,18 @@ int RowBatch::get_batch_size(const PRowBatch& batch) {
     return result;
 }
 
+void RowBatch::deep_copy_to(RowBatch* dst) {
+    DCHECK_EQ(dst->_num_tuples_per_row, _num_tuples_per_row);
+    DCHECK_EQ(dst->_num_rows, 0);
+    DCHECK_GE(dst->_capacity, _num_rows);
+    dst->add_rows(_num_rows);
+    const std::vector<TupleDescriptor*>& descs = _row_desc.tuple_descriptors();
+    for (int i = 0; i < _num_rows; ++i) {
+        get_row(i)->deep_copy(dst->get_row(i), descs, dst->_tuple_data_pool.get(), false);
+    }
+    dst->commit_rows(_num_rows);
+}
+
 void RowBatch::acquire_state(RowBatch* src) {
     // DCHECK(_row_desc.equals(src->_row_desc));
     DCHECK_EQ(_num_tuples_per_row, src->_num_tuples_per_row);
@@ -20,10 +20,13 @@
 
 #include <boost/scoped_ptr.hpp>
 #include <cstring>
+#include <memory>
 #include <vector>
 
 #include "codegen/doris_ir.h"
 #include "common/logging.h"
+#include "common/status.h"
+#include "gen_cpp/segment_v2.pb.h"
 #include "runtime/buffered_block_mgr2.h" // for BufferedBlockMgr2::Block
 // #include "runtime/buffered_tuple_stream2.inline.h"
 #include "runtime/bufferpool/buffer_pool.h"
@@ -32,6 +35,10 @@
 #include "runtime/mem_pool.h"
 #include "runtime/row_batch_interface.hpp"
 
+namespace butil {
+class IOBuf;
+}
+
 namespace doris {
 
 class BufferedTupleStream2;
@@ -92,7 +99,13 @@ public:
     // (so that we don't need to make yet another copy)
     RowBatch(const RowDescriptor& row_desc, const TRowBatch& input_batch, MemTracker* tracker);
 
-    RowBatch(const RowDescriptor& row_desc, const PRowBatch& input_batch, MemTracker* tracker);
+    // Populates '*batch' from input_batch the same way. The tuple data is read from
+    // 'tuple_data' instead of input_batch.tuple_data if it is not nullptr, e.g. from the
+    // attachment of a brpc request, and is decompressed or copied straight from its
+    // blocks. Returns an error if the data cannot be decompressed.
+    static Status create(const RowDescriptor& row_desc, const PRowBatch& input_batch,
+                         const butil::IOBuf* tuple_data, MemTracker* tracker,
+                         std::unique_ptr<RowBatch>* batch);
 
     // Releases all resources accumulated at this row batch.  This includes
     //  - tuple_ptrs
@@ -350,6 +363,12 @@ public:
     int serialize(TRowBatch* output_batch);
     int serialize(PRowBatch* output_batch);
 
+    // Same as above, but compresses the tuple data with 'compression_type'. If
+    // 'tuple_data' is not nullptr, the tuple data is appended to it without copying
+    // instead of being stored in output_batch.tuple_data, which is left empty.
+    int serialize(PRowBatch* output_batch, segment_v2::CompressionTypePB compression_type,
+                  butil::IOBuf* tuple_data);
+
     // Utility function: returns total size of batch.
     static int get_batch_size(const TRowBatch& batch);
     static int get_batch_size(const PRowBatch& batch);
@@ -390,6 +409,11 @@ public:
     std::string to_string();
 
 private:
+    // Allocates the tuple pointers of input_batch, deserialize() fills in the rest.
+    RowBatch(const RowDescriptor& row_desc, const PRowBatch& input_batch, MemTracker* tracker);
+
+    Status deserialize(const PRowBatch& input_batch, const butil::IOBuf* tuple_data);
+
     MemTracker* _mem_tracker; // not owned
 
     // Close owned tuple streams and delete if needed.
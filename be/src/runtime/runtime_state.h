@@ -41,6 +41,7 @@
 namespace doris {
 
 class DescriptorTbl;
+class QueryFragmentsCtx;
 class ObjectPool;
 class Status;
 class ExecEnv;
@@ -105,6 +106,10 @@ public:
 
     const DescriptorTbl& desc_tbl() const { return *_desc_tbl; }
     void set_desc_tbl(DescriptorTbl* desc_tbl) { _desc_tbl = desc_tbl; }
+    // The components shared by the fragments of the query on this backend, nullptr if the
+    // fragment was not started with them.
+    QueryFragmentsCtx* query_fragments_ctx() const { return _query_fragments_ctx; }
+    void set_query_fragments_ctx(QueryFragmentsCtx* ctx) { _query_fragments_ctx = ctx; }
     int batch_size() const { return _query_options.batch_size; }
     bool abort_on_error() const { return _query_options.abort_on_error; }
     bool abort_on_default_limit_exceeded() const {
@@ -124,6 +129,7 @@ public:
     const std::vector<std::shared_ptr<MemTracker>>& mem_trackers() { return _mem_trackers; }
     std::shared_ptr<MemTracker> fragment_mem_tracker() { return _fragment_mem_tracker; }
 
+    std::shared_ptr<MemTracker> query_mem_tracker() { return _query_mem_tracker; }
     std::shared_ptr<MemTracker> instance_mem_tracker() { return _instance_mem_tracker; }
     ThreadResourceMgr::ResourcePool* resource_pool() { return _resource_pool; }
 
@@ -391,6 +397,7 @@ private:
     RuntimeProfile _profile;
 
     DescriptorTbl* _desc_tbl;
+    QueryFragmentsCtx* _query_fragments_ctx = nullptr;
     std::shared_ptr<ObjectPool> _obj_pool;
 
     // Protects _data_stream_recvrs_pool
@@ -481,6 +488,8 @@ private:
     int64_t _error_row_number;
     std::string _error_log_file_path;
     std::ofstream* _error_log_file = nullptr; // error file path, absolute path
+    // protect _error_log_file and _error_hub, which may be written by multiple scanner threads
+    boost::mutex _error_log_file_lock;
     std::unique_ptr<LoadErrorHub> _error_hub;
     std::vector<TTabletCommitInfo> _tablet_commit_infos;
 
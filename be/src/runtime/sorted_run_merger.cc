@@ -44,6 +44,7 @@ public:
             : _sorted_run(sorted_run),
               _input_row_batch(NULL),
               _input_row_batch_index(-1),
+              _current_key(0),
               _parent(parent) {}
 
     ~BatchedRowSupplier() {}
@@ -78,6 +79,9 @@ public:
             *done = _input_row_batch == NULL;
             _input_row_batch_index = 0;
         }
+        if (!*done && _parent->_use_normalized_key) {
+            _current_key = _parent->_compare_less_than.normalized_key(current_row());
+        }
         return Status::OK();
     }
 
@@ -95,10 +99,21 @@ private:
     // Index into _input_row_batch of the current row being processed.
     int _input_row_batch_index;
 
+    // Normalized key of the current row, if the merger uses normalized keys.
+    uint64_t _current_key;
+
     // The parent merger instance.
     SortedRunMerger* _parent;
 };
 
+inline bool SortedRunMerger::less_than(BatchedRowSupplier* lhs, BatchedRowSupplier* rhs) {
+    if (_use_normalized_key) {
+        return _compare_less_than.less(lhs->_current_key, lhs->current_row(), rhs->_current_key,
+                                       rhs->current_row());
+    }
+    return _compare_less_than(lhs->current_row(), rhs->current_row());
+}
+
 void SortedRunMerger::heapify(int parent_index) {
     int left_index = 2 * parent_index + 1;
     int right_index = left_index + 1;
@@ -108,8 +123,7 @@ void SortedRunMerger::heapify(int parent_index) {
     int least_child = 0;
     // Find the least child of parent.
     if (right_index >= _min_heap.size() ||
-        _compare_less_than(_min_heap[left_index]->current_row(),
-                           _min_heap[right_index]->current_row())) {
+        less_than(_min_heap[left_index], _min_heap[right_index])) {
         least_child = left_index;
     } else {
         least_child = right_index;
@@ -117,8 +131,7 @@ void SortedRunMerger::heapify(int parent_index) {
 
     // If the parent is out of place, swap it with the least child and invoke
     // heapify recursively.
-    if (_compare_less_than(_min_heap[least_child]->current_row(),
-                           _min_heap[parent_index]->current_row())) {
+    if (less_than(_min_heap[least_child], _min_heap[parent_index])) {
         iter_swap(_min_heap.begin() + least_child, _min_heap.begin() + parent_index);
         heapify(least_child);
     }
@@ -128,6 +141,7 @@ SortedRunMerger::SortedRunMerger(const TupleRowComparator& compare_less_than,
                                  RowDescriptor* row_desc, RuntimeProfile* profile,
                                  bool deep_copy_input)
         : _compare_less_than(compare_less_than),
+          _use_normalized_key(compare_less_than.has_normalized_key()),
           _input_row_desc(row_desc),
           _deep_copy_input(deep_copy_input) {
     _get_next_timer = ADD_TIMER(profile, "MergeGetNext");
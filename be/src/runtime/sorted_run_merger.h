@@ -68,6 +68,9 @@ public:
 private:
     class BatchedRowSupplier;
 
+    // Returns true if the current row of lhs is less than the current row of rhs.
+    bool less_than(BatchedRowSupplier* lhs, BatchedRowSupplier* rhs);
+
     // Assuming the element at parent_index is the only out of place element in the heap,
     // restore the heap property (i.e. swap elements so parent <= children).
     void heapify(int parent_index);
@@ -84,6 +87,10 @@ private:
     // Row comparator. Returns true if lhs < rhs.
     TupleRowComparator _compare_less_than;
 
+    // If true, the current row of each input run carries its normalized key, so most
+    // comparisons do not evaluate the sort exprs.
+    bool _use_normalized_key;
+
     // Descriptor for the rows provided by the input runs. Owned by the exec-node through
     // which this merger was created.
     RowDescriptor* _input_row_desc;
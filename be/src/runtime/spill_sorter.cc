@@ -17,6 +17,7 @@
 
 #include "runtime/spill_sorter.h"
 
+#include <algorithm>
 #include <boost/mem_fn.hpp>
 #include <sstream>
 #include <string>
@@ -26,6 +27,7 @@
 #include "runtime/runtime_state.h"
 #include "runtime/sorted_run_merger.h"
 #include "util/debug_util.h"
+#include "util/radix_sort.h"
 #include "util/runtime_profile.h"
 
 using std::deque;
@@ -239,13 +241,16 @@ private:
 }; // class SpillSorter::Run
 
 // Sorts a sequence of tuples from a run in place using a provided tuple comparator.
-// Quick sort is used for sequences of tuples larger that 16 elements, and insertion sort
-// is used for smaller sequences. The TupleSorter is initialized with a RuntimeState
-// instance to check for cancellation during an in-memory sort.
+// If the first sort key has a normalized key (see TupleRowComparator), the keys are
+// sorted together with the tuple indexes, using a radix sort if the normalized key is
+// exact, and the tuples are permuted into place afterwards. Otherwise quick sort is used
+// for sequences of tuples larger that 16 elements, and insertion sort is used for smaller
+// sequences. The TupleSorter is initialized with a RuntimeState instance to check for
+// cancellation during an in-memory sort.
 class SpillSorter::TupleSorter {
 public:
     TupleSorter(const TupleRowComparator& less_than_comp, int64_t block_size, int tuple_size,
-                RuntimeState* state);
+                const std::shared_ptr<MemTracker>& mem_tracker, RuntimeState* state);
 
     ~TupleSorter();
 
@@ -258,6 +263,28 @@ public:
 private:
     static const int INSERTION_THRESHOLD = 16;
 
+    // Normalized key of a tuple and its index in the run.
+    struct SortEntry {
+        uint64_t key;
+        int64_t index;
+    };
+
+    struct SortEntryRadixSortTraits {
+        using Element = SortEntry;
+        using Key = uint64_t;
+        using CountType = uint32_t;
+        using KeyBits = uint64_t;
+
+        static constexpr size_t PART_SIZE_BITS = 8;
+
+        using Transform = RadixSortIdentityTransform<KeyBits>;
+        using Allocator = RadixSortMallocAllocator;
+
+        static Key& extractKey(Element& elem) { return elem.key; }
+
+        static bool less(Key x, Key y) { return x < y; }
+    };
+
     // Helper class used to iterate over tuples in a run during quick sort and insertion sort.
     class TupleIterator {
     public:
@@ -345,6 +372,9 @@ private:
     // Tuple comparator that returns true if lhs < rhs.
     const TupleRowComparator _less_than_comp;
 
+    // Tracks the memory of the normalized key entries. Not owned.
+    std::shared_ptr<MemTracker> _mem_tracker;
+
     // Runtime state instance to check for cancellation. Not owned.
     RuntimeState* const _state;
 
@@ -379,6 +409,23 @@ private:
 
     // Swaps tuples pointed to by left and right using the swap buffer.
     void swap(uint8_t* left, uint8_t* right);
+
+    // Sorts _run by the normalized keys of its tuples. Returns false without modifying
+    // the run if the memory for the keys could not be reserved.
+    bool sort_normalized_keys();
+
+    // Sorts the entries in [first, last) by normalized key, comparing the tuples if the
+    // keys are equal.
+    void sort_entries(SortEntry* first, SortEntry* last);
+
+    // Moves the tuples of _run to the order given by 'entries' using the swap buffer.
+    void permute(std::vector<SortEntry>* entries);
+
+    // Returns the tuple at 'index' in _run.
+    uint8_t* tuple_at(int64_t index) const {
+        return _run->_fixed_len_blocks[index / _block_capacity]->buffer() +
+               (index % _block_capacity) * _tuple_size;
+    }
 }; // class TupleSorter
 
 // SpillSorter::Run methods
@@ -871,11 +918,14 @@ void SpillSorter::Run::copy_var_len_data_convert_offset(char* dest, int64_t offs
 
 // SpillSorter::TupleSorter methods.
 SpillSorter::TupleSorter::TupleSorter(const TupleRowComparator& comp, int64_t block_size,
-                                      int tuple_size, RuntimeState* state)
+                                      int tuple_size,
+                                      const std::shared_ptr<MemTracker>& mem_tracker,
+                                      RuntimeState* state)
         : _tuple_size(tuple_size),
           _block_capacity(block_size / tuple_size),
           _last_tuple_block_offset(tuple_size * ((block_size / tuple_size) - 1)),
           _less_than_comp(comp),
+          _mem_tracker(mem_tracker),
           _state(state) {
     _temp_tuple_buffer = new uint8_t[tuple_size];
     _temp_tuple_row = reinterpret_cast<TupleRow*>(&_temp_tuple_buffer);
@@ -889,10 +939,87 @@ SpillSorter::TupleSorter::~TupleSorter() {
 
 void SpillSorter::TupleSorter::sort(Run* run) {
     _run = run;
-    sort_helper(TupleIterator(this, 0), TupleIterator(this, _run->_num_tuples));
+    if (!_less_than_comp.has_normalized_key() || !sort_normalized_keys()) {
+        sort_helper(TupleIterator(this, 0), TupleIterator(this, _run->_num_tuples));
+    }
     run->_is_sorted = true;
 }
 
+bool SpillSorter::TupleSorter::sort_normalized_keys() {
+    const int64_t num_tuples = _run->_num_tuples;
+    if (num_tuples <= INSERTION_THRESHOLD) {
+        return false;
+    }
+    // The entries and the buffer the radix sort swaps them through.
+    const int64_t mem_usage = 2 * num_tuples * sizeof(SortEntry);
+    if (!_mem_tracker->TryConsume(mem_usage)) {
+        return false;
+    }
+
+    std::vector<SortEntry> entries(num_tuples);
+    TupleIterator iter(this, 0);
+    for (int64_t i = 0; i < num_tuples; ++i, iter.next()) {
+        entries[i].key =
+                _less_than_comp.normalized_key(reinterpret_cast<TupleRow*>(&iter._current_tuple));
+        entries[i].index = i;
+    }
+
+    SortEntry* first = &entries[0];
+    SortEntry* last = first + num_tuples;
+    if (_less_than_comp.normalized_key_is_exact()) {
+        // Rows with equal exact keys are equal, so the order of the keys is the order of
+        // the rows.
+        RadixSort<SortEntryRadixSortTraits>::executeLSD(first, num_tuples);
+    } else {
+        sort_entries(first, last);
+    }
+
+    if (LIKELY(!_state->is_cancelled())) {
+        permute(&entries);
+    }
+    _mem_tracker->Release(mem_usage);
+    return true;
+}
+
+void SpillSorter::TupleSorter::sort_entries(SortEntry* first, SortEntry* last) {
+    if (last - first < 2) {
+        return;
+    }
+    std::sort(first, last, [this](const SortEntry& lhs, const SortEntry& rhs) {
+        if (lhs.key != rhs.key) {
+            return lhs.key < rhs.key;
+        }
+        uint8_t* lhs_tuple = tuple_at(lhs.index);
+        uint8_t* rhs_tuple = tuple_at(rhs.index);
+        return _less_than_comp.less(lhs.key, reinterpret_cast<TupleRow*>(&lhs_tuple), rhs.key,
+                                    reinterpret_cast<TupleRow*>(&rhs_tuple));
+    });
+}
+
+// Entry i names the tuple that belongs at position i. Each cycle of the permutation is
+// rotated through the swap buffer, and the entries of moved positions are marked with -1.
+void SpillSorter::TupleSorter::permute(std::vector<SortEntry>* entries) {
+    const int64_t num_tuples = entries->size();
+    for (int64_t start = 0; start < num_tuples; ++start) {
+        int64_t src = (*entries)[start].index;
+        if (src == start || src < 0) {
+            continue;
+        }
+        memcpy(_swap_buffer, tuple_at(start), _tuple_size);
+        int64_t dst = start;
+        while (true) {
+            src = (*entries)[dst].index;
+            (*entries)[dst].index = -1;
+            if (src == start) {
+                memcpy(tuple_at(dst), _swap_buffer, _tuple_size);
+                break;
+            }
+            memcpy(tuple_at(dst), tuple_at(src), _tuple_size);
+            dst = src;
+        }
+    }
+}
+
 // Sort the sequence of tuples from [first, last).
 // Begin with a sorted sequence of size 1 [first, first+1).
 // During each pass of the outermost loop, add the next tuple (at position 'i') to
@@ -1066,7 +1193,8 @@ Status SpillSorter::init() {
     TupleDescriptor* sort_tuple_desc = _output_row_desc->tuple_descriptors()[0];
     _has_var_len_slots = sort_tuple_desc->has_varlen_slots();
     _in_mem_tuple_sorter.reset(new TupleSorter(_compare_less_than, _block_mgr->max_block_size(),
-                                               sort_tuple_desc->byte_size(), _state));
+                                               sort_tuple_desc->byte_size(), _mem_tracker,
+                                               _state));
     _unsorted_run = _obj_pool.add(new Run(this, sort_tuple_desc, true));
 
     _initial_runs_counter = ADD_COUNTER(_profile, "InitialRunsCreated", TUnit::UNIT);
@@ -25,6 +25,7 @@
 #include "runtime/message_body_sink.h"
 #include "util/bit_util.h"
 #include "util/byte_buffer.h"
+#include "util/time.h"
 
 namespace doris {
 
@@ -38,6 +39,10 @@ public:
               _max_buffered_bytes(max_buffered_bytes),
               _min_chunk_size(min_chunk_size),
               _total_length(total_length),
+              _appended_bytes(0),
+              _peak_buffered_bytes(0),
+              _append_wait_nanos(0),
+              _read_wait_nanos(0),
               _finished(false),
               _cancelled(false) {}
     virtual ~StreamLoadPipe() {}
@@ -66,6 +71,16 @@ public:
                 _write_buf.reset();
             }
         }
+        if (pos == size) {
+            return Status::OK();
+        }
+        if (_total_length > 0 && _appended_bytes == 0) {
+            // The whole data will be read by read_one_message(), receive it into one chunk,
+            // so that it can be handed out to the reader without copying.
+            _write_buf = ByteBuffer::allocate(std::max<size_t>(_total_length, size - pos));
+            _write_buf->put_bytes(data + pos, size - pos);
+            return Status::OK();
+        }
         // need to allocate a new chunk, min chunk is 64k
         size_t chunk_size = std::max(_min_chunk_size, size - pos);
         chunk_size = BitUtil::RoundUpToPowerOfTwo(chunk_size);
@@ -86,39 +101,55 @@ public:
     // If _total_length == -1, this should be a Kafka routine load task,
     // just get the next buffer directly from the buffer queue, because one buffer contains a complete piece of data.
     // Otherwise, this should be a stream load task that needs to read the specified amount of data.
-    Status read_one_message(uint8_t** data, size_t* length) override {
+    // In both cases the buffer in the queue is handed out without copying if possible.
+    Status read_one_message(ByteBufferPtr* buf) override {
         if (_total_length < -1) {
             std::stringstream ss;
             ss << "invalid, _total_length is: " << _total_length;
             return Status::InternalError(ss.str());
         } else if (_total_length == 0) {
             // no data
-            *length = 0;
+            buf->reset();
             return Status::OK();
         }
 
         if (_total_length == -1) {
-            return _read_next_buffer(data, length);
+            return _read_next_buffer(buf);
         }
 
         // _total_length > 0, read the entire data
-        *data = new uint8_t[_total_length];
-        *length = _total_length;
+        {
+            std::unique_lock<std::mutex> l(_lock);
+            _wait_for_data(&l);
+            if (_cancelled) {
+                return Status::InternalError("cancelled");
+            }
+            // the whole data is received into one chunk by append()
+            if (!_buf_queue.empty() && _buf_queue.front()->remaining() == _total_length) {
+                _pop_front(buf);
+                return Status::OK();
+            }
+        }
+        // the data is received in multiple chunks, merge them
+        ByteBufferPtr whole_buf = ByteBuffer::allocate(_total_length);
+        size_t length = _total_length;
         bool eof = false;
-        Status st = read(*data, length, &eof);
+        RETURN_IF_ERROR(read((uint8_t*)whole_buf->ptr, &length, &eof));
         if (eof) {
-            *length = 0;
+            buf->reset();
+            return Status::OK();
         }
-        return st;
+        whole_buf->pos = length;
+        whole_buf->flip();
+        *buf = whole_buf;
+        return Status::OK();
     }
 
     Status read(uint8_t* data, size_t* data_size, bool* eof) override {
         size_t bytes_read = 0;
         while (bytes_read < *data_size) {
             std::unique_lock<std::mutex> l(_lock);
-            while (!_cancelled && !_finished && _buf_queue.empty()) {
-                _get_cond.wait(l);
-            }
+            _wait_for_data(&l);
             // cancelled
             if (_cancelled) {
                 return Status::InternalError("cancelled");
@@ -186,13 +217,48 @@ public:
         _put_cond.notify_all();
     }
 
+    // The peak of bytes buffered in this pipe, and the time the producer waited for
+    // free buffer space and the consumer waited for data.
+    size_t peak_buffered_bytes() {
+        std::lock_guard<std::mutex> l(_lock);
+        return _peak_buffered_bytes;
+    }
+    int64_t append_wait_nanos() {
+        std::lock_guard<std::mutex> l(_lock);
+        return _append_wait_nanos;
+    }
+    int64_t read_wait_nanos() {
+        std::lock_guard<std::mutex> l(_lock);
+        return _read_wait_nanos;
+    }
+
 private:
-    // read the next buffer from _buf_queue
-    Status _read_next_buffer(uint8_t** data, size_t* length) {
-        std::unique_lock<std::mutex> l(_lock);
+    // wait until there is data in _buf_queue, or the pipe is finished or cancelled.
+    // NOTE: must hold _lock
+    void _wait_for_data(std::unique_lock<std::mutex>* l) {
+        if (_cancelled || _finished || !_buf_queue.empty()) {
+            return;
+        }
+        int64_t start_nanos = MonotonicNanos();
         while (!_cancelled && !_finished && _buf_queue.empty()) {
-            _get_cond.wait(l);
+            _get_cond.wait(*l);
         }
+        _read_wait_nanos += MonotonicNanos() - start_nanos;
+    }
+
+    // hand out the first buffer of _buf_queue
+    // NOTE: must hold _lock
+    void _pop_front(ByteBufferPtr* buf) {
+        *buf = _buf_queue.front();
+        _buf_queue.pop_front();
+        _buffered_bytes -= (*buf)->limit;
+        _put_cond.notify_one();
+    }
+
+    // read the next buffer from _buf_queue
+    Status _read_next_buffer(ByteBufferPtr* buf) {
+        std::unique_lock<std::mutex> l(_lock);
+        _wait_for_data(&l);
         // cancelled
         if (_cancelled) {
             return Status::InternalError("cancelled");
@@ -200,18 +266,10 @@ private:
         // finished
         if (_buf_queue.empty()) {
             DCHECK(_finished);
-            *data = nullptr;
-            *length = 0;
+            buf->reset();
             return Status::OK();
         }
-        auto buf = _buf_queue.front();
-        *length = buf->remaining();
-        *data = new uint8_t[*length];
-        buf->get_bytes((char*)(*data), *length);
-
-        _buf_queue.pop_front();
-        _buffered_bytes -= buf->limit;
-        _put_cond.notify_one();
+        _pop_front(buf);
         return Status::OK();
     }
 
@@ -219,15 +277,22 @@ private:
         {
             std::unique_lock<std::mutex> l(_lock);
             // if _buf_queue is empty, we append this buf without size check
-            while (!_cancelled && !_buf_queue.empty() &&
-                   _buffered_bytes + buf->remaining() > _max_buffered_bytes) {
-                _put_cond.wait(l);
+            if (!_cancelled && !_buf_queue.empty() &&
+                _buffered_bytes + buf->remaining() > _max_buffered_bytes) {
+                int64_t start_nanos = MonotonicNanos();
+                while (!_cancelled && !_buf_queue.empty() &&
+                       _buffered_bytes + buf->remaining() > _max_buffered_bytes) {
+                    _put_cond.wait(l);
+                }
+                _append_wait_nanos += MonotonicNanos() - start_nanos;
             }
             if (_cancelled) {
                 return Status::InternalError("cancelled");
             }
             _buf_queue.push_back(buf);
             _buffered_bytes += buf->remaining();
+            _appended_bytes += buf->remaining();
+            _peak_buffered_bytes = std::max(_peak_buffered_bytes, _buffered_bytes);
         }
         _get_cond.notify_one();
         return Status::OK();
@@ -246,6 +311,11 @@ private:
     // and the length is unknown.
     // size_t is unsigned, so use int64_t
     int64_t _total_length = -1;
+    // bytes appended to _buf_queue so far
+    int64_t _appended_bytes;
+    size_t _peak_buffered_bytes;
+    int64_t _append_wait_nanos;
+    int64_t _read_wait_nanos;
     std::deque<ByteBufferPtr> _buf_queue;
     std::condition_variable _put_cond;
     std::condition_variable _get_cond;
@@ -17,10 +17,14 @@
 
 #include "runtime/tablets_channel.h"
 
+#include <algorithm>
+
+#include "common/config.h"
 #include "exec/tablet_info.h"
 #include "gutil/strings/substitute.h"
 #include "olap/delta_writer.h"
 #include "olap/memtable.h"
+#include "olap/rowset_sync_handler.h"
 #include "runtime/row_batch.h"
 #include "runtime/tuple_row.h"
 #include "util/doris_metrics.h"
@@ -170,12 +174,45 @@ Status TabletsChannel::close(int sender_id, bool* finished,
             // tablet_vec will only contains success tablet, and then let FE judge it.
             writer->close_wait(tablet_vec);
         }
+
+        // 3. sync the committed rowsets to slave replicas in single replica load
+        _sync_rowsets_to_slaves(need_wait_writers, tablet_vec);
         // TODO(gaodayue) clear and destruct all delta writers to make sure all memory are freed
         // DCHECK_EQ(_mem_tracker->consumption(), 0);
     }
     return Status::OK();
 }
 
+void TabletsChannel::_sync_rowsets_to_slaves(
+        const std::vector<DeltaWriter*>& writers,
+        google::protobuf::RepeatedPtrField<PTabletInfo>* tablet_vec) {
+    std::vector<RowsetSyncer*> syncers;
+    for (auto writer : writers) {
+        for (auto& syncer : writer->rowset_syncers()) {
+            syncers.push_back(syncer.get());
+        }
+    }
+    // the rowsets of a group of tablets are synced in parallel, each syncer has one chunk
+    // in flight at a time, the memory of attachments is bounded by the group size.
+    const size_t group_size = std::max(config::single_replica_load_sync_parallel_tablets, 1);
+    for (size_t begin = 0; begin < syncers.size(); begin += group_size) {
+        size_t end = std::min(syncers.size(), begin + group_size);
+        bool sent = true;
+        while (sent) {
+            sent = false;
+            for (size_t i = begin; i < end; ++i) {
+                sent |= syncers[i]->send();
+            }
+            for (size_t i = begin; i < end; ++i) {
+                syncers[i]->wait();
+            }
+        }
+        for (size_t i = begin; i < end; ++i) {
+            syncers[i]->get_committed_tablets(tablet_vec);
+        }
+    }
+}
+
 Status TabletsChannel::reduce_mem_usage() {
     std::lock_guard<std::mutex> l(_lock);
     if (_state == kFinished) {
@@ -225,6 +262,11 @@ Status TabletsChannel::_open_all_writers(const PTabletWriterOpenRequest& params)
         ss << "unknown index id, key=" << _key;
         return Status::InternalError(ss.str());
     }
+    // tablet_id -> slave replicas, only set in single replica load
+    std::unordered_map<int64_t, const PSlaveTabletNodes*> slave_tablet_nodes;
+    for (auto& nodes : params.slave_tablet_nodes()) {
+        slave_tablet_nodes.emplace(nodes.tablet_id(), &nodes);
+    }
     for (auto& tablet : params.tablets()) {
         WriteRequest request;
         request.tablet_id = tablet.tablet_id();
@@ -236,6 +278,11 @@ Status TabletsChannel::_open_all_writers(const PTabletWriterOpenRequest& params)
         request.need_gen_rollup = params.need_gen_rollup();
         request.tuple_desc = _tuple_desc;
         request.slots = index_slots;
+        auto it = slave_tablet_nodes.find(tablet.tablet_id());
+        if (it != slave_tablet_nodes.end()) {
+            request.slave_nodes.assign(it->second->slave_nodes().begin(),
+                                       it->second->slave_nodes().end());
+        }
 
         DeltaWriter* writer = nullptr;
         auto st = DeltaWriter::open(&request, _mem_tracker, &writer);
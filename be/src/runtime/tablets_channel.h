@@ -86,6 +86,11 @@ private:
     // open all writer
     Status _open_all_writers(const PTabletWriterOpenRequest& params);
 
+    // send the rowsets committed by 'writers' to their slave replicas in single replica
+    // load, tablets committed on slaves successfully are added to 'tablet_vec'.
+    void _sync_rowsets_to_slaves(const std::vector<DeltaWriter*>& writers,
+                                 google::protobuf::RepeatedPtrField<PTabletInfo>* tablet_vec);
+
 private:
     // id of this load channel
     TabletsChannelKey _key;
@@ -17,6 +17,9 @@
 
 #include "runtime/test_env.h"
 
+#include "common/config.h"
+#include "runtime/thread_resource_mgr.h"
+#include "runtime/tmp_file_mgr.h"
 #include "util/disk_info.h"
 #include "util/doris_metrics.h"
 
@@ -26,12 +29,13 @@ namespace doris {
 
 TestEnv::TestEnv() {
     _exec_env.reset(new ExecEnv());
-    // _exec_env->init_for_tests();
+    _exec_env->_thread_mgr = new ThreadResourceMgr();
+    _exec_env->_disk_io_mgr = new DiskIoMgr();
     _io_mgr_tracker.reset(new MemTracker(-1));
     _block_mgr_parent_tracker.reset(new MemTracker(-1));
     _exec_env->disk_io_mgr()->init(_io_mgr_tracker);
     _tmp_file_mgr.reset(new TmpFileMgr());
-    _tmp_file_mgr->init();
+    _tmp_file_mgr->init_custom({config::query_scratch_dirs}, false);
 }
 
 void TestEnv::init_tmp_file_mgr(const std::vector<std::string>& tmp_dirs, bool one_dir_per_device) {
@@ -44,21 +48,30 @@ TestEnv::~TestEnv() {
     // Queries must be torn down first since they are dependent on global state.
     tear_down_query_states();
     _block_mgr_parent_tracker.reset();
+    delete _exec_env->_disk_io_mgr;
+    delete _exec_env->_thread_mgr;
     _exec_env.reset();
     _io_mgr_tracker.reset();
     _tmp_file_mgr.reset();
 }
 
-RuntimeState* TestEnv::create_runtime_state(int64_t query_id) {
+RuntimeState* TestEnv::create_runtime_state(int64_t query_id,
+                                            const TQueryOptions& query_options) {
     TExecPlanFragmentParams plan_params = TExecPlanFragmentParams();
     plan_params.params.query_id.hi = 0;
     plan_params.params.query_id.lo = query_id;
-    return new RuntimeState(plan_params.params, TQueryOptions(), TQueryGlobals(), _exec_env.get());
+    return new RuntimeState(plan_params.params, query_options, TQueryGlobals(), _exec_env.get());
 }
 
 Status TestEnv::create_query_state(int64_t query_id, int max_buffers, int block_size,
                                    RuntimeState** runtime_state) {
-    *runtime_state = create_runtime_state(query_id);
+    return create_query_state(query_id, max_buffers, block_size, TQueryOptions(), runtime_state);
+}
+
+Status TestEnv::create_query_state(int64_t query_id, int max_buffers, int block_size,
+                                   const TQueryOptions& query_options,
+                                   RuntimeState** runtime_state) {
+    *runtime_state = create_runtime_state(query_id, query_options);
     if (*runtime_state == NULL) {
         return Status::InternalError("Unexpected error creating RuntimeState");
     }
@@ -41,6 +41,10 @@ public:
     Status create_query_state(int64_t query_id, int max_buffers, int block_size,
                               RuntimeState** runtime_state);
 
+    // Same as above, with the given query options, e.g. to enable spilling.
+    Status create_query_state(int64_t query_id, int max_buffers, int block_size,
+                              const TQueryOptions& query_options, RuntimeState** runtime_state);
+
     // Create multiple separate RuntimeStates with associated block managers, e.g. as if
     // multiple queries were executing. The RuntimeStates are owned by TestEnv.
     Status create_query_states(int64_t start_query_id, int num_mgrs, int buffers_per_mgr,
@@ -63,7 +67,7 @@ private:
     void init_metrics();
 
     // Create a new RuntimeState sharing global environment.
-    RuntimeState* create_runtime_state(int64_t query_id);
+    RuntimeState* create_runtime_state(int64_t query_id, const TQueryOptions& query_options);
 
     // Global state for test environment.
     boost::scoped_ptr<ExecEnv> _exec_env;
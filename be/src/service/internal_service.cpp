@@ -20,6 +20,8 @@
 #include "common/config.h"
 #include "gen_cpp/BackendService.h"
 #include "gen_cpp/internal_service.pb.h"
+#include "olap/rowset_sync_handler.h"
+#include "olap/storage_engine.h"
 #include "runtime/buffer_control_block.h"
 #include "runtime/data_stream_mgr.h"
 #include "runtime/exec_env.h"
@@ -35,7 +37,9 @@ namespace doris {
 
 template <typename T>
 PInternalServiceImpl<T>::PInternalServiceImpl(ExecEnv* exec_env)
-        : _exec_env(exec_env), _tablet_worker_pool(config::number_tablet_writer_threads, 10240) {}
+        : _exec_env(exec_env),
+          _tablet_worker_pool(config::number_tablet_writer_threads, 10240),
+          _sync_rowset_worker_pool(config::number_sync_rowset_threads, 10240) {}
 
 template <typename T>
 PInternalServiceImpl<T>::~PInternalServiceImpl() {}
@@ -47,12 +51,29 @@ void PInternalServiceImpl<T>::transmit_data(google::protobuf::RpcController* cnt
                                             google::protobuf::Closure* done) {
     VLOG_ROW << "transmit data: fragment_instance_id=" << print_id(request->finst_id())
              << " node=" << request->node_id();
-    _exec_env->stream_mgr()->transmit_data(request, &done);
+    brpc::Controller* cntl = static_cast<brpc::Controller*>(cntl_base);
+    _exec_env->stream_mgr()->transmit_data(request, &cntl->request_attachment(), response,
+                                           &done);
     if (done != nullptr) {
         done->Run();
     }
 }
 
+template <typename T>
+void PInternalServiceImpl<T>::transmit_data_batch(google::protobuf::RpcController* cntl_base,
+                                                  const PTransmitDataBatchParams* request,
+                                                  PTransmitDataBatchResult* response,
+                                                  google::protobuf::Closure* done) {
+    VLOG_ROW << "transmit data batch: #packets=" << request->params_size();
+    brpc::ClosureGuard closure_guard(done);
+    brpc::Controller* cntl = static_cast<brpc::Controller*>(cntl_base);
+    Status st = _exec_env->stream_mgr()->transmit_data_batch(
+            request, &cntl->request_attachment(), response);
+    if (!st.ok()) {
+        cntl->SetFailed(st.get_error_msg());
+    }
+}
+
 template <typename T>
 void PInternalServiceImpl<T>::tablet_writer_open(google::protobuf::RpcController* controller,
                                                  const PTabletWriterOpenRequest* request,
@@ -130,6 +151,27 @@ void PInternalServiceImpl<T>::tablet_writer_cancel(google::protobuf::RpcControll
     }
 }
 
+template <typename T>
+void PInternalServiceImpl<T>::tablet_writer_sync_rowset(
+        google::protobuf::RpcController* cntl_base, const PTabletWriterSyncRowsetRequest* request,
+        PTabletWriterSyncRowsetResult* response, google::protobuf::Closure* done) {
+    VLOG_RPC << "tablet writer sync rowset, id=" << request->id()
+             << ", tablet_id=" << request->tablet_id() << ", txn_id=" << request->txn_id();
+    brpc::Controller* cntl = static_cast<brpc::Controller*>(cntl_base);
+    // writing segment file may cost a lot of time, put this to a local thread pool
+    _sync_rowset_worker_pool.offer([request, response, done, cntl]() {
+        brpc::ClosureGuard closure_guard(done);
+        RowsetSyncHandler handler(StorageEngine::instance());
+        auto st = handler.process(*request, cntl->request_attachment());
+        if (!st.ok()) {
+            LOG(WARNING) << "tablet writer sync rowset failed, message=" << st.get_error_msg()
+                         << ", id=" << request->id() << ", tablet_id=" << request->tablet_id()
+                         << ", txn_id=" << request->txn_id();
+        }
+        st.to_protobuf(response->mutable_status());
+    });
+}
+
 template <typename T>
 Status PInternalServiceImpl<T>::_exec_plan_fragment(brpc::Controller* cntl) {
     auto ser_request = cntl->request_attachment().to_string();
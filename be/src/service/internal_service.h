@@ -42,6 +42,11 @@ public:
                        ::doris::PTransmitDataResult* response,
                        ::google::protobuf::Closure* done) override;
 
+    void transmit_data_batch(::google::protobuf::RpcController* controller,
+                             const ::doris::PTransmitDataBatchParams* request,
+                             ::doris::PTransmitDataBatchResult* response,
+                             ::google::protobuf::Closure* done) override;
+
     void exec_plan_fragment(google::protobuf::RpcController* controller,
                             const PExecPlanFragmentRequest* request,
                             PExecPlanFragmentResult* result,
@@ -70,6 +75,11 @@ public:
                               PTabletWriterCancelResult* response,
                               google::protobuf::Closure* done) override;
 
+    void tablet_writer_sync_rowset(google::protobuf::RpcController* controller,
+                                   const PTabletWriterSyncRowsetRequest* request,
+                                   PTabletWriterSyncRowsetResult* response,
+                                   google::protobuf::Closure* done) override;
+
     void trigger_profile_report(google::protobuf::RpcController* controller,
                                 const PTriggerProfileReportRequest* request,
                                 PTriggerProfileReportResult* result,
@@ -94,6 +104,9 @@ private:
 private:
     ExecEnv* _exec_env;
     PriorityThreadPool _tablet_worker_pool;
+    // rowset sync requests are sent by tablet writers of other backends, which are
+    // waiting in their own tablet worker pool. use a separate pool to avoid deadlock.
+    PriorityThreadPool _sync_rowset_worker_pool;
 };
 
 } // namespace doris
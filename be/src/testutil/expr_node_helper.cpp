@@ -0,0 +1,89 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "testutil/expr_node_helper.h"
+
+#include "runtime/primitive_type.h"
+#include "runtime/types.h"
+
+namespace doris {
+
+TTypeDesc expr_node_type(TPrimitiveType::type type) {
+    TTypeDesc type_desc = gen_type_desc(type);
+    // the length of a string type is required
+    if (type == TPrimitiveType::CHAR) {
+        type_desc.types[0].scalar_type.__set_len(TypeDescriptor::MAX_CHAR_LENGTH);
+    } else if (type == TPrimitiveType::VARCHAR || type == TPrimitiveType::HLL) {
+        type_desc.types[0].scalar_type.__set_len(TypeDescriptor::MAX_VARCHAR_LENGTH);
+    }
+    return type_desc;
+}
+
+TExprNode slot_node(int slot_id, TPrimitiveType::type type, int tuple_id) {
+    TExprNode node;
+    node.__set_node_type(TExprNodeType::SLOT_REF);
+    node.__set_type(expr_node_type(type));
+    node.__set_num_children(0);
+    TSlotRef slot_ref;
+    slot_ref.__set_slot_id(slot_id);
+    slot_ref.__set_tuple_id(tuple_id);
+    node.__set_slot_ref(slot_ref);
+    return node;
+}
+
+TExprNode int_node(int64_t value, TPrimitiveType::type type) {
+    TExprNode node;
+    node.__set_node_type(TExprNodeType::INT_LITERAL);
+    node.__set_type(expr_node_type(type));
+    node.__set_num_children(0);
+    TIntLiteral int_literal;
+    int_literal.__set_value(value);
+    node.__set_int_literal(int_literal);
+    return node;
+}
+
+TExprNode string_node(const std::string& value) {
+    TExprNode node;
+    node.__set_node_type(TExprNodeType::STRING_LITERAL);
+    node.__set_type(expr_node_type(TPrimitiveType::VARCHAR));
+    node.__set_num_children(0);
+    TStringLiteral string_literal;
+    string_literal.__set_value(value);
+    node.__set_string_literal(string_literal);
+    return node;
+}
+
+TExprNode datetime_node(const std::string& value) {
+    TExprNode node;
+    node.__set_node_type(TExprNodeType::DATE_LITERAL);
+    node.__set_type(expr_node_type(TPrimitiveType::DATETIME));
+    node.__set_num_children(0);
+    TDateLiteral date_literal;
+    date_literal.__set_value(value);
+    node.__set_date_literal(date_literal);
+    return node;
+}
+
+TExprNode null_node(TPrimitiveType::type type) {
+    TExprNode node;
+    node.__set_node_type(TExprNodeType::NULL_LITERAL);
+    node.__set_type(expr_node_type(type));
+    node.__set_num_children(0);
+    return node;
+}
+
+} // namespace doris
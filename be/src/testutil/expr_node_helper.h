@@ -0,0 +1,49 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_TESTUTIL_EXPR_NODE_HELPER_H
+#define DORIS_BE_SRC_TESTUTIL_EXPR_NODE_HELPER_H
+
+#include <string>
+
+#include "gen_cpp/Exprs_types.h"
+#include "gen_cpp/Types_types.h"
+
+namespace doris {
+
+// Factories of the nodes of the TExprs of tests. A TExpr lists the nodes of its tree in
+// depth-first order, eg. {compare node, slot_node(0, INT), int_node(3)} for c0 < 3.
+
+// Returns the type of a node, a string type is of its max length.
+TTypeDesc expr_node_type(TPrimitiveType::type type);
+
+// A reference to slot 'slot_id' of tuple 'tuple_id'.
+TExprNode slot_node(int slot_id, TPrimitiveType::type type, int tuple_id = 0);
+
+TExprNode int_node(int64_t value, TPrimitiveType::type type = TPrimitiveType::INT);
+
+// A VARCHAR literal.
+TExprNode string_node(const std::string& value);
+
+// A DATETIME literal, 'value' is like "2020-01-01 00:00:00".
+TExprNode datetime_node(const std::string& value);
+
+TExprNode null_node(TPrimitiveType::type type);
+
+} // namespace doris
+
+#endif
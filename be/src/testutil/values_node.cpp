@@ -0,0 +1,109 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "testutil/values_node.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "runtime/descriptors.h"
+#include "runtime/row_batch.h"
+#include "runtime/runtime_state.h"
+#include "runtime/tuple.h"
+#include "runtime/tuple_row.h"
+
+namespace doris {
+
+const int32_t ValuesNode::NULL_VALUE = std::numeric_limits<int32_t>::min();
+
+TPlanNode ValuesNode::make_plan_node(int node_id, TupleId tuple_id) {
+    TPlanNode tnode;
+    tnode.__set_node_id(node_id);
+    // a list of constant rows, as a union node without children
+    tnode.__set_node_type(TPlanNodeType::UNION_NODE);
+    tnode.__set_num_children(0);
+    tnode.__set_limit(-1);
+    tnode.__set_row_tuples(std::vector<TTupleId>{tuple_id});
+    tnode.__set_nullable_tuples(std::vector<bool>{false});
+    tnode.__set_compact_data(false);
+    return tnode;
+}
+
+ValuesNode::ValuesNode(ObjectPool* pool, int node_id, const DescriptorTbl& descs,
+                       TupleId tuple_id, const std::vector<std::vector<int32_t>>& rows)
+        : ExecNode(pool, make_plan_node(node_id, tuple_id), descs), _rows(rows) {}
+
+Status ValuesNode::prepare(RuntimeState* state) {
+    RETURN_IF_ERROR(ExecNode::prepare(state));
+    _tuple_desc = _row_descriptor.tuple_descriptors()[0];
+    for (auto slot : _tuple_desc->slots()) {
+        if (slot->type().type != TYPE_INT) {
+            return Status::InvalidArgument("ValuesNode only supports INT slots");
+        }
+    }
+    return Status::OK();
+}
+
+Status ValuesNode::open(RuntimeState* state) {
+    RETURN_IF_ERROR(ExecNode::open(state));
+    _next_row = 0;
+    ++_num_opens;
+    return Status::OK();
+}
+
+Status ValuesNode::get_next(RuntimeState* state, RowBatch* row_batch, bool* eos) {
+    RETURN_IF_CANCELLED(state);
+    int max_rows = row_batch->capacity();
+    if (_batch_size > 0) {
+        max_rows = std::min(max_rows, row_batch->num_rows() + _batch_size);
+    }
+    const std::vector<SlotDescriptor*>& slots = _tuple_desc->slots();
+    while (_next_row < _rows.size() && row_batch->num_rows() < max_rows) {
+        const std::vector<int32_t>& values = _rows[_next_row++];
+        DCHECK_EQ(values.size(), slots.size());
+        Tuple* tuple = Tuple::create(_tuple_desc->byte_size(), row_batch->tuple_data_pool());
+        for (int i = 0; i < slots.size(); ++i) {
+            if (values[i] == NULL_VALUE) {
+                tuple->set_null(slots[i]->null_indicator_offset());
+            } else {
+                *reinterpret_cast<int32_t*>(tuple->get_slot(slots[i]->tuple_offset())) =
+                        values[i];
+            }
+        }
+        int row_idx = row_batch->add_row();
+        row_batch->get_row(row_idx)->set_tuple(0, tuple);
+        row_batch->commit_last_row();
+        ++_num_rows_returned;
+    }
+    *eos = _next_row == _rows.size();
+    return Status::OK();
+}
+
+Status ValuesNode::reset(RuntimeState* state) {
+    _next_row = 0;
+    ++_num_opens;
+    return ExecNode::reset(state);
+}
+
+Status ValuesNode::close(RuntimeState* state) {
+    if (is_closed()) {
+        return Status::OK();
+    }
+    return ExecNode::close(state);
+}
+
+} // namespace doris
@@ -0,0 +1,68 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_TESTUTIL_VALUES_NODE_H
+#define DORIS_BE_SRC_TESTUTIL_VALUES_NODE_H
+
+#include <vector>
+
+#include "exec/exec_node.h"
+
+namespace doris {
+
+class TupleDescriptor;
+
+// A leaf exec node returning the rows given by a test, as the child of the node under
+// test. Every row has one tuple of INT slots, a slot is NULL if its value is NULL_VALUE.
+//
+// Example usage:
+// DescriptorTblBuilder builder(&pool);
+// builder.declare_tuple() << TYPE_INT << TYPE_INT;
+// DescriptorTbl* desc_tbl = builder.build();
+// ValuesNode child(&pool, 1, *desc_tbl, 0, {{1, 10}, {2, ValuesNode::NULL_VALUE}});
+class ValuesNode : public ExecNode {
+public:
+    static const int32_t NULL_VALUE;
+
+    ValuesNode(ObjectPool* pool, int node_id, const DescriptorTbl& descs, TupleId tuple_id,
+               const std::vector<std::vector<int32_t>>& rows);
+
+    virtual Status prepare(RuntimeState* state);
+    virtual Status open(RuntimeState* state);
+    virtual Status get_next(RuntimeState* state, RowBatch* row_batch, bool* eos);
+    virtual Status reset(RuntimeState* state);
+    virtual Status close(RuntimeState* state);
+
+    // Returns at most 'batch_size' rows in a batch, to split few rows into several batches.
+    void set_batch_size(int batch_size) { _batch_size = batch_size; }
+
+    // Number of times the rows are read from the start, by open() or after reset().
+    int num_opens() const { return _num_opens; }
+
+private:
+    static TPlanNode make_plan_node(int node_id, TupleId tuple_id);
+
+    std::vector<std::vector<int32_t>> _rows;
+    const TupleDescriptor* _tuple_desc = nullptr;
+    int _batch_size = 0;
+    size_t _next_row = 0;
+    int _num_opens = 0;
+};
+
+} // namespace doris
+
+#endif // DORIS_BE_SRC_TESTUTIL_VALUES_NODE_H
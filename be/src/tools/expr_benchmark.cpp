@@ -0,0 +1,232 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+// Measures the rows per second of evaluating filters over batches of rows in the ways the
+// BE can evaluate them:
+// - exprs: a row at a time through the expr tree
+// - specialized: a row at a time through the SpecializedPredicate of the tree, if any
+// - batch: column-at-a-time, see ExecNode::eval_conjuncts_batch()
+
+#include <gflags/gflags.h>
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/object_pool.h"
+#include "exec/exec_node.h"
+#include "exprs/expr.h"
+#include "exprs/expr_context.h"
+#include "gen_cpp/Exprs_types.h"
+#include "runtime/descriptor_helper.h"
+#include "runtime/descriptors.h"
+#include "runtime/mem_tracker.h"
+#include "runtime/row_batch.h"
+#include "runtime/runtime_state.h"
+#include "runtime/tuple.h"
+#include "runtime/tuple_row.h"
+#include "testutil/expr_node_helper.h"
+#include "util/cpu_info.h"
+#include "util/stopwatch.hpp"
+
+DEFINE_int32(num_rows, 1024, "number of rows of the batch");
+DEFINE_int32(num_iters, 1000, "number of times each filter is evaluated over the batch");
+
+namespace doris {
+
+static TExprNode op_node(TExprNodeType::type node_type, TExprOpcode::type opcode,
+                         TPrimitiveType::type type, TPrimitiveType::type child_type) {
+    TExprNode node;
+    node.__set_node_type(node_type);
+    node.__set_type(expr_node_type(type));
+    node.__set_num_children(2);
+    node.__set_opcode(opcode);
+    node.__set_child_type(child_type);
+    return node;
+}
+
+class ExprBenchmark {
+public:
+    ExprBenchmark() : _state(TQueryGlobals()), _tracker(new MemTracker(-1)) {}
+
+    ~ExprBenchmark() {
+        for (ExprContext* ctx : _ctxs) {
+            ctx->close(&_state);
+        }
+    }
+
+    // Creates a batch of the nullable slots (c0 INT, c1 INT) with the rows
+    // (i % 17 - 8, i % 5 - 2), c0 is null in every 11th row and c1 in every 13th.
+    void init() {
+        _state.init_instance_mem_tracker();
+        TDescriptorTableBuilder table_builder;
+        TTupleDescriptorBuilder tuple;
+        for (int i = 0; i < 2; ++i) {
+            tuple.add_slot(TSlotDescriptorBuilder()
+                                   .type(TYPE_INT)
+                                   .nullable(true)
+                                   .column_name("c" + std::to_string(i))
+                                   .column_pos(i)
+                                   .build());
+        }
+        tuple.build(&table_builder);
+        DescriptorTbl::create(&_obj_pool, table_builder.desc_tbl(), &_desc_tbl);
+        _state.set_desc_tbl(_desc_tbl);
+        _row_desc.reset(new RowDescriptor(*_desc_tbl, {0}, {false}));
+
+        TupleDescriptor* tuple_desc = _desc_tbl->get_tuple_descriptor(0);
+        const std::vector<SlotDescriptor*>& slots = tuple_desc->slots();
+        _batch.reset(new RowBatch(*_row_desc, FLAGS_num_rows, _tracker.get()));
+        for (int i = 0; i < FLAGS_num_rows; ++i) {
+            int row_idx = _batch->add_row();
+            Tuple* tuple = Tuple::create(tuple_desc->byte_size(), _batch->tuple_data_pool());
+            *reinterpret_cast<int32_t*>(tuple->get_slot(slots[0]->tuple_offset())) = i % 17 - 8;
+            *reinterpret_cast<int32_t*>(tuple->get_slot(slots[1]->tuple_offset())) = i % 5 - 2;
+            if (i % 11 == 0) {
+                tuple->set_null(slots[0]->null_indicator_offset());
+            }
+            if (i % 13 == 0) {
+                tuple->set_null(slots[1]->null_indicator_offset());
+            }
+            _batch->get_row(row_idx)->set_tuple(0, tuple);
+            _batch->commit_last_row();
+            _rows.push_back(_batch->get_row(row_idx));
+        }
+    }
+
+    // Prints the rows per second of each way to evaluate the filter of 'nodes'.
+    Status run(const std::string& name, const std::vector<TExprNode>& nodes) {
+        TExpr texpr;
+        texpr.nodes = nodes;
+        ExprContext* ctx = nullptr;
+        RETURN_IF_ERROR(Expr::create_expr_tree(&_obj_pool, texpr, &ctx));
+        _ctxs.push_back(ctx);
+        RETURN_IF_ERROR(ctx->prepare(&_state, *_row_desc, _tracker));
+        RETURN_IF_ERROR(ctx->open(&_state));
+        std::cout << name << std::endl;
+
+        MonotonicStopWatch expr_watch;
+        expr_watch.start();
+        int expr_matches = 0;
+        for (int k = 0; k < FLAGS_num_iters; ++k) {
+            for (TupleRow* row : _rows) {
+                BooleanVal value = ctx->root()->get_boolean_val(ctx, row);
+                expr_matches += !value.is_null && value.val;
+            }
+        }
+        print_rate("exprs", expr_watch.elapsed_time());
+
+        if (ctx->specialized_predicate() != nullptr) {
+            MonotonicStopWatch specialized_watch;
+            specialized_watch.start();
+            int specialized_matches = 0;
+            for (int k = 0; k < FLAGS_num_iters; ++k) {
+                for (TupleRow* row : _rows) {
+                    BooleanVal value = ctx->get_boolean_val(row);
+                    specialized_matches += !value.is_null && value.val;
+                }
+            }
+            print_rate("specialized", specialized_watch.elapsed_time());
+            RETURN_IF_ERROR(check_matches(expr_matches, specialized_matches));
+        }
+
+        std::vector<TupleRow*> rows(_rows.size());
+        std::vector<int> sel(_rows.size());
+        MonotonicStopWatch batch_watch;
+        batch_watch.start();
+        int batch_matches = 0;
+        for (int k = 0; k < FLAGS_num_iters; ++k) {
+            std::copy(_rows.begin(), _rows.end(), rows.begin());
+            batch_matches += ExecNode::eval_conjuncts_batch(&ctx, 1, rows.data(), rows.size(),
+                                                            sel.data());
+        }
+        print_rate("batch", batch_watch.elapsed_time());
+        return check_matches(expr_matches, batch_matches);
+    }
+
+private:
+    void print_rate(const std::string& way, int64_t elapsed_ns) {
+        int64_t num_rows = static_cast<int64_t>(FLAGS_num_iters) * FLAGS_num_rows;
+        std::cout << "    " << way << ": "
+                  << num_rows * 1000000000L / std::max<int64_t>(elapsed_ns, 1) << " rows/s"
+                  << std::endl;
+    }
+
+    static Status check_matches(int expected, int actual) {
+        if (expected != actual) {
+            return Status::InternalError("matched " + std::to_string(actual) +
+                                         " rows, expected " + std::to_string(expected));
+        }
+        return Status::OK();
+    }
+
+    ObjectPool _obj_pool;
+    RuntimeState _state;
+    std::shared_ptr<MemTracker> _tracker;
+    DescriptorTbl* _desc_tbl = nullptr;
+    std::unique_ptr<RowDescriptor> _row_desc;
+    std::unique_ptr<RowBatch> _batch;
+    std::vector<TupleRow*> _rows;
+    std::vector<ExprContext*> _ctxs;
+};
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    gflags::SetUsageMessage("Prints the rows per second of the ways to evaluate filters.\n"
+                            "Usage: expr_benchmark [--num_rows=1024] [--num_iters=1000]");
+    google::ParseCommandLineFlags(&argc, &argv, true);
+    if (FLAGS_num_rows <= 0 || FLAGS_num_iters <= 0) {
+        std::cerr << "num_rows and num_iters must be positive" << std::endl;
+        return -1;
+    }
+    doris::CpuInfo::init();
+
+    using doris::TExprNodeType;
+    using doris::TExprOpcode;
+    using doris::TPrimitiveType;
+    TPrimitiveType::type BIGINT = TPrimitiveType::BIGINT;
+    TPrimitiveType::type BOOLEAN = TPrimitiveType::BOOLEAN;
+    TPrimitiveType::type INT = TPrimitiveType::INT;
+    doris::ExprBenchmark benchmark;
+    benchmark.init();
+    doris::Status status = benchmark.run(
+            "c0 + c1 * 2 > 0",
+            {doris::op_node(TExprNodeType::BINARY_PRED, TExprOpcode::GT, BOOLEAN, BIGINT),
+             doris::op_node(TExprNodeType::ARITHMETIC_EXPR, TExprOpcode::ADD, BIGINT, BIGINT),
+             doris::slot_node(0, INT),
+             doris::op_node(TExprNodeType::ARITHMETIC_EXPR, TExprOpcode::MULTIPLY, BIGINT,
+                            BIGINT),
+             doris::slot_node(1, INT), doris::int_node(2, BIGINT), doris::int_node(0, BIGINT)});
+    if (status.ok()) {
+        status = benchmark.run(
+                "c0 >= -2 AND c0 <= 4",
+                {doris::op_node(TExprNodeType::COMPOUND_PRED, TExprOpcode::COMPOUND_AND, BOOLEAN,
+                                BOOLEAN),
+                 doris::op_node(TExprNodeType::BINARY_PRED, TExprOpcode::GE, BOOLEAN, INT),
+                 doris::slot_node(0, INT), doris::int_node(-2),
+                 doris::op_node(TExprNodeType::BINARY_PRED, TExprOpcode::LE, BOOLEAN, INT),
+                 doris::slot_node(0, INT), doris::int_node(4)});
+    }
+    if (!status.ok()) {
+        std::cerr << status.to_string() << std::endl;
+        return -1;
+    }
+    return 0;
+}
@@ -18,6 +18,8 @@
 #include "util/arrow/row_block.h"
 
 #include <arrow/array/builder_primitive.h>
+#include <arrow/buffer.h>
+#include <arrow/builder.h>
 #include <arrow/memory_pool.h>
 #include <arrow/pretty_print.h>
 #include <arrow/record_batch.h>
@@ -32,7 +34,13 @@
 #include "olap/row_block2.h"
 #include "olap/schema.h"
 #include "olap/tablet_schema.h"
+#include "olap/uint24.h"
+#include "runtime/datetime_value.h"
+#include "runtime/decimal_value.h"
+#include "runtime/decimalv2_value.h"
+#include "runtime/large_int_value.h"
 #include "util/arrow/utils.h"
+#include "util/types.h"
 
 namespace doris {
 
@@ -137,14 +145,27 @@ Status convert_to_doris_schema(const arrow::Schema& schema, std::shared_ptr<Sche
     return Status::OK();
 }
 
+// An arrow buffer pointing into the column data of a RowBlockV2, keeps the block alive as
+// long as the buffer is referenced.
+class RowBlockBuffer : public arrow::Buffer {
+public:
+    RowBlockBuffer(const uint8_t* data, int64_t size, std::shared_ptr<const RowBlockV2> block)
+            : arrow::Buffer(data, size), _block(std::move(block)) {}
+
+private:
+    std::shared_ptr<const RowBlockV2> _block;
+};
+
 // Convert data in RowBlockV2 to an Arrow RecordBatch
 // We should keep this function to keep compatible with arrow's type visitor
 // Now we inherit TypeVisitor to use default Visit implementation
 class FromRowBlockConverter : public arrow::TypeVisitor {
 public:
-    FromRowBlockConverter(const RowBlockV2& block, const std::shared_ptr<arrow::Schema>& schema,
-                          arrow::MemoryPool* pool)
-            : _block(block), _schema(schema), _pool(pool) {}
+    // If 'owner' is not null, fixed-width columns without nulls are not copied, the
+    // result references the column data and holds 'owner'.
+    FromRowBlockConverter(const RowBlockV2& block, std::shared_ptr<const RowBlockV2> owner,
+                          const std::shared_ptr<arrow::Schema>& schema, arrow::MemoryPool* pool)
+            : _block(block), _owner(std::move(owner)), _schema(schema), _pool(pool) {}
 
     ~FromRowBlockConverter() override {}
 
@@ -163,34 +184,160 @@ public:
 
 #undef PRIMITIVE_VISIT
 
+    // process string-transformable column, same as the strings converted from tuples
+    arrow::Status Visit(const arrow::StringType& type) override {
+        arrow::StringBuilder builder(_pool);
+        ARROW_RETURN_NOT_OK(builder.Reserve(_num_rows));
+        auto field_type = _cur_field->type();
+        for (size_t i = 0; i < _num_rows; ++i) {
+            auto cell_ptr = _get_cell(i);
+            if (cell_ptr == nullptr) {
+                ARROW_RETURN_NOT_OK(builder.AppendNull());
+                continue;
+            }
+            switch (field_type) {
+            case OLAP_FIELD_TYPE_CHAR: {
+                const Slice* slice = reinterpret_cast<const Slice*>(cell_ptr);
+                ARROW_RETURN_NOT_OK(builder.Append(slice->data, strnlen(slice->data, slice->size)));
+                break;
+            }
+            case OLAP_FIELD_TYPE_VARCHAR:
+            case OLAP_FIELD_TYPE_HLL: {
+                const Slice* slice = reinterpret_cast<const Slice*>(cell_ptr);
+                ARROW_RETURN_NOT_OK(builder.Append(slice->data, slice->size));
+                break;
+            }
+            case OLAP_FIELD_TYPE_DATE:
+            case OLAP_FIELD_TYPE_DATETIME: {
+                DateTimeValue time_val;
+                bool valid = field_type == OLAP_FIELD_TYPE_DATE
+                                     ? time_val.from_olap_date(
+                                               *reinterpret_cast<const uint24_t*>(cell_ptr))
+                                     : time_val.from_olap_datetime(
+                                               *reinterpret_cast<const uint64_t*>(cell_ptr));
+                if (!valid) {
+                    ARROW_RETURN_NOT_OK(builder.AppendNull());
+                    break;
+                }
+                char buf[64];
+                char* pos = time_val.to_string(buf);
+                ARROW_RETURN_NOT_OK(builder.Append(buf, pos - buf - 1));
+                break;
+            }
+            case OLAP_FIELD_TYPE_LARGEINT: {
+                char buf[48];
+                int len = 48;
+                char* v = LargeIntValue::to_string(
+                        reinterpret_cast<const PackedInt128*>(cell_ptr)->value, buf, &len);
+                ARROW_RETURN_NOT_OK(builder.Append(v, len));
+                break;
+            }
+            case OLAP_FIELD_TYPE_DECIMAL: {
+                const decimal12_t* decimal = reinterpret_cast<const decimal12_t*>(cell_ptr);
+                DecimalValue decimal_val(decimal->integer, decimal->fraction);
+                ARROW_RETURN_NOT_OK(builder.Append(decimal_val.to_string()));
+                break;
+            }
+            default:
+                return arrow::Status::TypeError(
+                        Substitute("can't convert FieldType($0) to arrow string", field_type));
+            }
+        }
+        return builder.Finish(&_arrays[_cur_field_idx]);
+    }
+
+    // process doris DecimalV2
+    arrow::Status Visit(const arrow::Decimal128Type& type) override {
+        if (_cur_field->type() != OLAP_FIELD_TYPE_DECIMAL) {
+            return arrow::Status::TypeError(
+                    Substitute("can't convert FieldType($0) to arrow decimal", _cur_field->type()));
+        }
+        arrow::Decimal128Builder builder(_schema->field(_cur_field_idx)->type(), _pool);
+        ARROW_RETURN_NOT_OK(builder.Reserve(_num_rows));
+        for (size_t i = 0; i < _num_rows; ++i) {
+            auto cell_ptr = _get_cell(i);
+            if (cell_ptr == nullptr) {
+                ARROW_RETURN_NOT_OK(builder.AppendNull());
+                continue;
+            }
+            const decimal12_t* decimal = reinterpret_cast<const decimal12_t*>(cell_ptr);
+            DecimalV2Value decimal_val;
+            if (!decimal_val.from_olap_decimal(decimal->integer, decimal->fraction)) {
+                ARROW_RETURN_NOT_OK(builder.AppendNull());
+                continue;
+            }
+            int64_t high = decimal_val.value() >> 64;
+            uint64_t low = decimal_val.value();
+            ARROW_RETURN_NOT_OK(builder.Append(arrow::Decimal128(high, low)));
+        }
+        return builder.Finish(&_arrays[_cur_field_idx]);
+    }
+
     Status convert(std::shared_ptr<arrow::RecordBatch>* out);
 
 private:
+    // Returns the cell of the i-th selected row in the current column, nullptr if it is null.
+    const uint8_t* _get_cell(size_t i) const {
+        size_t row = _selection == nullptr ? i : _selection[i];
+        return _cur_column.is_null(row) ? nullptr : _cur_column.cell_ptr(row);
+    }
+
     template <typename T>
     typename std::enable_if<std::is_base_of<arrow::PrimitiveCType, T>::value, arrow::Status>::type
     _visit(const T& type) {
-        arrow::NumericBuilder<T> builder(_pool);
-        size_t num_rows = _block.num_rows();
-        builder.Reserve(num_rows);
+        std::shared_ptr<arrow::DataType> field_type;
+        if (!convert_to_arrow_type(_cur_field->type(), &field_type).ok() ||
+            field_type->id() != type.id()) {
+            return arrow::Status::TypeError(Substitute("can't convert FieldType($0) to $1",
+                                                       _cur_field->type(), type.ToString()));
+        }
+        using c_type = typename T::c_type;
+        if (_owner != nullptr && _selection == nullptr && !_has_null()) {
+            // same layout as the arrow array, reference the column data directly
+            auto data = std::make_shared<RowBlockBuffer>(_cur_column.data(),
+                                                         _num_rows * sizeof(c_type), _owner);
+            _arrays[_cur_field_idx] = std::make_shared<arrow::NumericArray<T>>(_num_rows, data);
+            return arrow::Status::OK();
+        }
 
-        auto column_block = _block.column_block(_cur_field_idx);
-        for (size_t i = 0; i < num_rows; ++i) {
-            if (column_block.is_null(i)) {
+        arrow::NumericBuilder<T> builder(_pool);
+        ARROW_RETURN_NOT_OK(builder.Reserve(_num_rows));
+        for (size_t i = 0; i < _num_rows; ++i) {
+            auto cell_ptr = _get_cell(i);
+            if (cell_ptr == nullptr) {
                 ARROW_RETURN_NOT_OK(builder.AppendNull());
             } else {
-                auto cell_ptr = column_block.cell_ptr(i);
-                ARROW_RETURN_NOT_OK(builder.Append(*(typename T::c_type*)cell_ptr));
+                ARROW_RETURN_NOT_OK(builder.Append(*(const c_type*)cell_ptr));
             }
         }
         return builder.Finish(&_arrays[_cur_field_idx]);
     }
 
+    bool _has_null() const {
+        if (!_cur_column.is_nullable()) {
+            return false;
+        }
+        for (size_t i = 0; i < _num_rows; ++i) {
+            if (_cur_column.is_null(i)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
 private:
     const RowBlockV2& _block;
+    std::shared_ptr<const RowBlockV2> _owner;
     std::shared_ptr<arrow::Schema> _schema;
     arrow::MemoryPool* _pool;
 
+    size_t _num_rows = 0;
+    // row indexes of the selected rows, nullptr if the first _num_rows rows are selected
+    const uint16_t* _selection = nullptr;
+
     size_t _cur_field_idx;
+    const Field* _cur_field = nullptr;
+    ColumnBlock _cur_column {nullptr, nullptr};
     std::vector<std::shared_ptr<arrow::Array>> _arrays;
 };
 
@@ -200,22 +347,41 @@ Status FromRowBlockConverter::convert(std::shared_ptr<arrow::RecordBatch>* out)
         return Status::InvalidArgument("Schema not match");
     }
 
+    // the storage engine sets num_rows to the number of rows that passed the predicates,
+    // whose indexes are the first num_rows entries of the selection vector.
+    _num_rows = _block.num_rows();
+    const uint16_t* selection = _block.selection_vector();
+    if (_num_rows > 0 && selection[_num_rows - 1] != _num_rows - 1) {
+        _selection = selection;
+    }
+
     _arrays.resize(num_fields);
     for (int idx = 0; idx < num_fields; ++idx) {
         _cur_field_idx = idx;
+        auto cid = _block.schema()->column_ids()[idx];
+        _cur_field = _block.schema()->column(cid);
+        _cur_column = _block.column_block(cid);
         auto arrow_st = arrow::VisitTypeInline(*_schema->field(idx)->type(), this);
         if (!arrow_st.ok()) {
             return to_status(arrow_st);
         }
     }
-    *out = arrow::RecordBatch::Make(_schema, _block.num_rows(), std::move(_arrays));
+    *out = arrow::RecordBatch::Make(_schema, _num_rows, std::move(_arrays));
     return Status::OK();
 }
 
 Status convert_to_arrow_batch(const RowBlockV2& block, const std::shared_ptr<arrow::Schema>& schema,
                               arrow::MemoryPool* pool,
                               std::shared_ptr<arrow::RecordBatch>* result) {
-    FromRowBlockConverter converter(block, schema, pool);
+    FromRowBlockConverter converter(block, nullptr, schema, pool);
+    return converter.convert(result);
+}
+
+Status convert_to_arrow_batch(const std::shared_ptr<const RowBlockV2>& block,
+                              const std::shared_ptr<arrow::Schema>& schema,
+                              arrow::MemoryPool* pool,
+                              std::shared_ptr<arrow::RecordBatch>* result) {
+    FromRowBlockConverter converter(*block, block, schema, pool);
     return converter.convert(result);
 }
 
@@ -49,6 +49,13 @@ Status convert_to_doris_schema(const arrow::Schema& schema, std::shared_ptr<Sche
 Status convert_to_arrow_batch(const RowBlockV2& block, const std::shared_ptr<arrow::Schema>& schema,
                               arrow::MemoryPool* pool, std::shared_ptr<arrow::RecordBatch>* result);
 
+// Same as above, but fixed-width columns without null values are not copied, the result
+// references the block's memory and keeps the block alive. Only the rows selected by the
+// block's selection vector are converted.
+Status convert_to_arrow_batch(const std::shared_ptr<const RowBlockV2>& block,
+                              const std::shared_ptr<arrow::Schema>& schema,
+                              arrow::MemoryPool* pool, std::shared_ptr<arrow::RecordBatch>* result);
+
 // Convert an Arrow RecordBatch to a Doris RowBlockV2. Schema should match
 // with RecordBatch's schema.
 Status convert_to_row_block(const arrow::RecordBatch& batch, const Schema& schema,
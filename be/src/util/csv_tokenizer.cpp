@@ -0,0 +1,153 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "util/csv_tokenizer.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <glog/logging.h>
+
+namespace doris {
+
+#ifdef __SSE2__
+// return a bitmask of the bytes in [p, p + 32) which equal to 'c'
+static inline uint32_t match_32_bytes(const char* p, __m128i c) {
+    __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16));
+    uint32_t lo_mask = _mm_movemask_epi8(_mm_cmpeq_epi8(lo, c));
+    uint32_t hi_mask = _mm_movemask_epi8(_mm_cmpeq_epi8(hi, c));
+    return lo_mask | (hi_mask << 16);
+}
+#endif
+
+CsvTokenizer::CsvTokenizer(const std::string& separator, char enclose)
+        : _separator(separator), _enclose(enclose) {
+    DCHECK(!_separator.empty());
+}
+
+void CsvTokenizer::split(const Slice& line, std::vector<Slice>* fields) const {
+    fields->clear();
+    if (_enclose == 0) {
+        _split_plain(line, fields);
+    } else {
+        _split_enclosed(line, fields);
+    }
+}
+
+void CsvTokenizer::_add_field(const char* begin, const char* end,
+                              std::vector<Slice>* fields) const {
+    if (_enclose != 0 && end - begin >= 2 && *begin == _enclose && *(end - 1) == _enclose) {
+        ++begin;
+        --end;
+    }
+    fields->emplace_back(begin, end - begin);
+}
+
+void CsvTokenizer::_split_plain(const Slice& line, std::vector<Slice>* fields) const {
+    const char* value = line.data;
+    const char* p = line.data;
+    const char* end = line.data + line.size;
+    const size_t sep_size = _separator.size();
+#ifdef __SSE2__
+    const __m128i sep = _mm_set1_epi8(_separator[0]);
+    for (; p + 32 <= end; p += 32) {
+        uint32_t mask = match_32_bytes(p, sep);
+        while (mask != 0) {
+            const char* pos = p + __builtin_ctz(mask);
+            mask &= mask - 1;
+            // 'pos' may be inside the previous separator when separator has repeated bytes
+            if (pos >= value && _is_separator(pos, end)) {
+                fields->emplace_back(value, pos - value);
+                value = pos + sep_size;
+            }
+        }
+    }
+#endif
+    for (; p < end; ++p) {
+        if (*p == _separator[0] && p >= value && _is_separator(p, end)) {
+            fields->emplace_back(value, p - value);
+            value = p + sep_size;
+        }
+    }
+    fields->emplace_back(value, end - value);
+}
+
+void CsvTokenizer::_split_enclosed(const Slice& line, std::vector<Slice>* fields) const {
+    const char* value = line.data;
+    const char* p = line.data;
+    const char* end = line.data + line.size;
+    const size_t sep_size = _separator.size();
+    bool in_enclose = false;
+#ifdef __SSE2__
+    const __m128i sep = _mm_set1_epi8(_separator[0]);
+    const __m128i enclose = _mm_set1_epi8(_enclose);
+    for (; p + 32 <= end; p += 32) {
+        uint32_t sep_mask = match_32_bytes(p, sep);
+        uint32_t enclose_mask = match_32_bytes(p, enclose);
+        if (in_enclose && enclose_mask == 0) {
+            // the whole block is inside an enclosed field
+            continue;
+        }
+        uint32_t mask = sep_mask | enclose_mask;
+        while (mask != 0) {
+            int idx = __builtin_ctz(mask);
+            const char* pos = p + idx;
+            mask &= mask - 1;
+            if (enclose_mask & (1u << idx)) {
+                in_enclose = !in_enclose;
+            } else if (!in_enclose && pos >= value && _is_separator(pos, end)) {
+                _add_field(value, pos, fields);
+                value = pos + sep_size;
+            }
+        }
+    }
+#endif
+    for (; p < end; ++p) {
+        if (*p == _enclose) {
+            in_enclose = !in_enclose;
+        } else if (!in_enclose && *p == _separator[0] && p >= value && _is_separator(p, end)) {
+            _add_field(value, p, fields);
+            value = p + sep_size;
+        }
+    }
+    _add_field(value, end, fields);
+}
+
+void CsvTokenizer::split_naive(const Slice& line, std::vector<Slice>* fields) const {
+    fields->clear();
+    const char* value = line.data;
+    const char* end = line.data + line.size;
+    bool in_enclose = false;
+    for (const char* p = line.data; p < end;) {
+        if (_enclose != 0 && *p == _enclose) {
+            in_enclose = !in_enclose;
+            ++p;
+        } else if (!in_enclose && end - p >= _separator.size() &&
+                   memcmp(p, _separator.data(), _separator.size()) == 0) {
+            _add_field(value, p, fields);
+            p += _separator.size();
+            value = p;
+        } else {
+            ++p;
+        }
+    }
+    _add_field(value, end, fields);
+}
+
+} // namespace doris
@@ -0,0 +1,74 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#ifndef DORIS_BE_SRC_UTIL_CSV_TOKENIZER_H
+#define DORIS_BE_SRC_UTIL_CSV_TOKENIZER_H
+
+#include <string>
+#include <vector>
+
+#include "util/slice.h"
+
+namespace doris {
+
+// Split a csv line into fields.
+//
+// Instead of comparing the line byte by byte, the tokenizer builds a structural
+// index of the line with simd instructions: 32 bytes are compared against the
+// first byte of separator (and the enclose char) at once, and the result bitmask
+// is walked with count-trailing-zeros. So the cost is mostly proportional to the
+// number of fields, not to the number of bytes.
+//
+// The separator can contain more than one byte, the candidates found by its first
+// byte are verified against the whole separator. Separators never overlap, eg.
+// "a|||b" with separator "||" is split into "a" and "|b".
+//
+// If 'enclose' is not 0, separators between a pair of enclose chars are part of
+// the field, and the enclose chars around a field are stripped. The doubled
+// enclose char inside an enclosed field is kept as is.
+class CsvTokenizer {
+public:
+    CsvTokenizer(const std::string& separator, char enclose = 0);
+
+    // 'fields' is cleared first, and the fields point into 'line'.
+    void split(const Slice& line, std::vector<Slice>* fields) const;
+
+    // Same as split(), byte by byte. Used to verify split().
+    void split_naive(const Slice& line, std::vector<Slice>* fields) const;
+
+    const std::string& separator() const { return _separator; }
+
+private:
+    void _split_plain(const Slice& line, std::vector<Slice>* fields) const;
+    void _split_enclosed(const Slice& line, std::vector<Slice>* fields) const;
+
+    // return true if a whole separator starts at 'pos', 'pos' points to first byte of separator
+    bool _is_separator(const char* pos, const char* end) const {
+        return _separator.size() == 1 ||
+               (end - pos >= _separator.size() &&
+                memcmp(pos + 1, _separator.data() + 1, _separator.size() - 1) == 0);
+    }
+
+    void _add_field(const char* begin, const char* end, std::vector<Slice>* fields) const;
+
+    std::string _separator;
+    char _enclose;
+};
+
+} // namespace doris
+
+#endif // DORIS_BE_SRC_UTIL_CSV_TOKENIZER_H
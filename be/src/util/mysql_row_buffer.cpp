@@ -17,11 +17,16 @@
 
 #include "util/mysql_row_buffer.h"
 
+#include <double-conversion/double-conversion.h>
+#include <float.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <cmath>
+
 #include "common/logging.h"
 #include "gutil/strings/numbers.h"
+#include "runtime/datetime_value.h"
 #include "util/mysql_global.h"
 
 namespace doris {
@@ -55,6 +60,78 @@ static char* pack_vlen(char* packet, uint64_t length) {
     int8store(packet, length);
     return packet + 8;
 }
+// Writes the decimal 'digits', whose decimal point is at 'point', like printf's "%.<precision>g"
+// does, and returns the end of the output. 'length' must not exceed 'precision'.
+static char* format_digits(bool negative, const char* digits, int length, int point,
+                           int precision, char* out) {
+    // "%g" removes the trailing zeros
+    while (length > 1 && digits[length - 1] == '0') {
+        --length;
+    }
+    if (negative) {
+        *out++ = '-';
+    }
+    int exponent = point - 1;
+    if (exponent < -4 || exponent >= precision) {
+        *out++ = digits[0];
+        if (length > 1) {
+            *out++ = '.';
+            memcpy(out, digits + 1, length - 1);
+            out += length - 1;
+        }
+        *out++ = 'e';
+        *out++ = exponent < 0 ? '-' : '+';
+        exponent = std::abs(exponent);
+        // at least two digits in the exponent
+        if (exponent < 10) {
+            *out++ = '0';
+        }
+        return FastInt32ToBufferLeft(exponent, out);
+    }
+    if (point <= 0) {
+        *out++ = '0';
+        *out++ = '.';
+        memset(out, '0', -point);
+        out += -point;
+        memcpy(out, digits, length);
+        return out + length;
+    }
+    if (point >= length) {
+        memcpy(out, digits, length);
+        memset(out + length, '0', point - length);
+        return out + point;
+    }
+    memcpy(out, digits, point);
+    out[point] = '.';
+    memcpy(out + point + 1, digits + point, length - point);
+    return out + length + 1;
+}
+
+// Same output as DoubleToBuffer() and FloatToBuffer(): "%.<digits10>g" if it is parsed back
+// to the same value, "%.<digits10 + 2>g" otherwise, without printf and strtod. The shortest
+// digits that are parsed back to the value are within half a unit of the 'digits10'-th digit
+// from it, so if there are at most 'digits10' of them, they are the digits of the first
+// format. 'value' must be normal or zero, subnormals have fewer significant digits.
+static int fast_float_to_buffer(double value, bool single, int digits10, char* buffer) {
+    using double_conversion::DoubleToStringConverter;
+    char digits[DoubleToStringConverter::kBase10MaximalLength + 2];
+    bool negative = false;
+    int length = 0;
+    int point = 0;
+    DoubleToStringConverter::DoubleToAscii(
+            value,
+            single ? DoubleToStringConverter::SHORTEST_SINGLE : DoubleToStringConverter::SHORTEST,
+            0, digits, sizeof(digits), &negative, &length, &point);
+    int precision = digits10;
+    if (length > digits10) {
+        precision = digits10 + 2;
+        DoubleToStringConverter::DoubleToAscii(value, DoubleToStringConverter::PRECISION,
+                                               precision, digits, sizeof(digits), &negative,
+                                               &length, &point);
+    }
+    return format_digits(negative, digits, length, point, precision, buffer) - buffer;
+}
+
 MysqlRowBuffer::MysqlRowBuffer()
         : _pos(_default_buf), _buf(_default_buf), _buf_size(sizeof(_default_buf)) {}
 
@@ -106,12 +183,7 @@ int MysqlRowBuffer::push_tinyint(int8_t data) {
         return ret;
     }
 
-    int length = snprintf(_pos + 1, MAX_TINYINT_WIDTH + 2, "%d", data);
-
-    if (length < 0) {
-        LOG(ERROR) << "snprintf failed. data = " << data;
-        return length;
-    }
+    int length = FastInt32ToBufferLeft(data, _pos + 1) - (_pos + 1);
 
     int1store(_pos, length);
     _pos += length + 1;
@@ -127,12 +199,7 @@ int MysqlRowBuffer::push_smallint(int16_t data) {
         return ret;
     }
 
-    int length = snprintf(_pos + 1, MAX_SMALLINT_WIDTH + 2, "%d", data);
-
-    if (length < 0) {
-        LOG(ERROR) << "snprintf failed. data = " << data;
-        return length;
-    }
+    int length = FastInt32ToBufferLeft(data, _pos + 1) - (_pos + 1);
 
     int1store(_pos, length);
     _pos += length + 1;
@@ -148,12 +215,7 @@ int MysqlRowBuffer::push_int(int32_t data) {
         return ret;
     }
 
-    int length = snprintf(_pos + 1, MAX_INT_WIDTH + 2, "%d", data);
-
-    if (length < 0) {
-        LOG(ERROR) << "snprintf failed. data = " << data;
-        return length;
-    }
+    int length = FastInt32ToBufferLeft(data, _pos + 1) - (_pos + 1);
 
     int1store(_pos, length);
     _pos += length + 1;
@@ -169,12 +231,7 @@ int MysqlRowBuffer::push_bigint(int64_t data) {
         return ret;
     }
 
-    int length = snprintf(_pos + 1, MAX_BIGINT_WIDTH + 2, "%ld", data);
-
-    if (length < 0) {
-        LOG(ERROR) << "snprintf failed. data = " << data;
-        return length;
-    }
+    int length = FastInt64ToBufferLeft(data, _pos + 1) - (_pos + 1);
 
     int1store(_pos, length);
     _pos += length + 1;
@@ -190,12 +247,7 @@ int MysqlRowBuffer::push_unsigned_bigint(uint64_t data) {
         return ret;
     }
 
-    int length = snprintf(_pos + 1, MAX_BIGINT_WIDTH + 3, "%ld", data);
-
-    if (length < 0) {
-        LOG(ERROR) << "snprintf failed. data = " << data;
-        return length;
-    }
+    int length = FastUInt64ToBufferLeft(data, _pos + 1) - (_pos + 1);
 
     int1store(_pos, length);
     _pos += length + 1;
@@ -211,7 +263,12 @@ int MysqlRowBuffer::push_float(float data) {
         return ret;
     }
 
-    int length = FloatToBuffer(data, MAX_FLOAT_STR_LENGTH + 2, _pos + 1);
+    int length = 0;
+    if (std::isnormal(data) || data == 0) {
+        length = fast_float_to_buffer(data, true, FLT_DIG, _pos + 1);
+    } else {
+        length = FloatToBuffer(data, MAX_FLOAT_STR_LENGTH + 2, _pos + 1);
+    }
 
     if (length < 0) {
         LOG(ERROR) << "gcvt float failed. data = " << data;
@@ -232,7 +289,12 @@ int MysqlRowBuffer::push_double(double data) {
         return ret;
     }
 
-    int length = DoubleToBuffer(data, MAX_DOUBLE_STR_LENGTH + 2, _pos + 1);
+    int length = 0;
+    if (std::isnormal(data) || data == 0) {
+        length = fast_float_to_buffer(data, false, DBL_DIG, _pos + 1);
+    } else {
+        length = DoubleToBuffer(data, MAX_DOUBLE_STR_LENGTH + 2, _pos + 1);
+    }
 
     if (length < 0) {
         LOG(ERROR) << "gcvt double failed. data = " << data;
@@ -264,6 +326,22 @@ int MysqlRowBuffer::push_string(const char* str, int length) {
     return 0;
 }
 
+int MysqlRowBuffer::push_datetime(const DateTimeValue& data) {
+    // 1 for length, 64 for 'YYYY-MM-DD hh:mm:ss.xxxxxx' and string trail with some margin
+    int ret = reserve(1 + 64);
+
+    if (0 != ret) {
+        LOG(ERROR) << "mysql row buffer reserve failed.";
+        return ret;
+    }
+
+    // to_string() returns the position after the string trail
+    int length = data.to_string(_pos + 1) - (_pos + 1) - 1;
+    int1store(_pos, length);
+    _pos += length + 1;
+    return 0;
+}
+
 int MysqlRowBuffer::push_null() {
     int ret = reserve(1);
 
@@ -22,6 +22,8 @@
 
 namespace doris {
 
+class DateTimeValue;
+
 // helper for construct MySQL send row
 // Now only support text protocol
 class MysqlRowBuffer {
@@ -40,6 +42,8 @@ public:
     int push_float(float data);
     int push_double(double data);
     int push_string(const char* str, int length);
+    // DATE or DATETIME, formatted as DateTimeValue::to_string()
+    int push_datetime(const DateTimeValue& data);
     int push_null();
 
     // this function reserved size, change the pos step size, return old pos
@@ -44,6 +44,10 @@ public:
 
     void join() { brpc::Join(cntl.call_id()); }
 
+    // Returns true if the rpc this closure was passed to has not run it yet, given the
+    // caller keeps one reference of its own.
+    bool is_rpc_running() const { return _refs.load() > 1; }
+
     brpc::Controller cntl;
     T result;
 
@@ -17,6 +17,131 @@
 
 #include "util/tuple_row_compare.h"
 
+#include "runtime/datetime_value.h"
 #include "runtime/runtime_state.h"
+#include "runtime/string_value.h"
+#include "util/radix_sort.h"
 
-namespace doris {}
+namespace doris {
+
+// The top bit of a normalized key is set for the values if NULLs sort first, and for the
+// NULLs if they sort last. The value is encoded in the other 63 bits.
+static const uint64_t NULL_BIT = 1ULL << 63;
+static const uint64_t VALUE_MASK = NULL_BIT - 1;
+
+void TupleRowComparator::init_normalized_key() {
+    _has_normalized_key = false;
+    _normalized_key_is_exact = false;
+    if (_key_expr_ctxs_lhs.empty()) {
+        return;
+    }
+    switch (_key_expr_ctxs_lhs[0]->root()->type().type) {
+    case TYPE_BOOLEAN:
+    case TYPE_TINYINT:
+    case TYPE_SMALLINT:
+    case TYPE_INT:
+    case TYPE_FLOAT:
+        _has_normalized_key = true;
+        // The whole value fits in the key, so equal keys are equal values.
+        _normalized_key_is_exact = _key_expr_ctxs_lhs.size() == 1;
+        break;
+    case TYPE_BIGINT:
+    case TYPE_DOUBLE:
+    case TYPE_DATE:
+    case TYPE_DATETIME:
+    case TYPE_LARGEINT:
+    case TYPE_DECIMALV2:
+    case TYPE_CHAR:
+    case TYPE_VARCHAR:
+        _has_normalized_key = true;
+        break;
+    default:
+        break;
+    }
+}
+
+// Maps a signed value to an unsigned one with the same order.
+static inline uint64_t encode_signed(int64_t value) {
+    return static_cast<uint64_t>(value) ^ (1ULL << 63);
+}
+
+static inline uint32_t encode_signed32(int32_t value) {
+    return static_cast<uint32_t>(value) ^ (1U << 31);
+}
+
+// Maps the bits of a float or double to an unsigned value with the same order.
+template <typename KeyBits>
+static inline KeyBits encode_float_bits(KeyBits bits) {
+    return RadixSortFloatTransform<KeyBits>::forward(bits);
+}
+
+uint64_t TupleRowComparator::normalized_key(TupleRow* row) const {
+    DCHECK(_has_normalized_key);
+    const void* value = _key_expr_ctxs_lhs[0]->get_value(row);
+    if (value == NULL) {
+        return _nulls_first[0] < 0 ? 0 : NULL_BIT;
+    }
+
+    // Values of up to 32 bits are encoded as is, the wider ones drop their lowest bit and
+    // ties are broken by compare().
+    uint64_t key = 0;
+    switch (_key_expr_ctxs_lhs[0]->root()->type().type) {
+    case TYPE_BOOLEAN:
+        key = *reinterpret_cast<const bool*>(value);
+        break;
+    case TYPE_TINYINT:
+        key = encode_signed32(*reinterpret_cast<const int8_t*>(value));
+        break;
+    case TYPE_SMALLINT:
+        key = encode_signed32(*reinterpret_cast<const int16_t*>(value));
+        break;
+    case TYPE_INT:
+        key = encode_signed32(*reinterpret_cast<const int32_t*>(value));
+        break;
+    case TYPE_FLOAT:
+        key = encode_float_bits(bit_cast<uint32_t>(*reinterpret_cast<const float*>(value)));
+        break;
+    case TYPE_BIGINT:
+        key = encode_signed(*reinterpret_cast<const int64_t*>(value)) >> 1;
+        break;
+    case TYPE_DOUBLE:
+        key = encode_float_bits(bit_cast<uint64_t>(*reinterpret_cast<const double*>(value))) >>
+              1;
+        break;
+    case TYPE_DATE:
+    case TYPE_DATETIME:
+        // DateTimeValue compares by its packed representation.
+        key = encode_signed(reinterpret_cast<const DateTimeValue*>(value)
+                                    ->to_int64_datetime_packed()) >>
+              1;
+        break;
+    case TYPE_LARGEINT:
+    case TYPE_DECIMALV2: {
+        // The high 64 bits of the 128 bit value.
+        __int128 int128_value = reinterpret_cast<const PackedInt128*>(value)->value;
+        key = encode_signed(static_cast<int64_t>(int128_value >> 64)) >> 1;
+        break;
+    }
+    case TYPE_CHAR:
+    case TYPE_VARCHAR: {
+        // The first 8 bytes in big endian order compare like memcmp().
+        const StringValue* string_value = reinterpret_cast<const StringValue*>(value);
+        size_t len = std::min(string_value->len, sizeof(key));
+        for (size_t i = 0; i < len; ++i) {
+            key |= static_cast<uint64_t>(static_cast<uint8_t>(string_value->ptr[i]))
+                   << (8 * (sizeof(key) - 1 - i));
+        }
+        key >>= 1;
+        break;
+    }
+    default:
+        DCHECK(false) << "invalid type: " << _key_expr_ctxs_lhs[0]->root()->type();
+        break;
+    }
+    if (!_is_asc[0]) {
+        key = ~key & VALUE_MASK;
+    }
+    return _nulls_first[0] < 0 ? key | NULL_BIT : key;
+}
+
+} // namespace doris
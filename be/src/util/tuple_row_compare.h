@@ -47,6 +47,7 @@ public:
         for (int i = 0; i < key_expr_ctxs_lhs.size(); ++i) {
             _nulls_first.push_back(nulls_first[i] ? -1 : 1);
         }
+        init_normalized_key();
     }
 
     TupleRowComparator(const std::vector<ExprContext*>& key_expr_ctxs_lhs,
@@ -57,6 +58,7 @@ public:
               _is_asc(key_expr_ctxs_lhs.size(), is_asc),
               _nulls_first(key_expr_ctxs_lhs.size(), nulls_first ? -1 : 1) {
         DCHECK_EQ(key_expr_ctxs_lhs.size(), key_expr_ctxs_rhs.size());
+        init_normalized_key();
     }
 
     // 'sort_key_exprs' must have already been prepared.
@@ -75,13 +77,16 @@ public:
         for (int i = 0; i < _key_expr_ctxs_lhs.size(); ++i) {
             _nulls_first.push_back(nulls_first[i] ? -1 : 1);
         }
+        init_normalized_key();
     }
 
     TupleRowComparator(const SortExecExprs& sort_key_exprs, bool is_asc, bool nulls_first)
             : _key_expr_ctxs_lhs(sort_key_exprs.lhs_ordering_expr_ctxs()),
               _key_expr_ctxs_rhs(sort_key_exprs.rhs_ordering_expr_ctxs()),
               _is_asc(_key_expr_ctxs_lhs.size(), is_asc),
-              _nulls_first(_key_expr_ctxs_lhs.size(), nulls_first ? -1 : 1) {}
+              _nulls_first(_key_expr_ctxs_lhs.size(), nulls_first ? -1 : 1) {
+        init_normalized_key();
+    }
 
     // Returns a negative value if lhs is less than rhs, a positive value if lhs is greater
     // than rhs, or 0 if they are equal. All exprs (_key_exprs_lhs and _key_exprs_rhs)
@@ -133,11 +138,42 @@ public:
         return (*this)(lhs_row, rhs_row);
     }
 
+    // Normalized keys are fixed-width encodings of the first sort key whose unsigned
+    // order is the sort order: if normalized_key(lhs) < normalized_key(rhs) then lhs sorts
+    // before rhs. The top bit tells NULLs from values, so a NULL never shares its key with
+    // a value. Equal keys only mean equal rows if normalized_key_is_exact().
+
+    // Returns true if the type of the first sort key can be normalized.
+    bool has_normalized_key() const { return _has_normalized_key; }
+
+    // Returns true if equal normalized keys imply equal rows, i.e. the first sort key is
+    // the only one and its values fit in the key.
+    bool normalized_key_is_exact() const { return _normalized_key_is_exact; }
+
+    // Returns the normalized key of 'row'. has_normalized_key() must be true.
+    uint64_t normalized_key(TupleRow* row) const;
+
+    // Returns true if lhs is strictly less than rhs, given their normalized keys. Only
+    // evaluates the sort exprs if the normalized keys are equal.
+    bool less(uint64_t lhs_key, TupleRow* lhs, uint64_t rhs_key, TupleRow* rhs) const {
+        if (lhs_key != rhs_key) {
+            return lhs_key < rhs_key;
+        }
+        if (_normalized_key_is_exact) {
+            return false;
+        }
+        return compare(lhs, rhs) < 0;
+    }
+
 private:
+    void init_normalized_key();
+
     const std::vector<ExprContext*>& _key_expr_ctxs_lhs;
     const std::vector<ExprContext*>& _key_expr_ctxs_rhs;
     std::vector<bool> _is_asc;
     std::vector<int8_t> _nulls_first;
+    bool _has_normalized_key;
+    bool _normalized_key_is_exact;
 
     typedef int (*CompareFn)(ExprContext* const*, ExprContext* const*, TupleRow*, TupleRow*);
 };
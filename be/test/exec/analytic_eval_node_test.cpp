@@ -0,0 +1,257 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define protected public
+#define private public
+#include <gtest/gtest.h>
+
+#include "common/object_pool.h"
+#include "exec/analytic_eval_node.h"
+#include "exprs/expr.h"
+#include "exprs/expr_context.h"
+#include "gen_cpp/Exprs_types.h"
+#include "gen_cpp/PlanNodes_types.h"
+#include "runtime/descriptors.h"
+#include "runtime/mem_pool.h"
+#include "runtime/mem_tracker.h"
+#include "runtime/primitive_type.h"
+#include "runtime/runtime_state.h"
+#include "runtime/tuple.h"
+#include "runtime/tuple_row.h"
+#include "testutil/desc_tbl_builder.h"
+
+namespace doris {
+
+// A NULL argument of MIN()/MAX()
+static const int32_t NULL_VALUE = std::numeric_limits<int32_t>::min();
+
+class AnalyticEvalNodeTest : public testing::Test {
+public:
+    AnalyticEvalNodeTest()
+            : _state(TQueryGlobals()), _tracker(new MemTracker(-1)), _mem_pool(_tracker.get()) {}
+
+protected:
+    // tuple 0 (input), 1 (intermediate) and 2 (output) of one INT each, a node evaluating
+    // over ROWS BETWEEN 2 PRECEDING AND CURRENT ROW
+    void SetUp() override {
+        _state.init_instance_mem_tracker();
+        DescriptorTblBuilder builder(&_pool);
+        builder.declare_tuple() << TYPE_INT;
+        builder.declare_tuple() << TYPE_INT;
+        builder.declare_tuple() << TYPE_INT;
+        _desc_tbl = builder.build();
+        _tuple_desc = _desc_tbl->get_tuple_descriptor(0);
+        _row_desc.reset(new RowDescriptor(_tuple_desc, false));
+
+        TPlanNode tnode;
+        tnode.__set_node_id(0);
+        tnode.__set_node_type(TPlanNodeType::ANALYTIC_EVAL_NODE);
+        tnode.__set_num_children(1);
+        tnode.__set_limit(-1);
+        tnode.__set_row_tuples(std::vector<TTupleId>{0, 2});
+        tnode.__set_nullable_tuples(std::vector<bool>{false, false});
+        TAnalyticWindowBoundary window_start;
+        window_start.__set_type(TAnalyticWindowBoundaryType::PRECEDING);
+        window_start.__set_rows_offset_value(2);
+        TAnalyticWindowBoundary window_end;
+        window_end.__set_type(TAnalyticWindowBoundaryType::CURRENT_ROW);
+        TAnalyticWindow window;
+        window.__set_type(TAnalyticWindowType::ROWS);
+        window.__set_window_start(window_start);
+        window.__set_window_end(window_end);
+        TAnalyticNode analytic_node;
+        analytic_node.__set_intermediate_tuple_id(1);
+        analytic_node.__set_output_tuple_id(2);
+        analytic_node.__set_window(window);
+        tnode.__set_analytic_node(analytic_node);
+        _node.reset(new AnalyticEvalNode(&_pool, tnode, *_desc_tbl));
+    }
+
+    void TearDown() override {
+        for (ExprContext* ctx : _ctxs) {
+            ctx->close(&_state);
+        }
+    }
+
+    // Adds a MIN() (MAX()) window over the INT slot the way open() does.
+    void add_min_max_window(bool is_min) {
+        TExprNode node;
+        node.__set_node_type(TExprNodeType::SLOT_REF);
+        node.__set_type(gen_type_desc(TPrimitiveType::INT));
+        node.__set_num_children(0);
+        TSlotRef slot_ref;
+        slot_ref.__set_slot_id(_tuple_desc->slots()[0]->id());
+        slot_ref.__set_tuple_id(0);
+        node.__set_slot_ref(slot_ref);
+        TExpr texpr;
+        texpr.nodes.push_back(node);
+        ExprContext* ctx = nullptr;
+        ASSERT_TRUE(Expr::create_expr_tree(&_pool, texpr, &ctx).ok());
+        ASSERT_TRUE(ctx->prepare(&_state, *_row_desc, _tracker).ok());
+        ASSERT_TRUE(ctx->open(&_state).ok());
+        _ctxs.push_back(ctx);
+
+        AnalyticEvalNode::MinMaxWindow window;
+        window.evaluator_idx = _node->_min_max_windows.size();
+        window.is_min = is_min;
+        window.input_expr_ctx = ctx;
+        window.value_buffer = _mem_pool.allocate(sizeof(int32_t));
+        window.front_removed = false;
+        _node->_min_max_windows.push_back(window);
+    }
+
+    Tuple* create_tuple(int32_t value) {
+        Tuple* tuple = Tuple::create(_tuple_desc->byte_size(), &_mem_pool);
+        const SlotDescriptor* slot = _tuple_desc->slots()[0];
+        if (value == NULL_VALUE) {
+            tuple->set_null(slot->null_indicator_offset());
+        } else {
+            *reinterpret_cast<int32_t*>(tuple->get_slot(slot->tuple_offset())) = value;
+        }
+        return tuple;
+    }
+
+    // Returns the value at the front of the deque of 'window', NULL_VALUE if it is empty.
+    static int32_t front_value(AnalyticEvalNode::MinMaxWindow& window) {
+        if (window.tuples.empty()) {
+            return NULL_VALUE;
+        }
+        TupleRow* row = reinterpret_cast<TupleRow*>(&window.tuples.front().second);
+        return *reinterpret_cast<const int32_t*>(window.input_expr_ctx->get_value(row));
+    }
+
+    // Slides the window over 'values' like process_child_batch() and
+    // try_remove_rows_before_window() do, and checks after every row that the front of
+    // each deque is the min (max) of the non-NULL values in the window.
+    void check_sliding_window(const std::vector<int32_t>& values) {
+        const int window_size = 3;
+        for (int64_t idx = 0; idx < values.size(); ++idx) {
+            _node->add_min_max_window_tuple(idx, create_tuple(values[idx]));
+            if (idx >= window_size) {
+                _node->remove_min_max_window_tuple(idx - window_size);
+            }
+            for (AnalyticEvalNode::MinMaxWindow& window : _node->_min_max_windows) {
+                int32_t expected = NULL_VALUE;
+                for (int64_t i = std::max<int64_t>(0, idx - window_size + 1); i <= idx; ++i) {
+                    if (values[i] != NULL_VALUE &&
+                        (expected == NULL_VALUE ||
+                         (window.is_min ? values[i] < expected : values[i] > expected))) {
+                        expected = values[i];
+                    }
+                }
+                ASSERT_EQ(expected, front_value(window))
+                        << "row " << idx << (window.is_min ? " min" : " max");
+                ASSERT_LE(window.tuples.size(), static_cast<size_t>(window_size));
+                if (!window.tuples.empty()) {
+                    ASSERT_GT(window.tuples.front().first, idx - window_size);
+                }
+            }
+        }
+    }
+
+    ObjectPool _pool;
+    RuntimeState _state;
+    std::shared_ptr<MemTracker> _tracker;
+    MemPool _mem_pool;
+    DescriptorTbl* _desc_tbl = nullptr;
+    TupleDescriptor* _tuple_desc = nullptr;
+    std::unique_ptr<RowDescriptor> _row_desc;
+    std::unique_ptr<AnalyticEvalNode> _node;
+    std::vector<ExprContext*> _ctxs;
+};
+
+TEST_F(AnalyticEvalNodeTest, sliding_min_max) {
+    add_min_max_window(true);
+    add_min_max_window(false);
+    check_sliding_window({5, 3, 4, 8, 6, 7, 2, 9, 9, 1, 10, 11, 12, 0});
+}
+
+TEST_F(AnalyticEvalNodeTest, sliding_min_max_with_nulls) {
+    add_min_max_window(true);
+    add_min_max_window(false);
+    check_sliding_window({NULL_VALUE, 4, NULL_VALUE, NULL_VALUE, NULL_VALUE, 6, NULL_VALUE, 1,
+                          7, NULL_VALUE, NULL_VALUE, NULL_VALUE});
+}
+
+TEST_F(AnalyticEvalNodeTest, nulls_are_ignored) {
+    add_min_max_window(true);
+    AnalyticEvalNode::MinMaxWindow& window = _node->_min_max_windows[0];
+    _node->add_min_max_window_tuple(0, create_tuple(NULL_VALUE));
+    ASSERT_TRUE(window.tuples.empty());
+    _node->add_min_max_window_tuple(1, create_tuple(3));
+    _node->add_min_max_window_tuple(2, create_tuple(NULL_VALUE));
+    ASSERT_EQ(1, window.tuples.size());
+    // the NULL row leaving the window does not evict the min
+    _node->remove_min_max_window_tuple(0);
+    ASSERT_EQ(3, front_value(window));
+    ASSERT_FALSE(window.front_removed);
+}
+
+TEST_F(AnalyticEvalNodeTest, ties_keep_the_latest_row) {
+    add_min_max_window(false);
+    AnalyticEvalNode::MinMaxWindow& window = _node->_min_max_windows[0];
+    _node->add_min_max_window_tuple(0, create_tuple(4));
+    _node->add_min_max_window_tuple(1, create_tuple(4));
+    _node->add_min_max_window_tuple(2, create_tuple(2));
+    ASSERT_EQ(2, window.tuples.size());
+    ASSERT_EQ(1, window.tuples.front().first);
+
+    // the max stays in the window after the first of the equal rows left it
+    _node->remove_min_max_window_tuple(0);
+    ASSERT_FALSE(window.front_removed);
+    ASSERT_EQ(4, front_value(window));
+}
+
+TEST_F(AnalyticEvalNodeTest, sliding_min_max_with_ties) {
+    add_min_max_window(true);
+    add_min_max_window(false);
+    check_sliding_window({4, 4, 2, 4, 4, 4, 1, 1, 1, 3, 3, 1});
+}
+
+TEST_F(AnalyticEvalNodeTest, eviction_of_the_front) {
+    add_min_max_window(true);
+    AnalyticEvalNode::MinMaxWindow& window = _node->_min_max_windows[0];
+    _node->add_min_max_window_tuple(0, create_tuple(1));
+    _node->add_min_max_window_tuple(1, create_tuple(5));
+    _node->add_min_max_window_tuple(2, create_tuple(3));
+    ASSERT_EQ(3, window.tuples.size());
+
+    _node->remove_min_max_window_tuple(0);
+    ASSERT_TRUE(window.front_removed);
+    ASSERT_EQ(3, front_value(window));
+    // a smaller value replaces all the tuples
+    _node->add_min_max_window_tuple(3, create_tuple(2));
+    ASSERT_EQ(1, window.tuples.size());
+    _node->remove_min_max_window_tuple(1);
+    _node->remove_min_max_window_tuple(2);
+    ASSERT_EQ(2, front_value(window));
+    _node->remove_min_max_window_tuple(3);
+    ASSERT_TRUE(window.tuples.empty());
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
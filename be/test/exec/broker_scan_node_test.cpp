@@ -23,6 +23,7 @@
 #include <string>
 #include <vector>
 
+#include "common/config.h"
 #include "common/object_pool.h"
 #include "exec/local_file_reader.h"
 #include "exprs/cast_functions.h"
@@ -50,8 +51,14 @@ public:
     }
 
 protected:
-    virtual void SetUp() {}
-    virtual void TearDown() {}
+    virtual void SetUp() {
+        _max_scanner_threads = config::broker_scan_node_max_scanner_threads;
+        _range_split_bytes = config::broker_scan_range_split_bytes;
+    }
+    virtual void TearDown() {
+        config::broker_scan_node_max_scanner_threads = _max_scanner_threads;
+        config::broker_scan_range_split_bytes = _range_split_bytes;
+    }
 
 private:
     void init_desc_table();
@@ -61,6 +68,8 @@ private:
     TBrokerScanRangeParams _params;
     DescriptorTbl* _desc_tbl;
     TPlanNode _tnode;
+    int32_t _max_scanner_threads;
+    int64_t _range_split_bytes;
 };
 
 void BrokerScanNodeTest::init_desc_table() {
@@ -400,6 +409,8 @@ void BrokerScanNodeTest::init() {
 }
 
 TEST_F(BrokerScanNodeTest, normal) {
+    // scan ranges in order with one scanner thread
+    config::broker_scan_node_max_scanner_threads = 1;
     BrokerScanNode scan_node(&_obj_pool, _tnode, *_desc_tbl);
     auto status = scan_node.prepare(&_runtime_state);
     ASSERT_TRUE(status.ok());
@@ -484,6 +495,61 @@ TEST_F(BrokerScanNodeTest, normal) {
     }
 }
 
+TEST_F(BrokerScanNodeTest, split_range) {
+    // split the file into ranges of 4 bytes and scan them with multiple threads
+    config::broker_scan_node_max_scanner_threads = 4;
+    config::broker_scan_range_split_bytes = 4;
+    BrokerScanNode scan_node(&_obj_pool, _tnode, *_desc_tbl);
+    auto status = scan_node.prepare(&_runtime_state);
+    ASSERT_TRUE(status.ok());
+
+    std::vector<TScanRangeParams> scan_ranges;
+    {
+        TScanRangeParams scan_range_params;
+
+        TBrokerScanRange broker_scan_range;
+        broker_scan_range.params = _params;
+
+        TBrokerRangeDesc range;
+        range.path = "./be/test/exec/test_data/broker_scanner/normal.csv";
+        range.start_offset = 0;
+        range.size = -1;
+        range.__set_file_size(24);
+        range.file_type = TFileType::FILE_LOCAL;
+        range.format_type = TFileFormatType::FORMAT_CSV_PLAIN;
+        range.splittable = true;
+        std::vector<std::string> columns_from_path{"1"};
+        range.__set_columns_from_path(columns_from_path);
+        range.__set_num_of_columns_from_file(3);
+        broker_scan_range.ranges.push_back(range);
+
+        scan_range_params.scan_range.__set_broker_scan_range(broker_scan_range);
+
+        scan_ranges.push_back(scan_range_params);
+    }
+
+    scan_node.set_scan_ranges(scan_ranges);
+
+    status = scan_node.open(&_runtime_state);
+    ASSERT_TRUE(status.ok());
+
+    auto tracker = std::make_shared<MemTracker>();
+    RowBatch batch(scan_node.row_desc(), _runtime_state.batch_size(), tracker.get());
+
+    // every line is read by exactly one of the ranges
+    int num_rows = 0;
+    bool eos = false;
+    while (!eos) {
+        batch.reset();
+        status = scan_node.get_next(&_runtime_state, &batch, &eos);
+        ASSERT_TRUE(status.ok());
+        num_rows += batch.num_rows();
+    }
+    ASSERT_EQ(3, num_rows);
+
+    scan_node.close(&_runtime_state);
+}
+
 } // namespace doris
 
 int main(int argc, char** argv) {
@@ -0,0 +1,240 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <memory>
+#include <vector>
+
+#define protected public
+#define private public
+#include <gtest/gtest.h>
+
+#include "common/config.h"
+#include "common/object_pool.h"
+#include "exec/hash_join_node.h"
+#include "gen_cpp/PlanNodes_types.h"
+#include "runtime/descriptors.h"
+#include "runtime/row_batch.h"
+#include "runtime/runtime_state.h"
+#include "runtime/test_env.h"
+#include "runtime/tuple_row.h"
+#include "testutil/desc_tbl_builder.h"
+#include "testutil/values_node.h"
+#include "util/cpu_info.h"
+#include "util/disk_info.h"
+#include "util/logging.h"
+
+namespace doris {
+
+// Small blocks, so that a few thousand rows are enough to spill.
+static const int BLOCK_SIZE = 1024;
+
+class HashJoinNodeTest : public testing::Test {
+public:
+    HashJoinNodeTest() {}
+
+protected:
+    virtual void SetUp() {
+        _env.reset(new TestEnv());
+        // tuple 0 (probe): key, value; tuple 1 (build): key, value
+        DescriptorTblBuilder builder(&_pool);
+        builder.declare_tuple() << TYPE_INT << TYPE_INT;
+        builder.declare_tuple() << TYPE_INT << TYPE_INT;
+        _desc_tbl = builder.build();
+    }
+
+    virtual void TearDown() {
+        _pool.clear();
+        _env.reset();
+    }
+
+    void create_state(int max_buffers) {
+        TQueryOptions query_options;
+        query_options.__set_enable_spilling(true);
+        ASSERT_TRUE(_env->create_query_state(0, max_buffers, BLOCK_SIZE, query_options, &_state)
+                            .ok());
+        _state->init_instance_mem_tracker();
+        _state->set_desc_tbl(_desc_tbl);
+    }
+
+    static TExpr slot_ref(TupleId tuple_id, SlotId slot_id) {
+        TExprNode node;
+        node.__set_node_type(TExprNodeType::SLOT_REF);
+        node.__set_type(gen_type_desc(TPrimitiveType::INT));
+        node.__set_num_children(0);
+        TSlotRef slot;
+        slot.__set_slot_id(slot_id);
+        slot.__set_tuple_id(tuple_id);
+        node.__set_slot_ref(slot);
+        TExpr expr;
+        expr.nodes.push_back(node);
+        return expr;
+    }
+
+    // Inner join of probe.key = build.key, the build rows are (key, key * 10).
+    HashJoinNode* create_join(const std::vector<std::vector<int32_t>>& probe_rows,
+                              const std::vector<std::vector<int32_t>>& build_rows) {
+        TPlanNode tnode;
+        tnode.__set_node_id(0);
+        tnode.__set_node_type(TPlanNodeType::HASH_JOIN_NODE);
+        tnode.__set_num_children(2);
+        tnode.__set_limit(-1);
+        tnode.__set_row_tuples(std::vector<TTupleId>{0, 1});
+        tnode.__set_nullable_tuples(std::vector<bool>{false, false});
+        tnode.__set_compact_data(false);
+        TEqJoinCondition cond;
+        cond.__set_left(slot_ref(0, 0));
+        cond.__set_right(slot_ref(1, 2));
+        THashJoinNode join_node;
+        join_node.__set_join_op(TJoinOp::INNER_JOIN);
+        join_node.__set_eq_join_conjuncts(std::vector<TEqJoinCondition>{cond});
+        join_node.__set_is_push_down(false);
+        tnode.__set_hash_join_node(join_node);
+
+        HashJoinNode* join = _pool.add(new HashJoinNode(&_pool, tnode, *_desc_tbl));
+        EXPECT_TRUE(join->init(tnode, _state).ok());
+        join->_children.push_back(_pool.add(new ValuesNode(&_pool, 1, *_desc_tbl, 0, probe_rows)));
+        join->_children.push_back(_pool.add(new ValuesNode(&_pool, 2, *_desc_tbl, 1, build_rows)));
+        return join;
+    }
+
+    // Runs 'join' to the end and checks every probe key in [0, num_keys) is joined with
+    // its build row 'matches_per_key' times.
+    void check_join(HashJoinNode* join, int num_keys, int matches_per_key) {
+        ASSERT_TRUE(join->prepare(_state).ok());
+        ASSERT_TRUE(join->open(_state).ok());
+
+        const TupleDescriptor* probe_desc = _desc_tbl->get_tuple_descriptor(0);
+        const TupleDescriptor* build_desc = _desc_tbl->get_tuple_descriptor(1);
+        std::vector<int> matches(num_keys, 0);
+        int num_rows = 0;
+        RowBatch batch(join->row_desc(), _state->batch_size(), _state->instance_mem_tracker().get());
+        bool eos = false;
+        while (!eos) {
+            ASSERT_TRUE(join->get_next(_state, &batch, &eos).ok());
+            for (int i = 0; i < batch.num_rows(); ++i) {
+                TupleRow* row = batch.get_row(i);
+                int32_t probe_key = *reinterpret_cast<int32_t*>(
+                        row->get_tuple(0)->get_slot(probe_desc->slots()[0]->tuple_offset()));
+                int32_t build_key = *reinterpret_cast<int32_t*>(
+                        row->get_tuple(1)->get_slot(build_desc->slots()[0]->tuple_offset()));
+                int32_t build_value = *reinterpret_cast<int32_t*>(
+                        row->get_tuple(1)->get_slot(build_desc->slots()[1]->tuple_offset()));
+                ASSERT_EQ(probe_key, build_key);
+                ASSERT_EQ(build_key * 10, build_value);
+                ASSERT_GE(probe_key, 0);
+                ASSERT_LT(probe_key, num_keys);
+                ++matches[probe_key];
+                ++num_rows;
+            }
+            batch.reset();
+        }
+        ASSERT_EQ(num_keys * matches_per_key, num_rows);
+        for (int key = 0; key < num_keys; ++key) {
+            ASSERT_EQ(matches_per_key, matches[key]) << "key=" << key;
+        }
+    }
+
+    static std::vector<std::vector<int32_t>> build_rows(int num_keys) {
+        std::vector<std::vector<int32_t>> rows;
+        for (int key = 0; key < num_keys; ++key) {
+            rows.push_back({key, key * 10});
+        }
+        return rows;
+    }
+
+    static std::vector<std::vector<int32_t>> probe_rows(int num_keys, int rows_per_key) {
+        std::vector<std::vector<int32_t>> rows;
+        for (int i = 0; i < rows_per_key; ++i) {
+            for (int key = 0; key < num_keys; ++key) {
+                rows.push_back({key, i});
+            }
+        }
+        return rows;
+    }
+
+    ObjectPool _pool;
+    std::unique_ptr<TestEnv> _env;
+    DescriptorTbl* _desc_tbl = nullptr;
+    RuntimeState* _state = nullptr;
+};
+
+TEST_F(HashJoinNodeTest, no_spill) {
+    create_state(-1);
+    HashJoinNode* join = create_join(probe_rows(1000, 1), build_rows(1000));
+    check_join(join, 1000, 1);
+    ASSERT_EQ(0, join->_spilled_partitions_counter->value());
+    ASSERT_TRUE(join->close(_state).ok());
+}
+
+TEST_F(HashJoinNodeTest, spill_build) {
+    // about 48 blocks of build rows do not fit in 30 buffers, the spilled partitions are
+    // read back and joined after the probe input.
+    create_state(30);
+    HashJoinNode* join = create_join(probe_rows(4000, 1), build_rows(4000));
+    check_join(join, 4000, 1);
+    ASSERT_GT(join->_spilled_partitions_counter->value(), 0);
+    ASSERT_EQ(0, join->_repartitions_counter->value());
+    ASSERT_TRUE(join->close(_state).ok());
+}
+
+TEST_F(HashJoinNodeTest, spill_probe) {
+    create_state(30);
+    HashJoinNode* join = create_join(probe_rows(4000, 2), build_rows(4000));
+    ASSERT_TRUE(join->prepare(_state).ok());
+    ASSERT_TRUE(join->open(_state).ok());
+    ASSERT_FALSE(join->_spilled_partitions.empty());
+
+    // the probe rows of spilled partitions are buffered instead of being joined
+    RowBatch batch(join->row_desc(), _state->batch_size(), _state->instance_mem_tracker().get());
+    bool eos = false;
+    ASSERT_TRUE(join->get_next(_state, &batch, &eos).ok());
+    int64_t buffered_rows = 0;
+    for (auto partition : join->_spilled_partitions) {
+        buffered_rows += partition->probe_rows->num_rows();
+    }
+    ASSERT_GT(buffered_rows, 0);
+    batch.reset();
+    ASSERT_TRUE(join->close(_state).ok());
+
+    // and all of them are joined in the end
+    join = create_join(probe_rows(4000, 2), build_rows(4000));
+    check_join(join, 4000, 2);
+    ASSERT_TRUE(join->close(_state).ok());
+}
+
+TEST_F(HashJoinNodeTest, repartition) {
+    // a spilled partition of about 45 blocks can not be read back into 40 buffers, it is
+    // partitioned again.
+    create_state(40);
+    HashJoinNode* join = create_join(probe_rows(80000, 1), build_rows(80000));
+    check_join(join, 80000, 1);
+    ASSERT_GT(join->_repartitions_counter->value(), 0);
+    ASSERT_GT(join->_max_partition_level_counter->value(), 0);
+    ASSERT_TRUE(join->close(_state).ok());
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    doris::config::query_scratch_dirs = "/tmp";
+    doris::config::min_buffer_size = 1024;
+    doris::init_glog("be-test");
+    ::testing::InitGoogleTest(&argc, argv);
+    doris::CpuInfo::init();
+    doris::DiskInfo::init();
+    return RUN_ALL_TESTS();
+}
@@ -624,6 +624,109 @@ TEST_F(JsonScannerTest, normal_simple_arrayjson) {
     }
 }
 
+TEST_F(JsonScannerTest, normal_simple_json_lines) {
+    BrokerScanNode scan_node(&_obj_pool, _tnode, *_desc_tbl);
+    auto status = scan_node.prepare(&_runtime_state);
+    ASSERT_TRUE(status.ok());
+
+    // one json object per line, all in one message
+    std::vector<TScanRangeParams> scan_ranges;
+    {
+        TScanRangeParams scan_range_params;
+
+        TBrokerScanRange broker_scan_range;
+        broker_scan_range.params = _params;
+        TBrokerRangeDesc range;
+        range.start_offset = 0;
+        range.size = -1;
+        range.format_type = TFileFormatType::FORMAT_JSON;
+        range.strip_outer_array = false;
+        range.__isset.strip_outer_array = true;
+        range.splittable = true;
+        range.path = "./be/test/exec/test_data/json_scanner/test_simple_lines.json";
+        range.file_type = TFileType::FILE_LOCAL;
+        broker_scan_range.ranges.push_back(range);
+        scan_range_params.scan_range.__set_broker_scan_range(broker_scan_range);
+        scan_ranges.push_back(scan_range_params);
+    }
+
+    scan_node.set_scan_ranges(scan_ranges);
+    status = scan_node.open(&_runtime_state);
+    ASSERT_TRUE(status.ok());
+
+    MemTracker tracker;
+    RowBatch batch(scan_node.row_desc(), _runtime_state.batch_size(), &tracker);
+    bool eof = false;
+    status = scan_node.get_next(&_runtime_state, &batch, &eof);
+    ASSERT_TRUE(status.ok());
+    ASSERT_EQ(3, batch.num_rows());
+    auto tuple_str = batch.get_row(2)->get_tuple(0)->to_string(*scan_node.row_desc().tuple_descriptors()[0]);
+    ASSERT_FALSE(tuple_str.find("MobyDick") == tuple_str.npos);
+    ASSERT_FALSE(eof);
+    batch.reset();
+
+    status = scan_node.get_next(&_runtime_state, &batch, &eof);
+    ASSERT_TRUE(status.ok());
+    ASSERT_EQ(0, batch.num_rows());
+    ASSERT_TRUE(eof);
+
+    scan_node.close(&_runtime_state);
+}
+
+TEST_F(JsonScannerTest, malformed_json_lines) {
+    BrokerScanNode scan_node(&_obj_pool, _tnode, *_desc_tbl);
+    auto status = scan_node.prepare(&_runtime_state);
+    ASSERT_TRUE(status.ok());
+
+    // the 2nd line is cut short and the 4th is not json, each is one filtered row and the
+    // lines after them are loaded
+    std::vector<TScanRangeParams> scan_ranges;
+    {
+        TScanRangeParams scan_range_params;
+
+        TBrokerScanRange broker_scan_range;
+        broker_scan_range.params = _params;
+        TBrokerRangeDesc range;
+        range.start_offset = 0;
+        range.size = -1;
+        range.format_type = TFileFormatType::FORMAT_JSON;
+        range.strip_outer_array = false;
+        range.__isset.strip_outer_array = true;
+        range.splittable = true;
+        range.path = "./be/test/exec/test_data/json_scanner/test_bad_lines.json";
+        range.file_type = TFileType::FILE_LOCAL;
+        broker_scan_range.ranges.push_back(range);
+        scan_range_params.scan_range.__set_broker_scan_range(broker_scan_range);
+        scan_ranges.push_back(scan_range_params);
+    }
+
+    scan_node.set_scan_ranges(scan_ranges);
+    int64_t num_filtered = _runtime_state.num_rows_load_filtered();
+    status = scan_node.open(&_runtime_state);
+    ASSERT_TRUE(status.ok());
+
+    MemTracker tracker;
+    RowBatch batch(scan_node.row_desc(), _runtime_state.batch_size(), &tracker);
+    std::vector<std::string> tuple_strs;
+    bool eof = false;
+    while (!eof) {
+        status = scan_node.get_next(&_runtime_state, &batch, &eof);
+        ASSERT_TRUE(status.ok());
+        for (int i = 0; i < batch.num_rows(); ++i) {
+            tuple_strs.push_back(batch.get_row(i)->get_tuple(0)->to_string(
+                    *scan_node.row_desc().tuple_descriptors()[0]));
+        }
+        batch.reset();
+    }
+    ASSERT_EQ(3, tuple_strs.size());
+    ASSERT_FALSE(tuple_strs[0].find("NigelRees") == std::string::npos);
+    ASSERT_FALSE(tuple_strs[1].find("MobyDick") == std::string::npos);
+    ASSERT_FALSE(tuple_strs[2].find("TheLordoftheRings") == std::string::npos);
+
+    scan_node.close(&_runtime_state);
+    ASSERT_EQ(num_filtered + 2, _runtime_state.num_rows_load_filtered());
+}
+
 } // namespace doris
 
 int main(int argc, char** argv) {
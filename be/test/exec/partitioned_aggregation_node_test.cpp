@@ -0,0 +1,295 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#define protected public
+#define private public
+#include <gtest/gtest.h>
+
+#include "common/object_pool.h"
+#include "exec/partitioned_aggregation_node.h"
+#include "exec/partitioned_hash_table.h"
+#include "gen_cpp/Exprs_types.h"
+#include "gen_cpp/PlanNodes_types.h"
+#include "runtime/descriptors.h"
+#include "runtime/mem_pool.h"
+#include "runtime/mem_tracker.h"
+#include "runtime/primitive_type.h"
+#include "runtime/row_batch.h"
+#include "runtime/runtime_state.h"
+#include "runtime/tuple.h"
+#include "runtime/tuple_row.h"
+#include "testutil/desc_tbl_builder.h"
+#include "testutil/values_node.h"
+
+namespace doris {
+
+class PartitionedAggregationNodeTest : public testing::Test {
+public:
+    PartitionedAggregationNodeTest()
+            : _state(TQueryGlobals()), _tracker(new MemTracker(-1)), _mem_pool(_tracker.get()) {}
+
+protected:
+    // tuple 0 (input): key, value; tuple 1 (intermediate and output): key
+    void SetUp() override {
+        _state.init_instance_mem_tracker();
+        DescriptorTblBuilder builder(&_pool);
+        builder.declare_tuple() << TYPE_INT << TYPE_INT;
+        builder.declare_tuple() << TYPE_INT;
+        _desc_tbl = builder.build();
+        _state.set_desc_tbl(_desc_tbl);
+    }
+
+    void TearDown() override {
+        if (_node != nullptr) {
+            _node->ht_ctx_->Close(&_state);
+        }
+    }
+
+    static TExpr slot_ref(TupleId tuple_id, SlotId slot_id) {
+        TExprNode node;
+        node.__set_node_type(TExprNodeType::SLOT_REF);
+        node.__set_type(gen_type_desc(TPrimitiveType::INT));
+        node.__set_num_children(0);
+        TSlotRef slot;
+        slot.__set_slot_id(slot_id);
+        slot.__set_tuple_id(tuple_id);
+        node.__set_slot_ref(slot);
+        TExpr expr;
+        expr.nodes.push_back(node);
+        return expr;
+    }
+
+    // A grouping by the key without aggregate functions, prepared far enough to aggregate
+    // rows into intermediate tuples without hash tables, which need a buffer pool.
+    void create_node(bool streaming) {
+        TPlanNode tnode;
+        tnode.__set_node_id(0);
+        tnode.__set_node_type(TPlanNodeType::AGGREGATION_NODE);
+        tnode.__set_num_children(1);
+        tnode.__set_limit(-1);
+        tnode.__set_row_tuples(std::vector<TTupleId>{1});
+        tnode.__set_nullable_tuples(std::vector<bool>{false});
+        TAggregationNode agg_node;
+        agg_node.__set_grouping_exprs(
+                {slot_ref(0, _desc_tbl->get_tuple_descriptor(0)->slots()[0]->id())});
+        agg_node.__set_aggregate_functions({});
+        agg_node.__set_intermediate_tuple_id(1);
+        agg_node.__set_output_tuple_id(1);
+        agg_node.__set_need_finalize(false);
+        agg_node.__set_use_streaming_preaggregation(streaming);
+        tnode.__set_agg_node(agg_node);
+
+        _node = _pool.add(new PartitionedAggregationNode(&_pool, tnode, *_desc_tbl));
+        _child = _pool.add(new ValuesNode(&_pool, 1, *_desc_tbl, 0, {}));
+        _node->_children.push_back(_child);
+        ASSERT_TRUE(_node->init(tnode, &_state).ok());
+        ASSERT_TRUE(_node->prepare(&_state).ok());
+        ASSERT_TRUE(_node->ht_ctx_->Open(&_state).ok());
+    }
+
+    TupleRow* create_row(int32_t key) {
+        const TupleDescriptor* tuple_desc = _desc_tbl->get_tuple_descriptor(0);
+        Tuple* tuple = Tuple::create(tuple_desc->byte_size(), &_mem_pool);
+        *reinterpret_cast<int32_t*>(tuple->get_slot(tuple_desc->slots()[0]->tuple_offset())) = key;
+        TupleRow* row = reinterpret_cast<TupleRow*>(_mem_pool.allocate(sizeof(Tuple*)));
+        row->set_tuple(0, tuple);
+        return row;
+    }
+
+    // Evaluates the grouping exprs of 'row' the way ProcessBatch() does, returns its hash.
+    uint32_t eval_row(TupleRow* row) {
+        PartitionedHashTableCtx* ht_ctx = _node->ht_ctx_.get();
+        PartitionedHashTableCtx::ExprValuesCache* expr_vals_cache = ht_ctx->expr_values_cache();
+        expr_vals_cache->Reset();
+        EXPECT_TRUE(ht_ctx->EvalAndHashProbe(row));
+        expr_vals_cache->NextRow();
+        expr_vals_cache->ResetForRead();
+        return expr_vals_cache->CurExprValuesHash();
+    }
+
+    // Aggregates the rows of 'keys' into the current run while they continue it, and
+    // starts a run of a new intermediate tuple otherwise. Returns the number of runs.
+    int aggregate_rows(const std::vector<int32_t>& keys, bool in_hash_tbl) {
+        int num_runs = 0;
+        for (int32_t key : keys) {
+            TupleRow* row = create_row(key);
+            uint32_t hash = eval_row(row);
+            if (_node->TryAddToRun(_node->ht_ctx_.get(), row, hash)) {
+                continue;
+            }
+            Status status;
+            Tuple* tuple =
+                    _node->ConstructIntermediateTuple(_node->agg_fn_evals_, &_mem_pool, &status);
+            EXPECT_TRUE(tuple != nullptr);
+            _node->StartRun(tuple, hash, _node->agg_fn_evals_.data(), in_hash_tbl);
+            ++num_runs;
+        }
+        return num_runs;
+    }
+
+    // Completes a sampling window of 'partition' with 'window_rows' rows that reduce by
+    // 'reduction'. Returns true if the partition is in passthrough mode afterwards.
+    bool complete_window(PartitionedAggregationNode::Partition* partition, double reduction,
+                         bool ht_full) {
+        const int64_t window_rows = 16 * 1024;
+        partition->window_rows = window_rows;
+        partition->window_aggregated_rows =
+                window_rows - static_cast<int64_t>(window_rows / reduction);
+        _node->UpdateStreamingMode(partition, ht_full);
+        EXPECT_EQ(0, partition->window_rows);
+        EXPECT_EQ(0, partition->window_aggregated_rows);
+        return partition->is_passthrough;
+    }
+
+    ObjectPool _pool;
+    RuntimeState _state;
+    std::shared_ptr<MemTracker> _tracker;
+    MemPool _mem_pool;
+    DescriptorTbl* _desc_tbl = nullptr;
+    PartitionedAggregationNode* _node = nullptr;
+    ValuesNode* _child = nullptr;
+};
+
+TEST_F(PartitionedAggregationNodeTest, runs_of_equal_keys) {
+    create_node(false);
+    ASSERT_EQ(4, aggregate_rows({1, 1, 1, 2, 2, 3, 1, 1}, true));
+    ASSERT_EQ(4, _node->num_rows_in_runs_);
+    ASSERT_EQ(0, _node->num_passthrough_rows_in_runs_);
+}
+
+TEST_F(PartitionedAggregationNodeTest, run_needs_equal_keys) {
+    create_node(false);
+    TupleRow* row = create_row(2);
+    uint32_t hash = eval_row(row);
+    // no run yet
+    ASSERT_FALSE(_node->TryAddToRun(_node->ht_ctx_.get(), row, hash));
+
+    // a run of key 1 whose hash collides with the one of key 2
+    ASSERT_EQ(1, aggregate_rows({1}, true));
+    _node->run_hash_ = hash;
+    ASSERT_FALSE(_node->TryAddToRun(_node->ht_ctx_.get(), row, hash));
+    ASSERT_EQ(0, _node->num_rows_in_runs_);
+}
+
+TEST_F(PartitionedAggregationNodeTest, aggregated_input_rows) {
+    create_node(true);
+    // passed through: 2 output rows, 3 rows aggregated into them
+    ASSERT_EQ(2, aggregate_rows({1, 1, 2, 2, 2}, false));
+    // in the hash tables: 4 rows, 2 of them aggregated without probing
+    ASSERT_EQ(2, aggregate_rows({3, 3, 4, 4}, true));
+    ASSERT_EQ(5, _node->num_rows_in_runs_);
+    ASSERT_EQ(3, _node->num_passthrough_rows_in_runs_);
+
+    _child->_num_rows_returned = 9;
+    _node->_num_rows_returned = 2;
+    // the runs of hash table tuples count for the reduction of the hash tables
+    ASSERT_EQ(4, _node->NumAggregatedInputRows());
+}
+
+TEST_F(PartitionedAggregationNodeTest, reset_runs) {
+    create_node(false);
+    aggregate_rows({1, 1, 2}, true);
+    ASSERT_EQ(1, _node->num_rows_in_runs_);
+    ASSERT_TRUE(_node->reset(&_state).ok());
+    ASSERT_EQ(nullptr, _node->run_tuple_);
+    ASSERT_EQ(0, _node->num_rows_in_runs_);
+    ASSERT_EQ(0, _node->num_passthrough_rows_in_runs_);
+}
+
+TEST_F(PartitionedAggregationNodeTest, passthrough_needs_full_hash_table) {
+    create_node(true);
+    PartitionedAggregationNode::Partition partition(_node, 0, 0);
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_FALSE(complete_window(&partition, 1.0, false));
+    }
+    ASSERT_TRUE(complete_window(&partition, 1.0, true));
+    ASSERT_EQ(1, _node->preagg_passthrough_switches_->value());
+    partition.Close(false);
+}
+
+TEST_F(PartitionedAggregationNodeTest, passthrough_needs_min_aggregation_windows) {
+    create_node(true);
+    PartitionedAggregationNode::Partition partition(_node, 0, 0);
+    ASSERT_FALSE(complete_window(&partition, 1.0, true));
+    ASSERT_TRUE(complete_window(&partition, 1.0, true));
+    ASSERT_DOUBLE_EQ(1.0, partition.sampled_reduction);
+    partition.Close(false);
+}
+
+TEST_F(PartitionedAggregationNodeTest, aggregation_with_reduction) {
+    create_node(true);
+    PartitionedAggregationNode::Partition partition(_node, 0, 0);
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_FALSE(complete_window(&partition, 2.0, true));
+    }
+    ASSERT_EQ(0, _node->preagg_passthrough_switches_->value());
+    partition.Close(false);
+}
+
+TEST_F(PartitionedAggregationNodeTest, resume_aggregation) {
+    create_node(true);
+    PartitionedAggregationNode::Partition partition(_node, 0, 0);
+    partition.is_passthrough = true;
+    ASSERT_TRUE(complete_window(&partition, 1.5, false));
+    ASSERT_FALSE(complete_window(&partition, 4.0, false));
+    ASSERT_EQ(1, _node->preagg_aggregation_switches_->value());
+    ASSERT_EQ(0, partition.windows_in_mode);
+    partition.Close(false);
+}
+
+TEST_F(PartitionedAggregationNodeTest, passthrough_backoff) {
+    create_node(true);
+    PartitionedAggregationNode::Partition partition(_node, 0, 0);
+    // every resumed aggregation stops paying off right away
+    for (int passthrough_windows = 1; passthrough_windows <= 64; passthrough_windows *= 2) {
+        ASSERT_FALSE(complete_window(&partition, 1.0, true));
+        ASSERT_TRUE(complete_window(&partition, 1.0, true));
+        ASSERT_EQ(std::min(2 * passthrough_windows, 64), partition.min_passthrough_windows);
+        for (int i = 1; i < partition.min_passthrough_windows; ++i) {
+            ASSERT_TRUE(complete_window(&partition, 4.0, false));
+        }
+        ASSERT_FALSE(complete_window(&partition, 4.0, false));
+    }
+
+    // an aggregation that paid off for a while resets the backoff
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_FALSE(complete_window(&partition, 1.5, true));
+    }
+    ASSERT_TRUE(complete_window(&partition, 1.0, true));
+    ASSERT_EQ(1, partition.min_passthrough_windows);
+    ASSERT_FALSE(complete_window(&partition, 4.0, false));
+    partition.Close(false);
+}
+
+TEST_F(PartitionedAggregationNodeTest, no_expansion_in_passthrough) {
+    create_node(true);
+    PartitionedAggregationNode::Partition partition(_node, 0, 0);
+    partition.is_passthrough = true;
+    ASSERT_FALSE(_node->ShouldExpandPreaggHashTable(&partition));
+    partition.Close(false);
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,206 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#define protected public
+#define private public
+#include <gtest/gtest.h>
+
+#include "common/object_pool.h"
+#include "exec/except_node.h"
+#include "exec/intersect_node.h"
+#include "gen_cpp/PlanNodes_types.h"
+#include "runtime/descriptors.h"
+#include "runtime/row_batch.h"
+#include "runtime/runtime_state.h"
+#include "runtime/test_env.h"
+#include "runtime/tuple_row.h"
+#include "testutil/desc_tbl_builder.h"
+#include "testutil/values_node.h"
+#include "util/cpu_info.h"
+#include "util/disk_info.h"
+#include "util/logging.h"
+
+namespace doris {
+
+class SetOperationNodeTest : public testing::Test {
+public:
+    SetOperationNodeTest() {}
+
+protected:
+    // Every child has its own layout with the value in the last slot: tuple 0 (child 0):
+    // value, tuple 1 (child 1): pad, value, tuple 2 (child 2): pad, pad, value. Tuple 3
+    // is the output: value.
+    virtual void SetUp() {
+        _env.reset(new TestEnv());
+        DescriptorTblBuilder builder(&_pool);
+        builder.declare_tuple() << TYPE_INT;
+        builder.declare_tuple() << TYPE_INT << TYPE_INT;
+        builder.declare_tuple() << TYPE_INT << TYPE_INT << TYPE_INT;
+        builder.declare_tuple() << TYPE_INT;
+        _desc_tbl = builder.build();
+        ASSERT_TRUE(_env->create_query_state(0, -1, 8 * 1024 * 1024, &_state).ok());
+        _state->init_instance_mem_tracker();
+        _state->set_desc_tbl(_desc_tbl);
+    }
+
+    virtual void TearDown() {
+        _pool.clear();
+        _env.reset();
+    }
+
+    static TExpr slot_ref(TupleId tuple_id, SlotId slot_id) {
+        TExprNode node;
+        node.__set_node_type(TExprNodeType::SLOT_REF);
+        node.__set_type(gen_type_desc(TPrimitiveType::INT));
+        node.__set_num_children(0);
+        TSlotRef slot;
+        slot.__set_slot_id(slot_id);
+        slot.__set_tuple_id(tuple_id);
+        node.__set_slot_ref(slot);
+        TExpr expr;
+        expr.nodes.push_back(node);
+        return expr;
+    }
+
+    // Returns the plan node of an INTERSECT or EXCEPT of the values of the three children.
+    TPlanNode create_plan_node(TPlanNodeType::type type) {
+        TPlanNode tnode;
+        tnode.__set_node_id(0);
+        tnode.__set_node_type(type);
+        tnode.__set_num_children(3);
+        tnode.__set_limit(-1);
+        tnode.__set_row_tuples(std::vector<TTupleId>{3});
+        tnode.__set_nullable_tuples(std::vector<bool>{false});
+        tnode.__set_compact_data(false);
+        std::vector<std::vector<TExpr>> result_expr_lists;
+        for (TupleId tuple_id = 0; tuple_id < 3; ++tuple_id) {
+            const TupleDescriptor* tuple_desc = _desc_tbl->get_tuple_descriptor(tuple_id);
+            result_expr_lists.push_back({slot_ref(tuple_id, tuple_desc->slots().back()->id())});
+        }
+        if (type == TPlanNodeType::INTERSECT_NODE) {
+            TIntersectNode intersect_node;
+            intersect_node.__set_tuple_id(3);
+            intersect_node.__set_result_expr_lists(result_expr_lists);
+            intersect_node.__set_const_expr_lists({});
+            intersect_node.__set_first_materialized_child_idx(0);
+            tnode.__set_intersect_node(intersect_node);
+        } else {
+            TExceptNode except_node;
+            except_node.__set_tuple_id(3);
+            except_node.__set_result_expr_lists(result_expr_lists);
+            except_node.__set_const_expr_lists({});
+            except_node.__set_first_materialized_child_idx(0);
+            tnode.__set_except_node(except_node);
+        }
+        return tnode;
+    }
+
+    // Adds the children to 'node' and initializes it, the rows of child 1 and 2 are padded
+    // with values that are not in child 0.
+    void init_node(ExecNode* node, const TPlanNode& tnode, const std::vector<int32_t>& values0,
+                   const std::vector<int32_t>& values1, const std::vector<int32_t>& values2) {
+        std::vector<std::vector<int32_t>> rows0;
+        for (int32_t value : values0) {
+            rows0.push_back({value});
+        }
+        std::vector<std::vector<int32_t>> rows1;
+        for (int32_t value : values1) {
+            rows1.push_back({-1, value});
+        }
+        std::vector<std::vector<int32_t>> rows2;
+        for (int32_t value : values2) {
+            rows2.push_back({-2, -3, value});
+        }
+        node->_children.push_back(_pool.add(new ValuesNode(&_pool, 1, *_desc_tbl, 0, rows0)));
+        node->_children.push_back(_pool.add(new ValuesNode(&_pool, 2, *_desc_tbl, 1, rows1)));
+        node->_children.push_back(_pool.add(new ValuesNode(&_pool, 3, *_desc_tbl, 2, rows2)));
+        ASSERT_TRUE(node->init(tnode, _state).ok());
+    }
+
+    // Runs 'node' to the end and returns the sorted output values.
+    std::vector<int32_t> get_values(ExecNode* node) {
+        std::vector<int32_t> values;
+        EXPECT_TRUE(node->prepare(_state).ok());
+        EXPECT_TRUE(node->open(_state).ok());
+        const TupleDescriptor* tuple_desc = _desc_tbl->get_tuple_descriptor(3);
+        RowBatch batch(node->row_desc(), _state->batch_size(),
+                       _state->instance_mem_tracker().get());
+        bool eos = false;
+        while (!eos) {
+            EXPECT_TRUE(node->get_next(_state, &batch, &eos).ok());
+            for (int i = 0; i < batch.num_rows(); ++i) {
+                values.push_back(*reinterpret_cast<int32_t*>(
+                        batch.get_row(i)->get_tuple(0)->get_slot(
+                                tuple_desc->slots()[0]->tuple_offset())));
+            }
+            batch.reset();
+        }
+        EXPECT_TRUE(node->close(_state).ok());
+        std::sort(values.begin(), values.end());
+        return values;
+    }
+
+    ObjectPool _pool;
+    std::unique_ptr<TestEnv> _env;
+    DescriptorTbl* _desc_tbl = nullptr;
+    RuntimeState* _state = nullptr;
+};
+
+TEST_F(SetOperationNodeTest, intersect_three_children) {
+    TPlanNode tnode = create_plan_node(TPlanNodeType::INTERSECT_NODE);
+    IntersectNode* node = _pool.add(new IntersectNode(&_pool, tnode, *_desc_tbl));
+    init_node(node, tnode, {1, 2, 3, 4, 5, 5, 6}, {6, 2, 3, 4, 5, 2}, {4, 2, 7, 5, 4});
+    ASSERT_EQ(std::vector<int32_t>({2, 4, 5}), get_values(node));
+}
+
+TEST_F(SetOperationNodeTest, intersect_empty_result) {
+    TPlanNode tnode = create_plan_node(TPlanNodeType::INTERSECT_NODE);
+    IntersectNode* node = _pool.add(new IntersectNode(&_pool, tnode, *_desc_tbl));
+    init_node(node, tnode, {1, 2, 3}, {3, 4}, {1, 2});
+    ASSERT_TRUE(get_values(node).empty());
+    // the result was empty after child 1, child 2 was not read
+    ASSERT_EQ(0, node->child(2)->rows_returned());
+}
+
+TEST_F(SetOperationNodeTest, except_three_children) {
+    TPlanNode tnode = create_plan_node(TPlanNodeType::EXCEPT_NODE);
+    ExceptNode* node = _pool.add(new ExceptNode(&_pool, tnode, *_desc_tbl));
+    init_node(node, tnode, {1, 2, 3, 4, 5, 6, 6}, {1, 2, 8}, {3, 4, 9, 3});
+    ASSERT_EQ(std::vector<int32_t>({5, 6}), get_values(node));
+}
+
+TEST_F(SetOperationNodeTest, except_empty_result) {
+    TPlanNode tnode = create_plan_node(TPlanNodeType::EXCEPT_NODE);
+    ExceptNode* node = _pool.add(new ExceptNode(&_pool, tnode, *_desc_tbl));
+    init_node(node, tnode, {1, 2, 2}, {2, 1}, {1, 3});
+    ASSERT_TRUE(get_values(node).empty());
+    ASSERT_EQ(0, node->child(2)->rows_returned());
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    doris::init_glog("be-test");
+    ::testing::InitGoogleTest(&argc, argv);
+    doris::CpuInfo::init();
+    doris::DiskInfo::init();
+    return RUN_ALL_TESTS();
+}
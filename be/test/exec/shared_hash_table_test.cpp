@@ -0,0 +1,142 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "exec/shared_hash_table.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "exec/hash_table.h"
+#include "exprs/expr_context.h"
+#include "runtime/mem_pool.h"
+#include "runtime/mem_tracker.h"
+#include "runtime/runtime_state.h"
+
+namespace doris {
+
+class SharedHashTableTest : public testing::Test {
+public:
+    SharedHashTableTest() : _state(TQueryGlobals()) {}
+
+protected:
+    std::shared_ptr<HashTable> create_hash_table(const std::shared_ptr<MemTracker>& tracker) {
+        return std::make_shared<HashTable>(_exprs, _exprs, 1, false, std::vector<bool>(), 0,
+                                           tracker, 16);
+    }
+
+    RuntimeState _state;
+    // the table keeps references to its exprs
+    std::vector<ExprContext*> _exprs;
+};
+
+TEST_F(SharedHashTableTest, claim_build_once) {
+    SharedHashTable shared_table;
+    ASSERT_TRUE(shared_table.claim_build(&_state));
+    ASSERT_TRUE(shared_table.mem_tracker() != nullptr);
+    ASSERT_FALSE(shared_table.claim_build(&_state));
+    ASSERT_FALSE(shared_table.claim_build(&_state));
+    ASSERT_FALSE(shared_table.is_ready());
+}
+
+TEST_F(SharedHashTableTest, shared_build) {
+    SharedHashTable shared_table;
+    ASSERT_TRUE(shared_table.claim_build(&_state));
+    std::shared_ptr<HashTable> hash_table = create_hash_table(shared_table.mem_tracker());
+
+    std::shared_ptr<MemTracker> builder_tracker(new MemTracker(-1));
+    MemPool build_pool(builder_tracker.get());
+    build_pool.allocate(1024);
+    int64_t table_bytes = shared_table.mem_tracker()->consumption();
+    shared_table.set_ready(Status::OK(), hash_table, &build_pool);
+    ASSERT_TRUE(shared_table.is_ready());
+
+    // every instance gets the same table, whose data outlives the builder
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(shared_table.wait(&_state).ok());
+        ASSERT_EQ(hash_table, shared_table.hash_table());
+    }
+    ASSERT_EQ(0, builder_tracker->consumption());
+    ASSERT_GE(shared_table.mem_tracker()->consumption(), table_bytes + 1024);
+}
+
+TEST_F(SharedHashTableTest, cancelled_builder) {
+    SharedHashTable shared_table;
+    ASSERT_TRUE(shared_table.claim_build(&_state));
+    shared_table.set_ready(Status::Cancelled("Cancelled"), nullptr, nullptr);
+    ASSERT_TRUE(shared_table.is_ready());
+    Status status = shared_table.wait(&_state);
+    ASSERT_TRUE(status.is_cancelled());
+    ASSERT_TRUE(shared_table.hash_table() == nullptr);
+}
+
+TEST_F(SharedHashTableTest, wake_up_waiters) {
+    SharedHashTable shared_table;
+    ASSERT_TRUE(shared_table.claim_build(&_state));
+    std::atomic<int> num_done(0);
+    std::atomic<int> num_ok(0);
+    std::vector<std::thread> waiters;
+    for (int i = 0; i < 4; ++i) {
+        waiters.emplace_back([&]() {
+            if (shared_table.wait(&_state).ok()) {
+                ++num_ok;
+            }
+            ++num_done;
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(0, num_done);
+
+    std::shared_ptr<HashTable> hash_table = create_hash_table(shared_table.mem_tracker());
+    MemPool build_pool(shared_table.mem_tracker().get());
+    shared_table.set_ready(Status::OK(), hash_table, &build_pool);
+    for (std::thread& waiter : waiters) {
+        waiter.join();
+    }
+    ASSERT_EQ(4, num_ok);
+}
+
+TEST_F(SharedHashTableTest, wake_up_waiters_on_failure) {
+    SharedHashTable shared_table;
+    ASSERT_TRUE(shared_table.claim_build(&_state));
+    std::atomic<int> num_failed(0);
+    std::vector<std::thread> waiters;
+    for (int i = 0; i < 4; ++i) {
+        waiters.emplace_back([&]() {
+            if (!shared_table.wait(&_state).ok()) {
+                ++num_failed;
+            }
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    shared_table.set_ready(Status::MemoryLimitExceeded("build failed"), nullptr, nullptr);
+    for (std::thread& waiter : waiters) {
+        waiter.join();
+    }
+    ASSERT_EQ(4, num_failed);
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
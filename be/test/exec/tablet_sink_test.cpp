@@ -314,6 +314,12 @@ public:
                             const PTabletWriterOpenRequest* request,
                             PTabletWriterOpenResult* response,
                             google::protobuf::Closure* done) override {
+        {
+            std::lock_guard<std::mutex> l(_lock);
+            for (auto& nodes : request->slave_tablet_nodes()) {
+                slave_node_counters += nodes.slave_nodes_size();
+            }
+        }
         Status status;
         status.to_protobuf(response->mutable_status());
         done->Run();
@@ -352,6 +358,7 @@ public:
     std::mutex _lock;
     int64_t eof_counters = 0;
     int64_t row_counters = 0;
+    int64_t slave_node_counters = 0;
     RowDescriptor* _row_desc = nullptr;
     std::set<std::string>* _output_set;
 };
@@ -463,6 +470,96 @@ TEST_F(OlapTableSinkTest, normal) {
     ASSERT_EQ(1, state.num_rows_load_filtered());
 }
 
+TEST_F(OlapTableSinkTest, single_replica) {
+    // start brpc service first
+    _server = new brpc::Server();
+    auto service = new TestInternalService();
+    ASSERT_EQ(_server->AddService(service, brpc::SERVER_OWNS_SERVICE), 0);
+    brpc::ServerOptions options;
+    {
+        debug::ScopedLeakCheckDisabler disable_lsan;
+        _server->Start(4356, &options);
+    }
+
+    TUniqueId fragment_id;
+    TQueryOptions query_options;
+    query_options.batch_size = 1;
+    RuntimeState state(fragment_id, query_options, TQueryGlobals(), _env);
+    state.init_mem_trackers(TUniqueId());
+
+    ObjectPool obj_pool;
+    TDescriptorTable tdesc_tbl;
+    auto t_data_sink = get_data_sink(&tdesc_tbl);
+    t_data_sink.olap_table_sink.__set_write_single_replica(true);
+
+    // crate desc_tabl
+    DescriptorTbl* desc_tbl = nullptr;
+    auto st = DescriptorTbl::create(&obj_pool, tdesc_tbl, &desc_tbl);
+    ASSERT_TRUE(st.ok());
+    state._desc_tbl = desc_tbl;
+
+    TupleDescriptor* tuple_desc = desc_tbl->get_tuple_descriptor(0);
+    RowDescriptor row_desc(*desc_tbl, {0}, {false});
+
+    OlapTableSink sink(&obj_pool, row_desc, {}, &st);
+    ASSERT_TRUE(st.ok());
+
+    // init
+    st = sink.init(t_data_sink);
+    ASSERT_TRUE(st.ok());
+    // prepare
+    st = sink.prepare(&state);
+    ASSERT_TRUE(st.ok());
+    // open, master of tablet 6 is node 0 and master of tablet 7 is node 1,
+    // so the unreachable node 2 is only a slave.
+    st = sink.open(&state);
+    ASSERT_TRUE(st.ok());
+    // send
+    auto tracker = std::make_shared<MemTracker>();
+    RowBatch batch(row_desc, 1024, tracker.get());
+    // 12, 9, "abc"
+    {
+        Tuple* tuple = (Tuple*)batch.tuple_data_pool()->allocate(tuple_desc->byte_size());
+        batch.get_row(batch.add_row())->set_tuple(0, tuple);
+        memset(tuple, 0, tuple_desc->byte_size());
+
+        *reinterpret_cast<int*>(tuple->get_slot(4)) = 12;
+        *reinterpret_cast<int64_t*>(tuple->get_slot(8)) = 9;
+        StringValue* str_val = reinterpret_cast<StringValue*>(tuple->get_slot(16));
+        str_val->ptr = (char*)batch.tuple_data_pool()->allocate(10);
+        str_val->len = 3;
+        memcpy(str_val->ptr, "abc", str_val->len);
+        batch.commit_last_row();
+    }
+    // 13, 25, "abcd"
+    {
+        Tuple* tuple = (Tuple*)batch.tuple_data_pool()->allocate(tuple_desc->byte_size());
+        batch.get_row(batch.add_row())->set_tuple(0, tuple);
+        memset(tuple, 0, tuple_desc->byte_size());
+
+        *reinterpret_cast<int*>(tuple->get_slot(4)) = 13;
+        *reinterpret_cast<int64_t*>(tuple->get_slot(8)) = 25;
+        StringValue* str_val = reinterpret_cast<StringValue*>(tuple->get_slot(16));
+        str_val->ptr = (char*)batch.tuple_data_pool()->allocate(10);
+        str_val->len = 4;
+        memcpy(str_val->ptr, "abcd", str_val->len);
+
+        batch.commit_last_row();
+    }
+    st = sink.send(&state, &batch);
+    ASSERT_TRUE(st.ok());
+    // close
+    st = sink.close(&state, Status::OK());
+    ASSERT_TRUE(st.ok());
+
+    // each master node has a eof
+    ASSERT_EQ(2, service->eof_counters);
+    // every row is sent to its master replica only
+    ASSERT_EQ(2, service->row_counters);
+    // 2 tablets * 2 slaves
+    ASSERT_EQ(4, service->slave_node_counters);
+}
+
 TEST_F(OlapTableSinkTest, convert) {
     // start brpc service first
     _server = new brpc::Server();
@@ -0,0 +1,253 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#define protected public
+#define private public
+#include <gtest/gtest.h>
+
+#include "common/config.h"
+#include "common/object_pool.h"
+#include "exec/olap_scan_node.h"
+#include "exec/olap_scanner.h"
+#include "gen_cpp/PlanNodes_types.h"
+#include "runtime/descriptor_helper.h"
+#include "runtime/descriptors.h"
+#include "runtime/mem_pool.h"
+#include "runtime/mem_tracker.h"
+#include "runtime/runtime_state.h"
+#include "runtime/string_value.h"
+#include "runtime/tuple.h"
+
+namespace doris {
+
+class TopNRuntimeFilterTest : public testing::Test {
+public:
+    TopNRuntimeFilterTest() : _state(TQueryGlobals()), _tracker(new MemTracker(-1)) {}
+
+protected:
+    // a tuple of (k1 INT NULL, k2 VARCHAR NULL, k3 DOUBLE, v1 INT), keys k1, k2 and k3
+    void SetUp() override {
+        _enable_topn_runtime_filter = config::enable_topn_runtime_filter;
+        config::enable_topn_runtime_filter = true;
+
+        TDescriptorTableBuilder table_builder;
+        TTupleDescriptorBuilder tuple;
+        tuple.add_slot(TSlotDescriptorBuilder()
+                               .type(TYPE_INT)
+                               .nullable(true)
+                               .column_name("k1")
+                               .column_pos(0)
+                               .build());
+        tuple.add_slot(TSlotDescriptorBuilder()
+                               .string_type(64)
+                               .nullable(true)
+                               .column_name("k2")
+                               .column_pos(1)
+                               .build());
+        tuple.add_slot(TSlotDescriptorBuilder()
+                               .type(TYPE_DOUBLE)
+                               .nullable(false)
+                               .column_name("k3")
+                               .column_pos(2)
+                               .build());
+        tuple.add_slot(TSlotDescriptorBuilder()
+                               .type(TYPE_INT)
+                               .nullable(false)
+                               .column_name("v1")
+                               .column_pos(3)
+                               .build());
+        tuple.build(&table_builder);
+        DescriptorTbl::create(&_obj_pool, table_builder.desc_tbl(), &_desc_tbl);
+        _tuple_desc = _desc_tbl->get_tuple_descriptor(0);
+
+        TPlanNode tnode;
+        tnode.__set_node_id(0);
+        tnode.__set_node_type(TPlanNodeType::OLAP_SCAN_NODE);
+        tnode.__set_num_children(0);
+        tnode.__set_limit(-1);
+        tnode.__set_row_tuples(std::vector<TTupleId>{0});
+        tnode.__set_nullable_tuples(std::vector<bool>{false});
+        tnode.__set_compact_data(false);
+        TOlapScanNode olap_scan_node;
+        olap_scan_node.__set_tuple_id(0);
+        olap_scan_node.__set_key_column_name({"k1", "k2", "k3"});
+        olap_scan_node.__set_key_column_type(
+                {TPrimitiveType::INT, TPrimitiveType::VARCHAR, TPrimitiveType::DOUBLE});
+        olap_scan_node.__set_is_preaggregation(true);
+        tnode.__set_olap_scan_node(olap_scan_node);
+        _scan_node.reset(new OlapScanNode(&_obj_pool, tnode, *_desc_tbl));
+        // set by prepare(), which needs the storage engine
+        _scan_node->_tuple_desc = _tuple_desc;
+        _mem_pool.reset(new MemPool(_tracker.get()));
+    }
+
+    void TearDown() override { config::enable_topn_runtime_filter = _enable_topn_runtime_filter; }
+
+    SlotId slot_id(int idx) { return _tuple_desc->slots()[idx]->id(); }
+
+    Tuple* int_tuple(const int32_t* k1) {
+        Tuple* tuple = Tuple::create(_tuple_desc->byte_size(), _mem_pool.get());
+        const SlotDescriptor* slot = _tuple_desc->slots()[0];
+        if (k1 == nullptr) {
+            tuple->set_null(slot->null_indicator_offset());
+        } else {
+            *reinterpret_cast<int32_t*>(tuple->get_slot(slot->tuple_offset())) = *k1;
+        }
+        return tuple;
+    }
+
+    Tuple* int_tuple(int32_t k1) { return int_tuple(&k1); }
+
+    Tuple* string_tuple(const std::string& k2) {
+        Tuple* tuple = Tuple::create(_tuple_desc->byte_size(), _mem_pool.get());
+        const SlotDescriptor* slot = _tuple_desc->slots()[1];
+        *tuple->get_string_slot(slot->tuple_offset()) =
+                StringValue(const_cast<char*>(k2.data()), k2.size());
+        return tuple;
+    }
+
+    std::unique_ptr<OlapScanner> create_scanner() {
+        return std::unique_ptr<OlapScanner>(new OlapScanner(
+                &_state, _scan_node.get(), false, false, TPaloScanRange(), {}));
+    }
+
+    bool _enable_topn_runtime_filter;
+    ObjectPool _obj_pool;
+    RuntimeState _state;
+    std::shared_ptr<MemTracker> _tracker;
+    std::unique_ptr<MemPool> _mem_pool;
+    DescriptorTbl* _desc_tbl = nullptr;
+    TupleDescriptor* _tuple_desc = nullptr;
+    std::unique_ptr<OlapScanNode> _scan_node;
+};
+
+TEST_F(TopNRuntimeFilterTest, disabled_by_config) {
+    config::enable_topn_runtime_filter = false;
+    ASSERT_FALSE(_scan_node->register_topn_filter(slot_id(0), true, false));
+    ASSERT_EQ(nullptr, _scan_node->_topn_slot);
+}
+
+TEST_F(TopNRuntimeFilterTest, register_filter) {
+    // NULLs would sort before the boundary
+    ASSERT_FALSE(_scan_node->register_topn_filter(slot_id(0), true, true));
+    // not a key column
+    ASSERT_FALSE(_scan_node->register_topn_filter(slot_id(3), true, false));
+    // no storage condition for the type
+    ASSERT_FALSE(_scan_node->register_topn_filter(slot_id(2), true, false));
+    ASSERT_EQ(nullptr, _scan_node->_topn_slot);
+
+    ASSERT_TRUE(_scan_node->register_topn_filter(slot_id(0), false, false));
+    ASSERT_EQ(_tuple_desc->slots()[0], _scan_node->_topn_slot);
+    ASSERT_FALSE(_scan_node->_topn_is_asc);
+}
+
+TEST_F(TopNRuntimeFilterTest, update_threshold) {
+    ASSERT_TRUE(_scan_node->register_topn_filter(slot_id(0), true, false));
+    TCondition condition;
+    // nothing is published until the TopN heap is full
+    ASSERT_FALSE(_scan_node->get_topn_condition(&condition));
+
+    int32_t value = 100;
+    _scan_node->update_topn_threshold(&value);
+    std::string bytes;
+    ASSERT_EQ(1, _scan_node->get_topn_threshold(0, &bytes));
+    ASSERT_EQ(value, *reinterpret_cast<const int32_t*>(bytes.data()));
+    ASSERT_TRUE(_scan_node->get_topn_condition(&condition));
+    ASSERT_EQ("k1", condition.column_name);
+    ASSERT_EQ("<=", condition.condition_op);
+    ASSERT_EQ(std::vector<std::string>{"100"}, condition.condition_values);
+
+    // a reader that is up to date does not copy the value again
+    bytes.clear();
+    ASSERT_EQ(1, _scan_node->get_topn_threshold(1, &bytes));
+    ASSERT_TRUE(bytes.empty());
+
+    value = 42;
+    _scan_node->update_topn_threshold(&value);
+    ASSERT_EQ(2, _scan_node->get_topn_threshold(1, &bytes));
+    ASSERT_EQ(value, *reinterpret_cast<const int32_t*>(bytes.data()));
+    ASSERT_TRUE(_scan_node->get_topn_condition(&condition));
+    ASSERT_EQ(std::vector<std::string>{"42"}, condition.condition_values);
+}
+
+TEST_F(TopNRuntimeFilterTest, string_threshold) {
+    ASSERT_TRUE(_scan_node->register_topn_filter(slot_id(1), false, false));
+    std::string str = "doris";
+    StringValue value(const_cast<char*>(str.data()), str.size());
+    _scan_node->update_topn_threshold(&value);
+    TCondition condition;
+    ASSERT_TRUE(_scan_node->get_topn_condition(&condition));
+    ASSERT_EQ("k2", condition.column_name);
+    ASSERT_EQ(">=", condition.condition_op);
+    ASSERT_EQ(std::vector<std::string>{"doris"}, condition.condition_values);
+
+    std::unique_ptr<OlapScanner> scanner = create_scanner();
+    scanner->_refresh_topn_threshold();
+    // the scanner keeps its own copy of the value
+    str = "xxxxx";
+    ASSERT_TRUE(scanner->_is_topn_filtered(string_tuple("apache")));
+    ASSERT_FALSE(scanner->_is_topn_filtered(string_tuple("doris")));
+    ASSERT_FALSE(scanner->_is_topn_filtered(string_tuple("olap")));
+}
+
+TEST_F(TopNRuntimeFilterTest, filter_rows) {
+    ASSERT_TRUE(_scan_node->register_topn_filter(slot_id(0), true, false));
+    std::unique_ptr<OlapScanner> scanner = create_scanner();
+    scanner->_refresh_topn_threshold();
+    ASSERT_EQ(nullptr, scanner->_topn_threshold);
+
+    int32_t value = 10;
+    _scan_node->update_topn_threshold(&value);
+    scanner->_refresh_topn_threshold();
+    ASSERT_FALSE(scanner->_is_topn_filtered(int_tuple(-5)));
+    // rows equal to the boundary may still enter by the later sort keys
+    ASSERT_FALSE(scanner->_is_topn_filtered(int_tuple(10)));
+    ASSERT_TRUE(scanner->_is_topn_filtered(int_tuple(11)));
+    // NULLS LAST, so they are after the boundary
+    ASSERT_TRUE(scanner->_is_topn_filtered(int_tuple(nullptr)));
+
+    // the scanner picks up a narrower boundary at its next batch
+    value = 0;
+    _scan_node->update_topn_threshold(&value);
+    ASSERT_FALSE(scanner->_is_topn_filtered(int_tuple(5)));
+    scanner->_refresh_topn_threshold();
+    ASSERT_TRUE(scanner->_is_topn_filtered(int_tuple(5)));
+    ASSERT_FALSE(scanner->_is_topn_filtered(int_tuple(0)));
+}
+
+TEST_F(TopNRuntimeFilterTest, filter_rows_desc) {
+    ASSERT_TRUE(_scan_node->register_topn_filter(slot_id(0), false, false));
+    std::unique_ptr<OlapScanner> scanner = create_scanner();
+    int32_t value = 10;
+    _scan_node->update_topn_threshold(&value);
+    scanner->_refresh_topn_threshold();
+    ASSERT_TRUE(scanner->_is_topn_filtered(int_tuple(9)));
+    ASSERT_FALSE(scanner->_is_topn_filtered(int_tuple(10)));
+    ASSERT_FALSE(scanner->_is_topn_filtered(int_tuple(100)));
+    ASSERT_TRUE(scanner->_is_topn_filtered(int_tuple(nullptr)));
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,477 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <gtest/gtest.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "common/object_pool.h"
+#include "exec/exec_node.h"
+#include "exprs/batch_functions.h"
+#include "exprs/expr.h"
+#include "exprs/expr_column.h"
+#include "exprs/expr_context.h"
+#include "exprs/math_functions.h"
+#include "exprs/string_functions.h"
+#include "exprs/timestamp_functions.h"
+#include "gen_cpp/Exprs_types.h"
+#include "runtime/descriptor_helper.h"
+#include "runtime/descriptors.h"
+#include "runtime/mem_tracker.h"
+#include "runtime/raw_value.h"
+#include "runtime/row_batch.h"
+#include "runtime/runtime_state.h"
+#include "runtime/string_value.h"
+#include "runtime/tuple.h"
+#include "runtime/tuple_row.h"
+#include "runtime/user_function_cache.h"
+#include "testutil/expr_node_helper.h"
+#include "testutil/function_utils.h"
+
+namespace doris {
+
+static const int NUM_ROWS = 1024;
+
+static TExprNode op_node(TExprNodeType::type node_type, TExprOpcode::type opcode,
+                         TPrimitiveType::type type, TPrimitiveType::type child_type) {
+    TExprNode node;
+    node.node_type = node_type;
+    node.type = expr_node_type(type);
+    node.num_children = node_type == TExprNodeType::CAST_EXPR ? 1 : 2;
+    node.__set_opcode(opcode);
+    node.__set_child_type(child_type);
+    return node;
+}
+
+static TExprNode fn_node(const std::string& name, TPrimitiveType::type type, int num_children) {
+    TExprNode node;
+    node.node_type = TExprNodeType::FUNCTION_CALL;
+    node.type = expr_node_type(type);
+    node.num_children = num_children;
+    TFunction fn;
+    fn.name.function_name = name;
+    node.__set_fn(fn);
+    return node;
+}
+
+class ExprBatchTest : public testing::Test {
+public:
+    ExprBatchTest() : _state(TQueryGlobals()), _tracker(new MemTracker(-1)) {}
+
+    static void SetUpTestCase() {
+        UserFunctionCache::instance()->init(
+                "./be/test/runtime/test_data/user_function_cache/normal");
+        MathFunctions::init();
+    }
+
+protected:
+    // a tuple of the nullable slots (c0 INT, c1 INT, c2 VARCHAR, c3 DATETIME)
+    void SetUp() override {
+        _state.init_instance_mem_tracker();
+        TDescriptorTableBuilder table_builder;
+        TTupleDescriptorBuilder tuple;
+        tuple.add_slot(TSlotDescriptorBuilder()
+                               .type(TYPE_INT)
+                               .nullable(true)
+                               .column_name("c0")
+                               .column_pos(0)
+                               .build());
+        tuple.add_slot(TSlotDescriptorBuilder()
+                               .type(TYPE_INT)
+                               .nullable(true)
+                               .column_name("c1")
+                               .column_pos(1)
+                               .build());
+        tuple.add_slot(TSlotDescriptorBuilder()
+                               .string_type(64)
+                               .nullable(true)
+                               .column_name("c2")
+                               .column_pos(2)
+                               .build());
+        tuple.add_slot(TSlotDescriptorBuilder()
+                               .type(TYPE_DATETIME)
+                               .nullable(true)
+                               .column_name("c3")
+                               .column_pos(3)
+                               .build());
+        tuple.build(&table_builder);
+        DescriptorTbl::create(&_obj_pool, table_builder.desc_tbl(), &_desc_tbl);
+        _state.set_desc_tbl(_desc_tbl);
+        _row_desc.reset(new RowDescriptor(*_desc_tbl, {0}, {false}));
+        create_rows();
+    }
+
+    void TearDown() override {
+        for (auto ctx : _ctxs) {
+            ctx->close(&_state);
+        }
+    }
+
+    // rows of (i % 17 - 8, i % 5 - 2, "Str_<i % 7>", 2020-<i % 12 + 1>-<i % 28 + 1> <i % 24>:00)
+    // with some nulls in each column
+    void create_rows() {
+        TupleDescriptor* tuple_desc = _desc_tbl->get_tuple_descriptor(0);
+        const std::vector<SlotDescriptor*>& slots = tuple_desc->slots();
+        _batch.reset(new RowBatch(*_row_desc, NUM_ROWS, _tracker.get()));
+        MemPool* pool = _batch->tuple_data_pool();
+        for (int i = 0; i < NUM_ROWS; ++i) {
+            int row_idx = _batch->add_row();
+            Tuple* tuple = Tuple::create(tuple_desc->byte_size(), pool);
+            *reinterpret_cast<int32_t*>(tuple->get_slot(slots[0]->tuple_offset())) = i % 17 - 8;
+            *reinterpret_cast<int32_t*>(tuple->get_slot(slots[1]->tuple_offset())) = i % 5 - 2;
+            std::string str = "Str_" + std::to_string(i % 7);
+            char* ptr = reinterpret_cast<char*>(pool->allocate(str.size()));
+            memcpy(ptr, str.data(), str.size());
+            *tuple->get_string_slot(slots[2]->tuple_offset()) = StringValue(ptr, str.size());
+            DateTimeValue* datetime =
+                    reinterpret_cast<DateTimeValue*>(tuple->get_slot(slots[3]->tuple_offset()));
+            datetime->from_date_int64(20200000000000L + (i % 12 + 1) * 100000000L +
+                                      (i % 28 + 1) * 1000000L + (i % 24) * 10000L);
+            int divisors[] = {11, 13, 9, 19};
+            for (int j = 0; j < 4; ++j) {
+                if (i % divisors[j] == 0) {
+                    tuple->set_null(slots[j]->null_indicator_offset());
+                }
+            }
+            _batch->get_row(row_idx)->set_tuple(0, tuple);
+            _batch->commit_last_row();
+            _rows.push_back(_batch->get_row(row_idx));
+        }
+    }
+
+    ExprContext* create_ctx(const std::vector<TExprNode>& nodes) {
+        TExpr texpr;
+        texpr.nodes = nodes;
+        ExprContext* ctx = nullptr;
+        EXPECT_TRUE(Expr::create_expr_tree(&_obj_pool, texpr, &ctx).ok());
+        EXPECT_TRUE(ctx->prepare(&_state, *_row_desc, _tracker).ok());
+        EXPECT_TRUE(ctx->open(&_state).ok());
+        _ctxs.push_back(ctx);
+        return ctx;
+    }
+
+    // Checks that evaluating 'nodes' over the rows a batch at a time gets the values of
+    // evaluating them a row at a time.
+    void check_batch(const std::vector<TExprNode>& nodes) {
+        ExprContext* ctx = create_ctx(nodes);
+        const TypeDescriptor& type = ctx->root()->type();
+        // twice, the second evaluation reuses the columns of the first
+        for (int k = 0; k < 2; ++k) {
+            const ExprColumn* column = ctx->evaluate_batch(_rows.data(), NUM_ROWS);
+            ASSERT_EQ(NUM_ROWS, column->num_rows());
+            int num_nulls = 0;
+            for (int i = 0; i < NUM_ROWS; ++i) {
+                void* value = ctx->get_value(_rows[i]);
+                ASSERT_EQ(value == nullptr, column->is_null(i)) << "row " << i;
+                if (value != nullptr) {
+                    ASSERT_TRUE(RawValue::eq(value, column->value(i), type)) << "row " << i;
+                } else {
+                    ++num_nulls;
+                }
+            }
+            // every expr under test has both null and non-null rows
+            ASSERT_GT(num_nulls, 0);
+            ASSERT_LT(num_nulls, NUM_ROWS);
+        }
+    }
+
+    ObjectPool _obj_pool;
+    RuntimeState _state;
+    std::shared_ptr<MemTracker> _tracker;
+    DescriptorTbl* _desc_tbl = nullptr;
+    std::unique_ptr<RowDescriptor> _row_desc;
+    std::unique_ptr<RowBatch> _batch;
+    std::vector<TupleRow*> _rows;
+    std::vector<ExprContext*> _ctxs;
+};
+
+TEST_F(ExprBatchTest, slot_ref) {
+    check_batch({slot_node(0, TPrimitiveType::INT)});
+    check_batch({slot_node(2, TPrimitiveType::VARCHAR)});
+    check_batch({slot_node(3, TPrimitiveType::DATETIME)});
+}
+
+TEST_F(ExprBatchTest, arithmetic) {
+    TPrimitiveType::type BIGINT = TPrimitiveType::BIGINT;
+    TPrimitiveType::type INT = TPrimitiveType::INT;
+    // c0 + c1
+    check_batch({op_node(TExprNodeType::ARITHMETIC_EXPR, TExprOpcode::ADD, BIGINT, BIGINT),
+                 slot_node(0, INT), slot_node(1, INT)});
+    // c0 div c1, c1 is 0 in a fifth of the rows
+    check_batch({op_node(TExprNodeType::ARITHMETIC_EXPR, TExprOpcode::INT_DIVIDE, BIGINT,
+                         BIGINT),
+                 slot_node(0, INT), slot_node(1, INT)});
+    // c0 % c1
+    check_batch({op_node(TExprNodeType::ARITHMETIC_EXPR, TExprOpcode::MOD, BIGINT, BIGINT),
+                 slot_node(0, INT), slot_node(1, INT)});
+    // (c0 * 3) ^ c1
+    check_batch({op_node(TExprNodeType::ARITHMETIC_EXPR, TExprOpcode::BITXOR, BIGINT, BIGINT),
+                 op_node(TExprNodeType::ARITHMETIC_EXPR, TExprOpcode::MULTIPLY, BIGINT, BIGINT),
+                 slot_node(0, INT), int_node(3, BIGINT), slot_node(1, INT)});
+}
+
+TEST_F(ExprBatchTest, binary_predicate) {
+    TPrimitiveType::type BOOLEAN = TPrimitiveType::BOOLEAN;
+    check_batch({op_node(TExprNodeType::BINARY_PRED, TExprOpcode::LT, BOOLEAN,
+                         TPrimitiveType::INT),
+                 slot_node(0, TPrimitiveType::INT), slot_node(1, TPrimitiveType::INT)});
+    check_batch({op_node(TExprNodeType::BINARY_PRED, TExprOpcode::EQ, BOOLEAN,
+                         TPrimitiveType::VARCHAR),
+                 slot_node(2, TPrimitiveType::VARCHAR), string_node("Str_3")});
+    check_batch({op_node(TExprNodeType::BINARY_PRED, TExprOpcode::GE, BOOLEAN,
+                         TPrimitiveType::VARCHAR),
+                 slot_node(2, TPrimitiveType::VARCHAR), string_node("Str_3")});
+}
+
+TEST_F(ExprBatchTest, cast) {
+    check_batch({op_node(TExprNodeType::CAST_EXPR, TExprOpcode::CAST, TPrimitiveType::DOUBLE,
+                         TPrimitiveType::INT),
+                 slot_node(0, TPrimitiveType::INT)});
+    check_batch({op_node(TExprNodeType::CAST_EXPR, TExprOpcode::CAST, TPrimitiveType::TINYINT,
+                         TPrimitiveType::INT),
+                 slot_node(1, TPrimitiveType::INT)});
+}
+
+TEST_F(ExprBatchTest, conditional) {
+    TPrimitiveType::type INT = TPrimitiveType::INT;
+    // if(c0 < c1, c0, c1)
+    check_batch({fn_node("if", INT, 3),
+                 op_node(TExprNodeType::BINARY_PRED, TExprOpcode::LT, TPrimitiveType::BOOLEAN,
+                         INT),
+                 slot_node(0, INT), slot_node(1, INT), slot_node(0, INT), slot_node(1, INT)});
+    // ifnull(c2, c2), null where both are
+    check_batch({fn_node("ifnull", TPrimitiveType::VARCHAR, 2),
+                 slot_node(2, TPrimitiveType::VARCHAR), slot_node(2, TPrimitiveType::VARCHAR)});
+    // coalesce(c0, c1)
+    check_batch({fn_node("coalesce", INT, 2), slot_node(0, INT), slot_node(1, INT)});
+}
+
+TEST_F(ExprBatchTest, case_expr) {
+    TPrimitiveType::type INT = TPrimitiveType::INT;
+    // case c0 when 1 then c1 when -3 then 100 else c0 end
+    TExprNode with_case = fn_node("case", INT, 6);
+    with_case.node_type = TExprNodeType::CASE_EXPR;
+    with_case.__isset.fn = false;
+    with_case.__isset.case_expr = true;
+    with_case.case_expr.has_case_expr = true;
+    with_case.case_expr.has_else_expr = true;
+    check_batch({with_case, slot_node(0, INT), int_node(1, INT), slot_node(1, INT),
+                 int_node(-3, INT), int_node(100, INT), slot_node(0, INT)});
+
+    // case when c1 > 0 then c2 end
+    TExprNode without_case = fn_node("case", TPrimitiveType::VARCHAR, 2);
+    without_case.node_type = TExprNodeType::CASE_EXPR;
+    without_case.__isset.fn = false;
+    without_case.__isset.case_expr = true;
+    without_case.case_expr.has_case_expr = false;
+    without_case.case_expr.has_else_expr = false;
+    check_batch({without_case,
+                 op_node(TExprNodeType::BINARY_PRED, TExprOpcode::GT, TPrimitiveType::BOOLEAN,
+                         INT),
+                 slot_node(1, INT), int_node(0, INT), slot_node(2, TPrimitiveType::VARCHAR)});
+}
+
+TEST_F(ExprBatchTest, eval_conjuncts_batch) {
+    TPrimitiveType::type INT = TPrimitiveType::INT;
+    ExprContext* ctxs[] = {
+            create_ctx({op_node(TExprNodeType::BINARY_PRED, TExprOpcode::GT,
+                                TPrimitiveType::BOOLEAN, INT),
+                        slot_node(0, INT), int_node(-4, INT)}),
+            create_ctx({op_node(TExprNodeType::BINARY_PRED, TExprOpcode::NE,
+                                TPrimitiveType::BOOLEAN, INT),
+                        slot_node(1, INT), int_node(0, INT)})};
+    std::vector<TupleRow*> rows = _rows;
+    std::vector<int> sel(NUM_ROWS);
+    int num_sel = ExecNode::eval_conjuncts_batch(ctxs, 2, rows.data(), NUM_ROWS, sel.data());
+    std::vector<int> expected;
+    for (int i = 0; i < NUM_ROWS; ++i) {
+        if (ExecNode::eval_conjuncts(ctxs, 2, _rows[i])) {
+            expected.push_back(i);
+        }
+    }
+    ASSERT_EQ(expected, std::vector<int>(sel.begin(), sel.begin() + num_sel));
+}
+
+// random() returns a new value for each row, it is not evaluated once per batch like a
+// constant
+TEST_F(ExprBatchTest, nondeterministic_fn) {
+    TExprNode random = fn_node("random", TPrimitiveType::DOUBLE, 0);
+    random.fn.__isset.scalar_fn = true;
+    random.fn.scalar_fn.symbol = "_ZN5doris13MathFunctions4randEPN9doris_udf15FunctionContextE";
+    random.fn.scalar_fn.__set_prepare_fn_symbol(
+            "_ZN5doris13MathFunctions12rand_prepareEPN9doris_udf15FunctionContextENS2_"
+            "18FunctionStateScopeE");
+    random.fn.scalar_fn.__set_close_fn_symbol(
+            "_ZN5doris13MathFunctions10rand_closeEPN9doris_udf15FunctionContextENS2_"
+            "18FunctionStateScopeE");
+    ExprContext* ctx = create_ctx({random});
+    ASSERT_FALSE(ctx->root()->is_constant());
+    const ExprColumn* column = ctx->evaluate_batch(_rows.data(), NUM_ROWS);
+    const double* values = column->data<double>();
+    ASSERT_GT(std::set<double>(values, values + NUM_ROWS).size(), 1);
+
+    for (const std::string& name : {"rand", "RANDOM", "uuid"}) {
+        TExpr texpr;
+        texpr.nodes.push_back(fn_node(name, TPrimitiveType::DOUBLE, 0));
+        ExprContext* fn_ctx = nullptr;
+        ASSERT_TRUE(Expr::create_expr_tree(&_obj_pool, texpr, &fn_ctx).ok());
+        ASSERT_FALSE(fn_ctx->root()->is_constant()) << name;
+    }
+
+    // a user function may not be deterministic either, a builtin without arguments is
+    TExpr texpr;
+    texpr.nodes.push_back(fn_node("pi", TPrimitiveType::DOUBLE, 0));
+    ExprContext* fn_ctx = nullptr;
+    ASSERT_TRUE(Expr::create_expr_tree(&_obj_pool, texpr, &fn_ctx).ok());
+    ASSERT_TRUE(fn_ctx->root()->is_constant());
+    texpr.nodes[0].fn.__set_binary_type(TFunctionBinaryType::NATIVE);
+    ASSERT_TRUE(Expr::create_expr_tree(&_obj_pool, texpr, &fn_ctx).ok());
+    ASSERT_FALSE(fn_ctx->root()->is_constant());
+}
+
+class BatchFunctionsTest : public testing::Test {
+public:
+    BatchFunctionsTest() : _tracker(new MemTracker(-1)) {}
+
+protected:
+    ExprColumn* string_column(const std::vector<std::string>& values) {
+        ExprColumn* column = _obj_pool.add(new ExprColumn(_tracker.get()));
+        column->reset(TYPE_VARCHAR, values.size());
+        for (int i = 0; i < values.size(); ++i) {
+            StringValue value(const_cast<char*>(values[i].data()), values[i].size());
+            column->set(i, &value);
+        }
+        return column;
+    }
+
+    ExprColumn* int_column(const std::vector<int32_t>& values) {
+        ExprColumn* column = _obj_pool.add(new ExprColumn(_tracker.get()));
+        column->reset(TYPE_INT, values.size());
+        for (int i = 0; i < values.size(); ++i) {
+            column->set(i, &values[i]);
+        }
+        return column;
+    }
+
+    ObjectPool _obj_pool;
+    std::shared_ptr<MemTracker> _tracker;
+    FunctionUtils _utils;
+};
+
+TEST_F(BatchFunctionsTest, substring) {
+    typedef StringVal (*SubstringFn)(FunctionContext*, const StringVal&, const IntVal&,
+                                     const IntVal&);
+    SubstringFn row_fn = &StringFunctions::substring;
+    BatchFn batch_fn = BatchFunctions::get(reinterpret_cast<void*>(row_fn));
+    ASSERT_TRUE(batch_fn != nullptr);
+
+    std::vector<std::string> strs;
+    std::vector<int32_t> positions;
+    std::vector<int32_t> lens;
+    for (const std::string& str : {"", "a", "hello", "\xE4\xBD\xA0\xE5\xA5\xBD world"}) {
+        for (int pos = -8; pos <= 8; ++pos) {
+            for (int len = -1; len <= 4; ++len) {
+                strs.push_back(str);
+                positions.push_back(pos);
+                lens.push_back(len);
+            }
+        }
+    }
+    const ExprColumn* args[] = {string_column(strs), int_column(positions), int_column(lens)};
+    ExprColumn result(_tracker.get());
+    result.reset(TYPE_VARCHAR, strs.size());
+    FunctionContext* context = _utils.get_fn_ctx();
+    batch_fn(context, args, strs.size(), &result);
+    for (int i = 0; i < strs.size(); ++i) {
+        StringVal expected = row_fn(context, StringVal(strs[i].c_str()), IntVal(positions[i]),
+                                    IntVal(lens[i]));
+        ASSERT_EQ(expected.is_null, result.is_null(i))
+                << strs[i] << ", " << positions[i] << ", " << lens[i];
+        if (!expected.is_null) {
+            ASSERT_EQ(StringValue::from_string_val(expected),
+                      *reinterpret_cast<const StringValue*>(result.value(i)));
+        }
+    }
+}
+
+TEST_F(BatchFunctionsTest, upper) {
+    typedef StringVal (*StringFn)(FunctionContext*, const StringVal&);
+    StringFn row_fn = &StringFunctions::upper;
+    BatchFn batch_fn = BatchFunctions::get(reinterpret_cast<void*>(row_fn));
+    ASSERT_TRUE(batch_fn != nullptr);
+
+    ExprColumn* str = string_column({"", "abc", "Hello World", "123_x"});
+    str->set(2, nullptr);
+    const ExprColumn* args[] = {str};
+    ExprColumn result(_tracker.get());
+    result.reset(TYPE_VARCHAR, 4);
+    batch_fn(_utils.get_fn_ctx(), args, 4, &result);
+    ASSERT_EQ("", result.data<StringValue>()[0].to_string());
+    ASSERT_EQ("ABC", result.data<StringValue>()[1].to_string());
+    ASSERT_TRUE(result.is_null(2));
+    ASSERT_EQ("123_X", result.data<StringValue>()[3].to_string());
+}
+
+TEST_F(BatchFunctionsTest, datetime_fields) {
+    ExprColumn datetimes(_tracker.get());
+    datetimes.reset(TYPE_DATETIME, 3);
+    DateTimeValue value;
+    value.from_date_int64(20210304050607L);
+    datetimes.set(0, &value);
+    datetimes.set(1, nullptr);
+    value.from_date_int64(19991231235959L);
+    datetimes.set(2, &value);
+    const ExprColumn* args[] = {&datetimes};
+
+    BatchFn year = BatchFunctions::get(reinterpret_cast<void*>(&TimestampFunctions::year));
+    BatchFn month = BatchFunctions::get(reinterpret_cast<void*>(&TimestampFunctions::month));
+    BatchFn day = BatchFunctions::get(reinterpret_cast<void*>(&TimestampFunctions::day_of_month));
+    BatchFn to_date = BatchFunctions::get(reinterpret_cast<void*>(&TimestampFunctions::to_date));
+    ExprColumn result(_tracker.get());
+    result.reset(TYPE_INT, 3);
+    year(_utils.get_fn_ctx(), args, 3, &result);
+    ASSERT_EQ(2021, result.data<int32_t>()[0]);
+    ASSERT_TRUE(result.is_null(1));
+    ASSERT_EQ(1999, result.data<int32_t>()[2]);
+    month(_utils.get_fn_ctx(), args, 3, &result);
+    ASSERT_EQ(3, result.data<int32_t>()[0]);
+    ASSERT_EQ(12, result.data<int32_t>()[2]);
+    day(_utils.get_fn_ctx(), args, 3, &result);
+    ASSERT_EQ(4, result.data<int32_t>()[0]);
+    ASSERT_EQ(31, result.data<int32_t>()[2]);
+
+    result.reset(TYPE_DATE, 3);
+    to_date(_utils.get_fn_ctx(), args, 3, &result);
+    ASSERT_EQ(20210304, result.data<DateTimeValue>()[0].to_int64());
+    ASSERT_TRUE(result.is_null(1));
+    ASSERT_EQ(19991231, result.data<DateTimeValue>()[2].to_int64());
+}
+
+TEST_F(BatchFunctionsTest, no_batch_version) {
+    typedef StringVal (*StringFn)(FunctionContext*, const StringVal&);
+    StringFn row_fn = &StringFunctions::reverse;
+    ASSERT_TRUE(BatchFunctions::get(reinterpret_cast<void*>(row_fn)) == nullptr);
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,308 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "exprs/specialized_predicate.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "common/object_pool.h"
+#include "exprs/expr.h"
+#include "exprs/expr_column.h"
+#include "exprs/expr_context.h"
+#include "gen_cpp/Exprs_types.h"
+#include "runtime/descriptor_helper.h"
+#include "runtime/descriptors.h"
+#include "runtime/mem_tracker.h"
+#include "runtime/row_batch.h"
+#include "runtime/runtime_state.h"
+#include "runtime/string_value.h"
+#include "runtime/tuple.h"
+#include "runtime/tuple_row.h"
+#include "testutil/expr_node_helper.h"
+
+namespace doris {
+
+static const int NUM_ROWS = 1024;
+
+static TExprNode node_with_opcode(TExprNodeType::type node_type, TExprOpcode::type opcode,
+                                  TPrimitiveType::type type, int num_children) {
+    TExprNode node;
+    node.node_type = node_type;
+    node.type = gen_type_desc(type);
+    node.num_children = num_children;
+    node.__set_opcode(opcode);
+    return node;
+}
+
+static TExprNode compare_node(TExprOpcode::type opcode, TPrimitiveType::type child_type) {
+    TExprNode node = node_with_opcode(TExprNodeType::BINARY_PRED, opcode,
+                                      TPrimitiveType::BOOLEAN, 2);
+    node.__set_child_type(child_type);
+    return node;
+}
+
+static TExprNode compound_node(TExprOpcode::type opcode) {
+    return node_with_opcode(TExprNodeType::COMPOUND_PRED, opcode, TPrimitiveType::BOOLEAN, 2);
+}
+
+static TExprNode in_node(bool is_not_in, int num_children) {
+    TExprNode node = node_with_opcode(
+            TExprNodeType::IN_PRED,
+            is_not_in ? TExprOpcode::FILTER_NOT_IN : TExprOpcode::FILTER_IN,
+            TPrimitiveType::BOOLEAN, num_children);
+    node.__isset.in_predicate = true;
+    node.in_predicate.is_not_in = is_not_in;
+    return node;
+}
+
+class SpecializedPredicateTest : public testing::Test {
+public:
+    SpecializedPredicateTest() : _state(TQueryGlobals()), _tracker(new MemTracker(-1)) {}
+
+protected:
+    // a tuple of the nullable slots (c0 INT, c1 INT, c2 VARCHAR, c3 DATETIME)
+    void SetUp() override {
+        _state.init_instance_mem_tracker();
+        TDescriptorTableBuilder table_builder;
+        TTupleDescriptorBuilder tuple;
+        tuple.add_slot(TSlotDescriptorBuilder()
+                               .type(TYPE_INT)
+                               .nullable(true)
+                               .column_name("c0")
+                               .column_pos(0)
+                               .build());
+        tuple.add_slot(TSlotDescriptorBuilder()
+                               .type(TYPE_INT)
+                               .nullable(true)
+                               .column_name("c1")
+                               .column_pos(1)
+                               .build());
+        tuple.add_slot(TSlotDescriptorBuilder()
+                               .string_type(64)
+                               .nullable(true)
+                               .column_name("c2")
+                               .column_pos(2)
+                               .build());
+        tuple.add_slot(TSlotDescriptorBuilder()
+                               .type(TYPE_DATETIME)
+                               .nullable(true)
+                               .column_name("c3")
+                               .column_pos(3)
+                               .build());
+        tuple.build(&table_builder);
+        DescriptorTbl::create(&_obj_pool, table_builder.desc_tbl(), &_desc_tbl);
+        _state.set_desc_tbl(_desc_tbl);
+        _row_desc.reset(new RowDescriptor(*_desc_tbl, {0}, {false}));
+        create_rows();
+    }
+
+    void TearDown() override {
+        for (auto ctx : _ctxs) {
+            ctx->close(&_state);
+        }
+    }
+
+    // rows of (i % 17 - 8, i % 5 - 2, "Str_<i % 7>", 2020-<i % 12 + 1>-<i % 28 + 1>) with
+    // some nulls in each column
+    void create_rows() {
+        TupleDescriptor* tuple_desc = _desc_tbl->get_tuple_descriptor(0);
+        const std::vector<SlotDescriptor*>& slots = tuple_desc->slots();
+        _batch.reset(new RowBatch(*_row_desc, NUM_ROWS, _tracker.get()));
+        MemPool* pool = _batch->tuple_data_pool();
+        for (int i = 0; i < NUM_ROWS; ++i) {
+            int row_idx = _batch->add_row();
+            Tuple* tuple = Tuple::create(tuple_desc->byte_size(), pool);
+            *reinterpret_cast<int32_t*>(tuple->get_slot(slots[0]->tuple_offset())) = i % 17 - 8;
+            *reinterpret_cast<int32_t*>(tuple->get_slot(slots[1]->tuple_offset())) = i % 5 - 2;
+            std::string str = "Str_" + std::to_string(i % 7);
+            char* ptr = reinterpret_cast<char*>(pool->allocate(str.size()));
+            memcpy(ptr, str.data(), str.size());
+            *tuple->get_string_slot(slots[2]->tuple_offset()) = StringValue(ptr, str.size());
+            DateTimeValue* datetime =
+                    reinterpret_cast<DateTimeValue*>(tuple->get_slot(slots[3]->tuple_offset()));
+            datetime->from_date_int64(20200000000000L + (i % 12 + 1) * 100000000L +
+                                      (i % 28 + 1) * 1000000L);
+            int divisors[] = {11, 13, 9, 19};
+            for (int j = 0; j < 4; ++j) {
+                if (i % divisors[j] == 0) {
+                    tuple->set_null(slots[j]->null_indicator_offset());
+                }
+            }
+            _batch->get_row(row_idx)->set_tuple(0, tuple);
+            _batch->commit_last_row();
+            _rows.push_back(_batch->get_row(row_idx));
+        }
+    }
+
+    ExprContext* create_ctx(const std::vector<TExprNode>& nodes) {
+        TExpr texpr;
+        texpr.nodes = nodes;
+        ExprContext* ctx = nullptr;
+        EXPECT_TRUE(Expr::create_expr_tree(&_obj_pool, texpr, &ctx).ok());
+        EXPECT_TRUE(ctx->prepare(&_state, *_row_desc, _tracker).ok());
+        EXPECT_TRUE(ctx->open(&_state).ok());
+        _ctxs.push_back(ctx);
+        return ctx;
+    }
+
+    // Checks that 'nodes' are specialized, and that the specialized version gets the values
+    // of the exprs for each row, a row and a batch at a time.
+    void check_specialized(const std::vector<TExprNode>& nodes) {
+        ExprContext* ctx = create_ctx(nodes);
+        ASSERT_TRUE(ctx->specialized_predicate() != nullptr);
+        const ExprColumn* column = ctx->evaluate_batch(_rows.data(), NUM_ROWS);
+        int num_true = 0;
+        int num_nulls = 0;
+        for (int i = 0; i < NUM_ROWS; ++i) {
+            BooleanVal expected = ctx->root()->get_boolean_val(ctx, _rows[i]);
+            BooleanVal actual = ctx->get_boolean_val(_rows[i]);
+            ASSERT_EQ(expected.is_null, actual.is_null) << "row " << i;
+            ASSERT_EQ(expected.is_null, column->is_null(i)) << "row " << i;
+            if (!expected.is_null) {
+                ASSERT_EQ(expected.val, actual.val) << "row " << i;
+                ASSERT_EQ(expected.val, column->data<bool>()[i]) << "row " << i;
+                num_true += expected.val;
+            } else {
+                ++num_nulls;
+            }
+        }
+        // every predicate under test has true, false and null rows
+        ASSERT_GT(num_true, 0);
+        ASSERT_GT(num_nulls, 0);
+        ASSERT_LT(num_true + num_nulls, NUM_ROWS);
+    }
+
+    ObjectPool _obj_pool;
+    RuntimeState _state;
+    std::shared_ptr<MemTracker> _tracker;
+    DescriptorTbl* _desc_tbl = nullptr;
+    std::unique_ptr<RowDescriptor> _row_desc;
+    std::unique_ptr<RowBatch> _batch;
+    std::vector<TupleRow*> _rows;
+    std::vector<ExprContext*> _ctxs;
+};
+
+TEST_F(SpecializedPredicateTest, compare) {
+    TPrimitiveType::type INT = TPrimitiveType::INT;
+    TExprOpcode::type ops[] = {TExprOpcode::EQ, TExprOpcode::NE, TExprOpcode::LT,
+                               TExprOpcode::LE, TExprOpcode::GT, TExprOpcode::GE};
+    for (auto op : ops) {
+        check_specialized({compare_node(op, INT), slot_node(0, INT), int_node(3)});
+        // literal op slot
+        check_specialized({compare_node(op, INT), int_node(3), slot_node(0, INT)});
+    }
+    check_specialized({compare_node(TExprOpcode::EQ, TPrimitiveType::VARCHAR),
+                       slot_node(2, TPrimitiveType::VARCHAR), string_node("Str_3")});
+    check_specialized({compare_node(TExprOpcode::LT, TPrimitiveType::VARCHAR),
+                       slot_node(2, TPrimitiveType::VARCHAR), string_node("Str_3")});
+    check_specialized({compare_node(TExprOpcode::GE, TPrimitiveType::DATETIME),
+                       slot_node(3, TPrimitiveType::DATETIME),
+                       datetime_node("2020-06-15 00:00:00")});
+}
+
+TEST_F(SpecializedPredicateTest, between) {
+    TPrimitiveType::type INT = TPrimitiveType::INT;
+    // c0 >= -2 AND c0 <= 4
+    check_specialized({compound_node(TExprOpcode::COMPOUND_AND),
+                       compare_node(TExprOpcode::GE, INT), slot_node(0, INT), int_node(-2),
+                       compare_node(TExprOpcode::LE, INT), slot_node(0, INT), int_node(4)});
+    // c0 < 4 AND -2 < c0
+    check_specialized({compound_node(TExprOpcode::COMPOUND_AND),
+                       compare_node(TExprOpcode::LT, INT), slot_node(0, INT), int_node(4),
+                       compare_node(TExprOpcode::LT, INT), int_node(-2), slot_node(0, INT)});
+    // c3 >= '2020-03-01' AND c3 < '2020-09-01'
+    check_specialized({compound_node(TExprOpcode::COMPOUND_AND),
+                       compare_node(TExprOpcode::GE, TPrimitiveType::DATETIME),
+                       slot_node(3, TPrimitiveType::DATETIME),
+                       datetime_node("2020-03-01 00:00:00"),
+                       compare_node(TExprOpcode::LT, TPrimitiveType::DATETIME),
+                       slot_node(3, TPrimitiveType::DATETIME),
+                       datetime_node("2020-09-01 00:00:00")});
+}
+
+TEST_F(SpecializedPredicateTest, in) {
+    TPrimitiveType::type INT = TPrimitiveType::INT;
+    TPrimitiveType::type VARCHAR = TPrimitiveType::VARCHAR;
+    check_specialized(
+            {in_node(false, 4), slot_node(0, INT), int_node(1), int_node(2), int_node(-5)});
+    check_specialized({in_node(true, 3), slot_node(2, VARCHAR), string_node("Str_1"),
+                       string_node("Str_2")});
+
+    // NULL in the list makes the values not in it NULL
+    ExprContext* ctx = create_ctx({in_node(false, 3), slot_node(0, INT), int_node(1),
+                                   null_node(TPrimitiveType::INT)});
+    ASSERT_TRUE(ctx->specialized_predicate() == nullptr);
+}
+
+TEST_F(SpecializedPredicateTest, compound) {
+    TPrimitiveType::type INT = TPrimitiveType::INT;
+    TPrimitiveType::type VARCHAR = TPrimitiveType::VARCHAR;
+    // (c0 < 0 OR c1 = 1) AND c2 != 'Str_0'
+    check_specialized({compound_node(TExprOpcode::COMPOUND_AND),
+                       compound_node(TExprOpcode::COMPOUND_OR),
+                       compare_node(TExprOpcode::LT, INT), slot_node(0, INT), int_node(0),
+                       compare_node(TExprOpcode::EQ, INT), slot_node(1, INT), int_node(1),
+                       compare_node(TExprOpcode::NE, VARCHAR), slot_node(2, VARCHAR),
+                       string_node("Str_0")});
+    // c0 > 0 AND c1 < 1, two slots
+    check_specialized({compound_node(TExprOpcode::COMPOUND_AND),
+                       compare_node(TExprOpcode::GT, INT), slot_node(0, INT), int_node(0),
+                       compare_node(TExprOpcode::LT, INT), slot_node(1, INT), int_node(1)});
+    // c0 IN (1, 2) OR c1 >= 1
+    check_specialized({compound_node(TExprOpcode::COMPOUND_OR), in_node(false, 3),
+                       slot_node(0, INT), int_node(1), int_node(2),
+                       compare_node(TExprOpcode::GE, INT), slot_node(1, INT), int_node(1)});
+}
+
+TEST_F(SpecializedPredicateTest, not_specialized) {
+    TPrimitiveType::type INT = TPrimitiveType::INT;
+    // slot op slot
+    ExprContext* ctx =
+            create_ctx({compare_node(TExprOpcode::LT, INT), slot_node(0, INT), slot_node(1, INT)});
+    ASSERT_TRUE(ctx->specialized_predicate() == nullptr);
+    // an AND with a child of another shape
+    ctx = create_ctx({compound_node(TExprOpcode::COMPOUND_AND),
+                      compare_node(TExprOpcode::GT, INT), slot_node(0, INT), int_node(0),
+                      compare_node(TExprOpcode::LT, INT), slot_node(0, INT), slot_node(1, INT)});
+    ASSERT_TRUE(ctx->specialized_predicate() == nullptr);
+    // a NULL literal
+    ctx = create_ctx({compare_node(TExprOpcode::EQ, INT), slot_node(0, INT), null_node(INT)});
+    ASSERT_TRUE(ctx->specialized_predicate() == nullptr);
+}
+
+TEST_F(SpecializedPredicateTest, clone) {
+    TPrimitiveType::type INT = TPrimitiveType::INT;
+    ExprContext* ctx = create_ctx(
+            {in_node(false, 4), slot_node(0, INT), int_node(1), int_node(2), int_node(-5)});
+    ExprContext* clone = nullptr;
+    ASSERT_TRUE(ctx->clone(&_state, &clone).ok());
+    _ctxs.push_back(clone);
+    ASSERT_TRUE(clone->specialized_predicate() != nullptr);
+    for (int i = 0; i < NUM_ROWS; ++i) {
+        ASSERT_TRUE(ctx->get_boolean_val(_rows[i]) == clone->get_boolean_val(_rows[i]));
+    }
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,477 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define private public
+#include "olap/data_dir.h"
+#include "olap/rowset_sync_handler.h"
+#undef private
+#include "common/config.h"
+#include "gen_cpp/Descriptors_types.h"
+#include "gen_cpp/PaloInternalService_types.h"
+#include "olap/delta_writer.h"
+#include "olap/rowset/beta_rowset.h"
+#include "olap/storage_engine.h"
+#include "olap/tablet_manager.h"
+#include "olap/txn_manager.h"
+#include "runtime/descriptor_helper.h"
+#include "runtime/descriptors.h"
+#include "runtime/exec_env.h"
+#include "runtime/mem_pool.h"
+#include "runtime/mem_tracker.h"
+#include "runtime/tuple.h"
+#include "service/brpc.h"
+#include "util/brpc_stub_cache.h"
+#include "util/cpu_info.h"
+#include "util/debug/leakcheck_disabler.h"
+#include "util/file_utils.h"
+#include "util/time.h"
+
+namespace doris {
+
+static const int TEST_PORT = 4370;
+static const int64_t MASTER_TABLET_ID = 15001;
+static const int64_t SLAVE_TABLET_ID = 15002;
+static const int32_t SCHEMA_HASH = 370068375;
+static const int64_t SLAVE_NODE_ID = 7;
+
+static StorageEngine* k_engine = nullptr;
+
+// Plays the slave replica: records the chunks and passes the requests to a
+// RowsetSyncHandler, rewritten from the master tablet to the slave tablet, which is on the
+// same engine. Fails the chunk at index 'fail_chunk', and holds back the response to the
+// request at index 'hold_request' until release().
+class TestSyncService : public PBackendService {
+public:
+    struct Chunk {
+        int32_t segment_id;
+        int64_t offset;
+        size_t size;
+    };
+
+    void tablet_writer_sync_rowset(google::protobuf::RpcController* controller,
+                                   const PTabletWriterSyncRowsetRequest* request,
+                                   PTabletWriterSyncRowsetResult* response,
+                                   google::protobuf::Closure* done) override {
+        brpc::ClosureGuard closure_guard(done);
+        brpc::Controller* cntl = static_cast<brpc::Controller*>(controller);
+        int request_idx = 0;
+        {
+            std::lock_guard<std::mutex> l(_lock);
+            request_idx = _num_requests++;
+            if (!request->has_rowset_meta()) {
+                chunks.push_back({request->segment_id(), request->offset(),
+                                  cntl->request_attachment().size()});
+            }
+        }
+        Status st;
+        if (request_idx == fail_chunk) {
+            st = Status::InternalError("injected failure");
+        } else {
+            PTabletWriterSyncRowsetRequest slave_request = *request;
+            slave_request.set_tablet_id(SLAVE_TABLET_ID);
+            if (slave_request.has_rowset_meta()) {
+                slave_request.mutable_rowset_meta()->set_tablet_id(SLAVE_TABLET_ID);
+                slave_request.mutable_rowset_meta()->set_tablet_schema_hash(SCHEMA_HASH);
+            }
+            st = RowsetSyncHandler(k_engine).process(slave_request, cntl->request_attachment());
+        }
+        st.to_protobuf(response->mutable_status());
+        if (request_idx == hold_request) {
+            std::lock_guard<std::mutex> l(_lock);
+            _held = closure_guard.release();
+        }
+    }
+
+    void release() {
+        google::protobuf::Closure* held = nullptr;
+        {
+            std::lock_guard<std::mutex> l(_lock);
+            std::swap(held, _held);
+        }
+        if (held != nullptr) {
+            held->Run();
+        }
+    }
+
+    int fail_chunk = -1;
+    int hold_request = -1;
+    std::vector<Chunk> chunks;
+
+private:
+    std::mutex _lock;
+    int _num_requests = 0;
+    google::protobuf::Closure* _held = nullptr;
+};
+
+static void create_tablet_request(int64_t tablet_id, TCreateTabletReq* request) {
+    request->tablet_id = tablet_id;
+    request->__set_version(1);
+    request->__set_version_hash(0);
+    request->tablet_schema.schema_hash = SCHEMA_HASH;
+    request->tablet_schema.short_key_column_count = 1;
+    request->tablet_schema.keys_type = TKeysType::AGG_KEYS;
+    request->tablet_schema.storage_type = TStorageType::COLUMN;
+
+    TColumn k1;
+    k1.column_name = "k1";
+    k1.__set_is_key(true);
+    k1.column_type.type = TPrimitiveType::INT;
+    request->tablet_schema.columns.push_back(k1);
+
+    TColumn v1;
+    v1.column_name = "v1";
+    v1.__set_is_key(false);
+    v1.column_type.type = TPrimitiveType::INT;
+    v1.__set_aggregation_type(TAggregationType::SUM);
+    request->tablet_schema.columns.push_back(v1);
+}
+
+class RowsetSyncHandlerTest : public testing::Test {
+protected:
+    void SetUp() override {
+        _saved_chunk_bytes = config::single_replica_load_sync_chunk_bytes;
+        _saved_rpc_timeout_sec = config::single_replica_load_sync_rpc_timeout_sec;
+        config::single_replica_load_sync_chunk_bytes = 1024;
+
+        TCreateTabletReq master_request;
+        create_tablet_request(MASTER_TABLET_ID, &master_request);
+        ASSERT_EQ(OLAP_SUCCESS, k_engine->create_tablet(master_request));
+        TCreateTabletReq slave_request;
+        create_tablet_request(SLAVE_TABLET_ID, &slave_request);
+        ASSERT_EQ(OLAP_SUCCESS, k_engine->create_tablet(slave_request));
+        _master = k_engine->tablet_manager()->get_tablet(MASTER_TABLET_ID, SCHEMA_HASH);
+        _slave = k_engine->tablet_manager()->get_tablet(SLAVE_TABLET_ID, SCHEMA_HASH);
+        ASSERT_TRUE(_master != nullptr);
+        ASSERT_TRUE(_slave != nullptr);
+
+        _service = new TestSyncService();
+        _server.reset(new brpc::Server());
+        ASSERT_EQ(0, _server->AddService(_service, brpc::SERVER_OWNS_SERVICE));
+        brpc::ServerOptions options;
+        {
+            debug::ScopedLeakCheckDisabler disable_lsan;
+            ASSERT_EQ(0, _server->Start(TEST_PORT, &options));
+        }
+        PNodeInfo node;
+        node.set_id(SLAVE_NODE_ID);
+        node.set_host("127.0.0.1");
+        node.set_async_internal_port(TEST_PORT);
+        _slave_nodes.push_back(node);
+        _load_id.set_hi(1);
+        _load_id.set_lo(2);
+    }
+
+    void TearDown() override {
+        _service->release();
+        _server->Stop(100);
+        _server->Join();
+        _master.reset();
+        _slave.reset();
+        k_engine->tablet_manager()->drop_tablet(MASTER_TABLET_ID, SCHEMA_HASH);
+        k_engine->tablet_manager()->drop_tablet(SLAVE_TABLET_ID, SCHEMA_HASH);
+        config::single_replica_load_sync_chunk_bytes = _saved_chunk_bytes;
+        config::single_replica_load_sync_rpc_timeout_sec = _saved_rpc_timeout_sec;
+    }
+
+    // Loads rows into the master tablet in txn 'txn_id', two segments of 'num_rows' rows
+    // each, and returns the committed rowset.
+    RowsetSharedPtr write_master_rowset(int64_t txn_id, int num_rows) {
+        TDescriptorTableBuilder dtb;
+        TTupleDescriptorBuilder tuple_builder;
+        tuple_builder.add_slot(
+                TSlotDescriptorBuilder().type(TYPE_INT).column_name("k1").column_pos(0).build());
+        tuple_builder.add_slot(
+                TSlotDescriptorBuilder().type(TYPE_INT).column_name("v1").column_pos(1).build());
+        tuple_builder.build(&dtb);
+        ObjectPool obj_pool;
+        DescriptorTbl* desc_tbl = nullptr;
+        DescriptorTbl::create(&obj_pool, dtb.desc_tbl(), &desc_tbl);
+        TupleDescriptor* tuple_desc = desc_tbl->get_tuple_descriptor(0);
+        const std::vector<SlotDescriptor*>& slots = tuple_desc->slots();
+
+        WriteRequest write_req = {MASTER_TABLET_ID, SCHEMA_HASH, WriteType::LOAD,
+                                  txn_id,           PARTITION_ID, _load_id,
+                                  false,            tuple_desc,   &slots};
+        DeltaWriter* writer = nullptr;
+        std::shared_ptr<MemTracker> tracker(new MemTracker(-1, "rowset sync test"));
+        DeltaWriter::open(&write_req, tracker, &writer);
+        EXPECT_TRUE(writer != nullptr);
+        std::unique_ptr<DeltaWriter> writer_holder(writer);
+        MemPool pool(tracker.get());
+        for (int seg = 0; seg < 2; ++seg) {
+            for (int i = 0; i < num_rows; ++i) {
+                Tuple* tuple = reinterpret_cast<Tuple*>(pool.allocate(tuple_desc->byte_size()));
+                memset(tuple, 0, tuple_desc->byte_size());
+                *reinterpret_cast<int32_t*>(tuple->get_slot(slots[0]->tuple_offset())) =
+                        seg * num_rows + i;
+                *reinterpret_cast<int32_t*>(tuple->get_slot(slots[1]->tuple_offset())) = i * 7;
+                EXPECT_EQ(OLAP_SUCCESS, writer->write(tuple));
+            }
+            // every flush writes a segment
+            EXPECT_EQ(OLAP_SUCCESS, writer->flush_memtable_and_wait());
+        }
+        EXPECT_EQ(OLAP_SUCCESS, writer->close());
+        EXPECT_EQ(OLAP_SUCCESS, writer->close_wait(nullptr));
+        return committed_rowset(MASTER_TABLET_ID, txn_id);
+    }
+
+    static RowsetSharedPtr committed_rowset(int64_t tablet_id, int64_t txn_id) {
+        std::map<TabletInfo, RowsetSharedPtr> tablet_rowsets;
+        k_engine->txn_manager()->get_txn_related_tablets(txn_id, PARTITION_ID, &tablet_rowsets);
+        for (auto& it : tablet_rowsets) {
+            if (it.first.tablet_id == tablet_id) {
+                return it.second;
+            }
+        }
+        return nullptr;
+    }
+
+    static std::string read_file(const std::string& path) {
+        std::unique_ptr<RandomAccessFile> file;
+        EXPECT_TRUE(Env::Default()->new_random_access_file(path, &file).ok());
+        uint64_t size = 0;
+        EXPECT_TRUE(file->size(&size).ok());
+        std::string content(size, '\0');
+        Slice slice(&content[0], size);
+        EXPECT_TRUE(file->read_at(0, slice).ok());
+        return content;
+    }
+
+    std::unique_ptr<RowsetSyncer> create_syncer(const RowsetSharedPtr& rowset, int64_t txn_id) {
+        return std::unique_ptr<RowsetSyncer>(new RowsetSyncer(
+                &_stub_cache, _master, rowset, _load_id, txn_id, PARTITION_ID, _slave_nodes));
+    }
+
+    // Sends all the chunks and the meta one request at a time like TabletsChannel does.
+    static void sync(RowsetSyncer* syncer) {
+        while (syncer->send()) {
+            syncer->wait();
+        }
+    }
+
+    PTabletWriterSyncRowsetRequest chunk_request(int64_t txn_id, const RowsetId& rowset_id,
+                                                 int64_t offset) {
+        PTabletWriterSyncRowsetRequest request;
+        request.mutable_id()->CopyFrom(_load_id);
+        request.set_txn_id(txn_id);
+        request.set_partition_id(PARTITION_ID);
+        request.set_tablet_id(SLAVE_TABLET_ID);
+        request.set_schema_hash(SCHEMA_HASH);
+        request.set_rowset_id(rowset_id.to_string());
+        request.set_segment_id(0);
+        request.set_offset(offset);
+        return request;
+    }
+
+    static const int64_t PARTITION_ID = 25001;
+
+    int64_t _saved_chunk_bytes;
+    int32_t _saved_rpc_timeout_sec;
+    TabletSharedPtr _master;
+    TabletSharedPtr _slave;
+    TestSyncService* _service = nullptr;
+    std::unique_ptr<brpc::Server> _server;
+    BrpcStubCache _stub_cache;
+    std::vector<PNodeInfo> _slave_nodes;
+    PUniqueId _load_id;
+};
+
+TEST_F(RowsetSyncHandlerTest, sync_rowset) {
+    const int64_t txn_id = 35001;
+    RowsetSharedPtr rowset = write_master_rowset(txn_id, 2000);
+    ASSERT_TRUE(rowset != nullptr);
+    ASSERT_EQ(2, rowset->num_segments());
+
+    std::unique_ptr<RowsetSyncer> syncer = create_syncer(rowset, txn_id);
+    sync(syncer.get());
+
+    // the chunks of a segment are sent in order and cover its file, segment after segment
+    int32_t seg_id = 0;
+    int64_t offset = 0;
+    int num_chunks = 0;
+    for (auto& chunk : _service->chunks) {
+        if (chunk.segment_id != seg_id) {
+            ASSERT_EQ(seg_id + 1, chunk.segment_id);
+            ASSERT_EQ(read_file(BetaRowset::segment_file_path(_master->tablet_path(),
+                                                              rowset->rowset_id(), seg_id))
+                              .size(),
+                      static_cast<size_t>(offset));
+            seg_id = chunk.segment_id;
+            offset = 0;
+        }
+        ASSERT_EQ(offset, chunk.offset);
+        ASSERT_LE(chunk.size, 1024u);
+        offset += chunk.size;
+        ++num_chunks;
+    }
+    ASSERT_EQ(1, seg_id);
+    ASSERT_GT(num_chunks, 2);
+
+    // the slave has the same segment files and has committed the rowset to the txn
+    for (int i = 0; i < rowset->num_segments(); ++i) {
+        ASSERT_EQ(read_file(BetaRowset::segment_file_path(_master->tablet_path(),
+                                                          rowset->rowset_id(), i)),
+                  read_file(BetaRowset::segment_file_path(_slave->tablet_path(),
+                                                          rowset->rowset_id(), i)));
+    }
+    RowsetSharedPtr slave_rowset = committed_rowset(SLAVE_TABLET_ID, txn_id);
+    ASSERT_TRUE(slave_rowset != nullptr);
+    ASSERT_EQ(rowset->rowset_id(), slave_rowset->rowset_id());
+    ASSERT_EQ(rowset->num_rows(), slave_rowset->num_rows());
+    ASSERT_EQ(_slave->tablet_uid(), slave_rowset->rowset_meta()->tablet_uid());
+    ASSERT_EQ(0, RowsetSyncHandler::_pending_rowsets.count(ROWSET_ID_PREFIX +
+                                                           rowset->rowset_id().to_string()));
+
+    google::protobuf::RepeatedPtrField<PTabletInfo> tablet_vec;
+    syncer->get_committed_tablets(&tablet_vec);
+    ASSERT_EQ(1, tablet_vec.size());
+    ASSERT_EQ(MASTER_TABLET_ID, tablet_vec.Get(0).tablet_id());
+    ASSERT_EQ(SLAVE_NODE_ID, tablet_vec.Get(0).node_id());
+}
+
+TEST_F(RowsetSyncHandlerTest, failed_chunk) {
+    const int64_t txn_id = 35002;
+    RowsetSharedPtr rowset = write_master_rowset(txn_id, 2000);
+    ASSERT_TRUE(rowset != nullptr);
+    _service->fail_chunk = 1;
+
+    std::unique_ptr<RowsetSyncer> syncer = create_syncer(rowset, txn_id);
+    sync(syncer.get());
+
+    // nothing is sent to the slave after the failed chunk, not even the meta
+    ASSERT_EQ(2, _service->chunks.size());
+    ASSERT_TRUE(committed_rowset(SLAVE_TABLET_ID, txn_id) == nullptr);
+    google::protobuf::RepeatedPtrField<PTabletInfo> tablet_vec;
+    syncer->get_committed_tablets(&tablet_vec);
+    ASSERT_EQ(0, tablet_vec.size());
+}
+
+TEST_F(RowsetSyncHandlerTest, timed_out_chunk) {
+    const int64_t txn_id = 35003;
+    RowsetSharedPtr rowset = write_master_rowset(txn_id, 2000);
+    ASSERT_TRUE(rowset != nullptr);
+    config::single_replica_load_sync_rpc_timeout_sec = 1;
+    _service->hold_request = 0;
+
+    std::unique_ptr<RowsetSyncer> syncer = create_syncer(rowset, txn_id);
+    sync(syncer.get());
+
+    ASSERT_EQ(1, _service->chunks.size());
+    google::protobuf::RepeatedPtrField<PTabletInfo> tablet_vec;
+    syncer->get_committed_tablets(&tablet_vec);
+    ASSERT_EQ(0, tablet_vec.size());
+}
+
+TEST_F(RowsetSyncHandlerTest, chunk_of_missing_file) {
+    RowsetId rowset_id = k_engine->next_rowset_id();
+    const std::string pending_id = ROWSET_ID_PREFIX + rowset_id.to_string();
+    butil::IOBuf data;
+    data.append("abc");
+    // a chunk after the first one needs the file the first one created
+    RowsetSyncHandler handler(k_engine);
+    ASSERT_FALSE(handler.process(chunk_request(35004, rowset_id, 3), data).ok());
+    ASSERT_FALSE(_slave->data_dir()->_check_pending_ids(pending_id));
+
+    ASSERT_TRUE(handler.process(chunk_request(35004, rowset_id, 0), data).ok());
+    ASSERT_TRUE(handler.process(chunk_request(35004, rowset_id, 3), data).ok());
+    ASSERT_EQ("abcabc", read_file(BetaRowset::segment_file_path(_slave->tablet_path(),
+                                                                rowset_id, 0)));
+    ASSERT_TRUE(_slave->data_dir()->_check_pending_ids(pending_id));
+    RowsetSyncHandler::_remove_pending_rowset(pending_id);
+}
+
+TEST_F(RowsetSyncHandlerTest, expire_pending_rowset) {
+    RowsetId rowset_id = k_engine->next_rowset_id();
+    const std::string pending_id = ROWSET_ID_PREFIX + rowset_id.to_string();
+    butil::IOBuf data;
+    data.append("abc");
+    RowsetSyncHandler handler(k_engine);
+    ASSERT_TRUE(handler.process(chunk_request(35005, rowset_id, 0), data).ok());
+    ASSERT_TRUE(_slave->data_dir()->_check_pending_ids(pending_id));
+
+    // still pending within twice the rpc timeout of its last chunk
+    RowsetSyncHandler::_expire_pending_rowsets();
+    ASSERT_TRUE(_slave->data_dir()->_check_pending_ids(pending_id));
+
+    // the master has given up, the files are left to path gc
+    {
+        std::lock_guard<std::mutex> l(RowsetSyncHandler::_pending_lock);
+        RowsetSyncHandler::_pending_rowsets[pending_id].last_active_sec -=
+                2 * config::single_replica_load_sync_rpc_timeout_sec + 1;
+    }
+    RowsetSyncHandler::_expire_pending_rowsets();
+    ASSERT_FALSE(_slave->data_dir()->_check_pending_ids(pending_id));
+    ASSERT_EQ(0, RowsetSyncHandler::_pending_rowsets.count(pending_id));
+}
+
+TEST_F(RowsetSyncHandlerTest, commit_with_missing_segment) {
+    const int64_t txn_id = 35006;
+    RowsetSharedPtr rowset = write_master_rowset(txn_id, 100);
+    ASSERT_TRUE(rowset != nullptr);
+
+    // only the meta arrives, the rowset fails to load and is not committed
+    PTabletWriterSyncRowsetRequest request = chunk_request(txn_id, rowset->rowset_id(), 0);
+    request.clear_rowset_id();
+    request.clear_segment_id();
+    request.clear_offset();
+    rowset->rowset_meta()->to_rowset_pb(request.mutable_rowset_meta());
+    request.mutable_rowset_meta()->set_tablet_id(SLAVE_TABLET_ID);
+    RowsetSyncHandler handler(k_engine);
+    ASSERT_FALSE(handler.process(request, butil::IOBuf()).ok());
+    ASSERT_TRUE(committed_rowset(SLAVE_TABLET_ID, txn_id) == nullptr);
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    std::string conffile = std::string(getenv("DORIS_HOME")) + "/conf/be.conf";
+    if (!doris::config::init(conffile.c_str(), false)) {
+        fprintf(stderr, "error read config file. \n");
+        return -1;
+    }
+    testing::InitGoogleTest(&argc, argv);
+    doris::CpuInfo::init();
+
+    char buffer[1024];
+    getcwd(buffer, 1024);
+    doris::config::storage_root_path = std::string(buffer) + "/data_test_rowset_sync";
+    doris::FileUtils::remove_all(doris::config::storage_root_path);
+    doris::FileUtils::create_dir(doris::config::storage_root_path);
+    doris::EngineOptions options;
+    options.store_paths.emplace_back(doris::config::storage_root_path, -1);
+    doris::Status st = doris::StorageEngine::open(options, &doris::k_engine);
+    if (!st.ok()) {
+        fprintf(stderr, "failed to open storage engine: %s\n", st.to_string().c_str());
+        return -1;
+    }
+    doris::ExecEnv::GetInstance()->set_storage_engine(doris::k_engine);
+
+    int ret = RUN_ALL_TESTS();
+
+    doris::k_engine->stop();
+    delete doris::k_engine;
+    doris::FileUtils::remove_all(doris::config::storage_root_path);
+    google::protobuf::ShutdownProtobufLibrary();
+    return ret;
+}
@@ -0,0 +1,1046 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <google/protobuf/stubs/common.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define private public
+#define protected public
+#include <gtest/gtest.h>
+
+#include "common/config.h"
+#include "common/object_pool.h"
+#include "exec/sort_exec_exprs.h"
+#include "exprs/expr.h"
+#include "exprs/expr_context.h"
+#include "gen_cpp/DataSinks_types.h"
+#include "gen_cpp/Exprs_types.h"
+#include "gen_cpp/data.pb.h"
+#include "gen_cpp/internal_service.pb.h"
+#include "runtime/data_stream_mgr.h"
+#include "runtime/data_stream_recvr.h"
+#include "runtime/data_stream_sender.h"
+#include "runtime/descriptor_helper.h"
+#include "runtime/descriptors.h"
+#include "runtime/mem_tracker.h"
+#include "runtime/primitive_type.h"
+#include "runtime/raw_value.h"
+#include "runtime/row_batch.h"
+#include "runtime/runtime_state.h"
+#include "runtime/string_value.h"
+#include "runtime/test_env.h"
+#include "runtime/tuple.h"
+#include "runtime/tuple_row.h"
+#include "service/backend_options.h"
+#include "service/brpc.h"
+#include "testutil/expr_node_helper.h"
+#include "util/brpc_stub_cache.h"
+#include "util/debug/leakcheck_disabler.h"
+#include "util/monotime.h"
+#include "util/runtime_profile.h"
+#include "util/threadpool.h"
+
+namespace doris {
+
+// Counts how often the receiver acked a batch.
+class CountingClosure : public google::protobuf::Closure {
+public:
+    void Run() override { ++num_runs; }
+
+    int num_runs = 0;
+};
+
+static const int TEST_PORT = 4361;
+
+// Holds back the transmit_data rpcs until the test delivers them to the receivers of
+// 'stream_mgr', in any order. Delivers them right away once holding is turned off.
+class HoldingBackendService : public PBackendService {
+public:
+    HoldingBackendService(DataStreamMgr* stream_mgr) : _stream_mgr(stream_mgr) {}
+
+    void transmit_data(google::protobuf::RpcController* controller,
+                       const PTransmitDataParams* request, PTransmitDataResult* response,
+                       google::protobuf::Closure* done) override {
+        HeldRpc rpc = {static_cast<brpc::Controller*>(controller), request, response, done};
+        {
+            std::lock_guard<std::mutex> l(_lock);
+            ++_num_rpcs;
+            if (_hold) {
+                _held.push_back(rpc);
+                return;
+            }
+        }
+        _deliver(rpc);
+    }
+
+    // Hands the packet 'packet_seq' to its receiver and responds, unless the receiver
+    // defers the response. Returns false if the packet was not received.
+    bool deliver(int64_t packet_seq) {
+        HeldRpc rpc;
+        {
+            std::lock_guard<std::mutex> l(_lock);
+            auto it = std::find_if(_held.begin(), _held.end(), [&](const HeldRpc& held) {
+                return held.request->packet_seq() == packet_seq;
+            });
+            if (it == _held.end()) {
+                return false;
+            }
+            rpc = *it;
+            _held.erase(it);
+        }
+        _deliver(rpc);
+        return true;
+    }
+
+    void set_hold(bool hold) {
+        std::lock_guard<std::mutex> l(_lock);
+        _hold = hold;
+    }
+
+    // Responds to the rpcs that were not delivered.
+    void release() {
+        std::vector<HeldRpc> held;
+        {
+            std::lock_guard<std::mutex> l(_lock);
+            held.swap(_held);
+        }
+        for (HeldRpc& rpc : held) {
+            rpc.done->Run();
+        }
+    }
+
+    int num_rpcs() {
+        std::lock_guard<std::mutex> l(_lock);
+        return _num_rpcs;
+    }
+
+private:
+    struct HeldRpc {
+        brpc::Controller* cntl;
+        const PTransmitDataParams* request;
+        PTransmitDataResult* response;
+        google::protobuf::Closure* done;
+    };
+
+    void _deliver(const HeldRpc& rpc) {
+        google::protobuf::Closure* done = rpc.done;
+        _stream_mgr->transmit_data(rpc.request, &rpc.cntl->request_attachment(), rpc.response,
+                                   &done);
+        if (done != nullptr) {
+            done->Run();
+        }
+    }
+
+    DataStreamMgr* _stream_mgr;
+    std::mutex _lock;
+    bool _hold = true;
+    std::vector<HeldRpc> _held;
+    int _num_rpcs = 0;
+};
+
+class DataStreamRecvrTest : public testing::Test {
+public:
+    DataStreamRecvrTest() : _profile("DataStreamRecvrTest"), _tracker(new MemTracker(-1)) {}
+
+protected:
+    // a tuple of (c0 INT, c1 VARCHAR)
+    void SetUp() override {
+        _max_in_flight_rpcs = config::exchange_max_in_flight_rpcs;
+        _merge_fan_in = config::exchange_merge_fan_in;
+        _local_exchange = config::enable_local_exchange;
+        _localhost = BackendOptions::_s_localhost;
+        BackendOptions::_s_localhost = "127.0.0.1";
+        _test_env.exec_env()->_stream_mgr = &_stream_mgr;
+        _test_env.exec_env()->_brpc_stub_cache = &_stub_cache;
+        _state.reset(new RuntimeState(TUniqueId(), TQueryOptions(), TQueryGlobals(),
+                                      _test_env.exec_env()));
+        _state->init_instance_mem_tracker();
+
+        TDescriptorTableBuilder table_builder;
+        TTupleDescriptorBuilder tuple;
+        tuple.add_slot(TSlotDescriptorBuilder()
+                               .type(TYPE_INT)
+                               .nullable(false)
+                               .column_name("c0")
+                               .column_pos(0)
+                               .build());
+        tuple.add_slot(TSlotDescriptorBuilder()
+                               .string_type(64)
+                               .nullable(false)
+                               .column_name("c1")
+                               .column_pos(1)
+                               .build());
+        tuple.build(&table_builder);
+        DescriptorTbl::create(&_obj_pool, table_builder.desc_tbl(), &_desc_tbl);
+        _state->set_desc_tbl(_desc_tbl);
+        _tuple_desc = _desc_tbl->get_tuple_descriptor(0);
+        _row_desc.reset(new RowDescriptor(*_desc_tbl, {0}, {false}));
+    }
+
+    void TearDown() override {
+        if (_server != nullptr) {
+            _service->release();
+            _server->Stop(100);
+            _server->Join();
+        }
+        config::exchange_max_in_flight_rpcs = _max_in_flight_rpcs;
+        config::exchange_merge_fan_in = _merge_fan_in;
+        config::enable_local_exchange = _local_exchange;
+        close_sort_exprs();
+        _state.reset();
+        _test_env.exec_env()->_stream_mgr = nullptr;
+        _test_env.exec_env()->_brpc_stub_cache = nullptr;
+        BackendOptions::_s_localhost = _localhost;
+    }
+
+    boost::shared_ptr<DataStreamRecvr> create_recvr(int buffer_size, int64_t finst_lo = 0) {
+        TUniqueId finst_id;
+        finst_id.hi = 1;
+        finst_id.lo = finst_lo;
+        return _stream_mgr.create_recvr(_state.get(), *_row_desc, finst_id, DEST_NODE_ID, 1,
+                                        buffer_size, &_profile, false, nullptr);
+    }
+
+    static TExpr slot_ref(TupleId tuple_id, SlotId slot_id) {
+        TExprNode node;
+        node.__set_node_type(TExprNodeType::SLOT_REF);
+        node.__set_type(gen_type_desc(TPrimitiveType::INT));
+        node.__set_num_children(0);
+        TSlotRef slot;
+        slot.__set_slot_id(slot_id);
+        slot.__set_tuple_id(tuple_id);
+        node.__set_slot_ref(slot);
+        TExpr expr;
+        expr.nodes.push_back(node);
+        return expr;
+    }
+
+    // A merging receiver of 'num_senders' senders, sorted by c0. The groups hand their
+    // rows over in batches of 4 rows.
+    boost::shared_ptr<DataStreamRecvr> create_merging_recvr(int num_senders) {
+        _state->_query_options.__set_batch_size(4);
+        TUniqueId finst_id;
+        finst_id.hi = 1;
+        finst_id.lo = 0;
+        return _stream_mgr.create_recvr(_state.get(), *_row_desc, finst_id, DEST_NODE_ID,
+                                        num_senders, 1024 * 1024, &_profile, true, nullptr);
+    }
+
+    // Creates the merger of 'recvr', which orders by c0, in the way the exchange node does.
+    Status create_merger(DataStreamRecvr* recvr) {
+        RETURN_IF_ERROR(_sort_exprs.init({slot_ref(0, _tuple_desc->slots()[0]->id())}, nullptr,
+                                         &_obj_pool));
+        RETURN_IF_ERROR(_sort_exprs.prepare(_state.get(), *_row_desc, *_row_desc, _tracker));
+        RETURN_IF_ERROR(_sort_exprs.open(_state.get()));
+        _sort_exprs_opened = true;
+        return recvr->create_merger(_state.get(), _sort_exprs, {true}, {false});
+    }
+
+    // Reads the merged stream of 'recvr' to the end, appends the values of c0 to 'values'.
+    Status get_merged_values(DataStreamRecvr* recvr, std::vector<int>* values) {
+        RowBatch batch(*_row_desc, 16, _tracker.get());
+        bool eos = false;
+        while (!eos) {
+            RETURN_IF_ERROR(recvr->get_next(&batch, &eos));
+            for (int i = 0; i < batch.num_rows(); ++i) {
+                Tuple* tuple = batch.get_row(i)->get_tuple(0);
+                values->push_back(*reinterpret_cast<int32_t*>(tuple->get_slot(int_offset())));
+            }
+            batch.reset();
+        }
+        return Status::OK();
+    }
+
+    // Sends 'num_batches' batches of 10 rows to every sender queue of a merging receiver of
+    // 'num_senders', sender i gets the values i, i + num_senders, ... Ends the stream of
+    // every sender if 'eos' is set.
+    void send_sorted_batches(DataStreamRecvr* recvr, int num_senders, int num_batches,
+                             bool eos) {
+        for (int b = 0; b < num_batches; ++b) {
+            for (int sender = 0; sender < num_senders; ++sender) {
+                std::unique_ptr<RowBatch> batch =
+                        create_batch(sender + b * 10 * num_senders, 10, num_senders);
+                google::protobuf::Closure* done = nullptr;
+                recvr->add_local_batch(batch.get(), sender, 0, false, &done);
+            }
+        }
+        if (eos) {
+            for (int sender = 0; sender < num_senders; ++sender) {
+                recvr->remove_sender(sender, 0);
+            }
+        }
+    }
+
+    void close_sort_exprs() {
+        if (_sort_exprs_opened) {
+            _sort_exprs.close(_state.get());
+            _sort_exprs_opened = false;
+        }
+    }
+
+    // rows (start, "start"), (start + step, "start + step"), ... of 'num_rows' rows
+    std::unique_ptr<RowBatch> create_batch(int start, int num_rows, int step = 1) {
+        std::unique_ptr<RowBatch> batch(new RowBatch(*_row_desc, num_rows, _tracker.get()));
+        MemPool* pool = batch->tuple_data_pool();
+        for (int i = 0; i < num_rows; ++i) {
+            int row_idx = batch->add_row();
+            Tuple* tuple = Tuple::create(_tuple_desc->byte_size(), pool);
+            *reinterpret_cast<int32_t*>(tuple->get_slot(int_offset())) = start + i * step;
+            std::string str = std::to_string(start + i * step);
+            char* data = reinterpret_cast<char*>(pool->allocate(str.size()));
+            memcpy(data, str.data(), str.size());
+            *tuple->get_string_slot(string_offset()) = StringValue(data, str.size());
+            batch->get_row(row_idx)->set_tuple(0, tuple);
+            batch->commit_last_row();
+        }
+        return batch;
+    }
+
+    // checks that 'batch' has the rows of create_batch(start, num_rows)
+    void check_batch(RowBatch* batch, int start, int num_rows) {
+        ASSERT_TRUE(batch != nullptr);
+        ASSERT_EQ(num_rows, batch->num_rows());
+        for (int i = 0; i < num_rows; ++i) {
+            Tuple* tuple = batch->get_row(i)->get_tuple(0);
+            ASSERT_EQ(start + i, *reinterpret_cast<int32_t*>(tuple->get_slot(int_offset())));
+            ASSERT_EQ(std::to_string(start + i),
+                      tuple->get_string_slot(string_offset())->to_string());
+        }
+    }
+
+    int int_offset() const { return _tuple_desc->slots()[0]->tuple_offset(); }
+    int string_offset() const { return _tuple_desc->slots()[1]->tuple_offset(); }
+
+    // Starts a server on TEST_PORT whose rpcs wait until the test delivers them.
+    void start_server() {
+        _service = new HoldingBackendService(&_stream_mgr);
+        _server.reset(new brpc::Server());
+        ASSERT_EQ(0, _server->AddService(_service, brpc::SERVER_OWNS_SERVICE));
+        brpc::ServerOptions options;
+        {
+            debug::ScopedLeakCheckDisabler disable_lsan;
+            ASSERT_EQ(0, _server->Start(TEST_PORT, &options));
+        }
+    }
+
+    // waits until the server got 'num_rpcs' rpcs
+    void wait_rpcs(int num_rpcs) {
+        for (int i = 0; i < 1000 && _service->num_rpcs() < num_rpcs; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        ASSERT_EQ(num_rpcs, _service->num_rpcs());
+    }
+
+    // waits until the responses to 'sender' arrived
+    static void wait_can_send(DataStreamSender* sender) {
+        for (int i = 0; i < 1000 && !sender->can_send(); ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        ASSERT_TRUE(sender->can_send());
+    }
+
+    // serialized rows of create_batch(start, num_rows)
+    void create_pb_batch(int start, int num_rows, PRowBatch* pb_batch) {
+        create_batch(start, num_rows)
+                ->serialize(pb_batch, segment_v2::CompressionTypePB::NO_COMPRESSION, nullptr);
+    }
+
+    // Adds a packet of create_batch(start, num_rows) to the receiver of 'finst_lo' to a
+    // multiplexed rpc, its tuple data goes into 'attachment' if 'by_attachment'. Adds an
+    // eos packet if 'num_rows' is 0.
+    void add_packet(PTransmitDataBatchParams* request, butil::IOBuf* attachment,
+                    int64_t finst_lo, int64_t packet_seq, int start, int num_rows,
+                    bool by_attachment) {
+        PTransmitDataParams* params = request->add_params();
+        params->mutable_finst_id()->set_hi(1);
+        params->mutable_finst_id()->set_lo(finst_lo);
+        params->set_node_id(DEST_NODE_ID);
+        params->set_sender_id(0);
+        params->set_be_number(0);
+        params->set_eos(num_rows == 0);
+        params->set_packet_seq(packet_seq);
+        butil::IOBuf tuple_data;
+        if (num_rows > 0) {
+            std::unique_ptr<RowBatch> batch = create_batch(start, num_rows);
+            batch->serialize(params->mutable_row_batch(),
+                             segment_v2::CompressionTypePB::NO_COMPRESSION,
+                             by_attachment ? &tuple_data : nullptr);
+            params->set_transfer_by_attachment(by_attachment);
+            // copied, the tuple data refers to the memory of the batch
+            attachment->append(tuple_data.to_string());
+        }
+        request->add_attachment_sizes(tuple_data.size());
+    }
+
+    // A sender to the receivers of 'finst_los' on the backend at 'port', this backend by
+    // default. Hash partitions by c0.
+    DataStreamSender* create_sender(TPartitionType::type part_type,
+                                    const std::vector<int64_t>& finst_los,
+                                    int port = config::brpc_port) {
+        TDataStreamSink stream_sink;
+        stream_sink.dest_node_id = DEST_NODE_ID;
+        stream_sink.output_partition.type = part_type;
+        if (part_type == TPartitionType::HASH_PARTITIONED) {
+            stream_sink.output_partition.__set_partition_exprs(
+                    {slot_ref(0, _tuple_desc->slots()[0]->id())});
+        }
+        std::vector<TPlanFragmentDestination> dests;
+        for (int64_t finst_lo : finst_los) {
+            TPlanFragmentDestination dest;
+            dest.fragment_instance_id.hi = 1;
+            dest.fragment_instance_id.lo = finst_lo;
+            dest.brpc_server.hostname = BackendOptions::get_localhost();
+            dest.brpc_server.port = port;
+            dests.push_back(dest);
+        }
+        DataStreamSender* sender = _obj_pool.add(
+                new DataStreamSender(&_obj_pool, 0, *_row_desc, stream_sink, dests, 1024, false));
+        TDataSink data_sink;
+        data_sink.__set_stream_sink(stream_sink);
+        EXPECT_TRUE(sender->init(data_sink).ok());
+        EXPECT_TRUE(sender->prepare(_state.get()).ok());
+        EXPECT_TRUE(sender->open(_state.get()).ok());
+        return sender;
+    }
+
+    // Checks that hash_partition_batch() puts every row into the channel, and in the order
+    // within the channel, it gets by hashing the row alone, with fnv hash for
+    // HASH_PARTITIONED and with crc32 for BUCKET_SHFFULE_HASH_PARTITIONED. The partition
+    // exprs are (c0 INT, c1 VARCHAR, c2 BIGINT) of a tuple of nullable slots, with nulls in
+    // c0 and c1.
+    void check_hash_partition(TPartitionType::type part_type) {
+        TDescriptorTableBuilder table_builder;
+        TTupleDescriptorBuilder tuple;
+        tuple.add_slot(TSlotDescriptorBuilder()
+                               .type(TYPE_INT)
+                               .nullable(true)
+                               .column_name("c0")
+                               .column_pos(0)
+                               .build());
+        tuple.add_slot(TSlotDescriptorBuilder()
+                               .string_type(64)
+                               .nullable(true)
+                               .column_name("c1")
+                               .column_pos(1)
+                               .build());
+        tuple.add_slot(TSlotDescriptorBuilder()
+                               .type(TYPE_BIGINT)
+                               .nullable(true)
+                               .column_name("c2")
+                               .column_pos(2)
+                               .build());
+        tuple.build(&table_builder);
+        DescriptorTbl* desc_tbl = nullptr;
+        ASSERT_TRUE(DescriptorTbl::create(&_obj_pool, table_builder.desc_tbl(), &desc_tbl).ok());
+        _state->set_desc_tbl(desc_tbl);
+        TupleDescriptor* tuple_desc = desc_tbl->get_tuple_descriptor(0);
+        const std::vector<SlotDescriptor*>& slots = tuple_desc->slots();
+        RowDescriptor row_desc(*desc_tbl, {0}, {false});
+
+        TDataStreamSink stream_sink;
+        stream_sink.dest_node_id = DEST_NODE_ID;
+        stream_sink.output_partition.type = part_type;
+        std::vector<TExpr> partition_exprs(3);
+        partition_exprs[0].nodes.push_back(slot_node(slots[0]->id(), TPrimitiveType::INT));
+        partition_exprs[1].nodes.push_back(slot_node(slots[1]->id(), TPrimitiveType::VARCHAR));
+        partition_exprs[2].nodes.push_back(slot_node(slots[2]->id(), TPrimitiveType::BIGINT));
+        stream_sink.output_partition.__set_partition_exprs(partition_exprs);
+        std::vector<TPlanFragmentDestination> dests(1);
+        dests[0].fragment_instance_id.hi = 1;
+        dests[0].brpc_server.hostname = BackendOptions::get_localhost();
+        dests[0].brpc_server.port = config::brpc_port;
+        DataStreamSender sender(&_obj_pool, 0, row_desc, stream_sink, dests, 1024, false);
+        TDataSink data_sink;
+        data_sink.__set_stream_sink(stream_sink);
+        ASSERT_TRUE(sender.init(data_sink).ok());
+        ASSERT_TRUE(sender.prepare(_state.get()).ok());
+        ASSERT_TRUE(sender.open(_state.get()).ok());
+
+        // rows (i % 13, "str_<i % 7>", i * 1000003), c0 is null in every 5th row and c1 in
+        // every 11th row
+        const int num_rows = 200;
+        RowBatch batch(row_desc, num_rows, _tracker.get());
+        MemPool* pool = batch.tuple_data_pool();
+        for (int i = 0; i < num_rows; ++i) {
+            int row_idx = batch.add_row();
+            Tuple* tuple = Tuple::create(tuple_desc->byte_size(), pool);
+            *reinterpret_cast<int32_t*>(tuple->get_slot(slots[0]->tuple_offset())) = i % 13;
+            std::string str = "str_" + std::to_string(i % 7);
+            char* data = reinterpret_cast<char*>(pool->allocate(str.size()));
+            memcpy(data, str.data(), str.size());
+            *tuple->get_string_slot(slots[1]->tuple_offset()) = StringValue(data, str.size());
+            *reinterpret_cast<int64_t*>(tuple->get_slot(slots[2]->tuple_offset())) =
+                    i * 1000003L;
+            if (i % 5 == 0) {
+                tuple->set_null(slots[0]->null_indicator_offset());
+            }
+            if (i % 11 == 0) {
+                tuple->set_null(slots[1]->null_indicator_offset());
+            }
+            batch.get_row(row_idx)->set_tuple(0, tuple);
+            batch.commit_last_row();
+        }
+
+        const int num_channels = 5;
+        bool use_fvn = part_type == TPartitionType::HASH_PARTITIONED;
+        std::vector<std::vector<TupleRow*>> expected(num_channels);
+        for (int i = 0; i < num_rows; ++i) {
+            TupleRow* row = batch.get_row(i);
+            uint32_t hash_val = 0;
+            for (ExprContext* ctx : sender._partition_expr_ctxs) {
+                void* value = ctx->get_value(row);
+                const TypeDescriptor& type = ctx->root()->type();
+                hash_val = use_fvn ? RawValue::get_hash_value_fvn(value, type, hash_val)
+                                   : RawValue::zlib_crc32(value, type, hash_val);
+            }
+            expected[hash_val % num_channels].push_back(row);
+        }
+
+        // twice, the second batch reuses the state of the first one
+        for (int k = 0; k < 2; ++k) {
+            sender.hash_partition_batch(&batch, num_channels, use_fvn);
+            ASSERT_EQ(num_channels + 1, static_cast<int>(sender._part_offsets.size()));
+            ASSERT_EQ(0, sender._part_offsets[0]);
+            ASSERT_EQ(num_rows, sender._part_offsets[num_channels]);
+            for (int c = 0; c < num_channels; ++c) {
+                // every channel gets rows, or the check proves little
+                ASSERT_FALSE(expected[c].empty()) << "channel " << c;
+                std::vector<TupleRow*> rows(
+                        sender._part_rows.begin() + sender._part_offsets[c],
+                        sender._part_rows.begin() + sender._part_offsets[c + 1]);
+                ASSERT_EQ(expected[c], rows) << "channel " << c;
+            }
+        }
+        Expr::close(sender._partition_expr_ctxs, _state.get());
+        _state->set_desc_tbl(_desc_tbl);
+    }
+
+    static const PlanNodeId DEST_NODE_ID = 1;
+
+    int32_t _max_in_flight_rpcs;
+    int32_t _merge_fan_in;
+    bool _local_exchange;
+    std::string _localhost;
+    TestEnv _test_env;
+    DataStreamMgr _stream_mgr;
+    BrpcStubCache _stub_cache;
+    std::unique_ptr<RuntimeState> _state;
+    ObjectPool _obj_pool;
+    RuntimeProfile _profile;
+    std::shared_ptr<MemTracker> _tracker;
+    DescriptorTbl* _desc_tbl = nullptr;
+    TupleDescriptor* _tuple_desc = nullptr;
+    std::unique_ptr<RowDescriptor> _row_desc;
+    HoldingBackendService* _service = nullptr;
+    std::unique_ptr<brpc::Server> _server;
+    SortExecExprs _sort_exprs;
+    bool _sort_exprs_opened = false;
+};
+
+TEST_F(DataStreamRecvrTest, local_batch_transfer) {
+    boost::shared_ptr<DataStreamRecvr> recvr = create_recvr(1024 * 1024);
+    std::unique_ptr<RowBatch> batch = create_batch(0, 10);
+    Tuple* first_tuple = batch->get_row(0)->get_tuple(0);
+    CountingClosure closure;
+    google::protobuf::Closure* done = &closure;
+    ASSERT_LT(0, recvr->add_local_batch(batch.get(), 0, 0, true, &done));
+    // the buffer is not full, the caller acks the batch
+    ASSERT_EQ(&closure, done);
+    // the rows and their memory are moved, not copied
+    ASSERT_EQ(0, batch->tuple_data_pool()->total_allocated_bytes());
+    batch->reset();
+    ASSERT_NE(RowBatch::INVALID_ROW_INDEX, batch->add_row());
+
+    RowBatch* received = nullptr;
+    ASSERT_TRUE(recvr->get_batch(&received).ok());
+    check_batch(received, 0, 10);
+    ASSERT_EQ(first_tuple, received->get_row(0)->get_tuple(0));
+    recvr->close();
+}
+
+TEST_F(DataStreamRecvrTest, local_batch_copy) {
+    boost::shared_ptr<DataStreamRecvr> recvr = create_recvr(1024 * 1024);
+    std::unique_ptr<RowBatch> batch = create_batch(0, 10);
+    google::protobuf::Closure* done = nullptr;
+    ASSERT_LT(0, recvr->add_local_batch(batch.get(), 0, 0, false, &done));
+    // the batch of the caller is left as it is
+    check_batch(batch.get(), 0, 10);
+
+    RowBatch* received = nullptr;
+    ASSERT_TRUE(recvr->get_batch(&received).ok());
+    check_batch(received, 0, 10);
+    ASSERT_NE(batch->get_row(0)->get_tuple(0), received->get_row(0)->get_tuple(0));
+    recvr->close();
+}
+
+TEST_F(DataStreamRecvrTest, local_batch_delays_ack) {
+    boost::shared_ptr<DataStreamRecvr> recvr = create_recvr(1);
+    CountingClosure closure1;
+    CountingClosure closure2;
+    google::protobuf::Closure* done1 = &closure1;
+    google::protobuf::Closure* done2 = &closure2;
+    // the buffer is full, but the batches are taken without waiting, their acks wait
+    recvr->add_local_batch(create_batch(0, 10).get(), 0, 0, true, &done1);
+    recvr->add_local_batch(create_batch(10, 10).get(), 0, 0, false, &done2);
+    ASSERT_EQ(nullptr, done1);
+    ASSERT_EQ(nullptr, done2);
+    ASSERT_EQ(0, closure1.num_runs);
+
+    // each batch fetched acks one batch
+    RowBatch* received = nullptr;
+    ASSERT_TRUE(recvr->get_batch(&received).ok());
+    check_batch(received, 0, 10);
+    ASSERT_EQ(1, closure1.num_runs);
+    ASSERT_EQ(0, closure2.num_runs);
+
+    // a cancelled receiver acks the rest and drops the batches that come later
+    recvr->cancel_stream();
+    ASSERT_EQ(1, closure2.num_runs);
+    CountingClosure closure3;
+    google::protobuf::Closure* done3 = &closure3;
+    ASSERT_EQ(0, recvr->add_local_batch(create_batch(20, 10).get(), 0, 0, true, &done3));
+    ASSERT_EQ(&closure3, done3);
+    recvr->close();
+}
+
+TEST_F(DataStreamRecvrTest, local_sender) {
+    config::enable_local_exchange = true;
+    boost::shared_ptr<DataStreamRecvr> recvr = create_recvr(1);
+    DataStreamSender* sender = create_sender(TPartitionType::UNPARTITIONED, {0});
+
+    std::unique_ptr<RowBatch> batch = create_batch(0, 10);
+    ASSERT_TRUE(sender->send(_state.get(), batch.get()).ok());
+    // passed in memory, there is no brpc server
+    ASSERT_LT(0, sender->_bytes_sent_counter->value());
+    ASSERT_EQ(recvr->_bytes_received_counter->value(), sender->_bytes_sent_counter->value());
+    // the receiver's buffer is full, the sender must wait for the ack before the next batch
+    ASSERT_FALSE(sender->can_send());
+
+    RowBatch* received = nullptr;
+    ASSERT_TRUE(recvr->get_batch(&received).ok());
+    check_batch(received, 0, 10);
+    ASSERT_TRUE(sender->can_send());
+
+    batch = create_batch(10, 10);
+    ASSERT_TRUE(sender->send(_state.get(), batch.get()).ok());
+    // eos does not wait for the ack
+    ASSERT_TRUE(sender->close(_state.get(), Status::OK()).ok());
+    ASSERT_TRUE(recvr->get_batch(&received).ok());
+    check_batch(received, 10, 10);
+    ASSERT_TRUE(recvr->get_batch(&received).ok());
+    ASSERT_EQ(nullptr, received);
+    recvr->close();
+}
+
+TEST_F(DataStreamRecvrTest, local_sender_hash_partitioned) {
+    config::enable_local_exchange = true;
+    std::vector<boost::shared_ptr<DataStreamRecvr>> recvrs = {create_recvr(1024 * 1024, 0),
+                                                              create_recvr(1024 * 1024, 1)};
+    DataStreamSender* sender = create_sender(TPartitionType::HASH_PARTITIONED, {0, 1});
+
+    std::unique_ptr<RowBatch> batch = create_batch(0, 10);
+    ASSERT_TRUE(sender->send(_state.get(), batch.get()).ok());
+    // the channels buffer the rows until they are closed
+    ASSERT_EQ(0, sender->_bytes_sent_counter->value());
+    ASSERT_TRUE(sender->close(_state.get(), Status::OK()).ok());
+
+    std::vector<int> values;
+    for (auto& recvr : recvrs) {
+        RowBatch* received = nullptr;
+        ASSERT_TRUE(recvr->get_batch(&received).ok());
+        if (received != nullptr) {
+            // moved from the batch of the channel, a copy would be sized to its rows
+            ASSERT_GT(received->capacity(), received->num_rows());
+            for (int i = 0; i < received->num_rows(); ++i) {
+                Tuple* tuple = received->get_row(i)->get_tuple(0);
+                values.push_back(*reinterpret_cast<int32_t*>(tuple->get_slot(int_offset())));
+            }
+            ASSERT_TRUE(recvr->get_batch(&received).ok());
+        }
+        ASSERT_EQ(nullptr, received);
+        recvr->close();
+    }
+    std::sort(values.begin(), values.end());
+    ASSERT_EQ(std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}), values);
+}
+
+TEST_F(DataStreamRecvrTest, hash_partition_batch) {
+    check_hash_partition(TPartitionType::HASH_PARTITIONED);
+}
+
+TEST_F(DataStreamRecvrTest, bucket_shuffle_partition_batch) {
+    check_hash_partition(TPartitionType::BUCKET_SHFFULE_HASH_PARTITIONED);
+}
+
+TEST_F(DataStreamRecvrTest, packets_out_of_order) {
+    boost::shared_ptr<DataStreamRecvr> recvr = create_recvr(1024 * 1024);
+    PRowBatch pb_batches[3];
+    for (int i = 0; i < 3; ++i) {
+        create_pb_batch(i * 10, 10, &pb_batches[i]);
+    }
+    // held back until the packets sent before it arrived
+    ASSERT_TRUE(recvr->add_batch(pb_batches[2], nullptr, 0, 0, 2, nullptr).ok());
+    ASSERT_TRUE(recvr->add_batch(pb_batches[0], nullptr, 0, 0, 0, nullptr).ok());
+    // a packet received twice is dropped, whether it was held back or queued
+    ASSERT_TRUE(recvr->add_batch(pb_batches[2], nullptr, 0, 0, 2, nullptr).ok());
+    ASSERT_TRUE(recvr->add_batch(pb_batches[0], nullptr, 0, 0, 0, nullptr).ok());
+    ASSERT_TRUE(recvr->add_batch(pb_batches[1], nullptr, 0, 0, 1, nullptr).ok());
+    recvr->remove_sender(0, 0);
+
+    RowBatch* received = nullptr;
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(recvr->get_batch(&received).ok());
+        check_batch(received, i * 10, 10);
+    }
+    ASSERT_TRUE(recvr->get_batch(&received).ok());
+    ASSERT_EQ(nullptr, received);
+    recvr->close();
+}
+
+TEST_F(DataStreamRecvrTest, packets_out_of_order_per_sender) {
+    TUniqueId finst_id;
+    finst_id.hi = 1;
+    finst_id.lo = 0;
+    boost::shared_ptr<DataStreamRecvr> recvr = _stream_mgr.create_recvr(
+            _state.get(), *_row_desc, finst_id, DEST_NODE_ID, 2, 1024 * 1024, &_profile, false,
+            nullptr);
+    PRowBatch pb_batches[3];
+    for (int i = 0; i < 3; ++i) {
+        create_pb_batch(i * 10, 10, &pb_batches[i]);
+    }
+    // the packets of each sender are numbered on their own
+    ASSERT_TRUE(recvr->add_batch(pb_batches[1], nullptr, 0, 1, 1, nullptr).ok());
+    ASSERT_TRUE(recvr->add_batch(pb_batches[2], nullptr, 0, 2, 0, nullptr).ok());
+    RowBatch* received = nullptr;
+    ASSERT_TRUE(recvr->get_batch(&received).ok());
+    check_batch(received, 20, 10);
+    ASSERT_TRUE(recvr->add_batch(pb_batches[0], nullptr, 0, 1, 0, nullptr).ok());
+    ASSERT_TRUE(recvr->get_batch(&received).ok());
+    check_batch(received, 0, 10);
+    ASSERT_TRUE(recvr->get_batch(&received).ok());
+    check_batch(received, 10, 10);
+    recvr->close();
+}
+
+TEST_F(DataStreamRecvrTest, in_flight_rpcs_out_of_order) {
+    config::exchange_max_in_flight_rpcs = 2;
+    start_server();
+    boost::shared_ptr<DataStreamRecvr> recvr = create_recvr(1024 * 1024);
+    DataStreamSender* sender = create_sender(TPartitionType::UNPARTITIONED, {0}, TEST_PORT);
+
+    std::unique_ptr<RowBatch> batch = create_batch(0, 10);
+    ASSERT_TRUE(sender->send(_state.get(), batch.get()).ok());
+    ASSERT_TRUE(sender->can_send());
+    batch = create_batch(10, 10);
+    ASSERT_TRUE(sender->send(_state.get(), batch.get()).ok());
+    // the window of in flight rpcs is full
+    ASSERT_FALSE(sender->can_send());
+    wait_rpcs(2);
+
+    // the second packet overtakes the first one, the sender keeps waiting for the first
+    ASSERT_TRUE(_service->deliver(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ASSERT_FALSE(sender->can_send());
+    ASSERT_TRUE(_service->deliver(0));
+    wait_can_send(sender);
+
+    _service->set_hold(false);
+    ASSERT_TRUE(sender->close(_state.get(), Status::OK()).ok());
+    RowBatch* received = nullptr;
+    ASSERT_TRUE(recvr->get_batch(&received).ok());
+    check_batch(received, 0, 10);
+    ASSERT_TRUE(recvr->get_batch(&received).ok());
+    check_batch(received, 10, 10);
+    ASSERT_TRUE(recvr->get_batch(&received).ok());
+    ASSERT_EQ(nullptr, received);
+    recvr->close();
+}
+
+TEST_F(DataStreamRecvrTest, credit_window) {
+    config::exchange_max_in_flight_rpcs = 1;
+    start_server();
+    // the buffer takes less than a batch, the receiver defers the ack of every batch
+    boost::shared_ptr<DataStreamRecvr> recvr = create_recvr(1);
+    DataStreamSender* sender = create_sender(TPartitionType::UNPARTITIONED, {0}, TEST_PORT);
+
+    std::unique_ptr<RowBatch> batch = create_batch(0, 10);
+    ASSERT_TRUE(sender->send(_state.get(), batch.get()).ok());
+    wait_rpcs(1);
+    // the ack is deferred until the batch is taken
+    ASSERT_TRUE(_service->deliver(0));
+    RowBatch* received = nullptr;
+    ASSERT_TRUE(recvr->get_batch(&received).ok());
+    check_batch(received, 0, 10);
+
+    // waits for the ack of the first batch, which grants no credit
+    batch = create_batch(10, 10);
+    ASSERT_TRUE(sender->send(_state.get(), batch.get()).ok());
+    wait_rpcs(2);
+    // the second rpc in flight would be within the limit, but not within the credit
+    config::exchange_max_in_flight_rpcs = 4;
+    ASSERT_FALSE(sender->can_send());
+    ASSERT_TRUE(_service->deliver(1));
+    ASSERT_TRUE(recvr->get_batch(&received).ok());
+    check_batch(received, 10, 10);
+    wait_can_send(sender);
+
+    _service->set_hold(false);
+    ASSERT_TRUE(sender->close(_state.get(), Status::OK()).ok());
+    ASSERT_TRUE(recvr->get_batch(&received).ok());
+    ASSERT_EQ(nullptr, received);
+    recvr->close();
+}
+
+TEST_F(DataStreamRecvrTest, eos_waits_for_in_flight_rpcs) {
+    config::exchange_max_in_flight_rpcs = 2;
+    start_server();
+    boost::shared_ptr<DataStreamRecvr> recvr = create_recvr(1024 * 1024);
+    DataStreamSender* sender = create_sender(TPartitionType::UNPARTITIONED, {0}, TEST_PORT);
+
+    std::unique_ptr<RowBatch> batch = create_batch(0, 10);
+    ASSERT_TRUE(sender->send(_state.get(), batch.get()).ok());
+    wait_rpcs(1);
+    Status close_status = Status::InternalError("not closed");
+    std::thread closer([&]() { close_status = sender->close(_state.get(), Status::OK()); });
+    // the receiver removes the sender on eos, so eos must not overtake the batch
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(1, _service->num_rpcs());
+    EXPECT_TRUE(_service->deliver(0));
+    wait_rpcs(2);
+    EXPECT_TRUE(_service->deliver(1));
+    // responds to the eos if it was not delivered, so the closer does not hang
+    _service->set_hold(false);
+    _service->release();
+    closer.join();
+    ASSERT_TRUE(close_status.ok());
+
+    RowBatch* received = nullptr;
+    ASSERT_TRUE(recvr->get_batch(&received).ok());
+    check_batch(received, 0, 10);
+    ASSERT_TRUE(recvr->get_batch(&received).ok());
+    ASSERT_EQ(nullptr, received);
+    recvr->close();
+}
+
+TEST_F(DataStreamRecvrTest, merge_groups) {
+    config::exchange_merge_fan_in = 2;
+    boost::shared_ptr<DataStreamRecvr> recvr = create_merging_recvr(7);
+    // the senders send while the groups merge
+    std::thread feeder([&]() {
+        for (int b = 0; b < 4; ++b) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            for (int sender = 0; sender < 7; ++sender) {
+                std::unique_ptr<RowBatch> batch = create_batch(sender + b * 70, 10, 7);
+                google::protobuf::Closure* done = nullptr;
+                recvr->add_local_batch(batch.get(), sender, 0, false, &done);
+            }
+        }
+        for (int sender = 0; sender < 7; ++sender) {
+            recvr->remove_sender(sender, 0);
+        }
+    });
+    ASSERT_TRUE(create_merger(recvr.get()).ok());
+    // groups of 2, 2, 2 and 1 senders
+    ASSERT_EQ(4, recvr->_merge_groups.size());
+    std::vector<int> values;
+    ASSERT_TRUE(get_merged_values(recvr.get(), &values).ok());
+    feeder.join();
+    ASSERT_EQ(280, values.size());
+    for (int i = 0; i < values.size(); ++i) {
+        ASSERT_EQ(i, values[i]);
+    }
+    recvr->close();
+}
+
+TEST_F(DataStreamRecvrTest, merge_groups_without_pool) {
+    config::exchange_merge_fan_in = 2;
+    _stream_mgr._merge_thread_pool.reset();
+    boost::shared_ptr<DataStreamRecvr> recvr = create_merging_recvr(5);
+    send_sorted_batches(recvr.get(), 5, 3, true);
+    // the receiver merges every group itself
+    ASSERT_TRUE(create_merger(recvr.get()).ok());
+    ASSERT_EQ(3, recvr->_merge_groups.size());
+    std::vector<int> values;
+    ASSERT_TRUE(get_merged_values(recvr.get(), &values).ok());
+    ASSERT_EQ(150, values.size());
+    for (int i = 0; i < values.size(); ++i) {
+        ASSERT_EQ(i, values[i]);
+    }
+    recvr->close();
+}
+
+TEST_F(DataStreamRecvrTest, merge_groups_on_busy_pool) {
+    config::exchange_merge_fan_in = 2;
+    ASSERT_TRUE(ThreadPoolBuilder("busy")
+                        .set_min_threads(1)
+                        .set_max_threads(1)
+                        .build(&_stream_mgr._merge_thread_pool)
+                        .ok());
+    // the only thread of the pool is busy until the query finished
+    std::atomic<bool> busy(true);
+    ASSERT_TRUE(_stream_mgr._merge_thread_pool
+                        ->submit_func([&busy]() {
+                            while (busy) {
+                                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                            }
+                        })
+                        .ok());
+    boost::shared_ptr<DataStreamRecvr> recvr = create_merging_recvr(6);
+    send_sorted_batches(recvr.get(), 6, 2, true);
+    ASSERT_TRUE(create_merger(recvr.get()).ok());
+    std::vector<int> values;
+    ASSERT_TRUE(get_merged_values(recvr.get(), &values).ok());
+    ASSERT_EQ(120, values.size());
+    for (int i = 0; i < values.size(); ++i) {
+        ASSERT_EQ(i, values[i]);
+    }
+    recvr->close();
+    recvr.reset();
+    // the tasks of the groups run after the groups were closed, and do nothing
+    busy = false;
+    ASSERT_TRUE(_stream_mgr._merge_thread_pool->wait_for(MonoDelta::FromSeconds(5)));
+}
+
+TEST_F(DataStreamRecvrTest, merge_group_error) {
+    config::exchange_merge_fan_in = 2;
+    boost::shared_ptr<DataStreamRecvr> recvr = create_merging_recvr(4);
+    // group 0 has senders 0 and 2 and finishes, group 1 has senders 1 and 3 and fails
+    // because sender 3 never ends its stream
+    send_sorted_batches(recvr.get(), 4, 1, false);
+    recvr->remove_sender(0, 0);
+    recvr->remove_sender(1, 0);
+    recvr->remove_sender(2, 0);
+
+    Status status;
+    std::vector<int> values;
+    std::thread consumer([&]() {
+        status = create_merger(recvr.get());
+        if (status.ok()) {
+            status = get_merged_values(recvr.get(), &values);
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    recvr->cancel_stream();
+    consumer.join();
+    ASSERT_TRUE(status.is_cancelled()) << status.get_error_msg();
+    // what was merged before is in order
+    ASSERT_LT(values.size(), 40);
+    for (int i = 0; i < values.size(); ++i) {
+        ASSERT_EQ(i, values[i]);
+    }
+    recvr->close();
+}
+
+TEST_F(DataStreamRecvrTest, cancel_while_groups_wait) {
+    config::exchange_merge_fan_in = 2;
+    boost::shared_ptr<DataStreamRecvr> recvr = create_merging_recvr(6);
+    // no sender sends anything, the groups and the merger wait on the sender queues
+    Status status;
+    std::thread consumer([&]() { status = create_merger(recvr.get()); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    TUniqueId finst_id;
+    finst_id.hi = 1;
+    finst_id.lo = 0;
+    _stream_mgr.cancel(finst_id);
+    consumer.join();
+    ASSERT_TRUE(status.is_cancelled()) << status.get_error_msg();
+    recvr->close();
+    ASSERT_TRUE(_stream_mgr._merge_thread_pool->wait_for(MonoDelta::FromSeconds(5)));
+}
+
+TEST_F(DataStreamRecvrTest, close_while_groups_wait) {
+    config::exchange_merge_fan_in = 2;
+    boost::shared_ptr<DataStreamRecvr> recvr = create_merging_recvr(6);
+    // the senders do not end their streams
+    send_sorted_batches(recvr.get(), 6, 1, false);
+    ASSERT_TRUE(create_merger(recvr.get()).ok());
+    RowBatch batch(*_row_desc, 16, _tracker.get());
+    bool eos = false;
+    ASSERT_TRUE(recvr->get_next(&batch, &eos).ok());
+    ASSERT_FALSE(eos);
+    ASSERT_EQ(16, batch.num_rows());
+    // e.g. a limit was reached, the receiver is closed while the groups wait for more rows
+    recvr->close();
+    ASSERT_TRUE(_stream_mgr._merge_thread_pool->wait_for(MonoDelta::FromSeconds(5)));
+}
+
+TEST_F(DataStreamRecvrTest, transmit_data_batch) {
+    // receiver 0 is full once it holds a batch
+    boost::shared_ptr<DataStreamRecvr> recvr0 = create_recvr(1, 0);
+    boost::shared_ptr<DataStreamRecvr> recvr1 = create_recvr(1024 * 1024, 1);
+    PTransmitDataBatchParams request;
+    butil::IOBuf attachment;
+    add_packet(&request, &attachment, 0, 0, 0, 10, true);
+    add_packet(&request, &attachment, 1, 0, 10, 10, false);
+    PTransmitDataBatchResult response;
+    ASSERT_TRUE(_stream_mgr.transmit_data_batch(&request, &attachment, &response).ok());
+    ASSERT_EQ(2, response.results_size());
+    for (const PTransmitDataResult& result : response.results()) {
+        ASSERT_FALSE(result.resend());
+        ASSERT_FALSE(result.has_status());
+        ASSERT_TRUE(result.has_credit_bytes());
+    }
+
+    // the packet to the full receiver is refused, the eos to the other one is taken
+    request.Clear();
+    attachment.clear();
+    add_packet(&request, &attachment, 0, 1, 20, 10, true);
+    add_packet(&request, &attachment, 1, 1, 0, 0, false);
+    response.Clear();
+    ASSERT_TRUE(_stream_mgr.transmit_data_batch(&request, &attachment, &response).ok());
+    ASSERT_EQ(2, response.results_size());
+    ASSERT_TRUE(response.results(0).resend());
+    ASSERT_FALSE(response.results(1).resend());
+
+    RowBatch* received = nullptr;
+    ASSERT_TRUE(recvr1->get_batch(&received).ok());
+    check_batch(received, 10, 10);
+    ASSERT_TRUE(recvr1->get_batch(&received).ok());
+    ASSERT_EQ(nullptr, received);
+
+    // resent on its own, the packet is taken and its ack waits for the receiver
+    CountingClosure closure;
+    google::protobuf::Closure* done = &closure;
+    butil::IOBuf packet_attachment = attachment;
+    PTransmitDataResult result;
+    ASSERT_TRUE(_stream_mgr
+                        .transmit_data(&request.params(0), &packet_attachment, &result, &done)
+                        .ok());
+    ASSERT_EQ(nullptr, done);
+    ASSERT_TRUE(recvr0->get_batch(&received).ok());
+    check_batch(received, 0, 10);
+    ASSERT_EQ(1, closure.num_runs);
+    ASSERT_TRUE(recvr0->get_batch(&received).ok());
+    check_batch(received, 20, 10);
+    recvr0->close();
+    recvr1->close();
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
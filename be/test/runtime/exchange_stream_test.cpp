@@ -0,0 +1,252 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "runtime/exchange_stream.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+
+#include "service/brpc.h"
+#include "util/brpc_stub_cache.h"
+#include "util/debug/leakcheck_disabler.h"
+
+namespace doris {
+
+static const int TEST_PORT = 4360;
+
+// Records the packets of each transmit_data_batch rpc. Holds back the response of the
+// first rpc until release() if 'hold_first'. Asks for the packets in 'resend_seqs' to be
+// resent, and holds back the responses to the transmit_data rpcs resending them until
+// release().
+class TestExchangeService : public PBackendService {
+public:
+    void transmit_data(google::protobuf::RpcController* controller,
+                       const PTransmitDataParams* request, PTransmitDataResult* response,
+                       google::protobuf::Closure* done) override {
+        brpc::Controller* cntl = static_cast<brpc::Controller*>(controller);
+        response->set_credit_bytes(100 + request->packet_seq());
+        std::lock_guard<std::mutex> l(_lock);
+        resent.push_back(std::to_string(request->packet_seq()) + ":" +
+                         cntl->request_attachment().to_string());
+        _held_resent.push_back(done);
+    }
+
+    void transmit_data_batch(google::protobuf::RpcController* controller,
+                             const PTransmitDataBatchParams* request,
+                             PTransmitDataBatchResult* response,
+                             google::protobuf::Closure* done) override {
+        brpc::Controller* cntl = static_cast<brpc::Controller*>(controller);
+        butil::IOBuf attachment = cntl->request_attachment();
+        std::vector<std::string> packets;
+        for (int i = 0; i < request->params_size(); ++i) {
+            butil::IOBuf packet_attachment;
+            attachment.cutn(&packet_attachment, request->attachment_sizes(i));
+            packets.push_back(std::to_string(request->params(i).packet_seq()) + ":" +
+                              packet_attachment.to_string());
+            PTransmitDataResult* result = response->add_results();
+            if (resend_seqs.count(request->params(i).packet_seq()) > 0) {
+                result->set_resend(true);
+            } else {
+                result->set_credit_bytes(request->params(i).packet_seq());
+            }
+        }
+        std::lock_guard<std::mutex> l(_lock);
+        rpcs.push_back(packets);
+        if (hold_first && rpcs.size() == 1) {
+            _held = done;
+            return;
+        }
+        done->Run();
+    }
+
+    void release() {
+        std::vector<google::protobuf::Closure*> held;
+        {
+            std::lock_guard<std::mutex> l(_lock);
+            held.swap(_held_resent);
+            if (_held != nullptr) {
+                held.push_back(_held);
+                _held = nullptr;
+            }
+        }
+        for (google::protobuf::Closure* done : held) {
+            done->Run();
+        }
+    }
+
+    std::vector<std::vector<std::string>> get_rpcs() {
+        std::lock_guard<std::mutex> l(_lock);
+        return rpcs;
+    }
+
+    std::vector<std::string> get_resent() {
+        std::lock_guard<std::mutex> l(_lock);
+        return resent;
+    }
+
+    bool hold_first = false;
+    std::set<int64_t> resend_seqs;
+    std::vector<std::vector<std::string>> rpcs;
+    std::vector<std::string> resent;
+
+private:
+    std::mutex _lock;
+    google::protobuf::Closure* _held = nullptr;
+    std::vector<google::protobuf::Closure*> _held_resent;
+};
+
+class ExchangeStreamTest : public testing::Test {
+protected:
+    void SetUp() override {
+        _service = new TestExchangeService();
+        _server.reset(new brpc::Server());
+        ASSERT_EQ(0, _server->AddService(_service, brpc::SERVER_OWNS_SERVICE));
+        brpc::ServerOptions options;
+        {
+            debug::ScopedLeakCheckDisabler disable_lsan;
+            ASSERT_EQ(0, _server->Start(TEST_PORT, &options));
+        }
+        _stream = std::make_shared<ExchangeStream>(_stub_cache.get_stub("127.0.0.1", TEST_PORT),
+                                                   10000);
+    }
+
+    void TearDown() override {
+        _service->release();
+        _server->Stop(100);
+        _server->Join();
+    }
+
+    std::shared_ptr<ExchangePacket> send(int64_t packet_seq, const std::string& tuple_data) {
+        PTransmitDataParams request;
+        request.mutable_finst_id()->set_hi(1);
+        request.mutable_finst_id()->set_lo(packet_seq);
+        request.set_node_id(1);
+        request.set_sender_id(0);
+        request.set_be_number(0);
+        request.set_eos(false);
+        request.set_packet_seq(packet_seq);
+        if (tuple_data.empty()) {
+            return _stream->send(request, nullptr);
+        }
+        butil::IOBuf attachment;
+        attachment.append(tuple_data);
+        request.set_transfer_by_attachment(true);
+        return _stream->send(request, &attachment);
+    }
+
+    // waits until the service got 'num_rpcs' rpcs
+    void wait_rpcs(int num_rpcs) {
+        for (int i = 0; i < 1000 && _service->get_rpcs().size() < num_rpcs; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        ASSERT_EQ(num_rpcs, _service->get_rpcs().size());
+    }
+
+    TestExchangeService* _service = nullptr;
+    std::unique_ptr<brpc::Server> _server;
+    BrpcStubCache _stub_cache;
+    std::shared_ptr<ExchangeStream> _stream;
+};
+
+TEST_F(ExchangeStreamTest, batch_while_in_flight) {
+    _service->hold_first = true;
+    auto first = send(0, "a");
+    wait_rpcs(1);
+    // queued while the first rpc is in flight, sent together once it finished
+    auto second = send(1, "bc");
+    auto third = send(2, "");
+    auto fourth = send(3, "def");
+    ASSERT_FALSE(second->is_done());
+    _service->release();
+
+    _stream->wait(fourth.get());
+    _stream->wait(first.get());
+    auto rpcs = _service->get_rpcs();
+    ASSERT_EQ(2, rpcs.size());
+    ASSERT_EQ(std::vector<std::string>({"0:a"}), rpcs[0]);
+    ASSERT_EQ(std::vector<std::string>({"1:bc", "2:", "3:def"}), rpcs[1]);
+    std::shared_ptr<ExchangePacket> packets[] = {first, second, third, fourth};
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(packets[i]->is_done());
+        ASSERT_TRUE(packets[i]->status().ok());
+        ASSERT_EQ(i, packets[i]->result().credit_bytes());
+    }
+}
+
+TEST_F(ExchangeStreamTest, wait_sends_queued) {
+    _service->hold_first = true;
+    auto first = send(0, "a");
+    wait_rpcs(1);
+    auto second = send(1, "b");
+    // waiting on a queued packet must not wait for the held rpc
+    _stream->wait(second.get());
+    ASSERT_TRUE(second->status().ok());
+    ASSERT_FALSE(first->is_done());
+    ASSERT_EQ(2, _service->get_rpcs().size());
+    _service->release();
+    _stream->wait(first.get());
+    ASSERT_TRUE(first->status().ok());
+}
+
+TEST_F(ExchangeStreamTest, resend_refused_packet) {
+    _service->hold_first = true;
+    auto first = send(0, "a");
+    wait_rpcs(1);
+    _service->resend_seqs = {1};
+    auto second = send(1, "bc");
+    auto third = send(2, "d");
+    _service->release();
+
+    // the packet refused by its receiver does not hold back the other one
+    _stream->wait(third.get());
+    ASSERT_TRUE(third->status().ok());
+    ASSERT_EQ(2, third->result().credit_bytes());
+    for (int i = 0; i < 1000 && _service->get_resent().empty(); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    ASSERT_EQ(std::vector<std::string>({"1:bc"}), _service->get_resent());
+    // the response to the resent packet is held back
+    ASSERT_FALSE(second->is_done());
+    _service->release();
+    _stream->wait(second.get());
+    ASSERT_TRUE(second->status().ok());
+    ASSERT_EQ(101, second->result().credit_bytes());
+    ASSERT_EQ(2, _service->get_rpcs().size());
+}
+
+TEST_F(ExchangeStreamTest, rpc_failed) {
+    auto packet = send(0, "a");
+    _stream->wait(packet.get());
+    ASSERT_TRUE(packet->status().ok());
+
+    _server->Stop(100);
+    _server->Join();
+    packet = send(1, "b");
+    _stream->wait(packet.get());
+    ASSERT_FALSE(packet->status().ok());
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,254 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "runtime/pipeline_scheduler.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "util/countdown_latch.h"
+
+namespace doris {
+
+// Runs 'num_steps' steps, each of them only once 'input' has reached the step number.
+class CountingTask : public PipelineTask {
+public:
+    CountingTask(int num_steps, std::atomic<int>* input, CountDownLatch* finished)
+            : _num_steps(num_steps), _input(input), _finished(finished) {}
+
+    bool is_ready() override {
+        return _cancelled || _input == nullptr || _input->load() > _steps;
+    }
+
+    void execute_step(bool* done) override {
+        ++_steps;
+        *done = _cancelled || _steps.load() == _num_steps;
+        if (*done) {
+            _finished->count_down();
+        }
+    }
+
+    void cancel() override { _cancelled = true; }
+
+    int steps() const { return _steps.load(); }
+    bool cancelled() const { return _cancelled.load(); }
+
+private:
+    int _num_steps;
+    std::atomic<int> _steps {0};
+    std::atomic<bool> _cancelled {false};
+    std::atomic<int>* _input;
+    CountDownLatch* _finished;
+};
+
+// Waits inside a BlockingScope until 'flag' is set, like a fragment waiting on an exchange.
+// Counts the tasks blocked at the same time in 'num_blocked'.
+class BlockingTask : public PipelineTask {
+public:
+    BlockingTask(std::atomic<bool>* flag, CountDownLatch* finished,
+                 std::atomic<int>* num_blocked = nullptr)
+            : _flag(flag), _finished(finished), _num_blocked(num_blocked) {}
+
+    bool is_ready() override { return true; }
+
+    void execute_step(bool* done) override {
+        PipelineScheduler::BlockingScope blocking;
+        if (_num_blocked != nullptr) {
+            ++*_num_blocked;
+        }
+        while (!_flag->load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if (_num_blocked != nullptr) {
+            --*_num_blocked;
+        }
+        *done = true;
+        _finished->count_down();
+    }
+
+    void cancel() override {}
+
+private:
+    std::atomic<bool>* _flag;
+    CountDownLatch* _finished;
+    std::atomic<int>* _num_blocked;
+};
+
+// Sets 'flag' in its only step.
+class SettingTask : public PipelineTask {
+public:
+    SettingTask(std::atomic<bool>* flag, CountDownLatch* finished)
+            : _flag(flag), _finished(finished) {}
+
+    bool is_ready() override { return true; }
+
+    void execute_step(bool* done) override {
+        _flag->store(true);
+        *done = true;
+        _finished->count_down();
+    }
+
+    void cancel() override {}
+
+private:
+    std::atomic<bool>* _flag;
+    CountDownLatch* _finished;
+};
+
+// Records in its only step whether it runs on a worker thread.
+class CheckingTask : public PipelineTask {
+public:
+    CheckingTask(std::atomic<bool>* is_worker, CountDownLatch* finished)
+            : _is_worker(is_worker), _finished(finished) {}
+
+    bool is_ready() override { return true; }
+
+    void execute_step(bool* done) override {
+        _is_worker->store(PipelineScheduler::is_worker_thread());
+        *done = true;
+        _finished->count_down();
+    }
+
+    void cancel() override {}
+
+private:
+    std::atomic<bool>* _is_worker;
+    CountDownLatch* _finished;
+};
+
+TEST(PipelineSchedulerTest, ready_tasks) {
+    PipelineScheduler scheduler(2, 4);
+    ASSERT_TRUE(scheduler.start().ok());
+
+    CountDownLatch finished(8);
+    std::vector<std::shared_ptr<CountingTask>> tasks;
+    for (int i = 0; i < 8; ++i) {
+        tasks.emplace_back(new CountingTask(100, nullptr, &finished));
+        ASSERT_TRUE(scheduler.submit(tasks.back()).ok());
+    }
+    ASSERT_TRUE(finished.wait_for(MonoDelta::FromSeconds(10)));
+    for (auto& task : tasks) {
+        ASSERT_EQ(100, task->steps());
+    }
+    scheduler.shutdown();
+}
+
+TEST(PipelineSchedulerTest, blocked_tasks) {
+    PipelineScheduler scheduler(1, 4);
+    ASSERT_TRUE(scheduler.start().ok());
+
+    std::atomic<int> input(0);
+    CountDownLatch finished(1);
+    std::shared_ptr<CountingTask> task(new CountingTask(10, &input, &finished));
+    ASSERT_TRUE(scheduler.submit(task).ok());
+
+    // the task is parked until its input arrives and the scheduler is notified
+    for (int i = 1; i <= 10; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        ASSERT_EQ(i - 1, task->steps());
+        input.store(i);
+        PipelineScheduler::notify_blocked_tasks();
+    }
+    ASSERT_TRUE(finished.wait_for(MonoDelta::FromSeconds(10)));
+    ASSERT_EQ(10, task->steps());
+    scheduler.shutdown();
+}
+
+TEST(PipelineSchedulerTest, blocking_scope) {
+    // the only worker blocks on a task queued behind it, an extra worker must run it
+    PipelineScheduler scheduler(1, 2);
+    ASSERT_TRUE(scheduler.start().ok());
+
+    std::atomic<bool> flag(false);
+    CountDownLatch finished(2);
+    ASSERT_TRUE(scheduler.submit(std::make_shared<BlockingTask>(&flag, &finished)).ok());
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ASSERT_TRUE(scheduler.submit(std::make_shared<SettingTask>(&flag, &finished)).ok());
+    ASSERT_TRUE(finished.wait_for(MonoDelta::FromSeconds(10)));
+    scheduler.shutdown();
+}
+
+TEST(PipelineSchedulerTest, bounded_extra_workers) {
+    // one worker and at most one extra worker for the blocked ones
+    PipelineScheduler scheduler(1, 2);
+    ASSERT_TRUE(scheduler.start().ok());
+
+    std::atomic<bool> flag(false);
+    std::atomic<int> num_blocked(0);
+    CountDownLatch finished(3);
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(scheduler
+                            .submit(std::make_shared<BlockingTask>(&flag, &finished,
+                                                                   &num_blocked))
+                            .ok());
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_EQ(2, num_blocked.load());
+    flag.store(true);
+    ASSERT_TRUE(finished.wait_for(MonoDelta::FromSeconds(10)));
+    scheduler.shutdown();
+}
+
+TEST(PipelineSchedulerTest, shutdown_cancels_tasks) {
+    PipelineScheduler scheduler(1, 1);
+    ASSERT_TRUE(scheduler.start().ok());
+
+    // never ready on its own
+    std::atomic<int> input(0);
+    CountDownLatch finished(1);
+    std::shared_ptr<CountingTask> task(new CountingTask(10, &input, &finished));
+    ASSERT_TRUE(scheduler.submit(task).ok());
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ASSERT_EQ(0, task->steps());
+
+    scheduler.shutdown();
+    ASSERT_TRUE(task->cancelled());
+    ASSERT_EQ(1, task->steps());
+    ASSERT_EQ(0, finished.count());
+}
+
+TEST(PipelineSchedulerTest, worker_thread) {
+    PipelineScheduler scheduler(1, 1);
+    ASSERT_TRUE(scheduler.start().ok());
+    ASSERT_FALSE(PipelineScheduler::is_worker_thread());
+
+    std::atomic<bool> is_worker(false);
+    CountDownLatch finished(1);
+    ASSERT_TRUE(scheduler.submit(std::make_shared<CheckingTask>(&is_worker, &finished)).ok());
+    ASSERT_TRUE(finished.wait_for(MonoDelta::FromSeconds(10)));
+    ASSERT_TRUE(is_worker.load());
+    scheduler.shutdown();
+}
+
+TEST(PipelineSchedulerTest, submit_after_shutdown) {
+    PipelineScheduler scheduler(1, 1);
+    ASSERT_TRUE(scheduler.start().ok());
+    scheduler.shutdown();
+
+    CountDownLatch finished(1);
+    ASSERT_FALSE(scheduler.submit(std::make_shared<CountingTask>(1, nullptr, &finished)).ok());
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
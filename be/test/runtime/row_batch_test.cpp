@@ -0,0 +1,196 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "runtime/row_batch.h"
+
+#include <butil/iobuf.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "common/object_pool.h"
+#include "gen_cpp/data.pb.h"
+#include "runtime/descriptor_helper.h"
+#include "runtime/descriptors.h"
+#include "runtime/mem_tracker.h"
+#include "runtime/string_value.h"
+#include "runtime/tuple.h"
+#include "runtime/tuple_row.h"
+
+namespace doris {
+
+class RowBatchTest : public testing::Test {
+public:
+    RowBatchTest() : _tracker(new MemTracker(-1)) {}
+
+protected:
+    void SetUp() override {
+        TDescriptorTableBuilder table_builder;
+        TTupleDescriptorBuilder tuple;
+        tuple.add_slot(TSlotDescriptorBuilder()
+                               .type(TYPE_INT)
+                               .nullable(false)
+                               .column_name("c1")
+                               .column_pos(0)
+                               .build());
+        tuple.add_slot(TSlotDescriptorBuilder()
+                               .string_type(64)
+                               .nullable(false)
+                               .column_name("c2")
+                               .column_pos(1)
+                               .build());
+        tuple.build(&table_builder);
+        DescriptorTbl::create(&_obj_pool, table_builder.desc_tbl(), &_desc_tbl);
+        _row_desc.reset(new RowDescriptor(*_desc_tbl, {0}, {false}));
+    }
+
+    // rows of (i, "value_<i % 10>"), repetitive enough for every codec to compress
+    RowBatch* create_batch(int num_rows) {
+        TupleDescriptor* tuple_desc = _desc_tbl->get_tuple_descriptor(0);
+        const SlotDescriptor* int_slot = tuple_desc->slots()[0];
+        const SlotDescriptor* str_slot = tuple_desc->slots()[1];
+        RowBatch* batch = _obj_pool.add(new RowBatch(*_row_desc, num_rows, _tracker.get()));
+        for (int i = 0; i < num_rows; ++i) {
+            int row_idx = batch->add_row();
+            Tuple* tuple = Tuple::create(tuple_desc->byte_size(), batch->tuple_data_pool());
+            *reinterpret_cast<int32_t*>(tuple->get_slot(int_slot->tuple_offset())) = i;
+            std::string value = "value_" + std::to_string(i % 10);
+            char* str = reinterpret_cast<char*>(batch->tuple_data_pool()->allocate(value.size()));
+            memcpy(str, value.data(), value.size());
+            *tuple->get_string_slot(str_slot->tuple_offset()) = StringValue(str, value.size());
+            batch->get_row(row_idx)->set_tuple(0, tuple);
+            batch->commit_last_row();
+        }
+        return batch;
+    }
+
+    void check_batch(const RowBatch& batch, int num_rows) {
+        TupleDescriptor* tuple_desc = _desc_tbl->get_tuple_descriptor(0);
+        const SlotDescriptor* int_slot = tuple_desc->slots()[0];
+        const SlotDescriptor* str_slot = tuple_desc->slots()[1];
+        ASSERT_EQ(num_rows, batch.num_rows());
+        for (int i = 0; i < num_rows; ++i) {
+            Tuple* tuple = batch.get_row(i)->get_tuple(0);
+            ASSERT_EQ(i, *reinterpret_cast<int32_t*>(tuple->get_slot(int_slot->tuple_offset())));
+            ASSERT_EQ("value_" + std::to_string(i % 10),
+                      tuple->get_string_slot(str_slot->tuple_offset())->to_string());
+        }
+    }
+
+    ObjectPool _obj_pool;
+    std::shared_ptr<MemTracker> _tracker;
+    DescriptorTbl* _desc_tbl = nullptr;
+    std::unique_ptr<RowDescriptor> _row_desc;
+};
+
+TEST_F(RowBatchTest, serialize) {
+    segment_v2::CompressionTypePB types[] = {
+            segment_v2::CompressionTypePB::NO_COMPRESSION, segment_v2::CompressionTypePB::SNAPPY,
+            segment_v2::CompressionTypePB::LZ4, segment_v2::CompressionTypePB::ZSTD};
+    RowBatch* batch = create_batch(1024);
+    for (auto type : types) {
+        PRowBatch pb_batch;
+        int uncompressed_size = batch->serialize(&pb_batch, type, nullptr);
+        ASSERT_EQ(type != segment_v2::CompressionTypePB::NO_COMPRESSION, pb_batch.is_compressed());
+        ASSERT_GE(uncompressed_size, RowBatch::get_batch_size(pb_batch));
+
+        std::unique_ptr<RowBatch> output;
+        ASSERT_TRUE(
+                RowBatch::create(*_row_desc, pb_batch, nullptr, _tracker.get(), &output).ok());
+        check_batch(*output, 1024);
+    }
+}
+
+TEST_F(RowBatchTest, serialize_to_attachment) {
+    segment_v2::CompressionTypePB types[] = {
+            segment_v2::CompressionTypePB::NO_COMPRESSION, segment_v2::CompressionTypePB::SNAPPY,
+            segment_v2::CompressionTypePB::LZ4, segment_v2::CompressionTypePB::ZSTD};
+    RowBatch* batch = create_batch(1024);
+    for (auto type : types) {
+        PRowBatch pb_batch;
+        butil::IOBuf tuple_data;
+        batch->serialize(&pb_batch, type, &tuple_data);
+        ASSERT_TRUE(pb_batch.tuple_data().empty());
+        ASSERT_GT(tuple_data.size(), 0);
+
+        // the receiver gets the attachment split into blocks
+        butil::IOBuf received;
+        while (!tuple_data.empty()) {
+            tuple_data.cutn(&received, 100);
+        }
+        std::unique_ptr<RowBatch> output;
+        ASSERT_TRUE(
+                RowBatch::create(*_row_desc, pb_batch, &received, _tracker.get(), &output).ok());
+        check_batch(*output, 1024);
+    }
+}
+
+TEST_F(RowBatchTest, serialize_legacy) {
+    RowBatch* batch = create_batch(1024);
+    PRowBatch pb_batch;
+    batch->serialize(&pb_batch);
+    // a snappy compressed batch from an old sender has no compression type
+    pb_batch.clear_compression_type();
+    pb_batch.clear_uncompressed_size();
+    std::unique_ptr<RowBatch> output;
+    ASSERT_TRUE(RowBatch::create(*_row_desc, pb_batch, nullptr, _tracker.get(), &output).ok());
+    check_batch(*output, 1024);
+}
+
+TEST_F(RowBatchTest, deserialize_invalid_compression_type) {
+    RowBatch* batch = create_batch(1024);
+    PRowBatch pb_batch;
+    batch->serialize(&pb_batch, segment_v2::CompressionTypePB::LZ4, nullptr);
+    ASSERT_TRUE(pb_batch.is_compressed());
+    pb_batch.set_compression_type(segment_v2::CompressionTypePB::NO_COMPRESSION);
+    std::unique_ptr<RowBatch> output;
+    ASSERT_FALSE(RowBatch::create(*_row_desc, pb_batch, nullptr, _tracker.get(), &output).ok());
+    ASSERT_TRUE(output == nullptr);
+}
+
+TEST_F(RowBatchTest, deserialize_corrupt_data) {
+    RowBatch* batch = create_batch(1024);
+    segment_v2::CompressionTypePB types[] = {segment_v2::CompressionTypePB::SNAPPY,
+                                             segment_v2::CompressionTypePB::LZ4,
+                                             segment_v2::CompressionTypePB::ZSTD};
+    for (auto type : types) {
+        PRowBatch pb_batch;
+        batch->serialize(&pb_batch, type, nullptr);
+        ASSERT_TRUE(pb_batch.is_compressed());
+        // the tuple data got truncated on the way
+        pb_batch.mutable_tuple_data()->resize(pb_batch.tuple_data().size() / 2);
+        std::unique_ptr<RowBatch> output;
+        ASSERT_FALSE(
+                RowBatch::create(*_row_desc, pb_batch, nullptr, _tracker.get(), &output).ok());
+    }
+
+    // snappy data of an old sender without a valid length
+    PRowBatch pb_batch;
+    batch->serialize(&pb_batch, segment_v2::CompressionTypePB::SNAPPY, nullptr);
+    pb_batch.clear_compression_type();
+    pb_batch.clear_uncompressed_size();
+    pb_batch.mutable_tuple_data()->assign("\xff\xff\xff\xff\xff\xff");
+    std::unique_ptr<RowBatch> output;
+    ASSERT_FALSE(RowBatch::create(*_row_desc, pb_batch, nullptr, _tracker.get(), &output).ok());
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -197,6 +197,90 @@ TEST_F(StreamLoadPipeTest, append_mix) {
     t1.join();
 }
 
+TEST_F(StreamLoadPipeTest, read_one_message) {
+    StreamLoadPipe pipe(66, 64, 128);
+
+    auto appender = [&pipe] {
+        int k = 0;
+        for (int i = 0; i < 128; ++i) {
+            char buf = '0' + (k++ % 10);
+            pipe.append(&buf, 1);
+        }
+        pipe.finish();
+    };
+    std::thread t1(appender);
+
+    // the whole data is handed out as one buffer
+    ByteBufferPtr buf;
+    auto st = pipe.read_one_message(&buf);
+    ASSERT_TRUE(st.ok());
+    ASSERT_TRUE(buf != nullptr);
+    ASSERT_EQ(128, buf->remaining());
+    for (int i = 0; i < 128; ++i) {
+        ASSERT_EQ('0' + (i % 10), buf->ptr[buf->pos + i]);
+    }
+    st = pipe.read_one_message(&buf);
+    ASSERT_TRUE(st.ok());
+    ASSERT_TRUE(buf == nullptr);
+
+    t1.join();
+}
+
+TEST_F(StreamLoadPipeTest, read_one_message_multi_chunks) {
+    StreamLoadPipe pipe(66, 64, 128);
+
+    auto appender = [&pipe] {
+        int k = 0;
+        for (int i = 0; i < 2; ++i) {
+            auto byte_buf = ByteBuffer::allocate(64);
+            char buf[64];
+            for (int j = 0; j < 64; ++j) {
+                buf[j] = '0' + (k++ % 10);
+            }
+            byte_buf->put_bytes(buf, 64);
+            byte_buf->flip();
+            pipe.append(byte_buf);
+        }
+        pipe.finish();
+    };
+    std::thread t1(appender);
+
+    // chunks are merged into one buffer
+    ByteBufferPtr buf;
+    auto st = pipe.read_one_message(&buf);
+    ASSERT_TRUE(st.ok());
+    ASSERT_TRUE(buf != nullptr);
+    ASSERT_EQ(128, buf->remaining());
+    for (int i = 0; i < 128; ++i) {
+        ASSERT_EQ('0' + (i % 10), buf->ptr[buf->pos + i]);
+    }
+    st = pipe.read_one_message(&buf);
+    ASSERT_TRUE(st.ok());
+    ASSERT_TRUE(buf == nullptr);
+
+    t1.join();
+}
+
+TEST_F(StreamLoadPipeTest, read_one_message_unknown_length) {
+    StreamLoadPipe pipe;
+
+    ASSERT_TRUE(pipe.append_and_flush("abc", 3).ok());
+    ASSERT_TRUE(pipe.append_and_flush("de", 2).ok());
+    ASSERT_TRUE(pipe.finish().ok());
+
+    ByteBufferPtr buf;
+    auto st = pipe.read_one_message(&buf);
+    ASSERT_TRUE(st.ok());
+    ASSERT_EQ("abc", std::string(buf->ptr + buf->pos, buf->remaining()));
+    st = pipe.read_one_message(&buf);
+    ASSERT_TRUE(st.ok());
+    ASSERT_EQ("de", std::string(buf->ptr + buf->pos, buf->remaining()));
+    st = pipe.read_one_message(&buf);
+    ASSERT_TRUE(st.ok());
+    ASSERT_TRUE(buf == nullptr);
+    ASSERT_EQ(5, pipe.peak_buffered_bytes());
+}
+
 TEST_F(StreamLoadPipeTest, cancel) {
     StreamLoadPipe pipe(66, 64);
 
@@ -23,6 +23,7 @@
 #include "util/arrow/row_block.h"
 
 #define ARROW_UTIL_LOGGING_H
+#include <arrow/array.h>
 #include <arrow/buffer.h>
 #include <arrow/json/api.h>
 #include <arrow/json/test_common.h>
@@ -30,9 +31,11 @@
 #include <arrow/pretty_print.h>
 #include <arrow/record_batch.h>
 
+#include "olap/column_block.h"
 #include "olap/row_block2.h"
 #include "olap/schema.h"
 #include "olap/tablet_schema_helper.h"
+#include "util/slice.h"
 
 namespace doris {
 
@@ -89,6 +92,69 @@ TEST_F(ArrowRowBlockTest, Normal) {
     }
 }
 
+TEST_F(ArrowRowBlockTest, SelectedRows) {
+    // the block reads column 1 before column 0
+    std::vector<TabletColumn> columns({create_int_key(0, false), create_varchar_key(1)});
+    Schema schema(columns, std::vector<ColumnId>({1, 0}));
+    std::shared_ptr<RowBlockV2> block(new RowBlockV2(schema, 16));
+    ColumnBlock int_column = block->column_block(0);
+    ColumnBlock str_column = block->column_block(1);
+    for (int i = 0; i < 8; ++i) {
+        *reinterpret_cast<int32_t*>(int_column.mutable_cell_ptr(i)) = i;
+        if (i == 3) {
+            str_column.set_is_null(i, true);
+            continue;
+        }
+        std::string value = "v" + std::to_string(i);
+        char* data = reinterpret_cast<char*>(block->pool()->allocate(value.size()));
+        memcpy(data, value.data(), value.size());
+        str_column.set_is_null(i, false);
+        *reinterpret_cast<Slice*>(str_column.mutable_cell_ptr(i)) = Slice(data, value.size());
+    }
+    block->set_num_rows(8);
+
+    auto arrow_schema = arrow::schema(
+            {arrow::field("c1", arrow::utf8(), true), arrow::field("c0", arrow::int32(), false)});
+    arrow::MemoryPool* pool = arrow::default_memory_pool();
+    {
+        std::shared_ptr<arrow::RecordBatch> batch;
+        ASSERT_TRUE(convert_to_arrow_batch(block, arrow_schema, pool, &batch).ok());
+        ASSERT_EQ(8, batch->num_rows());
+        auto strs = std::static_pointer_cast<arrow::StringArray>(batch->column(0));
+        auto ints = std::static_pointer_cast<arrow::Int32Array>(batch->column(1));
+        // all rows are selected and there is no null, the ints are not copied
+        ASSERT_EQ(int_column.data(), ints->values()->data());
+        for (int i = 0; i < 8; ++i) {
+            ASSERT_EQ(i, ints->Value(i));
+            ASSERT_EQ(i == 3, strs->IsNull(i));
+            if (i != 3) {
+                ASSERT_EQ("v" + std::to_string(i), strs->GetString(i));
+            }
+        }
+    }
+
+    // rows 1, 3 and 6 passed the predicates
+    uint16_t* selection = block->selection_vector();
+    selection[0] = 1;
+    selection[1] = 3;
+    selection[2] = 6;
+    block->set_selected_size(3);
+    block->set_num_rows(3);
+    {
+        std::shared_ptr<arrow::RecordBatch> batch;
+        ASSERT_TRUE(convert_to_arrow_batch(block, arrow_schema, pool, &batch).ok());
+        ASSERT_EQ(3, batch->num_rows());
+        auto strs = std::static_pointer_cast<arrow::StringArray>(batch->column(0));
+        auto ints = std::static_pointer_cast<arrow::Int32Array>(batch->column(1));
+        ASSERT_EQ(1, ints->Value(0));
+        ASSERT_EQ(3, ints->Value(1));
+        ASSERT_EQ(6, ints->Value(2));
+        ASSERT_EQ("v1", strs->GetString(0));
+        ASSERT_TRUE(strs->IsNull(1));
+        ASSERT_EQ("v6", strs->GetString(2));
+    }
+}
+
 } // namespace doris
 
 int main(int argc, char** argv) {
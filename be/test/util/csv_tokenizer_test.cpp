@@ -0,0 +1,114 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "util/csv_tokenizer.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+namespace doris {
+
+class CsvTokenizerTest : public testing::Test {
+public:
+    CsvTokenizerTest() {}
+    virtual ~CsvTokenizerTest() {}
+
+protected:
+    static std::vector<std::string> split(const CsvTokenizer& tokenizer, const std::string& line) {
+        std::vector<Slice> fields;
+        tokenizer.split(Slice(line), &fields);
+        std::vector<std::string> res;
+        for (auto& field : fields) {
+            res.emplace_back(field.data, field.size);
+        }
+        return res;
+    }
+};
+
+TEST_F(CsvTokenizerTest, single_byte_separator) {
+    CsvTokenizer tokenizer(",");
+    ASSERT_EQ(std::vector<std::string>({""}), split(tokenizer, ""));
+    ASSERT_EQ(std::vector<std::string>({"", ""}), split(tokenizer, ","));
+    ASSERT_EQ(std::vector<std::string>({"a", "b", "c"}), split(tokenizer, "a,b,c"));
+    ASSERT_EQ(std::vector<std::string>({"a", "", "c", ""}), split(tokenizer, "a,,c,"));
+    // longer than one simd block
+    std::string line = "0123456789,0123456789,0123456789,0123456789,0123456789";
+    ASSERT_EQ(std::vector<std::string>(5, "0123456789"), split(tokenizer, line));
+}
+
+TEST_F(CsvTokenizerTest, multi_byte_separator) {
+    CsvTokenizer tokenizer("||");
+    ASSERT_EQ(std::vector<std::string>({"a", "b|c"}), split(tokenizer, "a||b|c"));
+    ASSERT_EQ(std::vector<std::string>({"a", "|b"}), split(tokenizer, "a|||b"));
+    ASSERT_EQ(std::vector<std::string>({"a", "", "b"}), split(tokenizer, "a||||b"));
+    ASSERT_EQ(std::vector<std::string>({"a|"}), split(tokenizer, "a|"));
+
+    // separator crosses the boundary of simd block
+    std::string line(31, 'x');
+    line += "||y";
+    ASSERT_EQ(std::vector<std::string>({std::string(31, 'x'), "y"}), split(tokenizer, line));
+
+    CsvTokenizer utf8_tokenizer("\xe2\x80\xa2");
+    ASSERT_EQ(std::vector<std::string>({"a", "b"}), split(utf8_tokenizer, "a\xe2\x80\xa2"
+                                                                          "b"));
+}
+
+TEST_F(CsvTokenizerTest, enclose) {
+    CsvTokenizer tokenizer(",", '"');
+    ASSERT_EQ(std::vector<std::string>({"a,b", "c"}), split(tokenizer, "\"a,b\",c"));
+    ASSERT_EQ(std::vector<std::string>({"a", "", "c"}), split(tokenizer, "a,\"\",c"));
+    // doubled enclose char is kept
+    ASSERT_EQ(std::vector<std::string>({"a\"\"b", "c"}), split(tokenizer, "\"a\"\"b\",c"));
+    // enclosed field longer than one simd block
+    std::string long_value(40, ',');
+    ASSERT_EQ(std::vector<std::string>({"x", long_value, "y"}),
+              split(tokenizer, "x,\"" + long_value + "\",y"));
+}
+
+TEST_F(CsvTokenizerTest, same_as_naive) {
+    std::mt19937 rng(1234);
+    const char alphabet[] = {'a', 'b', ',', '|', '"'};
+    std::vector<CsvTokenizer> tokenizers = {CsvTokenizer(","), CsvTokenizer("|"),
+                                            CsvTokenizer("||"), CsvTokenizer(",|,"),
+                                            CsvTokenizer(",", '"'), CsvTokenizer("||", '"')};
+    std::vector<Slice> fields;
+    std::vector<Slice> expected;
+    for (int i = 0; i < 1000; ++i) {
+        std::string line;
+        int len = rng() % 200;
+        for (int j = 0; j < len; ++j) {
+            line.push_back(alphabet[rng() % sizeof(alphabet)]);
+        }
+        for (auto& tokenizer : tokenizers) {
+            tokenizer.split(Slice(line), &fields);
+            tokenizer.split_naive(Slice(line), &expected);
+            ASSERT_EQ(expected.size(), fields.size()) << line;
+            for (int k = 0; k < fields.size(); ++k) {
+                ASSERT_EQ(expected[k].data, fields[k].data) << line;
+                ASSERT_EQ(expected[k].size, fields[k].size) << line;
+            }
+        }
+    }
+}
+
+} // namespace doris
+
+int main(int argc, char* argv[]) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
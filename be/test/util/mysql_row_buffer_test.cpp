@@ -0,0 +1,154 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "util/mysql_row_buffer.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <limits>
+#include <string>
+
+#include "gutil/strings/numbers.h"
+#include "runtime/datetime_value.h"
+
+namespace doris {
+
+// the text of the only cell in 'buffer', checking its 1 byte length prefix
+static std::string cell(const MysqlRowBuffer& buffer) {
+    EXPECT_LT(0, buffer.length());
+    EXPECT_EQ(buffer.length() - 1, static_cast<uint8_t>(buffer.buf()[0]));
+    return std::string(buffer.buf() + 1, buffer.length() - 1);
+}
+
+TEST(MysqlRowBufferTest, integers) {
+    MysqlRowBuffer buffer;
+    int64_t values[] = {0,
+                        1,
+                        -1,
+                        127,
+                        -128,
+                        32767,
+                        -32768,
+                        std::numeric_limits<int32_t>::max(),
+                        std::numeric_limits<int32_t>::min(),
+                        std::numeric_limits<int64_t>::max(),
+                        std::numeric_limits<int64_t>::min()};
+    char expected[32];
+    for (int64_t value : values) {
+        snprintf(expected, sizeof(expected), "%ld", value);
+        buffer.reset();
+        if (value == static_cast<int8_t>(value)) {
+            ASSERT_EQ(0, buffer.push_tinyint(value));
+            ASSERT_EQ(expected, cell(buffer));
+            buffer.reset();
+        }
+        if (value == static_cast<int16_t>(value)) {
+            ASSERT_EQ(0, buffer.push_smallint(value));
+            ASSERT_EQ(expected, cell(buffer));
+            buffer.reset();
+        }
+        if (value == static_cast<int32_t>(value)) {
+            ASSERT_EQ(0, buffer.push_int(value));
+            ASSERT_EQ(expected, cell(buffer));
+            buffer.reset();
+        }
+        ASSERT_EQ(0, buffer.push_bigint(value));
+        ASSERT_EQ(expected, cell(buffer));
+    }
+
+    buffer.reset();
+    ASSERT_EQ(0, buffer.push_unsigned_bigint(std::numeric_limits<uint64_t>::max()));
+    ASSERT_EQ("18446744073709551615", cell(buffer));
+}
+
+TEST(MysqlRowBufferTest, floating_points) {
+    double values[] = {0.0,
+                       -0.0,
+                       0.1,
+                       -0.1,
+                       1.0 / 3,
+                       2.0 / 3,
+                       1.5,
+                       100,
+                       123456789.0,
+                       1e15,
+                       1e16,
+                       1e20,
+                       1.7976931348623157e308,
+                       1e-4,
+                       1e-5,
+                       1.234e-5,
+                       5e-324,
+                       3.14159265358979,
+                       std::numeric_limits<double>::infinity(),
+                       -std::numeric_limits<double>::infinity(),
+                       std::numeric_limits<double>::quiet_NaN()};
+    MysqlRowBuffer buffer;
+    char expected[kDoubleToBufferSize];
+    for (double value : values) {
+        buffer.reset();
+        ASSERT_EQ(0, buffer.push_double(value));
+        ASSERT_EQ(DoubleToBuffer(value, expected), cell(buffer)) << value;
+
+        float float_value = static_cast<float>(value);
+        buffer.reset();
+        ASSERT_EQ(0, buffer.push_float(float_value));
+        ASSERT_EQ(FloatToBuffer(float_value, expected), cell(buffer)) << float_value;
+    }
+
+    float float_values[] = {123456789.0f, 0.3f, 16777216.0f, 1.17549435e-38f, 3.40282347e38f};
+    for (float value : float_values) {
+        buffer.reset();
+        ASSERT_EQ(0, buffer.push_float(value));
+        ASSERT_EQ(FloatToBuffer(value, expected), cell(buffer)) << value;
+    }
+}
+
+TEST(MysqlRowBufferTest, datetime) {
+    MysqlRowBuffer buffer;
+    DateTimeValue value;
+    std::string str = "2020-10-01 12:34:56";
+    ASSERT_TRUE(value.from_date_str(str.c_str(), str.size()));
+    ASSERT_EQ(0, buffer.push_datetime(value));
+    ASSERT_EQ(str, cell(buffer));
+
+    buffer.reset();
+    str = "2020-10-01";
+    ASSERT_TRUE(value.from_date_str(str.c_str(), str.size()));
+    value.cast_to_date();
+    ASSERT_EQ(0, buffer.push_datetime(value));
+    ASSERT_EQ(str, cell(buffer));
+}
+
+TEST(MysqlRowBufferTest, null_and_string) {
+    MysqlRowBuffer buffer;
+    ASSERT_EQ(0, buffer.push_null());
+    ASSERT_EQ(1, buffer.length());
+    ASSERT_EQ(251, static_cast<uint8_t>(buffer.buf()[0]));
+
+    buffer.reset();
+    ASSERT_EQ(0, buffer.push_string("doris", 5));
+    ASSERT_EQ("doris", cell(buffer));
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
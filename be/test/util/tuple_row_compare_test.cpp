@@ -0,0 +1,285 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "util/tuple_row_compare.h"
+
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "common/object_pool.h"
+#include "exprs/expr.h"
+#include "exprs/expr_context.h"
+#include "gen_cpp/Exprs_types.h"
+#include "runtime/decimalv2_value.h"
+#include "runtime/descriptor_helper.h"
+#include "runtime/descriptors.h"
+#include "runtime/mem_tracker.h"
+#include "runtime/row_batch.h"
+#include "runtime/runtime_state.h"
+#include "runtime/string_value.h"
+#include "runtime/tuple.h"
+#include "runtime/tuple_row.h"
+
+namespace doris {
+
+static const std::vector<int64_t> BIGINT_VALUES = {std::numeric_limits<int64_t>::min(),
+                                                   std::numeric_limits<int64_t>::min() + 1,
+                                                   -1,
+                                                   0,
+                                                   1,
+                                                   std::numeric_limits<int64_t>::max() - 1,
+                                                   std::numeric_limits<int64_t>::max()};
+static const std::vector<int32_t> INT_VALUES = {std::numeric_limits<int32_t>::min(), -1, 0, 1,
+                                                std::numeric_limits<int32_t>::max()};
+// values that only differ after the first 8 bytes or in the lowest bit of the 8th
+static const std::vector<std::string> STRING_VALUES = {
+        "",          "a",         "abcdefgh", "abcdefgi",
+        "abcdefgh1", "abcdefgh2", "b",        "\xff\xff\xff\xff\xff\xff\xff\xff"};
+// values that share the high 64 bits of their 128 bit representation
+static const std::vector<std::string> DECIMAL_VALUES = {
+        "-99999.5", "-0.000000001", "0", "0.000000001", "0.000000002", "1.5", "99999.5"};
+
+class TupleRowCompareTest : public testing::Test {
+public:
+    TupleRowCompareTest() : _state(TQueryGlobals()), _tracker(new MemTracker(-1)) {}
+
+protected:
+    // a tuple of the nullable slots (c0 BIGINT, c1 INT, c2 VARCHAR, c3 DECIMALV2)
+    void SetUp() override {
+        _state.init_instance_mem_tracker();
+        TDescriptorTableBuilder table_builder;
+        TTupleDescriptorBuilder tuple;
+        tuple.add_slot(TSlotDescriptorBuilder()
+                               .type(TYPE_BIGINT)
+                               .nullable(true)
+                               .column_name("c0")
+                               .column_pos(0)
+                               .build());
+        tuple.add_slot(TSlotDescriptorBuilder()
+                               .type(TYPE_INT)
+                               .nullable(true)
+                               .column_name("c1")
+                               .column_pos(1)
+                               .build());
+        tuple.add_slot(TSlotDescriptorBuilder()
+                               .string_type(64)
+                               .nullable(true)
+                               .column_name("c2")
+                               .column_pos(2)
+                               .build());
+        TSlotDescriptor decimal_slot = TSlotDescriptorBuilder()
+                                               .type(TYPE_DECIMALV2)
+                                               .nullable(true)
+                                               .column_name("c3")
+                                               .column_pos(3)
+                                               .build();
+        decimal_slot.slotType = slot_type(TPrimitiveType::DECIMALV2);
+        tuple.add_slot(decimal_slot);
+        tuple.build(&table_builder);
+        DescriptorTbl::create(&_obj_pool, table_builder.desc_tbl(), &_desc_tbl);
+        _state.set_desc_tbl(_desc_tbl);
+        _row_desc.reset(new RowDescriptor(*_desc_tbl, {0}, {false}));
+        create_rows();
+    }
+
+    void TearDown() override {
+        for (auto ctx : _ctxs) {
+            ctx->close(&_state);
+        }
+    }
+
+    // Each column cycles through its values and a NULL with its own period, so the rows
+    // repeat every value of a column next to different values of the others.
+    void create_rows() {
+        TupleDescriptor* tuple_desc = _desc_tbl->get_tuple_descriptor(0);
+        const std::vector<SlotDescriptor*>& slots = tuple_desc->slots();
+        const int num_rows = 64;
+        _batch.reset(new RowBatch(*_row_desc, num_rows, _tracker.get()));
+        MemPool* pool = _batch->tuple_data_pool();
+        for (int i = 0; i < num_rows; ++i) {
+            int row_idx = _batch->add_row();
+            Tuple* tuple = Tuple::create(tuple_desc->byte_size(), pool);
+            // index == size() is the NULL value of a column
+            int index = i % (BIGINT_VALUES.size() + 1);
+            if (index < BIGINT_VALUES.size()) {
+                *reinterpret_cast<int64_t*>(tuple->get_slot(slots[0]->tuple_offset())) =
+                        BIGINT_VALUES[index];
+            } else {
+                tuple->set_null(slots[0]->null_indicator_offset());
+            }
+            index = i % (INT_VALUES.size() + 1);
+            if (index < INT_VALUES.size()) {
+                *reinterpret_cast<int32_t*>(tuple->get_slot(slots[1]->tuple_offset())) =
+                        INT_VALUES[index];
+            } else {
+                tuple->set_null(slots[1]->null_indicator_offset());
+            }
+            index = i % (STRING_VALUES.size() + 1);
+            if (index < STRING_VALUES.size()) {
+                const std::string& str = STRING_VALUES[index];
+                char* ptr = reinterpret_cast<char*>(pool->allocate(str.size()));
+                memcpy(ptr, str.data(), str.size());
+                *tuple->get_string_slot(slots[2]->tuple_offset()) = StringValue(ptr, str.size());
+            } else {
+                tuple->set_null(slots[2]->null_indicator_offset());
+            }
+            index = (i / 3) % (DECIMAL_VALUES.size() + 1);
+            if (index < DECIMAL_VALUES.size()) {
+                DecimalV2Value value(DECIMAL_VALUES[index]);
+                memcpy(tuple->get_slot(slots[3]->tuple_offset()), &value, sizeof(value));
+            } else {
+                tuple->set_null(slots[3]->null_indicator_offset());
+            }
+            _batch->get_row(row_idx)->set_tuple(0, tuple);
+            _batch->commit_last_row();
+            _rows.push_back(_batch->get_row(row_idx));
+        }
+    }
+
+    static TTypeDesc slot_type(TPrimitiveType::type type) {
+        TTypeDesc type_desc = gen_type_desc(type);
+        if (type == TPrimitiveType::VARCHAR) {
+            type_desc.types[0].scalar_type.__set_len(64);
+        } else if (type == TPrimitiveType::DECIMALV2) {
+            type_desc.types[0].scalar_type.__set_precision(27);
+            type_desc.types[0].scalar_type.__set_scale(9);
+        }
+        return type_desc;
+    }
+
+    ExprContext* create_slot_ref(int slot_id, TPrimitiveType::type type) {
+        TExprNode node;
+        node.node_type = TExprNodeType::SLOT_REF;
+        node.type = slot_type(type);
+        node.num_children = 0;
+        node.__isset.slot_ref = true;
+        node.slot_ref.slot_id = slot_id;
+        node.slot_ref.tuple_id = 0;
+        TExpr texpr;
+        texpr.nodes.push_back(node);
+        ExprContext* ctx = nullptr;
+        EXPECT_TRUE(Expr::create_expr_tree(&_obj_pool, texpr, &ctx).ok());
+        EXPECT_TRUE(ctx->prepare(&_state, *_row_desc, _tracker).ok());
+        EXPECT_TRUE(ctx->open(&_state).ok());
+        _ctxs.push_back(ctx);
+        return ctx;
+    }
+
+    // Checks that the normalized keys of the sort keys 'ctxs' order the rows like
+    // compare() for every combination of ASC/DESC and NULLS FIRST/LAST, and that a NULL
+    // never gets the key of a value.
+    void check_normalized_keys(const std::vector<ExprContext*>& ctxs, bool exact) {
+        for (bool is_asc : {true, false}) {
+            for (bool nulls_first : {true, false}) {
+                TupleRowComparator comparator(ctxs, ctxs, is_asc, nulls_first);
+                ASSERT_TRUE(comparator.has_normalized_key());
+                ASSERT_EQ(exact, comparator.normalized_key_is_exact());
+                std::vector<uint64_t> keys;
+                for (TupleRow* row : _rows) {
+                    keys.push_back(comparator.normalized_key(row));
+                }
+                for (int i = 0; i < _rows.size(); ++i) {
+                    bool lhs_null = ctxs[0]->get_value(_rows[i]) == nullptr;
+                    for (int j = 0; j < _rows.size(); ++j) {
+                        int result = comparator.compare(_rows[i], _rows[j]);
+                        std::string trace = "rows " + std::to_string(i) + ", " +
+                                            std::to_string(j) + ", asc " +
+                                            std::to_string(is_asc) + ", nulls first " +
+                                            std::to_string(nulls_first);
+                        if (keys[i] < keys[j]) {
+                            ASSERT_LT(result, 0) << trace;
+                        } else if (keys[i] > keys[j]) {
+                            ASSERT_GT(result, 0) << trace;
+                        } else if (exact) {
+                            ASSERT_EQ(0, result) << trace;
+                        }
+                        ASSERT_EQ(result < 0,
+                                  comparator.less(keys[i], _rows[i], keys[j], _rows[j]))
+                                << trace;
+                        bool rhs_null = ctxs[0]->get_value(_rows[j]) == nullptr;
+                        if (lhs_null != rhs_null) {
+                            ASSERT_NE(keys[i], keys[j]) << trace;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    ObjectPool _obj_pool;
+    RuntimeState _state;
+    std::shared_ptr<MemTracker> _tracker;
+    DescriptorTbl* _desc_tbl = nullptr;
+    std::unique_ptr<RowDescriptor> _row_desc;
+    std::unique_ptr<RowBatch> _batch;
+    std::vector<TupleRow*> _rows;
+    std::vector<ExprContext*> _ctxs;
+};
+
+TEST_F(TupleRowCompareTest, int_key) {
+    check_normalized_keys({create_slot_ref(1, TPrimitiveType::INT)}, true);
+}
+
+// INT64_MIN and INT64_MAX used to share their keys with the NULLs.
+TEST_F(TupleRowCompareTest, bigint_key) {
+    check_normalized_keys({create_slot_ref(0, TPrimitiveType::BIGINT)}, false);
+}
+
+TEST_F(TupleRowCompareTest, string_key) {
+    check_normalized_keys({create_slot_ref(2, TPrimitiveType::VARCHAR)}, false);
+}
+
+TEST_F(TupleRowCompareTest, decimal_key) {
+    check_normalized_keys({create_slot_ref(3, TPrimitiveType::DECIMALV2)}, false);
+}
+
+// Ties of the first key are broken by the second one.
+TEST_F(TupleRowCompareTest, multiple_keys) {
+    check_normalized_keys({create_slot_ref(1, TPrimitiveType::INT),
+                           create_slot_ref(2, TPrimitiveType::VARCHAR)},
+                          false);
+}
+
+TEST_F(TupleRowCompareTest, null_keys) {
+    std::vector<ExprContext*> ctxs = {create_slot_ref(0, TPrimitiveType::BIGINT)};
+    // rows 0 and 6 are INT64_MIN and INT64_MAX, row 7 is NULL
+    ASSERT_EQ(std::numeric_limits<int64_t>::min(),
+              *reinterpret_cast<int64_t*>(ctxs[0]->get_value(_rows[0])));
+    ASSERT_EQ(std::numeric_limits<int64_t>::max(),
+              *reinterpret_cast<int64_t*>(ctxs[0]->get_value(_rows[6])));
+    ASSERT_EQ(nullptr, ctxs[0]->get_value(_rows[7]));
+    for (bool is_asc : {true, false}) {
+        TupleRowComparator nulls_first(ctxs, ctxs, is_asc, true);
+        EXPECT_LT(nulls_first.normalized_key(_rows[7]), nulls_first.normalized_key(_rows[0]));
+        EXPECT_LT(nulls_first.normalized_key(_rows[7]), nulls_first.normalized_key(_rows[6]));
+        EXPECT_EQ(nulls_first.normalized_key(_rows[7]), nulls_first.normalized_key(_rows[15]));
+        TupleRowComparator nulls_last(ctxs, ctxs, is_asc, false);
+        EXPECT_GT(nulls_last.normalized_key(_rows[7]), nulls_last.normalized_key(_rows[0]));
+        EXPECT_GT(nulls_last.normalized_key(_rows[7]), nulls_last.normalized_key(_rows[6]));
+        EXPECT_EQ(nulls_last.normalized_key(_rows[7]), nulls_last.normalized_key(_rows[15]));
+    }
+}
+
+} // namespace doris
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
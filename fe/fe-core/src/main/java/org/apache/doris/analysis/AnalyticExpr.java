@@ -476,13 +476,16 @@ public class AnalyticExpr extends Expr {
 
         standardize(analyzer);
 
-        // min/max is not currently supported on sliding windows (i.e. start bound is not
-        // unbounded).
+        // min/max on sliding windows (i.e. start bound is not unbounded) is only supported
+        // for ROWS windows, the backend keeps a monotonic deque of the window rows because
+        // min/max can not remove a value.
         if (window != null && isMinMax(fn) &&
                 window.getLeftBoundary().getType() != BoundaryType.UNBOUNDED_PRECEDING) {
-            throw new AnalysisException(
-                "'" + getFnCall().toSql() + "' is only supported with an "
-                + "UNBOUNDED PRECEDING start bound.");
+            if (window.getType() != AnalyticWindow.Type.ROWS) {
+                throw new AnalysisException(
+                    "'" + getFnCall().toSql() + "' is only supported with an "
+                    + "UNBOUNDED PRECEDING start bound for RANGE windows.");
+            }
         }
 
         setChildren();
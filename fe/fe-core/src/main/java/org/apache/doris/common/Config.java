@@ -1277,6 +1277,15 @@ public class Config extends ConfigBase {
     @ConfField(mutable = true, masterOnly = true)
     public static double default_max_filter_ratio = 0;
 
+    /*
+     * If set to true, only one replica of each tablet builds the rowset when loading,
+     * and the other replicas receive the finished segment files from it.
+     * This saves the CPU of sorting, aggregating and encoding data on the other replicas.
+     * Only tablets with beta rowset are supported.
+     */
+    @ConfField(mutable = true, masterOnly = true)
+    public static boolean enable_single_replica_load = false;
+
     /**
      * HTTP Server V2 is implemented by SpringBoot.
      * It uses an architecture that separates front and back ends.
@@ -193,7 +193,11 @@ public class BrokerScanNode extends LoadScanNode {
         context.params = params;
 
         BrokerFileGroup fileGroup = context.fileGroup;
-        params.setColumnSeparator(fileGroup.getValueSeparator().getBytes(Charset.forName("UTF-8"))[0]);
+        byte[] columnSeparator = fileGroup.getValueSeparator().getBytes(Charset.forName("UTF-8"));
+        params.setColumnSeparator(columnSeparator[0]);
+        if (columnSeparator.length > 1) {
+            params.setMultiColumnSeparator(fileGroup.getValueSeparator());
+        }
         params.setLineDelimiter(fileGroup.getLineDelimiter().getBytes(Charset.forName("UTF-8"))[0]);
         params.setStrictMode(strictMode);
         params.setProperties(brokerDesc.getProperties());
@@ -269,6 +269,7 @@ public class HashJoinNode extends PlanNode {
             msg.hash_join_node.addToOtherJoinConjuncts(e.treeToThrift());
         }
         msg.hash_join_node.setIsPushDown(isPushDown);
+        msg.hash_join_node.setIsBroadcastJoin(distrMode == DistributionMode.BROADCAST);
     }
 
     @Override
@@ -33,6 +33,7 @@ import org.apache.doris.catalog.PartitionType;
 import org.apache.doris.catalog.RangePartitionInfo;
 import org.apache.doris.catalog.Tablet;
 import org.apache.doris.common.AnalysisException;
+import org.apache.doris.common.Config;
 import org.apache.doris.common.DdlException;
 import org.apache.doris.common.ErrorCode;
 import org.apache.doris.common.ErrorReport;
@@ -124,6 +125,7 @@ public class OlapTableSink extends DataSink {
         }
         tSink.setNumReplicas(numReplicas);
         tSink.setNeedGenRollup(dstTable.shouldLoadToNewRollup());
+        tSink.setWriteSingleReplica(Config.enable_single_replica_load);
         tSink.setSchema(createSchema(tSink.getDbId(), dstTable));
         tSink.setPartition(createPartition(tSink.getDbId(), dstTable));
         tSink.setLocation(createLocation(dstTable));
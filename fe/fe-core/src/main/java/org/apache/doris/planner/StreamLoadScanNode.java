@@ -129,7 +129,11 @@ public class StreamLoadScanNode extends LoadScanNode {
 
         if (taskInfo.getColumnSeparator() != null) {
             String sep = taskInfo.getColumnSeparator().getColumnSeparator();
-            params.setColumnSeparator(sep.getBytes(Charset.forName("UTF-8"))[0]);
+            byte[] sepBytes = sep.getBytes(Charset.forName("UTF-8"));
+            params.setColumnSeparator(sepBytes[0]);
+            if (sepBytes.length > 1) {
+                params.setMultiColumnSeparator(sep);
+            }
         } else {
             params.setColumnSeparator((byte) '\t');
         }
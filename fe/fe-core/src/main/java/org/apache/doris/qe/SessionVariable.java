@@ -111,6 +111,10 @@ public class SessionVariable implements Serializable, Writable {
     // when true, the partition column must be set to NOT NULL.
     public static final String ALLOW_PARTITION_COLUMN_NULLABLE = "allow_partition_column_nullable";
 
+    // codec to compress the row batches sent between fragments: none, snappy, lz4 or zstd
+    public static final String FRAGMENT_TRANSMISSION_COMPRESSION_CODEC =
+            "fragment_transmission_compression_codec";
+
     // max memory used on every backend.
     @VariableMgr.VarAttr(name = EXEC_MEM_LIMIT)
     public long maxExecMemByte = 2147483648L;
@@ -276,6 +280,10 @@ public class SessionVariable implements Serializable, Writable {
     @VariableMgr.VarAttr(name = ALLOW_PARTITION_COLUMN_NULLABLE)
     private boolean allowPartitionColumnNullable = true;
 
+    // empty means unset, BE will use its config `compress_rowbatches`
+    @VariableMgr.VarAttr(name = FRAGMENT_TRANSMISSION_COMPRESSION_CODEC)
+    private String fragmentTransmissionCompressionCodec = "";
+
     public long getMaxExecMemByte() {
         return maxExecMemByte;
     }
@@ -536,6 +544,14 @@ public class SessionVariable implements Serializable, Writable {
 
     public boolean isAllowPartitionColumnNullable() { return allowPartitionColumnNullable; }
 
+    public String getFragmentTransmissionCompressionCodec() {
+        return fragmentTransmissionCompressionCodec;
+    }
+
+    public void setFragmentTransmissionCompressionCodec(String fragmentTransmissionCompressionCodec) {
+        this.fragmentTransmissionCompressionCodec = fragmentTransmissionCompressionCodec;
+    }
+
 
     // Serialize to thrift object
     // used for rest api
@@ -564,6 +580,9 @@ public class SessionVariable implements Serializable, Writable {
             tResult.setMaxPushdownConditionsPerColumn(maxPushdownConditionsPerColumn);
         }
         tResult.setEnableSpilling(enableSpilling);
+        if (!fragmentTransmissionCompressionCodec.isEmpty()) {
+            tResult.setFragmentTransmissionCompressionCodec(fragmentTransmissionCompressionCodec);
+        }
         return tResult;
     }
 
@@ -1351,6 +1351,28 @@ public class QueryPlanTest {
         Assert.assertTrue(explainString.contains("lag(`query_time`, 1, 2)"));
     }
 
+    @Test
+    public void testMinMaxSlidingWindow() throws Exception {
+        connectContext.setDatabase("default_cluster:test");
+
+        String queryStr = "explain select time, min(query_time) over (partition by user order by time "
+                + "rows between 2 preceding and current row) from test.test1";
+        String explainString = UtFrameUtils.getSQLPlanOrErrorMsg(connectContext, queryStr);
+        Assert.assertTrue(explainString.contains("min(`query_time`)"));
+        Assert.assertTrue(explainString.contains("window: ROWS BETWEEN 2 PRECEDING AND CURRENT ROW"));
+
+        queryStr = "explain select time, max(query_time) over (order by time "
+                + "rows between 3 preceding and 1 following) from test.test1";
+        explainString = UtFrameUtils.getSQLPlanOrErrorMsg(connectContext, queryStr);
+        Assert.assertTrue(explainString.contains("max(`query_time`)"));
+        Assert.assertTrue(explainString.contains("window: ROWS BETWEEN 3 PRECEDING AND 1 FOLLOWING"));
+
+        queryStr = "explain select time, min(query_time) over (order by time "
+                + "rows between 3 preceding and 1 preceding) from test.test1";
+        explainString = UtFrameUtils.getSQLPlanOrErrorMsg(connectContext, queryStr);
+        Assert.assertTrue(explainString.contains("window: ROWS BETWEEN 3 PRECEDING AND 1 PRECEDING"));
+    }
+
     @Test
     public void testIntDateTime() throws Exception {
         connectContext.setDatabase("default_cluster:test");
@@ -122,6 +122,9 @@ struct TOlapTableSink {
     12: required Descriptors.TOlapTableLocationParam location
     13: required Descriptors.TPaloNodesInfo nodes_info
     14: optional i64 load_channel_timeout_s // the timeout of load channels in second
+    // if true, only one replica of each tablet builds the rowset, the others
+    // receive the finished segment files from it
+    15: optional bool write_single_replica
 }
 
 struct TDataSink {
@@ -138,6 +138,9 @@ struct TQueryOptions {
   30: optional i32 max_pushdown_conditions_per_column
   // whether enable spilling to disk
   31: optional bool enable_spilling = false;
+  // codec to compress the row batches sent between fragments: none, snappy, lz4 or zstd.
+  // if not set, BE config `compress_rowbatches` decides between snappy and none.
+  32: optional string fragment_transmission_compression_codec
 }
     
 
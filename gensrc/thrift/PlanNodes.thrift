@@ -165,6 +165,9 @@ struct TBrokerScanRangeParams {
     // strictMode is a boolean
     // if strict mode is true, the incorrect data (the result of cast is null) will not be loaded
     10: optional bool strict_mode
+    // the whole column separator, if it has more than one byte.
+    // column_separator is the first byte of it.
+    11: optional string multi_column_separator
 }
 
 // Broker scan range
@@ -362,6 +365,10 @@ struct THashJoinNode {
   // If true, this join node can (but may choose not to) generate slot filters
   // after constructing the build side that can be applied to the probe side.
   5: optional bool add_probe_filters
+
+  // If true, every instance of this join receives the same build rows, so the instances
+  // on one backend can share a single hash table.
+  6: optional bool is_broadcast_join
 }
 
 struct TMergeJoinNode {